@@ -81,6 +81,8 @@ Bool TAppDecCfg::parseCfg( Int argc, Char* argv[] )
   ("SEIpictureDigest", m_decodedPictureHashSEIEnabled, 1, "deprecated alias for SEIDecodedPictureHash")
   ("TarDecLayerIdSetFile,l", cfg_TargetDecLayerIdSetFile, string(""), "targetDecLayerIdSet file name. The file should include white space separated LayerId values to be decoded. Omitting the option or a value of -1 in the file decodes all layers.")
   ("RespectDefDispWindow,w", m_respectDefDispWindow, 0, "Only output content inside the default display window\n")
+  ("Threads", m_numWorkerThreads, 1, "number of threads used for CTU-parallel loop filtering (1: single-threaded)")
+  ("FrameParallel", m_bFrameParallel, false, "run the in-loop filters of each picture on an extra thread while the next picture is decoded")
   ;
 
   po::setDefaults(opts);
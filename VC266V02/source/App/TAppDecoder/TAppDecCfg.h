@@ -67,6 +67,8 @@ protected:
 
   std::vector<Int> m_targetDecLayerIdSet;             ///< set of LayerIds to be included in the sub-bitstream extraction process.
   Int           m_respectDefDispWindow;               ///< Only output content inside the default display window 
+  Int           m_numWorkerThreads;                   ///< number of threads used for CTU-parallel loop filtering
+  Bool          m_bFrameParallel;                     ///< filter each picture on its own thread while the next one is decoded
 
 public:
   TAppDecCfg()
@@ -78,6 +80,8 @@ public:
   , m_iMaxTemporalLayer(-1)
   , m_decodedPictureHashSEIEnabled(0)
   , m_respectDefDispWindow(0)
+  , m_numWorkerThreads(1)
+  , m_bFrameParallel(false)
   {}
   virtual ~TAppDecCfg() {}
   
@@ -254,6 +254,8 @@ Void TAppDecTop::xInitDecLib()
   // initialize decoder class
   m_cTDecTop.init();
   m_cTDecTop.setDecodedPictureHashSEIEnabled(m_decodedPictureHashSEIEnabled);
+  m_cTDecTop.setNumWorkerThreads(m_numWorkerThreads);
+  m_cTDecTop.setFrameParallel(m_bFrameParallel);
 }
 
 /** \param pcListPic list of pictures to be written to file
@@ -292,6 +294,11 @@ Void TAppDecTop::xWriteOutput( TComList<TComPic*>* pcListPic, UInt tId )
     
     if ( pcPic->getOutputMark() && (numPicsNotYetDisplayed >  pcPic->getNumReorderPics(tId) && pcPic->getPOC() > m_iPOCLastDisplay))
     {
+      if ( !pcPic->isFinished() )
+      {
+        // still in the in-loop filters (frame-parallel decoding), it is written with the next call
+        break;
+      }
       // write to file
       numPicsNotYetDisplayed--;
       if ( m_pchReconFile )
@@ -331,6 +338,9 @@ Void TAppDecTop::xFlushOutput( TComList<TComPic*>* pcListPic )
   {
     return;
   } 
+  // the pictures are written and destroyed below
+  m_cTDecTop.waitForFilterStage();
+
   TComList<TComPic*>::iterator iterPic   = pcListPic->begin();
 
   iterPic   = pcListPic->begin();
@@ -245,6 +245,8 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ("FrameRate,-fr",         m_iFrameRate,          0, "Frame rate")
   ("FrameSkip,-fs",         m_FrameSkip,          0u, "Number of frames to skip at start of input YUV")
   ("FramesToBeEncoded,f",   m_framesToBeEncoded,   0, "Number of frames to be encoded (default=all)")
+  ("Threads",               m_numWorkerThreads,    1, "Number of threads used for CTU-parallel encoder stages (1: single-threaded)")
+  ("AsyncMetrics",          m_bAsyncMetrics,   false, "Compute PSNR/SSIM of a picture on a helper thread while the next picture is encoded")
   
   // Profile and level
   ("Profile", m_profile,   Profile::NONE, "Profile to be used when encoding (Incomplete)")
@@ -306,6 +308,8 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ("ALF", m_bUseALF, true, "Enable Adaptive Loop Filter")
 #if MQT_ALF_NPASS
   ("ALFEncodePassReduction", m_iALFEncodePassReduction, 0, "0:Original 16-pass, 1: 1-pass, 2: 2-pass encoding")
+  ("ALFTemporalReuse", m_bALFTemporalReuse, false, "Reuse or refit the ALF filters of the previous picture of the same temporal layer before a full design")
+  ("ALFCtuRowMode", m_bALFCtuRowMode, false, "Single-pass ALF: luma filter designed from the previous picture, deblocking/SAO/ALF run row by row while the picture is coded, no CU control or chroma ALF")
 #endif
 #endif
 
@@ -326,6 +330,7 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
 
   ("WeightedPredP,-wpP",          m_useWeightedPred,               false,      "Use weighted prediction in P slices")
   ("WeightedPredB,-wpB",          m_useWeightedBiPred,             false,      "Use weighted (bidirectional) prediction in B slices")
+  ("WPSADSubsample",              m_iWPSADSubsample,               2,          "Sample and line step of the SAD comparison that decides weighted prediction per reference (1: all samples)")
   ("Log2ParallelMergeLevel",      m_log2ParallelMergeLevel,        2u,         "Parallel merge estimation region")
 
   ("WaveFrontSynchro",            m_iWaveFrontSynchro,             0,          "0: no synchro; 1 synchro with TR; 2 TRR etc")
@@ -334,6 +339,8 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
 
   /* Misc. */
   ("SEIDecodedPictureHash",       m_decodedPictureHashSEIEnabled, 0, "Control generation of decode picture hash SEI messages\n"
+                                                                    "\t3: use checksum\n"
+                                                                    "\t2: use CRC\n"
                                                                     "\t1: use MD5\n"
                                                                     "\t0: disable")
   ("SEIpictureDigest",            m_decodedPictureHashSEIEnabled, 0, "deprecated alias for SEIDecodedPictureHash")
@@ -343,6 +350,11 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ("FDM", m_useFastDecisionForMerge, true, "Fast decision for Merge RD Cost") 
   ("CFM", m_bUseCbfFastMode, false, "Cbf fast mode setting")
   ("ESD", m_useEarlySkipDetection, false, "Early SKIP detection setting")
+  ("FastIntraSearch", m_useFastIntraSearch, false, "Fast intra mode search: MPM/gradient seeded SATD candidates with +-2/+-1 refinement")
+  ("FastCUSplit", m_useFastCUSplit, false, "Early CU split termination from neighbouring/co-located depths, residual and RD cost")
+  ("FastCUSplitScale", m_fastCUSplitScale, 1.0, "Scale of the FastCUSplit cost thresholds (larger terminates more splits)")
+  ("FastMergeRD", m_useFastMergeRD, false, "Full RD check of 2Nx2N merge only for the candidates with the lowest SATD and merge index cost")
+  ("FastMergeRDCands", m_fastMergeRDCands, 2, "Number of merge candidates kept for the full RD check by FastMergeRD")
   ( "RateControl",         m_RCEnableRateControl,   false, "Rate control: enable rate control" )
   ( "TargetBitrate",       m_RCTargetBitrate,           0, "Rate control: target bitrate" )
   ( "KeepHierarchicalBit", m_RCKeepHierarchicalBit,     0, "Rate control: 0: equal bit allocation; 1: fixed ratio bit allocation; 2: adaptive ratio bit allocation" )
@@ -350,6 +362,9 @@ Bool TAppEncCfg::parseCfg( Int argc, Char* argv[] )
   ( "RCLCUSeparateModel",  m_RCUseLCUSeparateModel,  true, "Rate control: use LCU level separate R-lambda model" )
   ( "InitialQP",           m_RCInitialQP,               0, "Rate control: initial QP" )
   ( "RCForceIntraQP",      m_RCForceIntraQP,        false, "Rate control: force intra QP to be equal to initial QP" )
+  ( "RCLookahead",         m_RCLookahead,           false, "Rate control: weight bit allocation by complexity measured ahead of coding on a background thread" )
+  ( "RCCpbSize",           m_RCCpbSize,                 0, "Rate control: HRD coded picture buffer size in bits, 0: no buffer constraint" )
+  ( "RCCpbMaxBitrate",     m_RCCpbMaxBitrate,           0, "Rate control: HRD coded picture buffer input bitrate, 0: TargetBitrate" )
 
 #if _Cal_SSIM_
   ( "SSIM,-ssim",          m_printSSIM,             true, "Pintout>> 0: only PSNR; 1: both PSNR and SSIM" )
@@ -596,10 +611,17 @@ Void TAppEncCfg::xCheckParameter()
   
   xConfirmPara(  m_maxNumMergeCand < 1,  "MaxNumMergeCand must be 1 or greater.");
   xConfirmPara(  m_maxNumMergeCand > 5,  "MaxNumMergeCand must be 5 or smaller.");
+  xConfirmPara(  m_iWPSADSubsample < 1,  "WPSADSubsample must be 1 or greater.");
+  xConfirmPara(  m_useFastMergeRD && m_fastMergeRDCands < 1, "FastMergeRDCands must be 1 or greater.");
 
 #if ALF_TEST
 #if MQT_ALF_NPASS
   xConfirmPara(m_iALFEncodePassReduction < 0 || m_iALFEncodePassReduction > 2, "ALFEncodePassReduction must be equal to 0, 1 or 2");
+  xConfirmPara(m_bALFTemporalReuse && m_iALFEncodePassReduction != 0, "ALFTemporalReuse requires ALFEncodePassReduction equal to 0");
+  xConfirmPara(m_bALFCtuRowMode && m_iALFEncodePassReduction != 0, "ALFCtuRowMode requires ALFEncodePassReduction equal to 0");
+  xConfirmPara(m_bALFCtuRowMode && m_bALFTemporalReuse, "ALFCtuRowMode and ALFTemporalReuse cannot be used together");
+  xConfirmPara(m_bALFCtuRowMode && m_saoLcuBoundary, "ALFCtuRowMode requires SAOLcuBoundary equal to 0");
+  xConfirmPara(m_bALFCtuRowMode && m_DeblockingFilterMetric, "ALFCtuRowMode requires DeblockingFilterMetric equal to 0");
 #endif
 #endif
 
@@ -960,6 +982,11 @@ Void TAppEncCfg::xCheckParameter()
       }
     }
   }
+  xConfirmPara( m_RCCpbSize < 0, "RCCpbSize cannot be negative" );
+  xConfirmPara( m_RCCpbSize > 0 && !m_RCEnableRateControl, "RCCpbSize requires RateControl" );
+  xConfirmPara( m_RCCpbMaxBitrate < 0, "RCCpbMaxBitrate cannot be negative" );
+  xConfirmPara( m_RCCpbSize > 0 && m_RCCpbMaxBitrate > 0 && m_RCCpbMaxBitrate < m_RCTargetBitrate, "RCCpbMaxBitrate must not be smaller than TargetBitrate" );
+  xConfirmPara( m_RCCpbSize > 0 && m_RCCpbSize < 2 * ( m_RCCpbMaxBitrate > 0 ? m_RCCpbMaxBitrate : m_RCTargetBitrate ) / m_iFrameRate, "RCCpbSize must hold at least two pictures at the buffer input bitrate" );
 
   xConfirmPara(!m_TransquantBypassEnableFlag && m_CUTransquantBypassFlagForce, "CUTransquantBypassFlagForce cannot be 1 when TransquantBypassEnableFlag is 0");
 
@@ -1005,6 +1032,8 @@ Void TAppEncCfg::xPrintParameter()
   printf("Real     Format              : %dx%d %dHz\n", m_iSourceWidth - m_confWinLeft - m_confWinRight, m_iSourceHeight - m_confWinTop - m_confWinBottom, m_iFrameRate );
   printf("Internal Format              : %dx%d %dHz\n", m_iSourceWidth, m_iSourceHeight, m_iFrameRate );
   printf("Frame index                  : %u - %d (%d frames)\n", m_FrameSkip, m_FrameSkip+m_framesToBeEncoded-1, m_framesToBeEncoded );
+  printf("Threads                      : %d\n", m_numWorkerThreads );
+  printf("Async metrics                : %d\n", m_bAsyncMetrics );
   printf("CU size / depth              : %d / %d\n", m_uiMaxCUWidth, m_uiMaxCUDepth );
   printf("RQT trans. size (min / max)  : %d / %d\n", 1 << m_uiQuadtreeTULog2MinSize, 1 << m_uiQuadtreeTULog2MaxSize );
   printf("Max RQT depth inter          : %d\n", m_uiQuadtreeTUMaxDepthInter);
@@ -1031,6 +1060,9 @@ Void TAppEncCfg::xPrintParameter()
     printf("UseLCUSeparateModel          : %d\n", m_RCUseLCUSeparateModel );
     printf("InitialQP                    : %d\n", m_RCInitialQP );
     printf("ForceIntraQP                 : %d\n", m_RCForceIntraQP );
+    printf("Lookahead                    : %d\n", m_RCLookahead );
+    printf("CpbSize                      : %d\n", m_RCCpbSize );
+    printf("CpbMaxBitrate                : %d\n", m_RCCpbMaxBitrate );
   }
   printf("Max Num Merge Candidates     : %d\n", m_maxNumMergeCand);
   printf("\n");
@@ -1046,6 +1078,9 @@ Void TAppEncCfg::xPrintParameter()
   printf("FDM:%d ", m_useFastDecisionForMerge );
   printf("CFM:%d ", m_bUseCbfFastMode         );
   printf("ESD:%d ", m_useEarlySkipDetection  );
+  printf("FIS:%d ", m_useFastIntraSearch     );
+  printf("FCS:%d ", m_useFastCUSplit         );
+  printf("FMR:%d ", m_useFastMergeRD         );
   printf("RQT:%d ", 1     );
   printf("TransformSkip:%d ",     m_useTransformSkip              );
   printf("TransformSkipFast:%d ", m_useTransformSkipFast       );
@@ -1054,6 +1089,10 @@ Void TAppEncCfg::xPrintParameter()
 
 #if ALF_TEST
   printf("ALF:%d ", (m_bUseALF) ? (1) : (0));
+#if MQT_ALF_NPASS
+  printf("ALFTemporalReuse:%d ", m_bALFTemporalReuse);
+  printf("ALFCtuRowMode:%d ", m_bALFCtuRowMode);
+#endif
 #endif
 
   printf("PCM:%d ", (m_usePCM && (1<<m_uiPCMLog2MinSize) <= m_uiMaxCUWidth)? 1 : 0);
@@ -1067,6 +1106,10 @@ Void TAppEncCfg::xPrintParameter()
   }
   printf("WPP:%d ", (Int)m_useWeightedPred);
   printf("WPB:%d ", (Int)m_useWeightedBiPred);
+  if (m_useWeightedPred || m_useWeightedBiPred)
+  {
+    printf("WPSADSubsample:%d ", m_iWPSADSubsample);
+  }
   printf("PME:%d ", m_log2ParallelMergeLevel);
   printf(" WaveFrontSynchro:%d WaveFrontSubstreams:%d",
           m_iWaveFrontSynchro, m_iWaveFrontSubstreams);
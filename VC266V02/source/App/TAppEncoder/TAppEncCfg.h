@@ -71,6 +71,8 @@ protected:
   Int       m_confWinBottom;
 
   Int       m_framesToBeEncoded;                              ///< number of encoded frames
+  Int       m_numWorkerThreads;                               ///< number of threads used for CTU-parallel encoder stages
+  Bool      m_bAsyncMetrics;                                  ///< compute picture quality metrics on a helper thread
   Int       m_aiPad[2];                                       ///< number of padded pixels for width and height
   
   // profile/level
@@ -136,6 +138,8 @@ protected:
   Bool      m_bUseALF;
 #ifdef MQT_ALF_NPASS
   Int       m_iALFEncodePassReduction;                        ///< ALF encoding pass, 0 = original 16-pass, 1 = 1-pass, 2 = 2-pass
+  Bool      m_bALFTemporalReuse;                              ///< reuse the ALF filters of the previous picture of the same temporal layer
+  Bool      m_bALFCtuRowMode;                                 ///< single-pass ALF, in-loop filters run per CTU row while coding
 #endif
 #endif
 
@@ -165,6 +169,11 @@ protected:
   Bool      m_useFastDecisionForMerge;                        ///< flag for using Fast Decision Merge RD-Cost 
   Bool      m_bUseCbfFastMode;                              ///< flag for using Cbf Fast PU Mode Decision
   Bool      m_useEarlySkipDetection;                         ///< flag for using Early SKIP Detection
+  Bool      m_useFastIntraSearch;                            ///< flag for using the seeded fast intra mode search
+  Bool      m_useFastCUSplit;                                ///< flag for using the early CU split termination
+  Double    m_fastCUSplitScale;                              ///< scale of the early CU split termination thresholds
+  Bool      m_useFastMergeRD;                                ///< flag for using the two-stage merge decision
+  Int       m_fastMergeRDCands;                              ///< number of merge candidates kept for the full RD check
 
   Int       m_iWaveFrontSynchro; //< 0: no WPP. >= 1: WPP is enabled, the "Top right" from which inheritance occurs is this LCU offset in the line above the current.
   Int       m_iWaveFrontSubstreams; //< If iWaveFrontSynchro, this is the number of substreams per frame (dependent tiles) or per tile (independent tiles).
@@ -177,6 +186,7 @@ protected:
   // weighted prediction
   Bool      m_useWeightedPred;                    ///< Use of weighted prediction in P slices
   Bool      m_useWeightedBiPred;                  ///< Use of bi-directional weighted prediction in B slices
+  Int       m_iWPSADSubsample;                    ///< sample and line step of the weighted prediction SAD check
   
   UInt      m_log2ParallelMergeLevel;                         ///< Parallel merge estimation region
   UInt      m_maxNumMergeCand;                                ///< Max number of merge candidates
@@ -190,6 +200,9 @@ protected:
   Bool      m_RCUseLCUSeparateModel;              ///< use separate R-lambda model at LCU level
   Int       m_RCInitialQP;                        ///< inital QP for rate control
   Bool      m_RCForceIntraQP;                     ///< force all intra picture to use initial QP or not
+  Bool      m_RCLookahead;                        ///< weight bit allocation by complexity measured ahead of coding
+  Int       m_RCCpbSize;                          ///< HRD coded picture buffer size in bits, 0: no buffer constraint
+  Int       m_RCCpbMaxBitrate;                    ///< HRD coded picture buffer input bitrate, 0: target bitrate
 
   Bool      m_TransquantBypassEnableFlag;                     ///< transquant_bypass_enable_flag setting in PPS.
   Bool      m_CUTransquantBypassFlagForce;                    ///< if transquant_bypass_enable_flag, then, if true, all CU transquant bypass flags will be set to true.
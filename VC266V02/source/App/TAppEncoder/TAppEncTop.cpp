@@ -91,6 +91,8 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setSourceHeight                 ( m_iSourceHeight );
   m_cTEncTop.setConformanceWindow            ( m_confWinLeft, m_confWinRight, m_confWinTop, m_confWinBottom );
   m_cTEncTop.setFramesToBeEncoded            ( m_framesToBeEncoded );
+  m_cTEncTop.setNumWorkerThreads             ( m_numWorkerThreads );
+  m_cTEncTop.setAsyncMetrics                 ( m_bAsyncMetrics );
   
   //====== Coding Structure ========
   m_cTEncTop.setIntraPeriod                  ( m_iIntraPeriod );
@@ -147,6 +149,11 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setUseFastDecisionForMerge      ( m_useFastDecisionForMerge  );
   m_cTEncTop.setUseCbfFastMode            ( m_bUseCbfFastMode  );
   m_cTEncTop.setUseEarlySkipDetection            ( m_useEarlySkipDetection );
+  m_cTEncTop.setUseFastIntraSearch               ( m_useFastIntraSearch );
+  m_cTEncTop.setUseFastCUSplit                   ( m_useFastCUSplit );
+  m_cTEncTop.setFastCUSplitScale                 ( m_fastCUSplitScale );
+  m_cTEncTop.setUseFastMergeRD                   ( m_useFastMergeRD );
+  m_cTEncTop.setFastMergeRDCands                 ( m_fastMergeRDCands );
 
   m_cTEncTop.setUseTransformSkip             ( m_useTransformSkip      );
   m_cTEncTop.setUseTransformSkipFast         ( m_useTransformSkipFast  );
@@ -160,12 +167,15 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setUseALF(m_bUseALF);
 #if MQT_ALF_NPASS
   m_cTEncTop.setALFEncodePassReduction(m_iALFEncodePassReduction);
+  m_cTEncTop.setALFTemporalReuse(m_bALFTemporalReuse);
+  m_cTEncTop.setALFCtuRowMode(m_bALFCtuRowMode);
 #endif
 #endif
 
   //====== Weighted Prediction ========
   m_cTEncTop.setUseWP                   ( m_useWeightedPred      );
   m_cTEncTop.setWPBiPred                ( m_useWeightedBiPred   );
+  m_cTEncTop.setWPSADSubsample          ( m_iWPSADSubsample     );
   //====== Parallel Merge Estimation ========
   m_cTEncTop.setLog2ParallelMergeLevelMinus2 ( m_log2ParallelMergeLevel - 2 );
 
@@ -190,6 +200,9 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setUseLCUSeparateModel ( m_RCUseLCUSeparateModel );
   m_cTEncTop.setInitialQP           ( m_RCInitialQP );
   m_cTEncTop.setForceIntraQP        ( m_RCForceIntraQP );
+  m_cTEncTop.setRCLookahead         ( m_RCLookahead );
+  m_cTEncTop.setCpbSize             ( m_RCCpbSize );
+  m_cTEncTop.setCpbMaxBitrate       ( m_RCCpbMaxBitrate );
   m_cTEncTop.setTransquantBypassEnableFlag(m_TransquantBypassEnableFlag);
   m_cTEncTop.setCUTransquantBypassFlagForceValue(m_CUTransquantBypassFlagForce);
   m_cTEncTop.setUseRecalculateQPAccordingToLambda( m_recalculateQPAccordingToLambda );
@@ -94,6 +94,12 @@
 
 #define NVM_BITS          "[%d bit] ", (sizeof(void*) == 8 ? 64 : 32) ///< used for checking 64-bit O/S
 
+#if ENABLE_SIMD_OPT && ( defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) )
+#define ENABLE_SIMD_SSE2            1           ///< SSE2 is available on the target, kernels include <emmintrin.h>
+#else
+#define ENABLE_SIMD_SSE2            0
+#endif
+
 #ifndef NULL
 #define NULL              0
 #endif
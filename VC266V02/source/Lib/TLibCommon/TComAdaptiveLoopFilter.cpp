@@ -40,6 +40,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 #if ALF_TEST
 
@@ -310,6 +313,25 @@ TComAdaptiveLoopFilter::TComAdaptiveLoopFilter()
 #if MTK_NONCROSS_INLOOP_FILTER
   m_bUseNonCrossALF = false;
 #endif
+#if MTK_NONCROSS_INLOOP_FILTER
+  m_apiAlfWinBuf[0] = m_apiAlfWinBuf[1] = m_apiAlfWinBuf[2] = NULL;
+  m_iAlfWinStride = 0;
+  m_iAlfWinHeight = 0;
+#endif
+#if MQT_BA_RA
+  m_piVarColAct = NULL;
+  m_piVarColVer = NULL;
+  m_piVarColHor = NULL;
+#endif
+  m_pcThreadPool       = NULL;
+  m_iParallelStage     = 0;
+  m_pcParallelPic      = NULL;
+  m_pcParallelAlfParam = NULL;
+  m_pcParallelPicDec   = NULL;
+  m_pcParallelPicRest  = NULL;
+  m_piParallelCoeff    = NULL;
+  m_iParallelTap       = 0;
+  m_iParallelNumRows   = 0;
 }
 
 Void TComAdaptiveLoopFilter:: xError(const char *text, int code)
@@ -498,9 +520,13 @@ Void TComAdaptiveLoopFilter::destroyMatrix4D_double(double ****m4D, int d1, int
   }
 }
 
-Void TComAdaptiveLoopFilter::create( Int iPicWidth, Int iPicHeight, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth )
+/** allocate the buffers of the filter
+ * \param bCreateTempPicYuv allocate the full-picture temporary buffer now; otherwise it is allocated by the first picture
+ *                          that needs it, i.e. a picture filtered slice by slice
+ */
+Void TComAdaptiveLoopFilter::create( Int iPicWidth, Int iPicHeight, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth, Bool bCreateTempPicYuv )
 {
-  if ( !m_pcTempPicYuv )
+  if ( !m_pcTempPicYuv && bCreateTempPicYuv )
   {
     m_pcTempPicYuv = new TComPicYuv;
     m_pcTempPicYuv->create( iPicWidth, iPicHeight, uiMaxCUWidth, uiMaxCUHeight, uiMaxCUDepth );
@@ -509,11 +535,13 @@ Void TComAdaptiveLoopFilter::create( Int iPicWidth, Int iPicHeight, UInt uiMaxCU
   m_img_width = iPicWidth;
 #if !MQT_BA_RA
   initMatrix_imgpel(&m_imgY_var, m_img_height, m_img_width); 
-#endif
   initMatrix_int(&m_imgY_temp, m_img_height+2*VAR_SIZE+3, m_img_width+2*VAR_SIZE+3);
+#endif
 #if MQT_BA_RA
-  initMatrix_int(&m_imgY_ver, m_img_height+2*VAR_SIZE+3, m_img_width+2*VAR_SIZE+3);
-  initMatrix_int(&m_imgY_hor, m_img_height+2*VAR_SIZE+3, m_img_width+2*VAR_SIZE+3);
+  // column sums cover the region plus one column on each side, padded for the block loop
+  m_piVarColAct = new Int[m_img_width + 2*VAR_SIZE_W];
+  m_piVarColVer = new Int[m_img_width + 2*VAR_SIZE_W];
+  m_piVarColHor = new Int[m_img_width + 2*VAR_SIZE_W];
   for(Int i=0; i< NUM_ALF_CLASS_METHOD; i++)
   {
     get_mem2Dpel(&(m_varImgMethods[i]), m_img_width, m_img_width);
@@ -536,6 +564,10 @@ Void TComAdaptiveLoopFilter::create( Int iPicWidth, Int iPicHeight, UInt uiMaxCU
 #if MQT_BA_RA
   createRegionIndexMap(m_varImgMethods[ALF_RA], m_img_width, m_img_height);
 #endif
+#if TSB_ALF_HEADER
+  // the decoder parses ALF parameters while the previous picture may still be filtered, so the CU count is set here
+  m_uiNumCUsInFrame = ( ( m_img_width + uiMaxCUWidth - 1 ) / uiMaxCUWidth ) * ( ( m_img_height + uiMaxCUHeight - 1 ) / uiMaxCUHeight );
+#endif
 }
 
 Void TComAdaptiveLoopFilter::destroy()
@@ -544,15 +576,26 @@ Void TComAdaptiveLoopFilter::destroy()
   {
     m_pcTempPicYuv->destroy();
     delete m_pcTempPicYuv;
+    m_pcTempPicYuv = NULL;
   }
+#if MTK_NONCROSS_INLOOP_FILTER
+  for(Int i = 0; i < 3; i++)
+  {
+    delete [] m_apiAlfWinBuf[i];
+    m_apiAlfWinBuf[i] = NULL;
+  }
+  m_iAlfWinStride = 0;
+  m_iAlfWinHeight = 0;
+#endif
 #if !MQT_BA_RA
   destroyMatrix_imgpel(m_imgY_var); 
-#endif
   destroyMatrix_int(m_imgY_temp);
+#endif
 
 #if MQT_BA_RA
-  destroyMatrix_int(m_imgY_ver);
-  destroyMatrix_int(m_imgY_hor);
+  delete [] m_piVarColAct;
+  delete [] m_piVarColVer;
+  delete [] m_piVarColHor;
   for(Int i=0; i< NUM_ALF_CLASS_METHOD; i++)
   {
     free_mem2Dpel(m_varImgMethods[i]);
@@ -791,16 +834,12 @@ Void TComAdaptiveLoopFilter::ALFProcess(TComPic* pcPic, ALFParam* pcAlfParam)
   }
   
   TComPicYuv* pcPicYuvRec    = pcPic->getPicYuvRec();
-  TComPicYuv* pcPicYuvExtRec = m_pcTempPicYuv;
-#if MTK_NONCROSS_INLOOP_FILTER
-  if(!m_bUseNonCrossALF)
-  {
-#endif     
+  TComPicYuv* pcPicYuvExtRec = NULL;
+#if !MTK_NONCROSS_INLOOP_FILTER
+  pcPicYuvExtRec = xGetTempPicYuv( pcPic );
   pcPicYuvRec   ->copyToPic          ( pcPicYuvExtRec );
   pcPicYuvExtRec->setBorderExtension ( false );
   pcPicYuvExtRec->extendPicBorder    ();
-#if MTK_NONCROSS_INLOOP_FILTER
-  }
 #endif
 
 #if TSB_ALF_HEADER
@@ -825,6 +864,14 @@ Void TComAdaptiveLoopFilter::ALFProcess(TComPic* pcPic, ALFParam* pcAlfParam)
 #endif
 
   }
+#endif
+#if MTK_NONCROSS_INLOOP_FILTER
+  if(!m_bUseNonCrossALF)
+  {
+    xFilterCtuRows(pcPic, pcAlfParam, pcPicYuvRec);
+    return;
+  }
+  pcPicYuvExtRec = xGetTempPicYuv( pcPic );
 #endif
   xALFLuma_qc(pcPic, pcAlfParam, pcPicYuvExtRec, pcPicYuvRec);
   
@@ -835,6 +882,220 @@ Void TComAdaptiveLoopFilter::ALFProcess(TComPic* pcPic, ALFParam* pcAlfParam)
   }
 }
 
+/** temporary picture buffer of the size of pcPic, allocated here if create() did not
+ */
+TComPicYuv* TComAdaptiveLoopFilter::xGetTempPicYuv( TComPic* pcPic )
+{
+  if ( !m_pcTempPicYuv )
+  {
+    TComSPS* pcSPS = pcPic->getSlice(0)->getSPS();
+    m_pcTempPicYuv = new TComPicYuv;
+    m_pcTempPicYuv->create( pcPic->getPicYuvRec()->getWidth(), pcPic->getPicYuvRec()->getHeight(), pcSPS->getMaxCUWidth(), pcSPS->getMaxCUHeight(), pcSPS->getMaxCUDepth() );
+  }
+  return m_pcTempPicYuv;
+}
+
+/** run one stage over items [0, iNumItems), on the worker threads if a thread pool is attached
+ */
+Void TComAdaptiveLoopFilter::runParallelStage(Int iStage, Int iNumItems)
+{
+  m_iParallelStage = iStage;
+  if(m_pcThreadPool != NULL && m_pcThreadPool->getNumThreads() > 1 && iNumItems > 1)
+  {
+    m_pcThreadPool->parallelFor(this, iNumItems);
+  }
+  else
+  {
+    for(Int i = 0; i < iNumItems; i++)
+    {
+      runItem(i, 0);
+    }
+  }
+}
+
+Void TComAdaptiveLoopFilter::runItem(Int itemIdx, Int threadIdx)
+{
+  switch(m_iParallelStage)
+  {
+#if MTK_NONCROSS_INLOOP_FILTER
+  case ALF_STAGE_PLANE_ROWS:
+    {
+      if(m_aiParallelPlane[itemIdx] == 0)
+      {
+        xFilterLumaCtuRows(m_pcParallelPic, m_pcParallelAlfParam, m_pcParallelPicRest);
+      }
+      else
+      {
+        xFilterChromaCtuRows(m_pcParallelAlfParam, m_pcParallelPicRest, m_aiParallelPlane[itemIdx] - 1);
+      }
+    }
+    break;
+#endif
+  case ALF_STAGE_CHROMA_BANDS:
+    {
+      Int iPlane      = m_aiParallelPlane[itemIdx / m_iParallelNumRows];
+      Int iBandHeight = g_uiMaxCUHeight >> 1;
+      Int iHeight     = m_pcParallelPicRest->getHeight() >> 1;
+      Int iRowStart   = (itemIdx % m_iParallelNumRows) * iBandHeight;
+      Int iRowEnd     = min(iRowStart + iBandHeight, iHeight);
+      Int iDecStride  = m_pcParallelPicDec->getCStride();
+      Int iRestStride = m_pcParallelPicRest->getCStride();
+      Pel* pDec  = (iPlane == 2) ? m_pcParallelPicDec->getCrAddr()  : m_pcParallelPicDec->getCbAddr();
+      Pel* pRest = (iPlane == 2) ? m_pcParallelPicRest->getCrAddr() : m_pcParallelPicRest->getCbAddr();
+      xFilterChroma(pDec + iRowStart*iDecStride, iDecStride, pRest + iRowStart*iRestStride, iRestStride,
+                    iRowEnd - iRowStart, m_pcParallelPicRest->getWidth() >> 1, m_piParallelCoeff, m_iParallelTap);
+    }
+    break;
+  default:
+    {
+      printf("Not a supported ALF processing stage\n");
+      assert(0);
+      exit(-1);
+    }
+  }
+}
+
+#if MTK_NONCROSS_INLOOP_FILTER
+/** Load the unfiltered rows of one CTU row of a plane into its line buffer window.
+ * Window row k holds picture row iRowStart-ALF_WIN_MARGIN+k. The ALF_WIN_MARGIN rows above the CTU row have been
+ * filtered in the picture already and are taken over from the window of the previous CTU row.
+ * Rows and columns outside the picture are clamped to the picture border.
+ * \param pWin      window sample of picture row iRowStart-ALF_WIN_MARGIN, column 0
+ * \param iPrevRows height of the previous CTU row
+ */
+Void TComAdaptiveLoopFilter::xLoadAlfWindow( Pel* pWin, Pel* pPic, Int iStride, Int iWidth, Int iHeight, Int iRowStart, Int iRowEnd, Int iPrevRows )
+{
+  const Int iMargin = ALF_WIN_MARGIN;
+  Int k = 0;
+  if(iRowStart > 0)
+  {
+    ::memmove(pWin - iMargin, pWin - iMargin + iPrevRows*iStride, sizeof(Pel)*(2*iMargin*iStride));
+    k = 2*iMargin;
+  }
+  for(; k < iRowEnd - iRowStart + 2*iMargin; k++)
+  {
+    Int y = Clip3(0, iHeight - 1, iRowStart - iMargin + k);
+    Pel* pDst = pWin + k*iStride;
+    const Pel* pSrc = pPic + y*iStride;
+    ::memcpy(pDst, pSrc, sizeof(Pel)*iWidth);
+    for(Int x = 1; x <= iMargin; x++)
+    {
+      pDst[-x]           = pSrc[0];
+      pDst[iWidth-1 + x] = pSrc[iWidth-1];
+    }
+  }
+}
+
+/** Filter the picture in place, one CTU row at a time.
+ * The samples each CTU row reads from beyond its own rows come from small line buffer windows instead of a
+ * border-extended copy of the whole picture.
+ */
+Void TComAdaptiveLoopFilter::xFilterCtuRows(TComPic* pcPic, ALFParam* pcAlfParam, TComPicYuv* pcPicRest)
+{
+  const Int iMargin = ALF_WIN_MARGIN;
+  Int iStride  = pcPicRest->getStride();
+  Int iCStride = pcPicRest->getCStride();
+
+  if(m_iAlfWinStride != iStride || m_iAlfWinHeight != (Int)g_uiMaxCUHeight)
+  {
+    for(Int i = 0; i < 3; i++)
+    {
+      delete [] m_apiAlfWinBuf[i];
+    }
+    m_apiAlfWinBuf[0] = new Pel[(g_uiMaxCUHeight + 2*iMargin) * iStride];
+    m_apiAlfWinBuf[1] = new Pel[((g_uiMaxCUHeight>>1) + 2*iMargin) * iCStride];
+    m_apiAlfWinBuf[2] = new Pel[((g_uiMaxCUHeight>>1) + 2*iMargin) * iCStride];
+    m_iAlfWinStride = iStride;
+    m_iAlfWinHeight = g_uiMaxCUHeight;
+  }
+  imgpel* pRest = (imgpel*)pcPicRest->getLumaAddr();
+  DecFilter_qc(pRest, pcAlfParam, iStride);
+#if MQT_BA_RA
+  m_uiVarGenMethod = pcAlfParam->alf_pcr_region_flag;
+  m_imgY_var       = m_varImgMethods[m_uiVarGenMethod];
+#endif
+  if(pcAlfParam->chroma_idc)
+  {
+    predictALFCoeffChroma(pcAlfParam);
+  }
+
+  // the planes only share read-only parameters, each one is filtered by its own work item
+  Int iNumPlanes = 0;
+  m_aiParallelPlane[iNumPlanes++] = 0;
+  if((pcAlfParam->chroma_idc>>1)&0x01)
+  {
+    m_aiParallelPlane[iNumPlanes++] = 1;
+  }
+  if(pcAlfParam->chroma_idc&0x01)
+  {
+    m_aiParallelPlane[iNumPlanes++] = 2;
+  }
+  m_pcParallelPic      = pcPic;
+  m_pcParallelAlfParam = pcAlfParam;
+  m_pcParallelPicRest  = pcPicRest;
+  runParallelStage(ALF_STAGE_PLANE_ROWS, iNumPlanes);
+  m_pcParallelPic      = NULL;
+  m_pcParallelAlfParam = NULL;
+  m_pcParallelPicRest  = NULL;
+}
+
+/** In-place luma ALF of the whole picture, one CTU row at a time
+ */
+Void TComAdaptiveLoopFilter::xFilterLumaCtuRows(TComPic* pcPic, ALFParam* pcAlfParam, TComPicYuv* pcPicRest)
+{
+  const Int iMargin = ALF_WIN_MARGIN;
+  Int iStride = pcPicRest->getStride();
+  Pel* pWinY  = m_apiAlfWinBuf[0] + iMargin;
+  imgpel* pRest = (imgpel*)pcPicRest->getLumaAddr();
+
+  for(UInt uiRow = 0; uiRow < m_uiNumLCUsInHeight; uiRow++)
+  {
+    Int iRowStart = uiRow * g_uiMaxCUHeight;
+    Int iRowEnd   = min(iRowStart + (Int)g_uiMaxCUHeight, m_img_height);
+
+    xLoadAlfWindow(pWinY, pcPicRest->getLumaAddr(), iStride, m_img_width, m_img_height, iRowStart, iRowEnd, g_uiMaxCUHeight);
+
+    // the luma filters address samples by picture position
+    imgpel* pDec = (imgpel*)(pWinY + (iMargin - iRowStart)*iStride);
+    calcVar(iRowStart, 0, m_imgY_var, pDec, FILTER_LENGTH/2, VAR_SIZE, iRowEnd - iRowStart, m_img_width, iStride);
+    if(pcAlfParam->cu_control_flag)
+    {
+      for(UInt uiCUAddr = uiRow*m_uiNumLCUsInWidth; uiCUAddr < (uiRow+1)*m_uiNumLCUsInWidth; uiCUAddr++)
+      {
+        xSubCUAdaptive_qc(pcPic->getCU(uiCUAddr), pcAlfParam, pRest, pDec, 0, 0, iStride);
+      }
+    }
+    else
+    {
+      subfilterFrame(pRest, pDec, pcAlfParam->realfiltNo, iRowStart, iRowEnd, 0, m_img_width, iStride);
+    }
+  }
+}
+
+/** In-place ALF of one chroma plane of the whole picture, one CTU row at a time
+ \param iColor      0 for Cb and 1 for Cr
+ */
+Void TComAdaptiveLoopFilter::xFilterChromaCtuRows(ALFParam* pcAlfParam, TComPicYuv* pcPicRest, Int iColor)
+{
+  const Int iMargin = ALF_WIN_MARGIN;
+  Int iCStride = pcPicRest->getCStride();
+  Int iCWidth  = m_img_width  >> 1;
+  Int iCHeight = m_img_height >> 1;
+  Pel* pWin    = m_apiAlfWinBuf[1 + iColor] + iMargin;
+  Pel* pPic    = iColor ? pcPicRest->getCrAddr() : pcPicRest->getCbAddr();
+
+  for(UInt uiRow = 0; uiRow < m_uiNumLCUsInHeight; uiRow++)
+  {
+    Int iCRowStart = (uiRow * g_uiMaxCUHeight) >> 1;
+    Int iCRowEnd   = min((Int)((uiRow + 1) * g_uiMaxCUHeight), m_img_height) >> 1;
+
+    xLoadAlfWindow(pWin, pPic, iCStride, iCWidth, iCHeight, iCRowStart, iCRowEnd, g_uiMaxCUHeight>>1);
+    xFilterChroma(pWin + iMargin*iCStride, iCStride, pPic + iCRowStart*iCStride, iCStride,
+                  iCRowEnd - iCRowStart, iCWidth, pcAlfParam->coeff_chroma, pcAlfParam->tap_chroma);
+  }
+}
+#endif
+
 // ====================================================================================================================
 // Protected member functions
 // ====================================================================================================================
@@ -858,7 +1119,9 @@ Void TComAdaptiveLoopFilter::xALFLuma_qc(TComPic* pcPic, ALFParam* pcAlfParam, T
 #endif
 
 #if MTK_NONCROSS_INLOOP_FILTER
+#if !MQT_BA_RA
   memset(m_imgY_temp[0],0,sizeof(int)*(m_img_height+2*VAR_SIZE)*(m_img_width+2*VAR_SIZE));
+#endif
   if(!m_bUseNonCrossALF)
   {
     calcVar(0, 0, m_imgY_var, pDec, FILTER_LENGTH/2, VAR_SIZE, m_img_height, m_img_width, LumaStride);
@@ -1023,6 +1286,57 @@ static imgpel Clip_post(int high, int val)
 {
   return (imgpel)(((val > high)? high: val));
 }
+#if MQT_BA_RA
+/** Accumulate the Laplacians of one row of samples into the per-column sums of a block row
+ * \param pRow    first sample of the row
+ * \param iWidth  number of columns
+ * \param iWeight weight of the row in the activity window
+ * \param bInner  row belongs to the 4x4 blocks, add to the direction sums
+ */
+Void TComAdaptiveLoopFilter::xAccumVarRow(const imgpel* pRow, Int iStride, Int iWidth, Int iWeight, Bool bInner)
+{
+  Int x = 0;
+#if ENABLE_SIMD_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mult = _mm_set1_epi32(iWeight);
+  for(; x + 8 <= iWidth; x += 8)
+  {
+    __m128i cur   = _mm_slli_epi16(_mm_loadu_si128((const __m128i*)(pRow + x)), 1);
+    __m128i ver   = _mm_sub_epi16(_mm_sub_epi16(cur, _mm_loadu_si128((const __m128i*)(pRow + x - iStride))), _mm_loadu_si128((const __m128i*)(pRow + x + iStride)));
+    __m128i hor   = _mm_sub_epi16(_mm_sub_epi16(cur, _mm_loadu_si128((const __m128i*)(pRow + x - 1))), _mm_loadu_si128((const __m128i*)(pRow + x + 1)));
+    ver = _mm_max_epi16(ver, _mm_sub_epi16(zero, ver));
+    hor = _mm_max_epi16(hor, _mm_sub_epi16(zero, hor));
+    __m128i sum = _mm_add_epi16(ver, hor);
+
+    __m128i* pAct = (__m128i*)(m_piVarColAct + x);
+    _mm_storeu_si128(pAct,   _mm_add_epi32(_mm_loadu_si128(pAct),   _mm_madd_epi16(_mm_unpacklo_epi16(sum, zero), mult)));
+    _mm_storeu_si128(pAct+1, _mm_add_epi32(_mm_loadu_si128(pAct+1), _mm_madd_epi16(_mm_unpackhi_epi16(sum, zero), mult)));
+    if(bInner)
+    {
+      __m128i* pVer = (__m128i*)(m_piVarColVer + x);
+      __m128i* pHor = (__m128i*)(m_piVarColHor + x);
+      _mm_storeu_si128(pVer,   _mm_add_epi32(_mm_loadu_si128(pVer),   _mm_unpacklo_epi16(ver, zero)));
+      _mm_storeu_si128(pVer+1, _mm_add_epi32(_mm_loadu_si128(pVer+1), _mm_unpackhi_epi16(ver, zero)));
+      _mm_storeu_si128(pHor,   _mm_add_epi32(_mm_loadu_si128(pHor),   _mm_unpacklo_epi16(hor, zero)));
+      _mm_storeu_si128(pHor+1, _mm_add_epi32(_mm_loadu_si128(pHor+1), _mm_unpackhi_epi16(hor, zero)));
+    }
+  }
+#endif
+  for(; x < iWidth; x++)
+  {
+    Int cur = pRow[x] << 1;
+    Int ver = abs(cur - pRow[x - iStride] - pRow[x + iStride]);
+    Int hor = abs(cur - pRow[x - 1] - pRow[x + 1]);
+    m_piVarColAct[x] += iWeight * (ver + hor);
+    if(bInner)
+    {
+      m_piVarColVer[x] += ver;
+      m_piVarColHor[x] += hor;
+    }
+  }
+}
+#endif
+
 #if MTK_NONCROSS_INLOOP_FILTER
 Void TComAdaptiveLoopFilter::calcVar(int ypos, int xpos, imgpel **imgY_var, imgpel *imgY_pad, int pad_size, int fl, int img_height, int img_width, int img_stride)
 #else
@@ -1036,84 +1350,49 @@ Void TComAdaptiveLoopFilter::calcVar(imgpel **imgY_var, imgpel *imgY_pad, int pa
     return;
   }
 
-  static Int shift_h     = (Int)(log((double)VAR_SIZE_H)/log(2.0));
-  static Int shift_w     = (Int)(log((double)VAR_SIZE_W)/log(2.0));
-
-#if MTK_NONCROSS_INLOOP_FILTER
-  Int start_height = ypos;
-  Int start_width  = xpos;
-  Int end_height   = ypos + img_height;
-  Int end_width    = xpos + img_width;
-#else
-  Int start_height = 0;
-  Int start_width = 0;
-  Int end_height = img_height;
-  Int end_width = img_width;
-#endif
-  Int i, j;
-  Int *p_imgY_temp;
 #if FULL_NBIT
   Int shift= (11+ g_uiBitIncrement + g_uiBitDepth - 8);
 #else
   Int shift= (11+ g_uiBitIncrement);
 #endif
-  Int fl2plusOne= (VAR_SIZE<<1)+1; //3
-  Int pad_offset = pad_size-fl-1;
   Int var_max= NO_VAR_BINS-1;
   Int mult_fact_int_tab[4]= {1,114,41,21};
   Int mult_fact_int = mult_fact_int_tab[VAR_SIZE];
-  Int avg_var;
-  Int vertical, horizontal;
-  Int direction;
   Int step1 = NO_VAR_BINS/3 - 1;
   Int th[NO_VAR_BINS] = {0, 1, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4}; 
-
-  for(i = 1+start_height; i < end_height + fl2plusOne; i++)
-  {
-    Int yoffset = (pad_offset+i-pad_size) * img_stride + pad_offset-pad_size;
-    imgpel *p_imgY_pad = &imgY_pad[yoffset];
-    imgpel *p_imgY_pad_up   = &imgY_pad[yoffset + img_stride];
-    imgpel *p_imgY_pad_down = &imgY_pad[yoffset - img_stride];
-    p_imgY_temp = (Int*)&m_imgY_temp[i-1][start_width];
-    for(j = 1+start_width; j < end_width +fl2plusOne; j++)  
+  // activity window of a 4x4 block: rows and columns -1..4 weighted by 1,2,3,3,2,1
+  static const Int weight[VAR_SIZE_H+2] = {1, 2, 3, 3, 2, 1};
+
+  Int colWidth = img_width + 2;
+  for(Int y = ypos; y < ypos + img_height; y += VAR_SIZE_H)
+  {
+    // per-column sums of the Laplacians over the rows of the block row, starting one column left of the region
+    memset(m_piVarColAct, 0, sizeof(Int)*colWidth);
+    memset(m_piVarColVer, 0, sizeof(Int)*colWidth);
+    memset(m_piVarColHor, 0, sizeof(Int)*colWidth);
+    const imgpel* pRow = imgY_pad + (y-1)*img_stride + xpos - 1;
+    for(Int k = 0; k < VAR_SIZE_H+2; k++, pRow += img_stride)
     {
-      vertical = abs((p_imgY_pad[j]<<1) - p_imgY_pad_down[j] - p_imgY_pad_up[j]);
-      horizontal = abs((p_imgY_pad[j]<<1) - p_imgY_pad[j+1] - p_imgY_pad[j-1]);
-      m_imgY_ver[i-1][j-1] = vertical;
-      m_imgY_hor[i-1][j-1] = horizontal;
-      *(p_imgY_temp++) = vertical + horizontal;
+      xAccumVarRow(pRow, img_stride, colWidth, weight[k], k > 0 && k <= VAR_SIZE_H);
     }
 
-    for(j = 1+start_width; j < end_width + fl2plusOne; j=j+4)  
-    {
-      m_imgY_temp [i-1][j] =  (m_imgY_temp [i-1][j-1] + m_imgY_temp [i-1][j+4])
-        + ((m_imgY_temp [i-1][j] + m_imgY_temp [i-1][j+3]) << 1)
-        + ((m_imgY_temp [i-1][j+1] + m_imgY_temp [i-1][j+2]) * 3);
-      m_imgY_ver[i-1][j] = m_imgY_ver[i-1][j] + m_imgY_ver[i-1][j+1] + m_imgY_ver[i-1][j+2] + m_imgY_ver[i-1][j+3];      
-      m_imgY_hor[i-1][j] = m_imgY_hor[i-1][j] + m_imgY_hor[i-1][j+1] + m_imgY_hor[i-1][j+2] + m_imgY_hor[i-1][j+3];    
-    }
-  }
-
-  for(i = 1+start_height; i < end_height + 1; i=i+4)
-  {
-    for(j = 1+start_width; j < end_width + 1; j=j+4)  
+    imgpel* pVar = &imgY_var[y >> 2][xpos >> 2];
+    for(Int c = 0; c < img_width; c += VAR_SIZE_W)
     {
-      m_imgY_temp [i-1][j-1] =  (m_imgY_temp [i-1][j]+m_imgY_temp [i+4][j])
-        + ((m_imgY_temp [i][j]+m_imgY_temp [i+3][j]) << 1)
-        + ((m_imgY_temp [i+1][j]+m_imgY_temp [i+2][j]) * 3);
+      const Int* pAct = m_piVarColAct + c;
+      Int act        = (pAct[0] + pAct[5]) + ((pAct[1] + pAct[4]) << 1) + ((pAct[2] + pAct[3]) * 3);
+      Int vertical   = m_piVarColVer[c+1] + m_piVarColVer[c+2] + m_piVarColVer[c+3] + m_piVarColVer[c+4];
+      Int horizontal = m_piVarColHor[c+1] + m_piVarColHor[c+2] + m_piVarColHor[c+3] + m_piVarColHor[c+4];
 
-      m_imgY_ver[i-1][j-1] = m_imgY_ver[i][j] + m_imgY_ver[i+1][j] + m_imgY_ver[i+2][j] + m_imgY_ver[i+3][j];  
-      m_imgY_hor[i-1][j-1] = m_imgY_hor[i][j] + m_imgY_hor[i+1][j] + m_imgY_hor[i+2][j] + m_imgY_hor[i+3][j];    
-      avg_var = m_imgY_temp [i-1][j-1]>>(shift_h + shift_w);
-      avg_var = (imgpel) Clip_post(var_max, (avg_var * mult_fact_int)>>shift);
+      Int avg_var = act >> 4;
+      avg_var = Clip_post(var_max, (avg_var * mult_fact_int)>>shift);
       avg_var = th[avg_var];
 
-      direction = 0;
-      if (m_imgY_ver[i-1][j-1] > 2*m_imgY_hor[i-1][j-1]) direction = 1; //vertical
-      if (m_imgY_hor[i-1][j-1] > 2*m_imgY_ver[i-1][j-1]) direction = 2; //horizontal
+      Int direction = 0;
+      if (vertical > 2*horizontal) direction = 1; //vertical
+      if (horizontal > 2*vertical) direction = 2; //horizontal
 
-      avg_var = Clip_post(step1, (Int) avg_var ) + (step1+1)*direction; 
-      imgY_var[(i - 1)>>shift_h][(j - 1)>>shift_w] = avg_var;   
+      *(pVar++) = Clip_post(step1, avg_var) + (step1+1)*direction;
     }
   }
 
@@ -1839,12 +2118,6 @@ Void TComAdaptiveLoopFilter::xFrameChroma(Int ypos, Int xpos, Int iHeight, Int i
 Void TComAdaptiveLoopFilter::xFrameChroma( TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Int *qh, Int iTap, Int iColor )
 #endif
 {
-  Int i, x, y, value, N, offset;
-  //  Pel PixSum[ALF_MAX_NUM_COEF_C];// th
-  Pel PixSum[ALF_MAX_NUM_COEF]; 
-  
-  N      = (iTap*iTap+1)>>1;
-  offset = iTap>>1;
 #if !MTK_NONCROSS_INLOOP_FILTER
   Int iHeight = pcPicRest->getHeight() >> 1;
   Int iWidth = pcPicRest->getWidth() >> 1;
@@ -1855,8 +2128,6 @@ Void TComAdaptiveLoopFilter::xFrameChroma( TComPicYuv* pcPicDec, TComPicYuv* pcP
   Pel* pRest;
   Int iRestStride = pcPicRest->getCStride();
   
-  Int iShift = g_uiBitDepth + g_uiBitIncrement - 8;
-  
   if (iColor)
   {
     pDec = pcPicDec->getCrAddr();
@@ -1881,6 +2152,154 @@ Void TComAdaptiveLoopFilter::xFrameChroma( TComPicYuv* pcPicDec, TComPicYuv* pcP
   }
 #endif
 
+  xFilterChroma(pDec, iDecStride, pRest, iRestStride, iHeight, iWidth, qh, iTap);
+}
+
+/** Whole-picture ALF of the chroma planes selected by iChromaIdc (bit 1: Cb, bit 0: Cr).
+ * The CTU rows of Cb and Cr are independent work items, so both planes are filtered concurrently.
+ \param pcPicDec    picture before ALF, with extended borders
+ \param pcPicRest   picture after  ALF
+ */
+Void TComAdaptiveLoopFilter::xFrameChromaPlanes(TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Int *qh, Int iTap, Int iChromaIdc)
+{
+  Int iNumPlanes = 0;
+  if((iChromaIdc>>1)&0x01)
+  {
+    m_aiParallelPlane[iNumPlanes++] = 1;
+  }
+  if(iChromaIdc&0x01)
+  {
+    m_aiParallelPlane[iNumPlanes++] = 2;
+  }
+  Int iBandHeight = g_uiMaxCUHeight >> 1;
+  m_iParallelNumRows  = ((pcPicRest->getHeight() >> 1) + iBandHeight - 1) / iBandHeight;
+  m_pcParallelPicDec  = pcPicDec;
+  m_pcParallelPicRest = pcPicRest;
+  m_piParallelCoeff   = qh;
+  m_iParallelTap      = iTap;
+  runParallelStage(ALF_STAGE_CHROMA_BANDS, iNumPlanes * m_iParallelNumRows);
+  m_pcParallelPicDec  = NULL;
+  m_pcParallelPicRest = NULL;
+  m_piParallelCoeff   = NULL;
+}
+
+#if ENABLE_SIMD_SSE2
+/** Filter the columns of a chroma block that fill whole vectors of 8 samples, for one tap size.
+ * The point-symmetric sample pairs are added in 16 bits and two neighbouring terms share one multiply-add,
+ * which gives the same wrap-around and rounding as the C code.
+ * \returns number of filtered columns, 0 if the coefficients do not fit 16 bits
+ */
+template<Int iTap>
+static Int xFilterChromaSSE2(const Pel* pDec, Int iDecStride, Pel* pRest, Int iRestStride, Int iHeight, Int iWidth, const Int* qh, Int iShift)
+{
+  const Int N     = (iTap*iTap+1)>>1;
+  const Int iHalf = iTap>>1;
+  Int iVecWidth   = iWidth & ~7;
+  Int i;
+
+  for(i = 0; i < N; i++)
+  {
+    if(qh[i] < -32768 || qh[i] > 32767)
+    {
+      return 0;
+    }
+  }
+  if(iVecWidth == 0)
+  {
+    return 0;
+  }
+
+  // offsets of the upper half of the pattern, in the order of the coefficients; the centre comes last
+  Int aiOffset[N-1];
+  i = 0;
+  for(Int dy = -iHalf; dy <= 0; dy++)
+  {
+    for(Int dx = -iHalf; dx <= iHalf && i < N-1; dx++)
+    {
+      aiOffset[i++] = dy*iDecStride + dx;
+    }
+  }
+  __m128i acCoeff[(N+1)>>1];
+  for(i = 0; i < N-1; i += 2)
+  {
+    acCoeff[i>>1] = _mm_set1_epi32((Int)(((UInt)qh[i+1] << 16) | ((UInt)qh[i] & 0xffff)));
+  }
+  acCoeff[N>>1] = _mm_set1_epi32(qh[N-1] & 0xffff);
+
+  const __m128i zero   = _mm_setzero_si128();
+  const __m128i maxVal = _mm_set1_epi16((Short)g_uiIBDI_MAX);
+  const __m128i offset = _mm_set1_epi32((qh[N] << iShift) + ALF_ROUND_OFFSET);
+  for(Int y = 0; y < iHeight; y++)
+  {
+    for(Int x = 0; x < iVecWidth; x += 8)
+    {
+      const Pel* p = pDec + x;
+      __m128i sumLo = offset;
+      __m128i sumHi = offset;
+      for(i = 0; i < N-1; i += 2)
+      {
+        __m128i t0 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(p + aiOffset[i])),   _mm_loadu_si128((const __m128i*)(p - aiOffset[i])));
+        __m128i t1 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(p + aiOffset[i+1])), _mm_loadu_si128((const __m128i*)(p - aiOffset[i+1])));
+        sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(t0, t1), acCoeff[i>>1]));
+        sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(t0, t1), acCoeff[i>>1]));
+      }
+      __m128i cen = _mm_loadu_si128((const __m128i*)p);
+      sumLo = _mm_add_epi32(sumLo, _mm_madd_epi16(_mm_unpacklo_epi16(cen, zero), acCoeff[N>>1]));
+      sumHi = _mm_add_epi32(sumHi, _mm_madd_epi16(_mm_unpackhi_epi16(cen, zero), acCoeff[N>>1]));
+      sumLo = _mm_srai_epi32(sumLo, ALF_NUM_BIT_SHIFT);
+      sumHi = _mm_srai_epi32(sumHi, ALF_NUM_BIT_SHIFT);
+      __m128i res = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(sumLo, sumHi), zero), maxVal);
+      _mm_storeu_si128((__m128i*)(pRest + x), res);
+    }
+    pDec  += iDecStride;
+    pRest += iRestStride;
+  }
+  return iVecWidth;
+}
+#endif
+
+/** Filter a block of one chroma plane
+ \param pDec        first sample before ALF, iTap/2 samples around the block are read
+ \param pRest       first sample after ALF
+ \param qh          filter coefficient
+ \param iTap        filter tap
+ */
+Void TComAdaptiveLoopFilter::xFilterChroma( Pel* pDec, Int iDecStride, Pel* pRest, Int iRestStride, Int iHeight, Int iWidth, Int *qh, Int iTap )
+{
+  Int i, x, y, value, N;
+  //  Pel PixSum[ALF_MAX_NUM_COEF_C];// th
+  Pel PixSum[ALF_MAX_NUM_COEF]; 
+  
+  N      = (iTap*iTap+1)>>1;
+  
+  Int iShift = g_uiBitDepth + g_uiBitIncrement - 8;
+
+#if ENABLE_SIMD_SSE2
+  Int iVecWidth = 0;
+  switch(iTap)
+  {
+    case 5:
+      iVecWidth = xFilterChromaSSE2<5>(pDec, iDecStride, pRest, iRestStride, iHeight, iWidth, qh, iShift);
+      break;
+    case 7:
+      iVecWidth = xFilterChromaSSE2<7>(pDec, iDecStride, pRest, iRestStride, iHeight, iWidth, qh, iShift);
+      break;
+    case 9:
+      iVecWidth = xFilterChromaSSE2<9>(pDec, iDecStride, pRest, iRestStride, iHeight, iWidth, qh, iShift);
+      break;
+    default:
+      break;
+  }
+  // the remaining columns are left to the C code
+  if(iVecWidth == iWidth)
+  {
+    return;
+  }
+  pDec   += iVecWidth;
+  pRest  += iVecWidth;
+  iWidth -= iVecWidth;
+#endif
+
   Pel* pTmpDec1, *pTmpDec2;
   Pel* pTmpPixSum;
   
@@ -69,8 +69,10 @@
 #endif
 
 #define FILTER_LENGTH          9
+#define ALF_WIN_MARGIN         (FILTER_LENGTH/2)  ///< unfiltered rows/columns kept around a CTU row for in-place filtering
 
 #define MAX_SQR_FILT_LENGTH   ((FILTER_LENGTH*FILTER_LENGTH) / 2 + 2)
+#define MAX_SQR_FILT_TRI_LENGTH (MAX_SQR_FILT_LENGTH*(MAX_SQR_FILT_LENGTH+1)/2)  ///< packed upper triangle of a MAX_SQR_FILT_LENGTH autocorrelation matrix
 #if TI_ALF_MAX_VSIZE_7
 #define SQR_FILT_LENGTH_9SYM  ((9*9) / 4 + 2 - 1) 
 #else
@@ -295,7 +297,7 @@ private:
 
 
 /// adaptive loop filter class
-class TComAdaptiveLoopFilter
+class TComAdaptiveLoopFilter : public TComParallelJob
 {
 protected:
   // quantized filter coefficients
@@ -307,7 +309,30 @@ protected:
 #endif
   
   // temporary picture buffer
-  TComPicYuv*   m_pcTempPicYuv;                          ///< temporary picture buffer for ALF processing
+  TComPicYuv*   m_pcTempPicYuv;                          ///< temporary picture buffer for ALF processing, NULL until needed if not created up front
+#if MTK_NONCROSS_INLOOP_FILTER
+  Pel*          m_apiAlfWinBuf[3];                       ///< unfiltered samples of one CTU row and its ALF_WIN_MARGIN neighbouring rows, per component
+  Int           m_iAlfWinStride;                         ///< luma stride of #m_apiAlfWinBuf
+  Int           m_iAlfWinHeight;                         ///< CTU height #m_apiAlfWinBuf is allocated for
+#endif
+  
+  /// stages spread over the thread pool, dispatched through runItem()
+  enum ParallelStage
+  {
+    ALF_STAGE_PLANE_ROWS = 0,                            ///< item = plane, in-place CTU-row filtering of the whole plane
+    ALF_STAGE_CHROMA_BANDS,                              ///< item = CTU row of a chroma plane, filtering into a separate picture
+    NUM_ALF_BASE_STAGES
+  };
+  TComThreadPool* m_pcThreadPool;
+  Int           m_iParallelStage;
+  TComPic*      m_pcParallelPic;                         ///< picture of the current parallel stage
+  ALFParam*     m_pcParallelAlfParam;                    ///< filter parameters of the current parallel stage
+  TComPicYuv*   m_pcParallelPicDec;                      ///< input of #ALF_STAGE_CHROMA_BANDS
+  TComPicYuv*   m_pcParallelPicRest;                     ///< output of the current parallel stage
+  Int*          m_piParallelCoeff;                       ///< chroma coefficients of #ALF_STAGE_CHROMA_BANDS
+  Int           m_iParallelTap;                          ///< chroma tap of #ALF_STAGE_CHROMA_BANDS
+  Int           m_aiParallelPlane[3];                    ///< plane (0: Y, 1: Cb, 2: Cr) of each group of items
+  Int           m_iParallelNumRows;                      ///< items per plane of #ALF_STAGE_CHROMA_BANDS
   
   // ------------------------------------------------------------------------------------------------------------------
   // For luma component
@@ -345,11 +370,14 @@ protected:
   
   imgpel **m_imgY_pad;
   imgpel **m_imgY_var;
+#if !MQT_BA_RA
   Int    **m_imgY_temp;
+#endif
   
 #if MQT_BA_RA
-  Int**    m_imgY_ver;
-  Int**    m_imgY_hor;
+  Int*     m_piVarColAct;        ///< weighted Laplacian sums per column of one 4x4 block row
+  Int*     m_piVarColVer;        ///< vertical Laplacian sums per column of one 4x4 block row
+  Int*     m_piVarColHor;        ///< horizontal Laplacian sums per column of one 4x4 block row
   UInt     m_uiVarGenMethod;
   imgpel** m_varImgMethods[NUM_ALF_CLASS_METHOD];
 #endif 
@@ -380,8 +408,17 @@ protected:
   Void createRegionIndexMap(imgpel **imgY_var, Int img_width, Int img_height);
 #endif
 
+#if MTK_NONCROSS_INLOOP_FILTER
+  /// in-place ALF of the whole picture, one CTU row at a time
+  Void xFilterCtuRows     ( TComPic* pcPic, ALFParam* pcAlfParam, TComPicYuv* pcPicRest );
+  Void xFilterLumaCtuRows ( TComPic* pcPic, ALFParam* pcAlfParam, TComPicYuv* pcPicRest );
+  Void xFilterChromaCtuRows( ALFParam* pcAlfParam, TComPicYuv* pcPicRest, Int iColor );
+  Void xLoadAlfWindow     ( Pel* pWin, Pel* pPic, Int iStride, Int iWidth, Int iHeight, Int iRowStart, Int iRowEnd, Int iPrevRows );
+#endif
+
   /// ALF for luma component
   Void xALFLuma_qc( TComPic* pcPic, ALFParam* pcAlfParam, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest );
+  TComPicYuv* xGetTempPicYuv( TComPic* pcPic );
   
   Void reconstructFilterCoeffs(ALFParam* pcAlfParam,int **pfilterCoeffSym, int bit_depth);
   Void getCurrentFilter(int **filterCoeffSym,ALFParam* pcAlfParam);
@@ -400,6 +437,9 @@ protected:
   Void get_mem2Dpel(imgpel ***array2D, int rows, int columns);
   Void no_mem_exit(const char *where);
   Void xError(const char *text, int code);
+#if MQT_BA_RA
+  Void xAccumVarRow(const imgpel* pRow, Int iStride, Int iWidth, Int iWeight, Bool bInner);
+#endif
 #if MTK_NONCROSS_INLOOP_FILTER
   Void calcVar(int ypos, int xpos, imgpel **imgY_var, imgpel *imgY_pad, int pad_size, int fl, int img_height, int img_width, int img_stride);
 #else
@@ -429,13 +469,21 @@ protected:
 #else
   Void xFrameChroma ( TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Int *qh, Int iTap, Int iColor );
 #endif
+  Void xFilterChroma( Pel* pDec, Int iDecStride, Pel* pRest, Int iRestStride, Int iHeight, Int iWidth, Int *qh, Int iTap );
+  /// whole-picture ALF of the chroma planes selected by iChromaIdc, Cb and Cr rows spread over the thread pool
+  Void xFrameChromaPlanes( TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Int *qh, Int iTap, Int iChromaIdc );
+  
+  Void runParallelStage( Int iStage, Int iNumItems );
 
 public:
   TComAdaptiveLoopFilter();
   virtual ~TComAdaptiveLoopFilter() {}
   
+  Void setThreadPool( TComThreadPool* pcThreadPool ) { m_pcThreadPool = pcThreadPool; }
+  virtual Void runItem( Int itemIdx, Int threadIdx );
+  
   // initialize & destory temporary buffer
-  Void create  ( Int iPicWidth, Int iPicHeight, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth );
+  Void create  ( Int iPicWidth, Int iPicHeight, UInt uiMaxCUWidth, UInt uiMaxCUHeight, UInt uiMaxCUDepth, Bool bCreateTempPicYuv = true );
   Void destroy ();
   
   // alloc & free & set functions
@@ -42,6 +42,27 @@
 //! \ingroup TLibCommon
 //! \{
 
+/// byte alignment of the arrays carved from the CU storage arena (one cache line)
+static const UInt CU_ARENA_ALIGN = 64;
+
+/// byte-sized per-partition arrays: zero-initialised ones, then the MVP ones reset to -1, then the rest
+static const UInt CU_NUM_ZERO_PLANES  = 13;
+static const UInt CU_NUM_UNSET_PLANES = 4;
+static const UInt CU_NUM_BYTE_PLANES  = 25;
+
+static inline UInt xArenaSize( UInt uiBytes )
+{
+  return ( uiBytes + CU_ARENA_ALIGN - 1 ) & ~( CU_ARENA_ALIGN - 1 );
+}
+
+/// hand out the next cache-line aligned array of uiNum elements from the arena
+template <typename T>
+static inline T* xArenaCarve( UChar*& rpcCur, UInt uiNum )
+{
+  T* p = (T*)rpcCur;
+  rpcCur += xArenaSize( sizeof(T) * uiNum );
+  return p;
+}
 
 // ====================================================================================================================
 // Constructor / destructor / create / destroy
@@ -104,6 +125,9 @@ TComDataCU::TComDataCU()
 
   m_bDecSubCu          = false;
   m_sliceStartCU        = 0;
+  m_pcArena            = NULL;
+  m_pcBytePlanes       = NULL;
+  m_uiBytePlaneStride  = 0;
 }
 
 TComDataCU::~TComDataCU()
@@ -121,67 +145,90 @@ Void TComDataCU::create(UInt uiNumPartition, UInt uiWidth, UInt uiHeight, Bool b
   
   if ( !bDecSubCu )
   {
-    m_phQP               = (Char*     )xMalloc(Char,     uiNumPartition);
-    m_puhDepth           = (UChar*    )xMalloc(UChar,    uiNumPartition);
-    m_puhWidth           = (UChar*    )xMalloc(UChar,    uiNumPartition);
-    m_puhHeight          = (UChar*    )xMalloc(UChar,    uiNumPartition);
-
-    m_skipFlag           = new Bool[ uiNumPartition ];
-
+    // all arrays of the CU live in one cache-line aligned arena: wide buffers first, then the per-partition planes
+    const UInt uiLumaSize   = uiWidth*uiHeight;
+    const UInt uiChromaSize = uiWidth*uiHeight/4;
+    const UInt uiNumBytePlanes = CU_NUM_BYTE_PLANES + 2;
+    UInt uiArenaSize = xArenaSize( sizeof(TCoeff)*uiLumaSize ) + 2*xArenaSize( sizeof(TCoeff)*uiChromaSize )
+                     + xArenaSize( sizeof(Pel)*uiLumaSize )    + 2*xArenaSize( sizeof(Pel)*uiChromaSize )
+                     + 4*xArenaSize( sizeof(TComMv)*uiNumPartition )
+                     + xArenaSize( sizeof(UInt)*uiNumPartition )
+#if ALF_TEST
+                     + xArenaSize( sizeof(UInt)*uiNumPartition )
+#endif
+                     + uiNumBytePlanes*xArenaSize( uiNumPartition );
+
+    m_pcArena = (UChar*)xMalloc( UChar, uiArenaSize + CU_ARENA_ALIGN - 1 );
+    memset( m_pcArena, 0, uiArenaSize + CU_ARENA_ALIGN - 1 );
+    UChar* pcCur = (UChar*)( ( (size_t)m_pcArena + CU_ARENA_ALIGN - 1 ) & ~(size_t)( CU_ARENA_ALIGN - 1 ) );
+    UChar* pcEnd = pcCur + uiArenaSize;
+
+    m_pcTrCoeffY         = xArenaCarve<TCoeff>( pcCur, uiLumaSize   );
+    m_pcTrCoeffCb        = xArenaCarve<TCoeff>( pcCur, uiChromaSize );
+    m_pcTrCoeffCr        = xArenaCarve<TCoeff>( pcCur, uiChromaSize );
+    m_pcIPCMSampleY      = xArenaCarve<Pel>   ( pcCur, uiLumaSize   );
+    m_pcIPCMSampleCb     = xArenaCarve<Pel>   ( pcCur, uiChromaSize );
+    m_pcIPCMSampleCr     = xArenaCarve<Pel>   ( pcCur, uiChromaSize );
+
+    TComMv* pcMv0  = xArenaCarve<TComMv>( pcCur, uiNumPartition );
+    TComMv* pcMvd0 = xArenaCarve<TComMv>( pcCur, uiNumPartition );
+    TComMv* pcMv1  = xArenaCarve<TComMv>( pcCur, uiNumPartition );
+    TComMv* pcMvd1 = xArenaCarve<TComMv>( pcCur, uiNumPartition );
+
+    m_sliceStartCU       = xArenaCarve<UInt>( pcCur, uiNumPartition );
 #if ALF_TEST
-    m_puiAlfCtrlFlag = (UInt*)xMalloc(UInt, uiNumPartition);
+    m_puiAlfCtrlFlag     = xArenaCarve<UInt>( pcCur, uiNumPartition );
 #endif
 
-    m_pePartSize         = new Char[ uiNumPartition ];
+    // the byte-sized arrays are carved in the order CU_NUM_ZERO_PLANES / CU_NUM_UNSET_PLANES / rest, at a fixed stride
+    m_uiBytePlaneStride  = xArenaSize( uiNumPartition );
+    m_pcBytePlanes       = pcCur;
+    m_puhTrIdx           = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhTransformSkip[0] = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhTransformSkip[1] = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhTransformSkip[2] = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhCbf[0]          = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhCbf[1]          = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhCbf[2]          = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_skipFlag           = xArenaCarve<Bool> ( pcCur, uiNumPartition );
+    m_pbIPCMFlag         = xArenaCarve<Bool> ( pcCur, uiNumPartition );
+    m_pbMergeFlag        = xArenaCarve<Bool> ( pcCur, uiNumPartition );
+    m_puhMergeIndex      = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhChromaIntraDir  = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhInterDir        = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_apiMVPIdx[0]       = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_apiMVPIdx[1]       = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_apiMVPNum[0]       = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_apiMVPNum[1]       = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_phQP               = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_puhDepth           = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhWidth           = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_puhHeight          = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    m_pePartSize         = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_pePredMode         = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    m_CUTransquantBypass = xArenaCarve<Bool> ( pcCur, uiNumPartition );
+    m_puhLumaIntraDir    = xArenaCarve<UChar>( pcCur, uiNumPartition );
+    assert( pcCur == m_pcBytePlanes + CU_NUM_BYTE_PLANES*m_uiBytePlaneStride );
+    Char* piRefIdx0      = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    Char* piRefIdx1      = xArenaCarve<Char> ( pcCur, uiNumPartition );
+    assert( pcCur == pcEnd );
+
     memset( m_pePartSize, SIZE_NONE,uiNumPartition * sizeof( *m_pePartSize ) );
-    m_pePredMode         = new Char[ uiNumPartition ];
-    m_CUTransquantBypass = new Bool[ uiNumPartition ];
-    m_pbMergeFlag        = (Bool*  )xMalloc(Bool,   uiNumPartition);
-    m_puhMergeIndex      = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhLumaIntraDir    = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhChromaIntraDir  = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhInterDir        = (UChar* )xMalloc(UChar,  uiNumPartition);
-    
-    m_puhTrIdx           = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhTransformSkip[0] = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhTransformSkip[1] = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhTransformSkip[2] = (UChar* )xMalloc(UChar,  uiNumPartition);
-
-    m_puhCbf[0]          = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhCbf[1]          = (UChar* )xMalloc(UChar,  uiNumPartition);
-    m_puhCbf[2]          = (UChar* )xMalloc(UChar,  uiNumPartition);
-    
-    m_apiMVPIdx[0]       = new Char[ uiNumPartition ];
-    m_apiMVPIdx[1]       = new Char[ uiNumPartition ];
-    m_apiMVPNum[0]       = new Char[ uiNumPartition ];
-    m_apiMVPNum[1]       = new Char[ uiNumPartition ];
     memset( m_apiMVPIdx[0], -1,uiNumPartition * sizeof( Char ) );
     memset( m_apiMVPIdx[1], -1,uiNumPartition * sizeof( Char ) );
-    
-    m_pcTrCoeffY         = (TCoeff*)xMalloc(TCoeff, uiWidth*uiHeight);
-    m_pcTrCoeffCb        = (TCoeff*)xMalloc(TCoeff, uiWidth*uiHeight/4);
-    m_pcTrCoeffCr        = (TCoeff*)xMalloc(TCoeff, uiWidth*uiHeight/4);
-    memset( m_pcTrCoeffY, 0,uiWidth*uiHeight * sizeof( TCoeff ) );
-    memset( m_pcTrCoeffCb, 0,uiWidth*uiHeight/4 * sizeof( TCoeff ) );
-    memset( m_pcTrCoeffCr, 0,uiWidth*uiHeight/4 * sizeof( TCoeff ) );
-    
-    m_pbIPCMFlag         = (Bool*  )xMalloc(Bool, uiNumPartition);
-    m_pcIPCMSampleY      = (Pel*   )xMalloc(Pel , uiWidth*uiHeight);
-    m_pcIPCMSampleCb     = (Pel*   )xMalloc(Pel , uiWidth*uiHeight/4);
-    m_pcIPCMSampleCr     = (Pel*   )xMalloc(Pel , uiWidth*uiHeight/4);
 
-    m_acCUMvField[0].create( uiNumPartition );
-    m_acCUMvField[1].create( uiNumPartition );
+    m_acCUMvField[0].create( uiNumPartition, pcMv0, pcMvd0, piRefIdx0 );
+    m_acCUMvField[1].create( uiNumPartition, pcMv1, pcMvd1, piRefIdx1 );
     
   }
   else
   {
     m_acCUMvField[0].setNumPartition(uiNumPartition );
     m_acCUMvField[1].setNumPartition(uiNumPartition );
+
+    m_sliceStartCU        = (UInt*  )xMalloc(UInt, uiNumPartition);
   }
   
-  m_sliceStartCU        = (UInt*  )xMalloc(UInt, uiNumPartition);
-  
   // create pattern memory
   m_pcPattern            = (TComPattern*)xMalloc(TComPattern, 1);
   
@@ -207,47 +254,47 @@ Void TComDataCU::destroy()
     m_pcPattern = NULL;
   }
   
-  // encoder-side buffer free
+  // encoder-side buffer free: every array is carved from the arena
   if ( !m_bDecSubCu )
   {
-    if ( m_phQP               ) { xFree(m_phQP);                m_phQP              = NULL; }
-    if ( m_puhDepth           ) { xFree(m_puhDepth);            m_puhDepth          = NULL; }
-    if ( m_puhWidth           ) { xFree(m_puhWidth);            m_puhWidth          = NULL; }
-    if ( m_puhHeight          ) { xFree(m_puhHeight);           m_puhHeight         = NULL; }
-
-    if ( m_skipFlag           ) { delete[] m_skipFlag;          m_skipFlag          = NULL; }
-
-    if ( m_pePartSize         ) { delete[] m_pePartSize;        m_pePartSize        = NULL; }
-    if ( m_pePredMode         ) { delete[] m_pePredMode;        m_pePredMode        = NULL; }
-    if ( m_CUTransquantBypass ) { delete[] m_CUTransquantBypass;m_CUTransquantBypass = NULL; }
-    if ( m_puhCbf[0]          ) { xFree(m_puhCbf[0]);           m_puhCbf[0]         = NULL; }
-    if ( m_puhCbf[1]          ) { xFree(m_puhCbf[1]);           m_puhCbf[1]         = NULL; }
-    if ( m_puhCbf[2]          ) { xFree(m_puhCbf[2]);           m_puhCbf[2]         = NULL; }
-    
+    if ( m_pcArena ) { xFree(m_pcArena); m_pcArena = NULL; }
+    m_pcBytePlanes       = NULL;
+
+    m_phQP               = NULL;
+    m_puhDepth           = NULL;
+    m_puhWidth           = NULL;
+    m_puhHeight          = NULL;
+    m_skipFlag           = NULL;
+    m_pePartSize         = NULL;
+    m_pePredMode         = NULL;
+    m_CUTransquantBypass = NULL;
+    m_puhCbf[0]          = NULL;
+    m_puhCbf[1]          = NULL;
+    m_puhCbf[2]          = NULL;
 #if ALF_TEST
-    if (m_puiAlfCtrlFlag) { xFree(m_puiAlfCtrlFlag);      m_puiAlfCtrlFlag = NULL; }
+    m_puiAlfCtrlFlag     = NULL;
 #endif
-    
-    if ( m_puhInterDir        ) { xFree(m_puhInterDir);         m_puhInterDir       = NULL; }
-    if ( m_pbMergeFlag        ) { xFree(m_pbMergeFlag);         m_pbMergeFlag       = NULL; }
-    if ( m_puhMergeIndex      ) { xFree(m_puhMergeIndex);       m_puhMergeIndex     = NULL; }
-    if ( m_puhLumaIntraDir    ) { xFree(m_puhLumaIntraDir);     m_puhLumaIntraDir   = NULL; }
-    if ( m_puhChromaIntraDir  ) { xFree(m_puhChromaIntraDir);   m_puhChromaIntraDir = NULL; }
-    if ( m_puhTrIdx           ) { xFree(m_puhTrIdx);            m_puhTrIdx          = NULL; }
-    if ( m_puhTransformSkip[0]) { xFree(m_puhTransformSkip[0]); m_puhTransformSkip[0] = NULL; }
-    if ( m_puhTransformSkip[1]) { xFree(m_puhTransformSkip[1]); m_puhTransformSkip[1] = NULL; }
-    if ( m_puhTransformSkip[2]) { xFree(m_puhTransformSkip[2]); m_puhTransformSkip[2] = NULL; }
-    if ( m_pcTrCoeffY         ) { xFree(m_pcTrCoeffY);          m_pcTrCoeffY        = NULL; }
-    if ( m_pcTrCoeffCb        ) { xFree(m_pcTrCoeffCb);         m_pcTrCoeffCb       = NULL; }
-    if ( m_pcTrCoeffCr        ) { xFree(m_pcTrCoeffCr);         m_pcTrCoeffCr       = NULL; }
-    if ( m_pbIPCMFlag         ) { xFree(m_pbIPCMFlag   );       m_pbIPCMFlag        = NULL; }
-    if ( m_pcIPCMSampleY      ) { xFree(m_pcIPCMSampleY);       m_pcIPCMSampleY     = NULL; }
-    if ( m_pcIPCMSampleCb     ) { xFree(m_pcIPCMSampleCb);      m_pcIPCMSampleCb    = NULL; }
-    if ( m_pcIPCMSampleCr     ) { xFree(m_pcIPCMSampleCr);      m_pcIPCMSampleCr    = NULL; }
-    if ( m_apiMVPIdx[0]       ) { delete[] m_apiMVPIdx[0];      m_apiMVPIdx[0]      = NULL; }
-    if ( m_apiMVPIdx[1]       ) { delete[] m_apiMVPIdx[1];      m_apiMVPIdx[1]      = NULL; }
-    if ( m_apiMVPNum[0]       ) { delete[] m_apiMVPNum[0];      m_apiMVPNum[0]      = NULL; }
-    if ( m_apiMVPNum[1]       ) { delete[] m_apiMVPNum[1];      m_apiMVPNum[1]      = NULL; }
+    m_puhInterDir        = NULL;
+    m_pbMergeFlag        = NULL;
+    m_puhMergeIndex      = NULL;
+    m_puhLumaIntraDir    = NULL;
+    m_puhChromaIntraDir  = NULL;
+    m_puhTrIdx           = NULL;
+    m_puhTransformSkip[0] = NULL;
+    m_puhTransformSkip[1] = NULL;
+    m_puhTransformSkip[2] = NULL;
+    m_pcTrCoeffY         = NULL;
+    m_pcTrCoeffCb        = NULL;
+    m_pcTrCoeffCr        = NULL;
+    m_pbIPCMFlag         = NULL;
+    m_pcIPCMSampleY      = NULL;
+    m_pcIPCMSampleCb     = NULL;
+    m_pcIPCMSampleCr     = NULL;
+    m_apiMVPIdx[0]       = NULL;
+    m_apiMVPIdx[1]       = NULL;
+    m_apiMVPNum[0]       = NULL;
+    m_apiMVPNum[1]       = NULL;
+    m_sliceStartCU       = NULL;
     
     m_acCUMvField[0].destroy();
     m_acCUMvField[1].destroy();
@@ -262,7 +309,7 @@ Void TComDataCU::destroy()
   m_apcCUColocated[0]   = NULL;
   m_apcCUColocated[1]   = NULL;
 
-  if( m_sliceStartCU )
+  if( m_sliceStartCU )  // decoder sub-CU only
   {
     xFree(m_sliceStartCU);
     m_sliceStartCU=NULL;
@@ -462,6 +509,16 @@ Void TComDataCU::initEstData( UInt uiDepth, Int qp, Bool bTransquantBypass )
   m_uiTotalBits        = 0;
   m_uiTotalBins        = 0;
 
+  xInitPartData( uiDepth, qp, bTransquantBypass );
+}
+
+/** reset the per-partition data, motion fields and residual buffers of an encoder CU
+*\param  uiDepth            depth of the CU
+*\param  qp                 qp for the CU
+*\param  bTransquantBypass  cu_transquant_bypass flag for the CU
+*/
+Void TComDataCU::xInitPartData( UInt uiDepth, Int qp, Bool bTransquantBypass )
+{
   UChar uhWidth  = g_uiMaxCUWidth  >> uiDepth;
   UChar uhHeight = g_uiMaxCUHeight >> uiDepth;
 
@@ -470,49 +527,32 @@ Void TComDataCU::initEstData( UInt uiDepth, Int qp, Bool bTransquantBypass )
   memset(m_puiAlfCtrlFlag, 0, iSizeInUInt);
 #endif
 
-  for (UInt ui = 0; ui < m_uiNumPartition; ui++)
-  {
-      m_apiMVPIdx[0][ui] = -1;
-      m_apiMVPIdx[1][ui] = -1;
-      m_apiMVPNum[0][ui] = -1;
-      m_apiMVPNum[1][ui] = -1;
-      m_puhDepth  [ui] = uiDepth;
-      m_puhWidth  [ui] = uhWidth;
-      m_puhHeight [ui] = uhHeight;
-      m_puhTrIdx  [ui] = 0;
-      m_puhTransformSkip[0][ui] = 0;
-      m_puhTransformSkip[1][ui] = 0;
-      m_puhTransformSkip[2][ui] = 0;
-      m_skipFlag[ui]   = false;
-      m_pePartSize[ui] = SIZE_NONE;
-      m_pePredMode[ui] = MODE_NONE;
-      m_CUTransquantBypass[ui] = bTransquantBypass;
-      m_pbIPCMFlag[ui] = 0;
-      m_phQP[ui] = qp;
-      m_pbMergeFlag[ui] = 0;
-      m_puhMergeIndex[ui] = 0;
-      m_puhLumaIntraDir[ui] = DC_IDX;
-      m_puhChromaIntraDir[ui] = 0;
-      m_puhInterDir[ui] = 0;
-      m_puhCbf[0][ui] = 0;
-      m_puhCbf[1][ui] = 0;
-      m_puhCbf[2][ui] = 0;
-  }
+  // the zero and -1 initialised arrays are contiguous in the arena, clear each group at once
+  memset( m_pcBytePlanes,                                         0, CU_NUM_ZERO_PLANES  * m_uiBytePlaneStride );
+  memset( m_pcBytePlanes + CU_NUM_ZERO_PLANES*m_uiBytePlaneStride, -1, CU_NUM_UNSET_PLANES * m_uiBytePlaneStride );
 
-    m_acCUMvField[0].clearMvField();
-    m_acCUMvField[1].clearMvField();
-    UInt uiTmp = uhWidth*uhHeight;
-    
-    memset( m_pcTrCoeffY,    0, uiTmp * sizeof( *m_pcTrCoeffY    ) );
-    memset( m_pcIPCMSampleY, 0, uiTmp * sizeof( *m_pcIPCMSampleY ) );
+  memset( m_phQP,               qp,                m_uiNumPartition );
+  memset( m_puhDepth,           uiDepth,           m_uiNumPartition );
+  memset( m_puhWidth,           uhWidth,           m_uiNumPartition );
+  memset( m_puhHeight,          uhHeight,          m_uiNumPartition );
+  memset( m_pePartSize,         SIZE_NONE,         m_uiNumPartition );
+  memset( m_pePredMode,         MODE_NONE,         m_uiNumPartition );
+  memset( m_CUTransquantBypass, bTransquantBypass, m_uiNumPartition );
+  memset( m_puhLumaIntraDir,    DC_IDX,            m_uiNumPartition );
 
-    uiTmp>>=2;
-    memset( m_pcTrCoeffCb,    0, uiTmp * sizeof( *m_pcTrCoeffCb    ) );
-    memset( m_pcTrCoeffCr,    0, uiTmp * sizeof( *m_pcTrCoeffCr    ) );
-    memset( m_pcIPCMSampleCb, 0, uiTmp * sizeof( *m_pcIPCMSampleCb ) );
-    memset( m_pcIPCMSampleCr, 0, uiTmp * sizeof( *m_pcIPCMSampleCr ) );
-}
+  m_acCUMvField[0].clearMvField();
+  m_acCUMvField[1].clearMvField();
+  UInt uiTmp = uhWidth*uhHeight;
+  
+  memset( m_pcTrCoeffY,    0, uiTmp * sizeof( *m_pcTrCoeffY    ) );
+  memset( m_pcIPCMSampleY, 0, uiTmp * sizeof( *m_pcIPCMSampleY ) );
 
+  uiTmp>>=2;
+  memset( m_pcTrCoeffCb,    0, uiTmp * sizeof( *m_pcTrCoeffCb    ) );
+  memset( m_pcTrCoeffCr,    0, uiTmp * sizeof( *m_pcTrCoeffCr    ) );
+  memset( m_pcIPCMSampleCb, 0, uiTmp * sizeof( *m_pcIPCMSampleCb ) );
+  memset( m_pcIPCMSampleCr, 0, uiTmp * sizeof( *m_pcIPCMSampleCr ) );
+}
 
 // initialize Sub partition
 Void TComDataCU::initSubCU( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth, Int qp )
@@ -535,58 +575,7 @@ Void TComDataCU::initSubCU( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth,
   m_uiTotalBins        = 0;
   m_uiNumPartition     = pcCU->getTotalNumPart() >> 2;
 
-  Int iSizeInUchar = sizeof( UChar  ) * m_uiNumPartition;
-  Int iSizeInBool  = sizeof( Bool   ) * m_uiNumPartition;
-
-  Int sizeInChar = sizeof( Char  ) * m_uiNumPartition;
-
-#if ALF_TEST
-  Int iSizeInUInt = sizeof(UInt)* m_uiNumPartition;
-  memset(m_puiAlfCtrlFlag, 0, iSizeInUInt);
-#endif
-
-  memset( m_phQP,              qp,  sizeInChar );
-
-  memset( m_pbMergeFlag,        0, iSizeInBool  );
-  memset( m_puhMergeIndex,      0, iSizeInUchar );
-  memset( m_puhLumaIntraDir,    DC_IDX, iSizeInUchar );
-  memset( m_puhChromaIntraDir,  0, iSizeInUchar );
-  memset( m_puhInterDir,        0, iSizeInUchar );
-  memset( m_puhTrIdx,           0, iSizeInUchar );
-  memset( m_puhTransformSkip[0], 0, iSizeInUchar );
-  memset( m_puhTransformSkip[1], 0, iSizeInUchar );
-  memset( m_puhTransformSkip[2], 0, iSizeInUchar );
-  memset( m_puhCbf[0],          0, iSizeInUchar );
-  memset( m_puhCbf[1],          0, iSizeInUchar );
-  memset( m_puhCbf[2],          0, iSizeInUchar );
-  memset( m_puhDepth,     uiDepth, iSizeInUchar );
-
-  UChar uhWidth  = g_uiMaxCUWidth  >> uiDepth;
-  UChar uhHeight = g_uiMaxCUHeight >> uiDepth;
-  memset( m_puhWidth,          uhWidth,  iSizeInUchar );
-  memset( m_puhHeight,         uhHeight, iSizeInUchar );
-  memset( m_pbIPCMFlag,        0, iSizeInBool  );
-  for (UInt ui = 0; ui < m_uiNumPartition; ui++)
-  {
-    m_skipFlag[ui]   = false;
-    m_pePartSize[ui] = SIZE_NONE;
-    m_pePredMode[ui] = MODE_NONE;
-    m_CUTransquantBypass[ui] = false;
-    m_apiMVPIdx[0][ui] = -1;
-    m_apiMVPIdx[1][ui] = -1;
-    m_apiMVPNum[0][ui] = -1;
-    m_apiMVPNum[1][ui] = -1;
-  }
-  UInt uiTmp = uhWidth*uhHeight;
-  memset( m_pcTrCoeffY , 0, sizeof(TCoeff)*uiTmp );
-  memset( m_pcIPCMSampleY , 0, sizeof( Pel ) * uiTmp );
-  uiTmp >>= 2;
-  memset( m_pcTrCoeffCb, 0, sizeof(TCoeff)*uiTmp );
-  memset( m_pcTrCoeffCr, 0, sizeof(TCoeff)*uiTmp );
-  memset( m_pcIPCMSampleCb , 0, sizeof( Pel ) * uiTmp );
-  memset( m_pcIPCMSampleCr , 0, sizeof( Pel ) * uiTmp );
-  m_acCUMvField[0].clearMvField();
-  m_acCUMvField[1].clearMvField();
+  xInitPartData( uiDepth, qp, false );
 
   m_pcCULeft        = pcCU->getCULeft();
   m_pcCUAbove       = pcCU->getCUAbove();
@@ -730,7 +719,7 @@ Void TComDataCU::copyInterPredInfoFrom    ( TComDataCU* pcCU, UInt uiAbsPartIdx,
 
 // Copy small CU to bigger CU.
 // One of quarter parts overwritten by predicted sub part.
-Void TComDataCU::copyPartFrom( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth )
+Void TComDataCU::copyPartFrom( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth, Bool bCopyResidual )
 {
   assert( uiPartUnitIdx<4 );
   
@@ -741,45 +730,13 @@ Void TComDataCU::copyPartFrom( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDept
   UInt uiOffset         = pcCU->getTotalNumPart()*uiPartUnitIdx;
   
   UInt uiNumPartition = pcCU->getTotalNumPart();
-  Int iSizeInUchar  = sizeof( UChar ) * uiNumPartition;
-  Int iSizeInBool   = sizeof( Bool  ) * uiNumPartition;
-  
-  Int sizeInChar  = sizeof( Char ) * uiNumPartition;
 
 #if ALF_TEST
   Int iSizeInUInt = sizeof(UInt)* uiNumPartition;
   memcpy(m_puiAlfCtrlFlag + uiOffset, pcCU->getAlfCtrlFlag(), iSizeInUInt);
 #endif
 
-  memcpy( m_skipFlag   + uiOffset, pcCU->getSkipFlag(),       sizeof( *m_skipFlag )   * uiNumPartition );
-  memcpy( m_phQP       + uiOffset, pcCU->getQP(),             sizeInChar                        );
-  memcpy( m_pePartSize + uiOffset, pcCU->getPartitionSize(),  sizeof( *m_pePartSize ) * uiNumPartition );
-  memcpy( m_pePredMode + uiOffset, pcCU->getPredictionMode(), sizeof( *m_pePredMode ) * uiNumPartition );
-  memcpy( m_CUTransquantBypass + uiOffset, pcCU->getCUTransquantBypass(), sizeof( *m_CUTransquantBypass ) * uiNumPartition );
-  memcpy( m_pbMergeFlag         + uiOffset, pcCU->getMergeFlag(),         iSizeInBool  );
-  memcpy( m_puhMergeIndex       + uiOffset, pcCU->getMergeIndex(),        iSizeInUchar );
-  memcpy( m_puhLumaIntraDir     + uiOffset, pcCU->getLumaIntraDir(),      iSizeInUchar );
-  memcpy( m_puhChromaIntraDir   + uiOffset, pcCU->getChromaIntraDir(),    iSizeInUchar );
-  memcpy( m_puhInterDir         + uiOffset, pcCU->getInterDir(),          iSizeInUchar );
-  memcpy( m_puhTrIdx            + uiOffset, pcCU->getTransformIdx(),      iSizeInUchar );
-  memcpy( m_puhTransformSkip[0] + uiOffset, pcCU->getTransformSkip(TEXT_LUMA),     iSizeInUchar );
-  memcpy( m_puhTransformSkip[1] + uiOffset, pcCU->getTransformSkip(TEXT_CHROMA_U), iSizeInUchar );
-  memcpy( m_puhTransformSkip[2] + uiOffset, pcCU->getTransformSkip(TEXT_CHROMA_V), iSizeInUchar );
-
-  memcpy( m_puhCbf[0] + uiOffset, pcCU->getCbf(TEXT_LUMA)    , iSizeInUchar );
-  memcpy( m_puhCbf[1] + uiOffset, pcCU->getCbf(TEXT_CHROMA_U), iSizeInUchar );
-  memcpy( m_puhCbf[2] + uiOffset, pcCU->getCbf(TEXT_CHROMA_V), iSizeInUchar );
-  
-  memcpy( m_puhDepth  + uiOffset, pcCU->getDepth(),  iSizeInUchar );
-  memcpy( m_puhWidth  + uiOffset, pcCU->getWidth(),  iSizeInUchar );
-  memcpy( m_puhHeight + uiOffset, pcCU->getHeight(), iSizeInUchar );
-  
-  memcpy( m_apiMVPIdx[0] + uiOffset, pcCU->getMVPIdx(REF_PIC_LIST_0), iSizeInUchar );
-  memcpy( m_apiMVPIdx[1] + uiOffset, pcCU->getMVPIdx(REF_PIC_LIST_1), iSizeInUchar );
-  memcpy( m_apiMVPNum[0] + uiOffset, pcCU->getMVPNum(REF_PIC_LIST_0), iSizeInUchar );
-  memcpy( m_apiMVPNum[1] + uiOffset, pcCU->getMVPNum(REF_PIC_LIST_1), iSizeInUchar );
-  
-  memcpy( m_pbIPCMFlag + uiOffset, pcCU->getIPCMFlag(), iSizeInBool );
+  xCopyBytePlanes( uiOffset, pcCU, uiNumPartition );
 
   m_pcCUAboveLeft      = pcCU->getCUAboveLeft();
   m_pcCUAboveRight     = pcCU->getCUAboveRight();
@@ -792,85 +749,56 @@ Void TComDataCU::copyPartFrom( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDept
   m_acCUMvField[0].copyFrom( pcCU->getCUMvField( REF_PIC_LIST_0 ), pcCU->getTotalNumPart(), uiOffset );
   m_acCUMvField[1].copyFrom( pcCU->getCUMvField( REF_PIC_LIST_1 ), pcCU->getTotalNumPart(), uiOffset );
   
-  UInt uiTmp  = g_uiMaxCUWidth*g_uiMaxCUHeight >> (uiDepth<<1);
-  UInt uiTmp2 = uiPartUnitIdx*uiTmp;
-  memcpy( m_pcTrCoeffY  + uiTmp2, pcCU->getCoeffY(),  sizeof(TCoeff)*uiTmp );
-  memcpy( m_pcIPCMSampleY + uiTmp2 , pcCU->getPCMSampleY(), sizeof(Pel) * uiTmp );
+  if ( bCopyResidual )
+  {
+    UInt uiTmp  = g_uiMaxCUWidth*g_uiMaxCUHeight >> (uiDepth<<1);
+    UInt uiTmp2 = uiPartUnitIdx*uiTmp;
+    memcpy( m_pcTrCoeffY  + uiTmp2, pcCU->getCoeffY(),  sizeof(TCoeff)*uiTmp );
+    memcpy( m_pcIPCMSampleY + uiTmp2 , pcCU->getPCMSampleY(), sizeof(Pel) * uiTmp );
 
-  uiTmp >>= 2; uiTmp2>>= 2;
-  memcpy( m_pcTrCoeffCb + uiTmp2, pcCU->getCoeffCb(), sizeof(TCoeff)*uiTmp );
-  memcpy( m_pcTrCoeffCr + uiTmp2, pcCU->getCoeffCr(), sizeof(TCoeff)*uiTmp );
-  memcpy( m_pcIPCMSampleCb + uiTmp2 , pcCU->getPCMSampleCb(), sizeof(Pel) * uiTmp );
-  memcpy( m_pcIPCMSampleCr + uiTmp2 , pcCU->getPCMSampleCr(), sizeof(Pel) * uiTmp );
+    uiTmp >>= 2; uiTmp2>>= 2;
+    memcpy( m_pcTrCoeffCb + uiTmp2, pcCU->getCoeffCb(), sizeof(TCoeff)*uiTmp );
+    memcpy( m_pcTrCoeffCr + uiTmp2, pcCU->getCoeffCr(), sizeof(TCoeff)*uiTmp );
+    memcpy( m_pcIPCMSampleCb + uiTmp2 , pcCU->getPCMSampleCb(), sizeof(Pel) * uiTmp );
+    memcpy( m_pcIPCMSampleCr + uiTmp2 , pcCU->getPCMSampleCr(), sizeof(Pel) * uiTmp );
+  }
   m_uiTotalBins += pcCU->getTotalBins();
   memcpy( m_sliceStartCU        + uiOffset, pcCU->m_sliceStartCU,        sizeof( UInt ) * uiNumPartition  );
 }
 
 // Copy current predicted part to a CU in picture.
 // It is used to predict for next part
-Void TComDataCU::copyToPic( UChar uhDepth )
+Void TComDataCU::copyToPic( UChar uhDepth, Bool bCopyResidual )
 {
   TComDataCU*& rpcCU = m_pcPic->getCU( m_uiCUAddr );
   
   rpcCU->getTotalCost()       = m_dTotalCost;
   rpcCU->getTotalDistortion() = m_uiTotalDistortion;
   rpcCU->getTotalBits()       = m_uiTotalBits;
-  
-  Int iSizeInUchar  = sizeof( UChar ) * m_uiNumPartition;
-  Int iSizeInBool   = sizeof( Bool  ) * m_uiNumPartition;
-  
-  Int sizeInChar  = sizeof( Char ) * m_uiNumPartition;
 
 #if ALF_TEST
   Int iSizeInUInt = sizeof(UInt)* m_uiNumPartition;
   memcpy(rpcCU->getAlfCtrlFlag() + m_uiAbsIdxInLCU, m_puiAlfCtrlFlag, iSizeInUInt);
 #endif
 
-  memcpy( rpcCU->getSkipFlag() + m_uiAbsIdxInLCU, m_skipFlag, sizeof( *m_skipFlag ) * m_uiNumPartition );
-
-  memcpy( rpcCU->getQP() + m_uiAbsIdxInLCU, m_phQP, sizeInChar  );
-
-  memcpy( rpcCU->getPartitionSize()  + m_uiAbsIdxInLCU, m_pePartSize, sizeof( *m_pePartSize ) * m_uiNumPartition );
-  memcpy( rpcCU->getPredictionMode() + m_uiAbsIdxInLCU, m_pePredMode, sizeof( *m_pePredMode ) * m_uiNumPartition );
-  memcpy( rpcCU->getCUTransquantBypass()+ m_uiAbsIdxInLCU, m_CUTransquantBypass, sizeof( *m_CUTransquantBypass ) * m_uiNumPartition );
-  memcpy( rpcCU->getMergeFlag()         + m_uiAbsIdxInLCU, m_pbMergeFlag,         iSizeInBool  );
-  memcpy( rpcCU->getMergeIndex()        + m_uiAbsIdxInLCU, m_puhMergeIndex,       iSizeInUchar );
-  memcpy( rpcCU->getLumaIntraDir()      + m_uiAbsIdxInLCU, m_puhLumaIntraDir,     iSizeInUchar );
-  memcpy( rpcCU->getChromaIntraDir()    + m_uiAbsIdxInLCU, m_puhChromaIntraDir,   iSizeInUchar );
-  memcpy( rpcCU->getInterDir()          + m_uiAbsIdxInLCU, m_puhInterDir,         iSizeInUchar );
-  memcpy( rpcCU->getTransformIdx()      + m_uiAbsIdxInLCU, m_puhTrIdx,            iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_LUMA)     + m_uiAbsIdxInLCU, m_puhTransformSkip[0], iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_CHROMA_U) + m_uiAbsIdxInLCU, m_puhTransformSkip[1], iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_CHROMA_V) + m_uiAbsIdxInLCU, m_puhTransformSkip[2], iSizeInUchar );
-
-  memcpy( rpcCU->getCbf(TEXT_LUMA)     + m_uiAbsIdxInLCU, m_puhCbf[0], iSizeInUchar );
-  memcpy( rpcCU->getCbf(TEXT_CHROMA_U) + m_uiAbsIdxInLCU, m_puhCbf[1], iSizeInUchar );
-  memcpy( rpcCU->getCbf(TEXT_CHROMA_V) + m_uiAbsIdxInLCU, m_puhCbf[2], iSizeInUchar );
-  
-  memcpy( rpcCU->getDepth()  + m_uiAbsIdxInLCU, m_puhDepth,  iSizeInUchar );
-  memcpy( rpcCU->getWidth()  + m_uiAbsIdxInLCU, m_puhWidth,  iSizeInUchar );
-  memcpy( rpcCU->getHeight() + m_uiAbsIdxInLCU, m_puhHeight, iSizeInUchar );
-  
-  memcpy( rpcCU->getMVPIdx(REF_PIC_LIST_0) + m_uiAbsIdxInLCU, m_apiMVPIdx[0], iSizeInUchar );
-  memcpy( rpcCU->getMVPIdx(REF_PIC_LIST_1) + m_uiAbsIdxInLCU, m_apiMVPIdx[1], iSizeInUchar );
-  memcpy( rpcCU->getMVPNum(REF_PIC_LIST_0) + m_uiAbsIdxInLCU, m_apiMVPNum[0], iSizeInUchar );
-  memcpy( rpcCU->getMVPNum(REF_PIC_LIST_1) + m_uiAbsIdxInLCU, m_apiMVPNum[1], iSizeInUchar );
+  rpcCU->xCopyBytePlanes( m_uiAbsIdxInLCU, this, m_uiNumPartition );
   
   m_acCUMvField[0].copyTo( rpcCU->getCUMvField( REF_PIC_LIST_0 ), m_uiAbsIdxInLCU );
   m_acCUMvField[1].copyTo( rpcCU->getCUMvField( REF_PIC_LIST_1 ), m_uiAbsIdxInLCU );
-  
-  memcpy( rpcCU->getIPCMFlag() + m_uiAbsIdxInLCU, m_pbIPCMFlag,         iSizeInBool  );
 
-  UInt uiTmp  = (g_uiMaxCUWidth*g_uiMaxCUHeight)>>(uhDepth<<1);
-  UInt uiTmp2 = m_uiAbsIdxInLCU*m_pcPic->getMinCUWidth()*m_pcPic->getMinCUHeight();
-  memcpy( rpcCU->getCoeffY()  + uiTmp2, m_pcTrCoeffY,  sizeof(TCoeff)*uiTmp  );
-  memcpy( rpcCU->getPCMSampleY() + uiTmp2 , m_pcIPCMSampleY, sizeof(Pel)*uiTmp );
+  if ( bCopyResidual )
+  {
+    UInt uiTmp  = (g_uiMaxCUWidth*g_uiMaxCUHeight)>>(uhDepth<<1);
+    UInt uiTmp2 = m_uiAbsIdxInLCU*m_pcPic->getMinCUWidth()*m_pcPic->getMinCUHeight();
+    memcpy( rpcCU->getCoeffY()  + uiTmp2, m_pcTrCoeffY,  sizeof(TCoeff)*uiTmp  );
+    memcpy( rpcCU->getPCMSampleY() + uiTmp2 , m_pcIPCMSampleY, sizeof(Pel)*uiTmp );
 
-  uiTmp >>= 2; uiTmp2 >>= 2;
-  memcpy( rpcCU->getCoeffCb() + uiTmp2, m_pcTrCoeffCb, sizeof(TCoeff)*uiTmp  );
-  memcpy( rpcCU->getCoeffCr() + uiTmp2, m_pcTrCoeffCr, sizeof(TCoeff)*uiTmp  );
-  memcpy( rpcCU->getPCMSampleCb() + uiTmp2 , m_pcIPCMSampleCb, sizeof( Pel ) * uiTmp );
-  memcpy( rpcCU->getPCMSampleCr() + uiTmp2 , m_pcIPCMSampleCr, sizeof( Pel ) * uiTmp );
+    uiTmp >>= 2; uiTmp2 >>= 2;
+    memcpy( rpcCU->getCoeffCb() + uiTmp2, m_pcTrCoeffCb, sizeof(TCoeff)*uiTmp  );
+    memcpy( rpcCU->getCoeffCr() + uiTmp2, m_pcTrCoeffCr, sizeof(TCoeff)*uiTmp  );
+    memcpy( rpcCU->getPCMSampleCb() + uiTmp2 , m_pcIPCMSampleCb, sizeof( Pel ) * uiTmp );
+    memcpy( rpcCU->getPCMSampleCr() + uiTmp2 , m_pcIPCMSampleCr, sizeof( Pel ) * uiTmp );
+  }
   rpcCU->getTotalBins() = m_uiTotalBins;
   memcpy( rpcCU->m_sliceStartCU        + m_uiAbsIdxInLCU, m_sliceStartCU,        sizeof( UInt ) * m_uiNumPartition  );
 }
@@ -887,42 +815,11 @@ Void TComDataCU::copyToPic( UChar uhDepth, UInt uiPartIdx, UInt uiPartDepth )
   rpcCU->getTotalDistortion() = m_uiTotalDistortion;
   rpcCU->getTotalBits()       = m_uiTotalBits;
   
-  Int iSizeInUchar  = sizeof( UChar  ) * uiQNumPart;
-  Int iSizeInBool   = sizeof( Bool   ) * uiQNumPart;
-  
-  Int sizeInChar  = sizeof( Char ) * uiQNumPart;
-  memcpy( rpcCU->getSkipFlag()       + uiPartOffset, m_skipFlag,   sizeof( *m_skipFlag )   * uiQNumPart );
-
-  memcpy( rpcCU->getQP() + uiPartOffset, m_phQP, sizeInChar );
-  memcpy( rpcCU->getPartitionSize()  + uiPartOffset, m_pePartSize, sizeof( *m_pePartSize ) * uiQNumPart );
-  memcpy( rpcCU->getPredictionMode() + uiPartOffset, m_pePredMode, sizeof( *m_pePredMode ) * uiQNumPart );
-  memcpy( rpcCU->getCUTransquantBypass()+ uiPartOffset, m_CUTransquantBypass, sizeof( *m_CUTransquantBypass ) * uiQNumPart );
-  memcpy( rpcCU->getMergeFlag()         + uiPartOffset, m_pbMergeFlag,         iSizeInBool  );
-  memcpy( rpcCU->getMergeIndex()        + uiPartOffset, m_puhMergeIndex,       iSizeInUchar );
-  memcpy( rpcCU->getLumaIntraDir()      + uiPartOffset, m_puhLumaIntraDir,     iSizeInUchar );
-  memcpy( rpcCU->getChromaIntraDir()    + uiPartOffset, m_puhChromaIntraDir,   iSizeInUchar );
-  memcpy( rpcCU->getInterDir()          + uiPartOffset, m_puhInterDir,         iSizeInUchar );
-  memcpy( rpcCU->getTransformIdx()      + uiPartOffset, m_puhTrIdx,            iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_LUMA)     + uiPartOffset, m_puhTransformSkip[0], iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_CHROMA_U) + uiPartOffset, m_puhTransformSkip[1], iSizeInUchar );
-  memcpy( rpcCU->getTransformSkip(TEXT_CHROMA_V) + uiPartOffset, m_puhTransformSkip[2], iSizeInUchar );
-  memcpy( rpcCU->getCbf(TEXT_LUMA)     + uiPartOffset, m_puhCbf[0], iSizeInUchar );
-  memcpy( rpcCU->getCbf(TEXT_CHROMA_U) + uiPartOffset, m_puhCbf[1], iSizeInUchar );
-  memcpy( rpcCU->getCbf(TEXT_CHROMA_V) + uiPartOffset, m_puhCbf[2], iSizeInUchar );
-  
-  memcpy( rpcCU->getDepth()  + uiPartOffset, m_puhDepth,  iSizeInUchar );
-  memcpy( rpcCU->getWidth()  + uiPartOffset, m_puhWidth,  iSizeInUchar );
-  memcpy( rpcCU->getHeight() + uiPartOffset, m_puhHeight, iSizeInUchar );
-  
-  memcpy( rpcCU->getMVPIdx(REF_PIC_LIST_0) + uiPartOffset, m_apiMVPIdx[0], iSizeInUchar );
-  memcpy( rpcCU->getMVPIdx(REF_PIC_LIST_1) + uiPartOffset, m_apiMVPIdx[1], iSizeInUchar );
-  memcpy( rpcCU->getMVPNum(REF_PIC_LIST_0) + uiPartOffset, m_apiMVPNum[0], iSizeInUchar );
-  memcpy( rpcCU->getMVPNum(REF_PIC_LIST_1) + uiPartOffset, m_apiMVPNum[1], iSizeInUchar );
+  rpcCU->xCopyBytePlanes( uiPartOffset, this, uiQNumPart );
+
   m_acCUMvField[0].copyTo( rpcCU->getCUMvField( REF_PIC_LIST_0 ), m_uiAbsIdxInLCU, uiPartStart, uiQNumPart );
   m_acCUMvField[1].copyTo( rpcCU->getCUMvField( REF_PIC_LIST_1 ), m_uiAbsIdxInLCU, uiPartStart, uiQNumPart );
   
-  memcpy( rpcCU->getIPCMFlag() + uiPartOffset, m_pbIPCMFlag,         iSizeInBool  );
-
   UInt uiTmp  = (g_uiMaxCUWidth*g_uiMaxCUHeight)>>((uhDepth+uiPartDepth)<<1);
   UInt uiTmp2 = uiPartOffset*m_pcPic->getMinCUWidth()*m_pcPic->getMinCUHeight();
   memcpy( rpcCU->getCoeffY()  + uiTmp2, m_pcTrCoeffY,  sizeof(TCoeff)*uiTmp  );
@@ -937,6 +834,23 @@ Void TComDataCU::copyToPic( UChar uhDepth, UInt uiPartIdx, UInt uiPartDepth )
   memcpy( rpcCU->m_sliceStartCU        + uiPartOffset, m_sliceStartCU,        sizeof( UInt ) * uiQNumPart  );
 }
 
+/** copy the byte-sized per-partition arrays of pcSrc into this CU
+ * \param uiDstOffset first partition written in this CU
+ * \param pcSrc       source CU, read from its first partition
+ * \param uiNumPart   number of partitions copied
+ */
+Void TComDataCU::xCopyBytePlanes( UInt uiDstOffset, const TComDataCU* pcSrc, UInt uiNumPart )
+{
+  UChar*       pcDst = m_pcBytePlanes + uiDstOffset;
+  const UChar* pcSrcPlane = pcSrc->m_pcBytePlanes;
+  for ( UInt ui = 0; ui < CU_NUM_BYTE_PLANES; ui++ )
+  {
+    memcpy( pcDst, pcSrcPlane, uiNumPart );
+    pcDst      += m_uiBytePlaneStride;
+    pcSrcPlane += pcSrc->m_uiBytePlaneStride;
+  }
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // Other public functions
 // --------------------------------------------------------------------------------------------------------------------
@@ -151,6 +151,9 @@ private:
   UInt          m_uiTotalBins;       ///< sum of partition bins
   UInt*         m_sliceStartCU;    ///< Start CU address of current slice
   Char          m_codedQP;
+  UChar*        m_pcArena;            ///< single allocation backing all per-partition and coefficient arrays
+  UChar*        m_pcBytePlanes;       ///< first of the byte-sized per-partition arrays, laid out back to back in the arena
+  UInt          m_uiBytePlaneStride;  ///< distance in bytes between two consecutive byte-sized per-partition arrays
 protected:
   
   /// add possible motion vector predictor candidates
@@ -169,6 +172,11 @@ protected:
   
   Void xDeriveCenterIdx( UInt uiPartIdx, UInt& ruiPartIdxCenter );
 
+  /// reset all per-partition data of the CU for the given depth and QP
+  Void          xInitPartData         ( UInt uiDepth, Int qp, Bool bTransquantBypass );
+  /// copy uiNumPart entries of every byte-sized per-partition array of pcSrc to uiDstOffset of this CU
+  Void          xCopyBytePlanes       ( UInt uiDstOffset, const TComDataCU* pcSrc, UInt uiNumPart );
+
 public:
   TComDataCU();
   virtual ~TComDataCU();
@@ -187,9 +195,9 @@ public:
 
   Void          copySubCU             ( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth );
   Void          copyInterPredInfoFrom ( TComDataCU* pcCU, UInt uiAbsPartIdx, RefPicList eRefPicList );
-  Void          copyPartFrom          ( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth );
+  Void          copyPartFrom          ( TComDataCU* pcCU, UInt uiPartUnitIdx, UInt uiDepth, Bool bCopyResidual = true );
   
-  Void          copyToPic             ( UChar uiDepth );
+  Void          copyToPic             ( UChar uiDepth, Bool bCopyResidual = true );
   Void          copyToPic             ( UChar uiDepth, UInt uiPartIdx, UInt uiPartDepth );
   
   // -------------------------------------------------------------------------------------------------------------------
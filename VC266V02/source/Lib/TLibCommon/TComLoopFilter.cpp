@@ -153,6 +153,35 @@ Void TComLoopFilter::loopFilterPic( TComPic* pcPic )
   }
 }
 
+/**
+ - deblock one CTU row, vertical edges first, then horizontal edges
+ .
+ Filtering the rows in increasing order gives the same result as loopFilterPic(): the vertical edges of a row only
+ touch that row and the horizontal edges of a row reach at most 3 lines into the row above.
+ \param  pcPic    picture class (TComPic) pointer
+ \param  iCtuRow  CTU row index
+ */
+Void TComLoopFilter::loopFilterCtuRow( TComPic* pcPic, Int iCtuRow )
+{
+  UInt uiWidthInCU   = pcPic->getFrameWidthInCU();
+  UInt uiStartCUAddr = iCtuRow * uiWidthInCU;
+  UInt uiEndCUAddr   = min( uiStartCUAddr + uiWidthInCU, pcPic->getNumCUsInFrame() );
+
+  for ( Int iDir = EDGE_VER; iDir <= EDGE_HOR; iDir++ )
+  {
+    for ( UInt uiCUAddr = uiStartCUAddr; uiCUAddr < uiEndCUAddr; uiCUAddr++ )
+    {
+      TComDataCU* pcCU = pcPic->getCU( uiCUAddr );
+
+      ::memset( m_aapucBS       [iDir], 0, sizeof( UChar ) * m_uiNumPartitions );
+      ::memset( m_aapbEdgeFilter[iDir], 0, sizeof( Bool  ) * m_uiNumPartitions );
+
+      // CU-based deblocking
+      xDeblockCU( pcCU, 0, 0, iDir );
+    }
+  }
+}
+
 
 // ====================================================================================================================
 // Protected member functions
@@ -113,6 +113,8 @@ public:
   
   /// picture-level deblocking filter
   Void loopFilterPic( TComPic* pcPic );
+  /// deblocking filter of one CTU row, rows must be filtered in increasing order
+  Void loopFilterCtuRow( TComPic* pcPic, Int iCtuRow );
 
   static Int getBeta( Int qp )
   {
@@ -62,6 +62,28 @@ Void TComCUMvField::create( UInt uiNumPartition )
   m_piRefIdx = new Char  [ uiNumPartition ];
   
   m_uiNumPartition = uiNumPartition;
+  m_bExtStorage    = false;
+}
+
+/** create motion field on externally owned storage
+ * \param uiNumPartition number of minimum partitions
+ * \param pcMv     motion vector array of uiNumPartition entries
+ * \param pcMvd    motion vector difference array of uiNumPartition entries
+ * \param piRefIdx reference index array of uiNumPartition entries
+ * The arrays are not released by destroy().
+ */
+Void TComCUMvField::create( UInt uiNumPartition, TComMv* pcMv, TComMv* pcMvd, Char* piRefIdx )
+{
+  assert(m_pcMv     == NULL);
+  assert(m_pcMvd    == NULL);
+  assert(m_piRefIdx == NULL);
+  
+  m_pcMv     = pcMv;
+  m_pcMvd    = pcMvd;
+  m_piRefIdx = piRefIdx;
+  
+  m_uiNumPartition = uiNumPartition;
+  m_bExtStorage    = true;
 }
 
 Void TComCUMvField::destroy()
@@ -70,15 +92,19 @@ Void TComCUMvField::destroy()
   assert(m_pcMvd    != NULL);
   assert(m_piRefIdx != NULL);
   
-  delete[] m_pcMv;
-  delete[] m_pcMvd;
-  delete[] m_piRefIdx;
+  if ( !m_bExtStorage )
+  {
+    delete[] m_pcMv;
+    delete[] m_pcMvd;
+    delete[] m_piRefIdx;
+  }
   
   m_pcMv     = NULL;
   m_pcMvd    = NULL;
   m_piRefIdx = NULL;
   
   m_uiNumPartition = 0;
+  m_bExtStorage    = false;
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -87,10 +113,10 @@ Void TComCUMvField::destroy()
 
 Void TComCUMvField::clearMvField()
 {
-  for ( Int i = 0; i < m_uiNumPartition; i++ )
+  for ( UInt i = 0; i < m_uiNumPartition; i++ )
   {
     m_pcMv [ i ].setZero();
-    m_pcMvd[ i ].setZero();      
+    m_pcMvd[ i ].setZero();
   }
   assert( sizeof( *m_piRefIdx ) == 1 );
   memset( m_piRefIdx, NOT_VALID, m_uiNumPartition * sizeof( *m_piRefIdx ) );
@@ -95,13 +95,14 @@ private:
   TComMv*   m_pcMvd;
   Char*     m_piRefIdx;
   UInt      m_uiNumPartition;
+  Bool      m_bExtStorage;    ///< arrays are carved from storage owned by the CU
   AMVPInfo  m_cAMVPInfo;
     
   template <typename T>
   Void setAll( T *p, T const & val, PartSize eCUMode, Int iPartAddr, UInt uiDepth, Int iPartIdx );
 
 public:
-  TComCUMvField() : m_pcMv(NULL), m_pcMvd(NULL), m_piRefIdx(NULL), m_uiNumPartition(0) {}
+  TComCUMvField() : m_pcMv(NULL), m_pcMvd(NULL), m_piRefIdx(NULL), m_uiNumPartition(0), m_bExtStorage(false) {}
   ~TComCUMvField() {}
 
   // ------------------------------------------------------------------------------------------------------------------
@@ -109,6 +110,7 @@ public:
   // ------------------------------------------------------------------------------------------------------------------
   
   Void    create( UInt uiNumPartition );
+  Void    create( UInt uiNumPartition, TComMv* pcMv, TComMv* pcMvd, Char* piRefIdx );
   Void    destroy();
   
   // ------------------------------------------------------------------------------------------------------------------
@@ -38,6 +38,9 @@
 #include "TComPic.h"
 #include "TComPattern.h"
 #include "TComDataCU.h"
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -173,10 +176,61 @@ Void TComPattern::initPattern( TComDataCU* pcCU, UInt uiPartDepth, UInt uiAbsPar
   m_cPatternCr.setPatternParamCU( pcCU, 2, uiWidth >> 1, uiHeight >> 1, uiOffsetLeft, uiOffsetAbove, uiAbsPartIdx );
 }
 
-Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt uiPartDepth, Int* piAdiBuf, Int iOrgBufStride, Int iOrgBufHeight, Bool& bAbove, Bool& bLeft, Bool bLMmode )
+/** [1 2 1] smoothing of the inner samples [1, len-1) of a sequential reference line
+ */
+static Void filterRefLine121(Int bitDepth, const Pel* src, Pel* dst, Int len)
+{
+  Int i = 1;
+#if ENABLE_SIMD_SSE2
+  if (bitDepth <= 14) // a+2b+c+2 stays within 16 unsigned bits
+  {
+    const __m128i rnd = _mm_set1_epi16(2);
+    for (; i+8 <= len-1; i+=8)
+    {
+      __m128i a = _mm_loadu_si128((const __m128i*)(src+i-1));
+      __m128i b = _mm_loadu_si128((const __m128i*)(src+i  ));
+      __m128i c = _mm_loadu_si128((const __m128i*)(src+i+1));
+      __m128i sum = _mm_add_epi16(_mm_add_epi16(a, c), _mm_add_epi16(_mm_slli_epi16(b, 1), rnd));
+      _mm_storeu_si128((__m128i*)(dst+i), _mm_srli_epi16(sum, 2));
+    }
+  }
+#endif
+  for (; i < len-1; i++)
+  {
+    dst[i] = (src[i - 1] + 2 * src[i] + src[i + 1] + 2) >> 2;
+  }
+}
+
+/** bilinear interpolation of the inner samples [1, len) between the end points a (position 0) and b (position len)
+ */
+static Void interpolateRefLine(Pel* dst, Int len, Int a, Int b, Int shift)
+{
+  Int i = 1;
+#if ENABLE_SIMD_SSE2
+  const __m128i ends   = _mm_set1_epi32((b << 16) | (a & 0xffff));
+  const __m128i rnd    = _mm_set1_epi32(len >> 1);
+  const __m128i step   = _mm_set1_epi32((8 << 16) | 0xfff8); // weight pairs (len-i, i) advance by (-8, +8)
+  __m128i weights0 = _mm_set_epi16(4, len-4, 3, len-3, 2, len-2, 1, len-1);
+  __m128i weights1 = _mm_set_epi16(8, len-8, 7, len-7, 6, len-6, 5, len-5);
+  for (; i+8 <= len; i+=8)
+  {
+    __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ends, weights0), rnd), shift);
+    __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ends, weights1), rnd), shift);
+    _mm_storeu_si128((__m128i*)(dst+i), _mm_packs_epi32(lo, hi));
+    weights0 = _mm_add_epi16(weights0, step);
+    weights1 = _mm_add_epi16(weights1, step);
+  }
+#endif
+  for (; i < len; i++)
+  {
+    dst[i] = ((len-i)*a + i*b + (len >> 1)) >> shift;
+  }
+}
+
+Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt uiPartDepth, Pel* piAdiBuf, Int iOrgBufStride, Int iOrgBufHeight, Bool& bAbove, Bool& bLeft, Bool bLMmode )
 {
   Pel*  piRoiOrigin;
-  Int*  piAdiTemp;
+  Pel*  piAdiTemp;
   UInt  uiCuWidth   = pcCU->getWidth(0) >> uiPartDepth;
   UInt  uiCuHeight  = pcCU->getHeight(0)>> uiPartDepth;
   UInt  uiCuWidth2  = uiCuWidth<<1;
@@ -229,10 +283,10 @@ Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt
 
   UInt uiWH = uiWidth * uiHeight;               // number of elements in one buffer
 
-  Int* piFilteredBuf1 = piAdiBuf + uiWH;        // 1. filter buffer
-  Int* piFilteredBuf2 = piFilteredBuf1 + uiWH;  // 2. filter buffer
-  Int* piFilterBuf = piFilteredBuf2 + uiWH;     // buffer for 2. filtering (sequential)
-  Int* piFilterBufN = piFilterBuf + iBufSize;   // buffer for 1. filtering (sequential)
+  Pel* piFilteredBuf1 = piAdiBuf + uiWH;        // 1. filter buffer
+  Pel* piFilteredBuf2 = piFilteredBuf1 + uiWH;  // 2. filter buffer
+  Pel* piFilterBuf = piFilteredBuf2 + uiWH;     // buffer for 2. filtering (sequential)
+  Pel* piFilterBufN = piFilterBuf + iBufSize;   // buffer for 1. filtering (sequential)
 
   Int l = 0;
   // left border from bottom to top
@@ -243,10 +297,7 @@ Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt
   // top left corner
   piFilterBuf[l++] = piAdiTemp[0];
   // above border from left to right
-  for (i=0; i < uiCuWidth2; i++)
-  {
-    piFilterBuf[l++] = piAdiTemp[1 + i];
-  }
+  ::memcpy(piFilterBuf + l, piAdiTemp + 1, uiCuWidth2 * sizeof(Pel));
 
   if (pcCU->getSlice()->getSPS()->getUseStrongIntraSmoothing())
   {
@@ -264,25 +315,15 @@ Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt
       piFilterBufN[0] = piFilterBuf[0];
       piFilterBufN[uiCuHeight2] = piFilterBuf[uiCuHeight2];
       piFilterBufN[iBufSize - 1] = piFilterBuf[iBufSize - 1];
-      for (i = 1; i < uiCuHeight2; i++)
-      {
-        piFilterBufN[i] = ((uiCuHeight2-i)*bottomLeft + i*topLeft + uiCuHeight) >> shift;
-      }
-  
-      for (i = 1; i < uiCuWidth2; i++)
-      {
-        piFilterBufN[uiCuHeight2 + i] = ((uiCuWidth2-i)*topLeft + i*topRight + uiCuWidth) >> shift;
-      }
+      interpolateRefLine(piFilterBufN,               uiCuHeight2, bottomLeft, topLeft,  shift);
+      interpolateRefLine(piFilterBufN + uiCuHeight2, uiCuWidth2,  topLeft,    topRight, shift);
     }
     else 
     {
       // 1. filtering with [1 2 1]
       piFilterBufN[0] = piFilterBuf[0];
       piFilterBufN[iBufSize - 1] = piFilterBuf[iBufSize - 1];
-      for (i = 1; i < iBufSize - 1; i++)
-      {
-        piFilterBufN[i] = (piFilterBuf[i - 1] + 2 * piFilterBuf[i]+piFilterBuf[i + 1] + 2) >> 2;
-      }
+      filterRefLine121(g_bitDepthY, piFilterBuf, piFilterBufN, iBufSize);
     }
   }
   else 
@@ -290,10 +331,7 @@ Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt
     // 1. filtering with [1 2 1]
     piFilterBufN[0] = piFilterBuf[0];
     piFilterBufN[iBufSize - 1] = piFilterBuf[iBufSize - 1];
-    for (i = 1; i < iBufSize - 1; i++)
-    {
-      piFilterBufN[i] = (piFilterBuf[i - 1] + 2 * piFilterBuf[i]+piFilterBuf[i + 1] + 2) >> 2;
-    }
+    filterRefLine121(g_bitDepthY, piFilterBuf, piFilterBufN, iBufSize);
   }
 
   // fill 1. filter buffer with filtered values
@@ -303,16 +341,13 @@ Void TComPattern::initAdiPattern( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt
     piFilteredBuf1[uiWidth * (uiCuHeight2 - i)] = piFilterBufN[l++];
   }
   piFilteredBuf1[0] = piFilterBufN[l++];
-  for (i = 0; i < uiCuWidth2; i++)
-  {
-    piFilteredBuf1[1 + i] = piFilterBufN[l++];
-  }
+  ::memcpy(piFilteredBuf1 + 1, piFilterBufN + l, uiCuWidth2 * sizeof(Pel));
 }
 
-Void TComPattern::initAdiPatternChroma( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt uiPartDepth, Int* piAdiBuf, Int iOrgBufStride, Int iOrgBufHeight, Bool& bAbove, Bool& bLeft )
+Void TComPattern::initAdiPatternChroma( TComDataCU* pcCU, UInt uiZorderIdxInPart, UInt uiPartDepth, Pel* piAdiBuf, Int iOrgBufStride, Int iOrgBufHeight, Bool& bAbove, Bool& bLeft )
 {
   Pel*  piRoiOrigin;
-  Int*  piAdiTemp;
+  Pel*  piAdiTemp;
   UInt  uiCuWidth  = pcCU->getWidth (0) >> uiPartDepth;
   UInt  uiCuHeight = pcCU->getHeight(0) >> uiPartDepth;
   UInt  uiWidth;
@@ -368,7 +403,7 @@ Void TComPattern::initAdiPatternChroma( TComDataCU* pcCU, UInt uiZorderIdxInPart
   fillReferenceSamples (g_bitDepthC, piRoiOrigin, piAdiTemp, bNeighborFlags, iNumIntraNeighbor, iUnitSize, iNumUnitsInCu, iTotalUnits, uiCuWidth, uiCuHeight, uiWidth, uiHeight, iPicStride);
 }
 
-Void TComPattern::fillReferenceSamples(Int bitDepth, Pel* piRoiOrigin, Int* piAdiTemp, Bool* bNeighborFlags, Int iNumIntraNeighbor, Int iUnitSize, Int iNumUnitsInCu, Int iTotalUnits, UInt uiCuWidth, UInt uiCuHeight, UInt uiWidth, UInt uiHeight, Int iPicStride, Bool bLMmode )
+Void TComPattern::fillReferenceSamples(Int bitDepth, Pel* piRoiOrigin, Pel* piAdiTemp, Bool* bNeighborFlags, Int iNumIntraNeighbor, Int iUnitSize, Int iNumUnitsInCu, Int iTotalUnits, UInt uiCuWidth, UInt uiCuHeight, UInt uiWidth, UInt uiHeight, Int iPicStride, Bool bLMmode )
 {
   Pel* piRoiTemp;
   Int  i, j;
@@ -554,17 +589,17 @@ Void TComPattern::fillReferenceSamples(Int bitDepth, Pel* piRoiOrigin, Int* piAd
   }
 }
 
-Int* TComPattern::getAdiOrgBuf( Int /*iCuWidth*/, Int /*iCuHeight*/, Int* piAdiBuf)
+Pel* TComPattern::getAdiOrgBuf( Int /*iCuWidth*/, Int /*iCuHeight*/, Pel* piAdiBuf)
 {
   return piAdiBuf;
 }
 
-Int* TComPattern::getAdiCbBuf( Int /*iCuWidth*/, Int /*iCuHeight*/, Int* piAdiBuf)
+Pel* TComPattern::getAdiCbBuf( Int /*iCuWidth*/, Int /*iCuHeight*/, Pel* piAdiBuf)
 {
   return piAdiBuf;
 }
 
-Int* TComPattern::getAdiCrBuf(Int iCuWidth,Int iCuHeight, Int* piAdiBuf)
+Pel* TComPattern::getAdiCrBuf(Int iCuWidth,Int iCuHeight, Pel* piAdiBuf)
 {
   return piAdiBuf+(iCuWidth*2+1)*(iCuHeight*2+1);
 }
@@ -577,9 +612,9 @@ Int* TComPattern::getAdiCrBuf(Int iCuWidth,Int iCuHeight, Int* piAdiBuf)
  *
  * The prediction mode index is used to determine whether a smoothed reference sample buffer is returned.
  */
-Int* TComPattern::getPredictorPtr( UInt uiDirMode, UInt log2BlkSize, Int* piAdiBuf )
+Pel* TComPattern::getPredictorPtr( UInt uiDirMode, UInt log2BlkSize, Pel* piAdiBuf )
 {
-  Int* piSrc;
+  Pel* piSrc;
   assert(log2BlkSize >= 2 && log2BlkSize < 7);
   Int diff = min<Int>(abs((Int) uiDirMode - HOR_IDX), abs((Int)uiDirMode - VER_IDX));
   UChar ucFiltIdx = diff > m_aucIntraFilter[log2BlkSize - 2] ? 1 : 0;
@@ -56,6 +56,7 @@ TComPic::TComPic()
 , m_bNeededForOutput                      (false)
 , m_uiCurrSliceIdx                        (0)
 , m_bCheckLTMSB                           (false)
+, m_bWpAcDcParamValid                     (false)
 {
   m_apcPicYuv[0]      = NULL;
   m_apcPicYuv[1]      = NULL;
@@ -82,6 +83,9 @@ Void TComPic::create( Int iWidth, Int iHeight, UInt uiMaxWidth, UInt uiMaxHeight
     deleteSEIs (m_SEIs);
   }
   m_bUsedByCurr = false;
+  m_bWpAcDcParamValid = false;
+  setFinished( false );
+  setMotionFinal( false );
 
   /* store conformance window parameters with picture */
   m_conformanceWindow = conformanceWindow;
@@ -121,6 +125,43 @@ Void TComPic::destroy()
   deleteSEIs(m_SEIs);
 }
 
+/** re-initialise a picture buffer for a new picture
+ * 
+ * The sample planes and the CU data are kept when the picture geometry is unchanged, only the per-picture state
+ * is reset; otherwise the buffers are reallocated.
+ */
+Void TComPic::reinit( Int iWidth, Int iHeight, UInt uiMaxWidth, UInt uiMaxHeight, UInt uiMaxDepth, Window &conformanceWindow, Window &defaultDisplayWindow,
+                      Int *numReorderPics, Bool bIsVirtual )
+{
+  if ( m_apcPicSym == NULL || m_apcPicYuv[1] == NULL || ( m_apcPicYuv[0] == NULL ) != bIsVirtual
+    || m_apcPicYuv[1]->getWidth() != iWidth || m_apcPicYuv[1]->getHeight() != iHeight
+    || m_apcPicSym->getMaxCUWidth() != uiMaxWidth || m_apcPicSym->getMaxCUHeight() != uiMaxHeight || m_apcPicSym->getTotalDepth() != uiMaxDepth )
+  {
+    destroy();
+    create( iWidth, iHeight, uiMaxWidth, uiMaxHeight, uiMaxDepth, conformanceWindow, defaultDisplayWindow, numReorderPics, bIsVirtual );
+    return;
+  }
+
+  m_apcPicSym->clearSliceBuffer();
+  for ( Int i = 0; i < 2; i++ )
+  {
+    if ( m_apcPicYuv[i] )
+    {
+      m_apcPicYuv[i]->setBorderExtension( false );
+    }
+  }
+
+  deleteSEIs(m_SEIs);
+  m_bUsedByCurr = false;
+  m_bWpAcDcParamValid = false;
+  setFinished( false );
+  setMotionFinal( false );
+
+  m_conformanceWindow    = conformanceWindow;
+  m_defaultDisplayWindow = defaultDisplayWindow;
+  memcpy(m_numReorderPics, numReorderPics, MAX_TLAYER*sizeof(Int));
+}
+
 Void TComPic::compressMotion()
 {
   TComPicSym* pPicSym = getPicSym(); 
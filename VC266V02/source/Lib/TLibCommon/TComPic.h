@@ -43,6 +43,7 @@
 #include "TComPicSym.h"
 #include "TComPicYuv.h"
 #include "TComBitStream.h"
+#include "TComThreadPool.h"
 #include "SEI.h"
 
 //! \ingroup TLibCommon
@@ -78,6 +79,12 @@ private:
 
   SEIMessages  m_SEIs; ///< Any SEI messages that have been received.  If !NULL we own the object.
 
+  wpACDCParam           m_aWpAcDcParam[3];        ///< AC/DC statistics of the original picture for the weighted prediction analysis
+  Bool                  m_bWpAcDcParamValid;
+
+  TComProgressCounter   m_cFinished;              ///< 1 once the picture is reconstructed, in-loop filtered and border-extended
+  TComProgressCounter   m_cMotionFinal;           ///< 1 once the motion field is compressed and can be used as collocated motion
+
 public:
   TComPic();
   virtual ~TComPic();
@@ -86,6 +93,8 @@ public:
                         Int *numReorderPics, Bool bIsVirtual = false );
                         
   virtual Void  destroy();
+  Void          reinit( Int iWidth, Int iHeight, UInt uiMaxWidth, UInt uiMaxHeight, UInt uiMaxDepth, Window &conformanceWindow, Window &defaultDisplayWindow, 
+                        Int *numReorderPics, Bool bIsVirtual = false );
   
   UInt          getTLayer()                { return m_uiTLayer;   }
   Void          setTLayer( UInt uiTLayer ) { m_uiTLayer = uiTLayer; }
@@ -134,6 +143,19 @@ public:
   Int           getNumReorderPics(UInt tlayer)        { return m_numReorderPics[tlayer]; }
 
   Void          compressMotion(); 
+
+  /// the weighted prediction statistics of the original picture are computed once and shared by all slices
+  Bool          getWpAcDcParamValid()               { return m_bWpAcDcParamValid; }
+  Void          setWpAcDcParamValid( Bool b )       { m_bWpAcDcParamValid = b; }
+  wpACDCParam*  getWpAcDcParam()                    { return m_aWpAcDcParam; }
+
+  /// decoding progress, used when a picture is referenced while its in-loop filters are still running on another thread;
+  /// the filters work on whole pictures, so the samples are published for the whole picture at once
+  Void          setFinished       ( Bool b )        { m_cFinished.set( b ? 1 : 0 ); }
+  Void          waitForFinished   ()                { m_cFinished.wait( 1 ); }
+  Bool          isFinished()                        { return m_cFinished.get() != 0; }
+  Void          setMotionFinal    ( Bool b )        { m_cMotionFinal.set( b ? 1 : 0 ); }
+  Void          waitForMotionFinal()                { m_cMotionFinal.wait( 1 ); }
   UInt          getCurrSliceIdx()            { return m_uiCurrSliceIdx;                }
   Void          setCurrSliceIdx(UInt i)      { m_uiCurrSliceIdx = i;                   }
   UInt          getNumAllocatedSlice()       {return m_apcPicSym->getNumAllocatedSlice();}
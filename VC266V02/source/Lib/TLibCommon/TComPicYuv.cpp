@@ -46,6 +46,7 @@
 #endif
 
 #include "TComPicYuv.h"
+#include "TComThreadPool.h"
 
 //! \ingroup TLibCommon
 //! \{
@@ -223,24 +224,92 @@ Void  TComPicYuv::copyToPicCr (TComPicYuv*  pcPicYuvDst)
   return;
 }
 
+/** copy the picture samples of one CTU row, the margins are left to extendPicBorderCtuRow()
+ * \param pcPicYuvDst destination picture of the same size
+ * \param iCtuRow     CTU row index
+ */
+Void  TComPicYuv::copyToPicCtuRow (TComPicYuv*  pcPicYuvDst, Int iCtuRow)
+{
+  assert( m_iPicWidth  == pcPicYuvDst->getWidth()  );
+  assert( m_iPicHeight == pcPicYuvDst->getHeight() );
+  
+  Int iRowStart = iCtuRow * m_iCuHeight;
+  Int iRowEnd   = std::min( iRowStart + m_iCuHeight, m_iPicHeight );
+  
+  for ( Int y = iRowStart; y < iRowEnd; y++ )
+  {
+    ::memcpy ( pcPicYuvDst->getLumaAddr() + y*pcPicYuvDst->getStride(), getLumaAddr() + y*getStride(), sizeof (Pel) * m_iPicWidth );
+  }
+  for ( Int y = iRowStart >> 1; y < iRowEnd >> 1; y++ )
+  {
+    ::memcpy ( pcPicYuvDst->getCbAddr() + y*pcPicYuvDst->getCStride(), getCbAddr() + y*getCStride(), sizeof (Pel) * (m_iPicWidth >> 1) );
+    ::memcpy ( pcPicYuvDst->getCrAddr() + y*pcPicYuvDst->getCStride(), getCrAddr() + y*getCStride(), sizeof (Pel) * (m_iPicWidth >> 1) );
+  }
+  return;
+}
+
 Void TComPicYuv::extendPicBorder ()
 {
   if ( m_bIsBorderExtended ) return;
   
-  xExtendPicCompBorder( getLumaAddr(), getStride(),  getWidth(),      getHeight(),      m_iLumaMarginX,   m_iLumaMarginY   );
-  xExtendPicCompBorder( getCbAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY );
-  xExtendPicCompBorder( getCrAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY );
+  xExtendPicCompBorder( getLumaAddr(), getStride(),  getWidth(),      getHeight(),      m_iLumaMarginX,   m_iLumaMarginY,   0, getHeight()      );
+  xExtendPicCompBorder( getCbAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, 0, getHeight() >> 1 );
+  xExtendPicCompBorder( getCrAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, 0, getHeight() >> 1 );
   
   m_bIsBorderExtended = true;
 }
 
-Void TComPicYuv::xExtendPicCompBorder  (Pel* piTxt, Int iStride, Int iWidth, Int iHeight, Int iMarginX, Int iMarginY)
+/// border extension of one CTU row per work item
+class TComPicYuvBorderJob : public TComParallelJob
+{
+public:
+  TComPicYuvBorderJob( TComPicYuv* pcPicYuv ) : m_pcPicYuv( pcPicYuv ) {}
+  Void runItem( Int itemIdx, Int threadIdx ) { m_pcPicYuv->extendPicBorderCtuRow( itemIdx ); }
+private:
+  TComPicYuv* m_pcPicYuv;
+};
+
+/** extend the picture borders with the CTU rows spread over a thread pool
+ *
+ * Unlike extendPicBorder() this neither checks nor sets the border extension flag: a decoder that filters
+ * the picture on another thread sets the flag when it hands the picture over, before the margins are filled.
+ * \param pcThreadPool worker threads, the serial path is used if NULL
+ */
+Void TComPicYuv::extendPicBorder ( TComThreadPool* pcThreadPool )
+{
+  if ( pcThreadPool == NULL || pcThreadPool->getNumThreads() <= 1 )
+  {
+    xExtendPicCompBorder( getLumaAddr(), getStride(),  getWidth(),      getHeight(),      m_iLumaMarginX,   m_iLumaMarginY,   0, getHeight()      );
+    xExtendPicCompBorder( getCbAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, 0, getHeight() >> 1 );
+    xExtendPicCompBorder( getCrAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, 0, getHeight() >> 1 );
+    return;
+  }
+  
+  TComPicYuvBorderJob cJob( this );
+  pcThreadPool->parallelFor( &cJob, getNumCtuRows() );
+}
+
+/** extend the left and right margins of the lines of one CTU row of all planes,
+ *  plus the top (bottom) margin for the first (last) CTU row. Rows may be extended in any order.
+ * \param iCtuRow CTU row index
+ */
+Void TComPicYuv::extendPicBorderCtuRow ( Int iCtuRow )
+{
+  Int iRowStart = iCtuRow * m_iCuHeight;
+  Int iRowEnd   = std::min( iRowStart + m_iCuHeight, m_iPicHeight );
+  
+  xExtendPicCompBorder( getLumaAddr(), getStride(),  getWidth(),      getHeight(),      m_iLumaMarginX,   m_iLumaMarginY,   iRowStart,      iRowEnd      );
+  xExtendPicCompBorder( getCbAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, iRowStart >> 1, iRowEnd >> 1 );
+  xExtendPicCompBorder( getCrAddr()  , getCStride(), getWidth() >> 1, getHeight() >> 1, m_iChromaMarginX, m_iChromaMarginY, iRowStart >> 1, iRowEnd >> 1 );
+}
+
+Void TComPicYuv::xExtendPicCompBorder  (Pel* piTxt, Int iStride, Int iWidth, Int iHeight, Int iMarginX, Int iMarginY, Int iRowStart, Int iRowEnd)
 {
   Int   x, y;
   Pel*  pi;
   
-  pi = piTxt;
-  for ( y = 0; y < iHeight; y++)
+  pi = piTxt + iRowStart*iStride;
+  for ( y = iRowStart; y < iRowEnd; y++)
   {
     for ( x = 0; x < iMarginX; x++ )
     {
@@ -250,16 +319,22 @@ Void TComPicYuv::xExtendPicCompBorder  (Pel* piTxt, Int iStride, Int iWidth, Int
     pi += iStride;
   }
   
-  pi -= (iStride + iMarginX);
-  for ( y = 0; y < iMarginY; y++ )
+  if ( iRowEnd == iHeight )
   {
-    ::memcpy( pi + (y+1)*iStride, pi, sizeof(Pel)*(iWidth + (iMarginX<<1)) );
+    pi = piTxt + (iHeight-1)*iStride - iMarginX;
+    for ( y = 0; y < iMarginY; y++ )
+    {
+      ::memcpy( pi + (y+1)*iStride, pi, sizeof(Pel)*(iWidth + (iMarginX<<1)) );
+    }
   }
   
-  pi -= ((iHeight-1) * iStride);
-  for ( y = 0; y < iMarginY; y++ )
+  if ( iRowStart == 0 )
   {
-    ::memcpy( pi - (y+1)*iStride, pi, sizeof(Pel)*(iWidth + (iMarginX<<1)) );
+    pi = piTxt - iMarginX;
+    for ( y = 0; y < iMarginY; y++ )
+    {
+      ::memcpy( pi - (y+1)*iStride, pi, sizeof(Pel)*(iWidth + (iMarginX<<1)) );
+    }
   }
 }
 
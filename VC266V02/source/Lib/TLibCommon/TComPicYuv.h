@@ -42,6 +42,8 @@
 #include "CommonDef.h"
 #include "TComRom.h"
 
+class TComThreadPool;
+
 //! \ingroup TLibCommon
 //! \{
 
@@ -88,7 +90,7 @@ private:
   Bool  m_bIsBorderExtended;
   
 protected:
-  Void  xExtendPicCompBorder (Pel* piTxt, Int iStride, Int iWidth, Int iHeight, Int iMarginX, Int iMarginY);
+  Void  xExtendPicCompBorder (Pel* piTxt, Int iStride, Int iWidth, Int iHeight, Int iMarginX, Int iMarginY, Int iRowStart, Int iRowEnd);
   
 public:
   TComPicYuv         ();
@@ -148,17 +150,24 @@ public:
   Void  copyToPicLuma   ( TComPicYuv*  pcPicYuvDst );
   Void  copyToPicCb     ( TComPicYuv*  pcPicYuvDst );
   Void  copyToPicCr     ( TComPicYuv*  pcPicYuvDst );
+  Void  copyToPicCtuRow ( TComPicYuv*  pcPicYuvDst, Int iCtuRow );
   
   //  Extend function of picture buffer
   Void  extendPicBorder      ();
+  Void  extendPicBorder      ( TComThreadPool* pcThreadPool );
+  Void  extendPicBorderCtuRow( Int iCtuRow );
+  Int   getNumCtuRows        () { return ( m_iPicHeight + m_iCuHeight - 1 ) / m_iCuHeight; }
   
   //  Dump picture
   Void  dump (Char* pFileName, Bool bAdd = false);
   
   // Set border extension flag
   Void  setBorderExtension(Bool b) { m_bIsBorderExtended = b; }
+  Bool  getBorderExtension()       { return m_bIsBorderExtended; }
 };// END CLASS DEFINITION TComPicYuv
-void calcMD5(TComPicYuv& pic, UChar digest[3][16]);
+void calcMD5(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool = NULL);
+void calcCRC(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool = NULL);
+void calcChecksum(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool = NULL);
 //! \}
 
 #endif // __TCOMPICYUV__
@@ -31,57 +31,305 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+
 #include "TComPicYuv.h"
+#include "TComThreadPool.h"
 #include "libmd5/MD5.h"
+#include <vector>
+
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
 
+/// true if a Pel is stored in little-endian byte order, i.e. a row of 16-bit samples already is the hashed byte string
+static inline Bool isLittleEndianPel()
+{
+  const Pel one = 1;
+  return *(const UChar*)&one == 1;
+}
+
 /**
- * Update md5 using n samples from plane, each sample is adjusted to
- * OUTBIT_BITDEPTH_DIV8.
+ * Convert n samples into OUTPUT_BITDEPTH_DIV8 bytes each, in little
+ * endian byte order. NB, for 8bit data, data is truncated to 8bits.
  */
 template<UInt OUTPUT_BITDEPTH_DIV8>
-static void md5_block(MD5& md5, const Pel* plane, UInt n)
+static void pack_samples(UChar* buf, const Pel* plane, UInt n)
 {
-  /* create a 64 byte buffer for packing Pel's into */
-  UChar buf[64/OUTPUT_BITDEPTH_DIV8][OUTPUT_BITDEPTH_DIV8];
-  for (UInt i = 0; i < n; i++)
+  UInt i = 0;
+#if ENABLE_SIMD_SSE2
+  if (OUTPUT_BITDEPTH_DIV8 == 1)
+  {
+    const __m128i lowByte = _mm_set1_epi16(0xff);
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)(plane + i)), lowByte);
+      __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(plane + i + 8)), lowByte);
+      _mm_storeu_si128((__m128i*)(buf + i), _mm_packus_epi16(a, b));
+    }
+  }
+#endif
+  for (; i < n; i++)
   {
     Pel pel = plane[i];
-    /* perform bitdepth and endian conversion */
     for (UInt d = 0; d < OUTPUT_BITDEPTH_DIV8; d++)
     {
-      buf[i][d] = pel >> (d*8);
+      buf[i*OUTPUT_BITDEPTH_DIV8 + d] = pel >> (d*8);
     }
   }
-  md5.update((UChar*)buf, n * OUTPUT_BITDEPTH_DIV8);
 }
 
 /**
  * Update md5 with all samples in plane in raster order, each sample
  * is adjusted to OUTBIT_BITDEPTH_DIV8.
+ * A row is passed to md5 in one update: 16-bit rows in place on little
+ * endian hosts, other rows after packing them into a row buffer.
  */
 template<UInt OUTPUT_BITDEPTH_DIV8>
 static void md5_plane(MD5& md5, const Pel* plane, UInt width, UInt height, UInt stride)
 {
-  /* N is the number of samples to process per md5 update.
-   * All N samples must fit in buf */
-  UInt N = 32;
-  UInt width_modN = width % N;
-  UInt width_less_modN = width - width_modN;
+  if (OUTPUT_BITDEPTH_DIV8 == sizeof(Pel) && isLittleEndianPel())
+  {
+    for (UInt y = 0; y < height; y++)
+    {
+      md5.update((UChar*)&plane[y*stride], width * OUTPUT_BITDEPTH_DIV8);
+    }
+    return;
+  }
 
+  std::vector<UChar> buf(width * OUTPUT_BITDEPTH_DIV8 + 1);
   for (UInt y = 0; y < height; y++)
   {
-    /* convert pel's into UInt chars in little endian byte order.
-     * NB, for 8bit data, data is truncated to 8bits. */
-    for (UInt x = 0; x < width_less_modN; x += N)
-      md5_block<OUTPUT_BITDEPTH_DIV8>(md5, &plane[y*stride + x], N);
+    pack_samples<OUTPUT_BITDEPTH_DIV8>(&buf[0], &plane[y*stride], width);
+    md5.update(&buf[0], width * OUTPUT_BITDEPTH_DIV8);
+  }
+}
+
+static void md5_plane_digest(const Pel* plane, UInt width, UInt height, UInt stride, Int bitDepth, UChar digest[16])
+{
+  MD5 md5;
+  if (bitDepth <= 8)
+  {
+    md5_plane<1>(md5, plane, width, height, stride);
+  }
+  else
+  {
+    md5_plane<2>(md5, plane, width, height, stride);
+  }
+  md5.finalize(digest);
+}
+
+/**
+ * Lookup tables of the CRC of the decoded picture hash (polynomial
+ * x^16 + x^12 + x^5 + 1, most significant bit first) for slice-by-8:
+ * m_auiTable[k][b] is the remainder of byte b followed by k zero bytes.
+ */
+struct TComCrcTable
+{
+  UShort m_auiTable[8][256];
+
+  TComCrcTable()
+  {
+    for (UInt b = 0; b < 256; b++)
+    {
+      UInt crc = b << 8;
+      for (Int bitIdx = 0; bitIdx < 8; bitIdx++)
+      {
+        crc = (crc << 1) ^ ((crc & 0x8000) ? 0x1021 : 0);
+      }
+      m_auiTable[0][b] = (UShort)crc;
+    }
+    for (Int k = 1; k < 8; k++)
+    {
+      for (UInt b = 0; b < 256; b++)
+      {
+        UInt crc = m_auiTable[k-1][b];
+        m_auiTable[k][b] = (UShort)((crc << 8) ^ m_auiTable[0][crc >> 8]);
+      }
+    }
+  }
+};
+
+static const TComCrcTable s_cCrcTable;
 
-    /* mop up any of the remaining line */
-    md5_block<OUTPUT_BITDEPTH_DIV8>(md5, &plane[y*stride + width_less_modN], width_modN);
+/**
+ * CRC of all samples in plane in raster order, the bytes of a sample in
+ * little-endian order.
+ * The specification shifts the bits into a register initialised to
+ * 0xffff and appends 16 zero bits; this is computed as a table driven CRC
+ * whose initial value is that register after 16 zero bits, eight bytes at
+ * a time.
+ */
+template<UInt OUTPUT_BITDEPTH_DIV8>
+static void crc_plane_digest(const Pel* plane, UInt width, UInt height, UInt stride, UChar digest[16])
+{
+  const UShort (*table)[256] = s_cCrcTable.m_auiTable;
+  UInt crc = 0xffff;
+  crc = ((crc << 8) ^ table[0][crc >> 8]) & 0xffff;
+  crc = ((crc << 8) ^ table[0][crc >> 8]) & 0xffff;
+
+  const UInt samplesPerStep = 8 / OUTPUT_BITDEPTH_DIV8;
+  for (UInt y = 0; y < height; y++)
+  {
+    const Pel* row = &plane[y*stride];
+    UInt x = 0;
+    for (; x + samplesPerStep <= width; x += samplesPerStep)
+    {
+      UChar b[8];
+      for (UInt i = 0; i < samplesPerStep; i++)
+      {
+        for (UInt d = 0; d < OUTPUT_BITDEPTH_DIV8; d++)
+        {
+          b[i*OUTPUT_BITDEPTH_DIV8 + d] = row[x + i] >> (d*8);
+        }
+      }
+      crc = table[7][b[0] ^ (crc >> 8)] ^ table[6][b[1] ^ (crc & 0xff)] ^ table[5][b[2]] ^ table[4][b[3]]
+          ^ table[3][b[4]] ^ table[2][b[5]] ^ table[1][b[6]] ^ table[0][b[7]];
+    }
+    for (; x < width; x++)
+    {
+      for (UInt d = 0; d < OUTPUT_BITDEPTH_DIV8; d++)
+      {
+        UChar b = row[x] >> (d*8);
+        crc = ((crc << 8) ^ table[0][(crc >> 8) ^ b]) & 0xffff;
+      }
+    }
   }
+
+  digest[0] = (crc >> 8) & 0xff;
+  digest[1] = crc & 0xff;
 }
+
+/**
+ * Checksum of all samples in plane: every byte of a sample is XORed with
+ * a mask derived from the sample position before it is added.
+ */
+template<UInt OUTPUT_BITDEPTH_DIV8>
+static void checksum_plane_digest(const Pel* plane, UInt width, UInt height, UInt stride, UChar digest[16])
+{
+  UInt checksum = 0;
+#if ENABLE_SIMD_SSE2
+  const __m128i lowByte = _mm_set1_epi16(0xff);
+  const __m128i one     = _mm_set1_epi16(1);
+  const __m128i step    = _mm_set1_epi16(8);
+  __m128i sum = _mm_setzero_si128();
+#endif
+
+  for (UInt y = 0; y < height; y++)
+  {
+    const Pel* row = &plane[y*stride];
+    UInt yMask = (y & 0xff) ^ (y >> 8);
+    UInt x = 0;
+#if ENABLE_SIMD_SSE2
+    // the masks of the bytes are below 256 and so are the 16-bit lane values; lanes are summed modulo 2^32
+    const __m128i rowMask = _mm_set1_epi16(yMask);
+    __m128i xPos = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    for (; x + 8 <= width; x += 8)
+    {
+      __m128i mask = _mm_xor_si128(_mm_xor_si128(_mm_and_si128(xPos, lowByte), _mm_srli_epi16(xPos, 8)), rowMask);
+      __m128i pel  = _mm_loadu_si128((const __m128i*)(row + x));
+      __m128i val  = _mm_xor_si128(_mm_and_si128(pel, lowByte), mask);
+      if (OUTPUT_BITDEPTH_DIV8 == 2)
+      {
+        val = _mm_add_epi16(val, _mm_xor_si128(_mm_srli_epi16(pel, 8), mask));
+      }
+      sum  = _mm_add_epi32(sum, _mm_madd_epi16(val, one));
+      xPos = _mm_add_epi16(xPos, step);
+    }
+#endif
+    for (; x < width; x++)
+    {
+      UChar xorMask = (x & 0xff) ^ (x >> 8) ^ yMask;
+      checksum += (row[x] & 0xff) ^ xorMask;
+      if (OUTPUT_BITDEPTH_DIV8 == 2)
+      {
+        checksum += (row[x] >> 8) ^ xorMask;
+      }
+    }
+  }
+
+#if ENABLE_SIMD_SSE2
+  UInt auiSum[4];
+  _mm_storeu_si128((__m128i*)auiSum, sum);
+  checksum += auiSum[0] + auiSum[1] + auiSum[2] + auiSum[3];
+#endif
+  digest[0] = (checksum >> 24) & 0xff;
+  digest[1] = (checksum >> 16) & 0xff;
+  digest[2] = (checksum >> 8) & 0xff;
+  digest[3] = checksum & 0xff;
+}
+
+static void crc_digest(const Pel* plane, UInt width, UInt height, UInt stride, Int bitDepth, UChar digest[16])
+{
+  if (bitDepth <= 8)
+  {
+    crc_plane_digest<1>(plane, width, height, stride, digest);
+  }
+  else
+  {
+    crc_plane_digest<2>(plane, width, height, stride, digest);
+  }
+}
+
+static void checksum_digest(const Pel* plane, UInt width, UInt height, UInt stride, Int bitDepth, UChar digest[16])
+{
+  if (bitDepth <= 8)
+  {
+    checksum_plane_digest<1>(plane, width, height, stride, digest);
+  }
+  else
+  {
+    checksum_plane_digest<2>(plane, width, height, stride, digest);
+  }
+}
+
+typedef void (*PlaneHashFunc)(const Pel*, UInt, UInt, UInt, Int, UChar[16]);
+
+/// hash of one plane per work item
+class TComPicHashJob : public TComParallelJob
+{
+public:
+  TComPicHashJob( TComPicYuv& rcPic, UChar digest[3][16], PlaneHashFunc pfHash )
+  : m_rcPic( rcPic ), m_digest( digest ), m_pfHash( pfHash )
+  {
+  }
+
+  Void runItem( Int itemIdx, Int threadIdx )
+  {
+    if (itemIdx == 0)
+    {
+      m_pfHash(m_rcPic.getLumaAddr(), m_rcPic.getWidth(), m_rcPic.getHeight(), m_rcPic.getStride(), g_bitDepthY, m_digest[0]);
+    }
+    else
+    {
+      m_pfHash(itemIdx == 1 ? m_rcPic.getCbAddr() : m_rcPic.getCrAddr(), m_rcPic.getWidth() >> 1, m_rcPic.getHeight() >> 1, m_rcPic.getCStride(),
+               g_bitDepthC, m_digest[itemIdx]);
+    }
+  }
+
+private:
+  TComPicYuv&   m_rcPic;
+  UChar       (*m_digest)[16];
+  PlaneHashFunc m_pfHash;
+};
+
+/// hash Y', Cb and Cr of pic, concurrently if pcThreadPool has more than one thread
+static void hashPicture(TComPicYuv& pic, UChar digest[3][16], PlaneHashFunc pfHash, TComThreadPool* pcThreadPool)
+{
+  TComPicHashJob cJob(pic, digest, pfHash);
+  if (pcThreadPool == NULL || pcThreadPool->getNumThreads() <= 1)
+  {
+    for (Int iComp = 0; iComp < 3; iComp++)
+    {
+      cJob.runItem(iComp, 0);
+    }
+    return;
+  }
+  pcThreadPool->parallelFor(&cJob, 3);
+}
+
 /**
  * Calculate the MD5sum of pic, storing the result in digest.
  * MD5 calculation is performed on Y' then Cb, then Cr; each in raster order.
@@ -89,30 +337,26 @@ static void md5_plane(MD5& md5, const Pel* plane, UInt width, UInt height, UInt
  * using sufficient bytes to represent the picture bitdepth.  Eg, 10bit data
  * uses little-endian two byte words; 8bit data uses single byte words.
  */
-void calcMD5(TComPicYuv& pic, UChar digest[3][16])
+void calcMD5(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool)
 {
-  /* choose an md5_plane packing function based on the system bitdepth */
-  typedef void (*MD5PlaneFunc)(MD5&, const Pel*, UInt, UInt, UInt);
-  MD5PlaneFunc md5_plane_func;
-  md5_plane_func = g_bitDepthY <= 8 ? (MD5PlaneFunc)md5_plane<1> : (MD5PlaneFunc)md5_plane<2>;
-
-  MD5 md5Y, md5U, md5V;
-  UInt width = pic.getWidth();
-  UInt height = pic.getHeight();
-  UInt stride = pic.getStride();
-
-  md5_plane_func(md5Y, pic.getLumaAddr(), width, height, stride);
-  md5Y.finalize(digest[0]);
-
-  md5_plane_func = g_bitDepthC <= 8 ? (MD5PlaneFunc)md5_plane<1> : (MD5PlaneFunc)md5_plane<2>;
-  width >>= 1;
-  height >>= 1;
-  stride >>= 1;
+  hashPicture(pic, digest, md5_plane_digest, pcThreadPool);
+}
 
-  md5_plane_func(md5U, pic.getCbAddr(), width, height, stride);
-  md5U.finalize(digest[1]);
+/**
+ * Calculate the CRC of each plane of pic, storing the 2 byte result of
+ * a plane in digest.
+ */
+void calcCRC(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool)
+{
+  hashPicture(pic, digest, crc_digest, pcThreadPool);
+}
 
-  md5_plane_func(md5V, pic.getCrAddr(), width, height, stride);
-  md5V.finalize(digest[2]);
+/**
+ * Calculate the checksum of each plane of pic, storing the 4 byte result
+ * of a plane in digest.
+ */
+void calcChecksum(TComPicYuv& pic, UChar digest[3][16], TComThreadPool* pcThreadPool)
+{
+  hashPicture(pic, digest, checksum_digest, pcThreadPool);
 }
 //! \}
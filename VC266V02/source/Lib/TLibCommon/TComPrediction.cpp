@@ -37,6 +37,9 @@
 
 #include <memory.h>
 #include "TComPrediction.h"
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -48,6 +51,8 @@
 TComPrediction::TComPrediction()
 : m_pLumaRecBuffer(0)
 , m_iLumaRecStride(0)
+, m_pcMCCache(NULL)
+, m_uiMCCacheStamp(0)
 {
   m_piYuvExt = NULL;
 }
@@ -66,6 +71,8 @@ TComPrediction::~TComPrediction()
   {
     delete [] m_pLumaRecBuffer;
   }
+
+  delete [] m_pcMCCache;
   
   Int i, j;
   for (i = 0; i < 4; i++)
@@ -95,7 +102,7 @@ Void TComPrediction::initTempBuff()
     }
     m_iYuvExtHeight  = ((MAX_CU_SIZE + 2) << 4);
     m_iYuvExtStride = ((MAX_CU_SIZE  + 8) << 4);
-    m_piYuvExt = new Int[ m_iYuvExtStride * m_iYuvExtHeight ];
+    m_piYuvExt = new Pel[ m_iYuvExtStride * m_iYuvExtHeight ];
 
     // new structure
     m_acYuvPred[0] .create( MAX_CU_SIZE, MAX_CU_SIZE );
@@ -114,12 +121,160 @@ Void TComPrediction::initTempBuff()
   }
 }
 
+/** Enable the cache of interpolated prediction blocks.
+ * Motion compensation of 8x8 aligned blocks stores the interpolated samples per 8x8 luma / 4x4 chroma
+ * block, so that repeated predictions of the same block from the same reference and MV are copied.
+ * The reference pictures must not change while the cache is in use, see resetMCCache().
+ */
+Void TComPrediction::createMCCache()
+{
+  if( m_pcMCCache == NULL )
+  {
+    m_pcMCCache = new TComMCCacheBlk[ 1 << MC_CACHE_LOG2_SIZE ];
+    m_uiMCCacheStamp = 0;
+    resetMCCache();
+  }
+}
+
+/** Invalidate all entries of the motion compensation cache, called per CTU.
+ */
+Void TComPrediction::resetMCCache()
+{
+  if( m_pcMCCache == NULL )
+  {
+    return;
+  }
+  if( ++m_uiMCCacheStamp == 1 )
+  {
+    for( Int i = 0; i < ( 1 << MC_CACHE_LOG2_SIZE ); i++ )
+    {
+      m_pcMCCache[i].uiStamp = 0;
+    }
+  }
+}
+
 // ====================================================================================================================
 // Public member functions
 // ====================================================================================================================
 
+#if ENABLE_SIMD_SSE2
+/** sum of a line of reference samples, 8 samples per iteration
+ * \returns number of samples processed
+ */
+static Int sumLineSSE2(const Pel* src, Int width, Int& sum)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i acc = _mm_setzero_si128();
+  Int x;
+  for (x=0; x+8 <= width; x+=8)
+  {
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(src+x)), one));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1,0,3,2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2,3,0,1)));
+  sum += _mm_cvtsi128_si32(acc);
+  return x;
+}
+
+/** angular interpolation of one prediction line, dst[x] = ((32-fract)*ref[x] + fract*ref[x+1] + 16) >> 5
+ * \returns number of samples processed
+ */
+static Int predIntraAngLineSSE2(const Pel* ref, Pel* dst, Int width, Int fract)
+{
+  const __m128i weights = _mm_set1_epi32((fract << 16) | (32 - fract));
+  const __m128i rnd     = _mm_set1_epi32(16);
+  Int x;
+  for (x=0; x+8 <= width; x+=8)
+  {
+    __m128i a  = _mm_loadu_si128((const __m128i*)(ref+x  ));
+    __m128i b  = _mm_loadu_si128((const __m128i*)(ref+x+1));
+    __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights), rnd), 5);
+    __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights), rnd), 5);
+    _mm_storeu_si128((__m128i*)(dst+x), _mm_packs_epi32(lo, hi));
+  }
+  if (x+4 <= width)
+  {
+    __m128i a  = _mm_loadl_epi64((const __m128i*)(ref+x  ));
+    __m128i b  = _mm_loadl_epi64((const __m128i*)(ref+x+1));
+    __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights), rnd), 5);
+    _mm_storel_epi64((__m128i*)(dst+x), _mm_packs_epi32(lo, lo));
+    x += 4;
+  }
+  return x;
+}
+
+/** planar prediction of one line, 4 samples per iteration; advances topRow by bottomRow as the C code does
+ * \returns number of samples processed
+ */
+static Int predIntraPlanarLineSSE2(Int* topRow, const Int* bottomRow, Int horBase, Int horStep, Pel* dst, Int width, Int shift)
+{
+  const __m128i sh    = _mm_cvtsi32_si128(shift);
+  const __m128i step4 = _mm_set1_epi32(4*horStep);
+  __m128i hor = _mm_set_epi32(horBase+4*horStep, horBase+3*horStep, horBase+2*horStep, horBase+horStep);
+  Int x;
+  for (x=0; x+4 <= width; x+=4)
+  {
+    __m128i top = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(topRow+x)), _mm_loadu_si128((const __m128i*)(bottomRow+x)));
+    _mm_storeu_si128((__m128i*)(topRow+x), top);
+    __m128i pred = _mm_sra_epi32(_mm_add_epi32(hor, top), sh);
+    _mm_storel_epi64((__m128i*)(dst+x), _mm_packs_epi32(pred, pred));
+    hor = _mm_add_epi32(hor, step4);
+  }
+  return x;
+}
+
+/** transpose of a block made of 8x8 tiles
+ */
+static Void transposeBlockSSE2(const Pel* src, Int srcStride, Pel* dst, Int dstStride, Int blkSize)
+{
+  for (Int y=0; y<blkSize; y+=8)
+  {
+    for (Int x=0; x<blkSize; x+=8)
+    {
+      const Pel* s = src + y*srcStride + x;
+      __m128i t0 = _mm_loadu_si128((const __m128i*)(s            ));
+      __m128i t1 = _mm_loadu_si128((const __m128i*)(s+  srcStride));
+      __m128i t2 = _mm_loadu_si128((const __m128i*)(s+2*srcStride));
+      __m128i t3 = _mm_loadu_si128((const __m128i*)(s+3*srcStride));
+      __m128i t4 = _mm_loadu_si128((const __m128i*)(s+4*srcStride));
+      __m128i t5 = _mm_loadu_si128((const __m128i*)(s+5*srcStride));
+      __m128i t6 = _mm_loadu_si128((const __m128i*)(s+6*srcStride));
+      __m128i t7 = _mm_loadu_si128((const __m128i*)(s+7*srcStride));
+
+      __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+      __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+      __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+      __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+      __m128i u4 = _mm_unpacklo_epi16(t4, t5);
+      __m128i u5 = _mm_unpackhi_epi16(t4, t5);
+      __m128i u6 = _mm_unpacklo_epi16(t6, t7);
+      __m128i u7 = _mm_unpackhi_epi16(t6, t7);
+
+      t0 = _mm_unpacklo_epi32(u0, u2);
+      t1 = _mm_unpackhi_epi32(u0, u2);
+      t2 = _mm_unpacklo_epi32(u1, u3);
+      t3 = _mm_unpackhi_epi32(u1, u3);
+      t4 = _mm_unpacklo_epi32(u4, u6);
+      t5 = _mm_unpackhi_epi32(u4, u6);
+      t6 = _mm_unpacklo_epi32(u5, u7);
+      t7 = _mm_unpackhi_epi32(u5, u7);
+
+      Pel* d = dst + x*dstStride + y;
+      _mm_storeu_si128((__m128i*)(d            ), _mm_unpacklo_epi64(t0, t4));
+      _mm_storeu_si128((__m128i*)(d+  dstStride), _mm_unpackhi_epi64(t0, t4));
+      _mm_storeu_si128((__m128i*)(d+2*dstStride), _mm_unpacklo_epi64(t1, t5));
+      _mm_storeu_si128((__m128i*)(d+3*dstStride), _mm_unpackhi_epi64(t1, t5));
+      _mm_storeu_si128((__m128i*)(d+4*dstStride), _mm_unpacklo_epi64(t2, t6));
+      _mm_storeu_si128((__m128i*)(d+5*dstStride), _mm_unpackhi_epi64(t2, t6));
+      _mm_storeu_si128((__m128i*)(d+6*dstStride), _mm_unpacklo_epi64(t3, t7));
+      _mm_storeu_si128((__m128i*)(d+7*dstStride), _mm_unpackhi_epi64(t3, t7));
+    }
+  }
+}
+#endif
+
 // Function for calculating DC value of the reference samples used in Intra prediction
-Pel TComPrediction::predIntraGetPredValDC( Int* pSrc, Int iSrcStride, UInt iWidth, UInt iHeight, Bool bAbove, Bool bLeft )
+Pel TComPrediction::predIntraGetPredValDC( Pel* pSrc, Int iSrcStride, UInt iWidth, UInt iHeight, Bool bAbove, Bool bLeft )
 {
   assert(iWidth > 0 && iHeight > 0);
   Int iInd, iSum = 0;
@@ -127,7 +282,11 @@ Pel TComPrediction::predIntraGetPredValDC( Int* pSrc, Int iSrcStride, UInt iWidt
 
   if (bAbove)
   {
-    for (iInd = 0;iInd < iWidth;iInd++)
+    iInd = 0;
+#if ENABLE_SIMD_SSE2
+    iInd = sumLineSSE2(pSrc-iSrcStride, iWidth, iSum);
+#endif
+    for (;iInd < iWidth;iInd++)
     {
       iSum += pSrc[iInd-iSrcStride];
     }
@@ -181,7 +340,7 @@ Pel TComPrediction::predIntraGetPredValDC( Int* pSrc, Int iSrcStride, UInt iWidt
  * the predicted value for the pixel is linearly interpolated from the reference samples. All reference samples are taken
  * from the extended main reference.
  */
-Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*& rpDst, Int dstStride, UInt width, UInt height, UInt dirMode, Bool blkAboveAvailable, Bool blkLeftAvailable, Bool bFilter )
+Void TComPrediction::xPredIntraAng(Int bitDepth, Pel* pSrc, Int srcStride, Pel*& rpDst, Int dstStride, UInt width, UInt height, UInt dirMode, Bool blkAboveAvailable, Bool blkLeftAvailable, Bool bFilter )
 {
   Int k,l;
   Int blkSize        = width;
@@ -208,12 +367,13 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
   {
     Pel dcval = predIntraGetPredValDC(pSrc, srcStride, width, height, blkAboveAvailable, blkLeftAvailable);
 
-    for (k=0;k<blkSize;k++)
+    for (l=0;l<blkSize;l++)
     {
-      for (l=0;l<blkSize;l++)
-      {
-        pDst[k*dstStride+l] = dcval;
-      }
+      pDst[l] = dcval;
+    }
+    for (k=1;k<blkSize;k++)
+    {
+      ::memcpy(pDst+k*dstStride, pDst, blkSize*sizeof(Pel));
     }
   }
 
@@ -224,14 +384,15 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
     Pel* refSide;
     Pel  refAbove[2*MAX_CU_SIZE+1];
     Pel  refLeft[2*MAX_CU_SIZE+1];
+    // horizontal modes are predicted into a transposed local block which is flipped into place at the end
+    Pel  predTrans[MAX_CU_SIZE*MAX_CU_SIZE];
+    Pel* pPred      = modeHor ? predTrans : pDst;
+    Int  predStride = modeHor ? blkSize  : dstStride;
 
     // Initialise the Main and Left reference array.
     if (intraPredAngle < 0)
     {
-      for (k=0;k<blkSize+1;k++)
-      {
-        refAbove[k+blkSize-1] = pSrc[k-srcStride-1];
-      }
+      ::memcpy(refAbove+blkSize-1, pSrc-srcStride-1, (blkSize+1)*sizeof(Pel));
       for (k=0;k<blkSize+1;k++)
       {
         refLeft[k+blkSize-1] = pSrc[(k-1)*srcStride-1];
@@ -249,10 +410,7 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
     }
     else
     {
-      for (k=0;k<2*blkSize+1;k++)
-      {
-        refAbove[k] = pSrc[k-srcStride-1];
-      }
+      ::memcpy(refAbove, pSrc-srcStride-1, (2*blkSize+1)*sizeof(Pel));
       for (k=0;k<2*blkSize+1;k++)
       {
         refLeft[k] = pSrc[(k-1)*srcStride-1];
@@ -265,17 +423,14 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
     {
       for (k=0;k<blkSize;k++)
       {
-        for (l=0;l<blkSize;l++)
-        {
-          pDst[k*dstStride+l] = refMain[l+1];
-        }
+        ::memcpy(pPred+k*predStride, refMain+1, blkSize*sizeof(Pel));
       }
 
       if ( bFilter )
       {
         for (k=0;k<blkSize;k++)
         {
-          pDst[k*dstStride] = Clip3(0, (1<<bitDepth)-1, pDst[k*dstStride] + (( refSide[k+1] - refSide[0] ) >> 1) );
+          pPred[k*predStride] = Clip3(0, (1<<bitDepth)-1, pPred[k*predStride] + (( refSide[k+1] - refSide[0] ) >> 1) );
         }
       }
     }
@@ -284,7 +439,6 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
       Int deltaPos=0;
       Int deltaInt;
       Int deltaFract;
-      Int refMainIndex;
 
       for (k=0;k<blkSize;k++)
       {
@@ -292,22 +446,24 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
         deltaInt   = deltaPos >> 5;
         deltaFract = deltaPos & (32 - 1);
 
+        Pel* ref   = refMain + deltaInt + 1;
+        Pel* pLine = pPred + k*predStride;
         if (deltaFract)
         {
           // Do linear filtering
-          for (l=0;l<blkSize;l++)
+          l = 0;
+#if ENABLE_SIMD_SSE2
+          l = predIntraAngLineSSE2(ref, pLine, blkSize, deltaFract);
+#endif
+          for (;l<blkSize;l++)
           {
-            refMainIndex        = l+deltaInt+1;
-            pDst[k*dstStride+l] = (Pel) ( ((32-deltaFract)*refMain[refMainIndex]+deltaFract*refMain[refMainIndex+1]+16) >> 5 );
+            pLine[l] = (Pel) ( ((32-deltaFract)*ref[l]+deltaFract*ref[l+1]+16) >> 5 );
           }
         }
         else
         {
           // Just copy the integer samples
-          for (l=0;l<blkSize;l++)
-          {
-            pDst[k*dstStride+l] = refMain[l+deltaInt+1];
-          }
+          ::memcpy(pLine, ref, blkSize*sizeof(Pel));
         }
       }
     }
@@ -315,14 +471,20 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
     // Flip the block if this is the horizontal mode
     if (modeHor)
     {
-      Pel  tmp;
-      for (k=0;k<blkSize-1;k++)
+#if ENABLE_SIMD_SSE2
+      if ((blkSize & 7) == 0)
+      {
+        transposeBlockSSE2(predTrans, blkSize, pDst, dstStride, blkSize);
+      }
+      else
+#endif
       {
-        for (l=k+1;l<blkSize;l++)
+        for (k=0;k<blkSize;k++)
         {
-          tmp                 = pDst[k*dstStride+l];
-          pDst[k*dstStride+l] = pDst[l*dstStride+k];
-          pDst[l*dstStride+k] = tmp;
+          for (l=0;l<blkSize;l++)
+          {
+            pDst[l*dstStride+k] = predTrans[k*blkSize+l];
+          }
         }
       }
     }
@@ -332,7 +494,7 @@ Void TComPrediction::xPredIntraAng(Int bitDepth, Int* pSrc, Int srcStride, Pel*&
 Void TComPrediction::predIntraLumaAng(TComPattern* pcTComPattern, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft )
 {
   Pel *pDst = piPred;
-  Int *ptrSrc;
+  Pel *ptrSrc;
 
   assert( g_aucConvertToBit[ iWidth ] >= 0 ); //   4x  4
   assert( g_aucConvertToBit[ iWidth ] <= 5 ); // 128x128
@@ -367,10 +529,10 @@ Void TComPrediction::predIntraLumaAng(TComPattern* pcTComPattern, UInt uiDirMode
 }
 
 // Angular chroma
-Void TComPrediction::predIntraChromaAng( Int* piSrc, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft )
+Void TComPrediction::predIntraChromaAng( Pel* piSrc, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft )
 {
   Pel *pDst = piPred;
-  Int *ptrSrc = piSrc;
+  Pel *ptrSrc = piSrc;
 
   // get starting pixel in block
   Int sw = 2 * iWidth + 1;
@@ -539,6 +701,82 @@ Void TComPrediction::xPredInterBi ( TComDataCU* pcCU, UInt uiPartAddr, Int iWidt
   }
 }
 
+/** Find the cache entry of a block position, MV and output precision
+ * \returns entry to load from if it is valid and matches, otherwise the entry to replace
+ */
+TComMCCacheBlk* TComPrediction::xGetMCCacheBlk( const Pel* pcOrg, TComMv* pcMv, Bool bi )
+{
+  UInt uiHash = (UInt)( (size_t)pcOrg >> 1 ) ^ ( (UInt)pcMv->getHor() * 0x85EBCA77u ) ^ ( (UInt)pcMv->getVer() * 0xC2B2AE3Du ) ^ (UInt)bi;
+  uiHash *= 0x9E3779B1u;
+  return m_pcMCCache + ( uiHash >> ( 32 - MC_CACHE_LOG2_SIZE ) );
+}
+
+/** Copy a prediction block from the motion compensation cache
+ * \param pcOrg      block position in the reference plane, without MV offset
+ * \param iBlkSize   cache block size of the plane
+ * \returns true if all sub-blocks were cached, otherwise the destination is partially written
+ */
+Bool TComPrediction::xLoadMCCache( const Pel* pcOrg, Int iOrgStride, TComMv* pcMv, Int iBlkSize, Int iWidth, Int iHeight, Pel* pcDst, Int iDstStride, Bool bi )
+{
+  if( m_pcMCCache == NULL || ( iWidth % iBlkSize ) || ( iHeight % iBlkSize ) )
+  {
+    return false;
+  }
+  for( Int y = 0; y < iHeight; y += iBlkSize )
+  {
+    for( Int x = 0; x < iWidth; x += iBlkSize )
+    {
+      const Pel* pcBlkOrg = pcOrg + y * iOrgStride + x;
+      TComMCCacheBlk* pcBlk = xGetMCCacheBlk( pcBlkOrg, pcMv, bi );
+      if( pcBlk->uiStamp != m_uiMCCacheStamp || pcBlk->pcOrg != pcBlkOrg || pcBlk->bBi != bi
+       || pcBlk->iMvHor != pcMv->getHor() || pcBlk->iMvVer != pcMv->getVer() )
+      {
+        return false;
+      }
+      const Pel* pcSrc = pcBlk->aiPel;
+      Pel* pcBlkDst = pcDst + y * iDstStride + x;
+      for( Int i = 0; i < iBlkSize; i++ )
+      {
+        ::memcpy( pcBlkDst, pcSrc, sizeof(Pel) * iBlkSize );
+        pcSrc    += iBlkSize;
+        pcBlkDst += iDstStride;
+      }
+    }
+  }
+  return true;
+}
+
+/** Store an interpolated prediction block in the motion compensation cache
+ */
+Void TComPrediction::xStoreMCCache( const Pel* pcOrg, Int iOrgStride, TComMv* pcMv, Int iBlkSize, Int iWidth, Int iHeight, Pel* pcDst, Int iDstStride, Bool bi )
+{
+  if( m_pcMCCache == NULL || ( iWidth % iBlkSize ) || ( iHeight % iBlkSize ) )
+  {
+    return;
+  }
+  for( Int y = 0; y < iHeight; y += iBlkSize )
+  {
+    for( Int x = 0; x < iWidth; x += iBlkSize )
+    {
+      const Pel* pcBlkOrg = pcOrg + y * iOrgStride + x;
+      TComMCCacheBlk* pcBlk = xGetMCCacheBlk( pcBlkOrg, pcMv, bi );
+      pcBlk->pcOrg   = pcBlkOrg;
+      pcBlk->iMvHor  = pcMv->getHor();
+      pcBlk->iMvVer  = pcMv->getVer();
+      pcBlk->bBi     = bi;
+      pcBlk->uiStamp = m_uiMCCacheStamp;
+      Pel* pcBlkDst = pcBlk->aiPel;
+      const Pel* pcSrc = pcDst + y * iDstStride + x;
+      for( Int i = 0; i < iBlkSize; i++ )
+      {
+        ::memcpy( pcBlkDst, pcSrc, sizeof(Pel) * iBlkSize );
+        pcBlkDst += iBlkSize;
+        pcSrc    += iDstStride;
+      }
+    }
+  }
+}
+
 /**
  * \brief Generate motion-compensated luma block
  *
@@ -555,10 +793,16 @@ Void TComPrediction::xPredInterLumaBlk( TComDataCU *cu, TComPicYuv *refPic, UInt
 {
   Int refStride = refPic->getStride();  
   Int refOffset = ( mv->getHor() >> 2 ) + ( mv->getVer() >> 2 ) * refStride;
-  Pel *ref      = refPic->getLumaAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr ) + refOffset;
+  Pel *org      = refPic->getLumaAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr );
+  Pel *ref      = org + refOffset;
   
   Int dstStride = dstPic->getStride();
   Pel *dst      = dstPic->getLumaAddr( partAddr );
+
+  if ( xLoadMCCache( org, refStride, mv, MC_CACHE_BLK_SIZE, width, height, dst, dstStride, bi ) )
+  {
+    return;
+  }
   
   Int xFrac = mv->getHor() & 0x3;
   Int yFrac = mv->getVer() & 0x3;
@@ -582,6 +826,8 @@ Void TComPrediction::xPredInterLumaBlk( TComDataCU *cu, TComPicYuv *refPic, UInt
     m_if.filterHorLuma(ref - (halfFilterSize-1)*refStride, refStride, tmp, tmpStride, width, height+filterSize-1, xFrac, false     );
     m_if.filterVerLuma(tmp + (halfFilterSize-1)*tmpStride, tmpStride, dst, dstStride, width, height,              yFrac, false, !bi);    
   }
+
+  xStoreMCCache( org, refStride, mv, MC_CACHE_BLK_SIZE, width, height, dst, dstStride, bi );
 }
 
 /**
@@ -603,8 +849,10 @@ Void TComPrediction::xPredInterChromaBlk( TComDataCU *cu, TComPicYuv *refPic, UI
   
   Int     refOffset  = (mv->getHor() >> 3) + (mv->getVer() >> 3) * refStride;
   
-  Pel*    refCb     = refPic->getCbAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr ) + refOffset;
-  Pel*    refCr     = refPic->getCrAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr ) + refOffset;
+  Pel*    orgCb     = refPic->getCbAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr );
+  Pel*    orgCr     = refPic->getCrAddr( cu->getAddr(), cu->getZorderIdxInCU() + partAddr );
+  Pel*    refCb     = orgCb + refOffset;
+  Pel*    refCr     = orgCr + refOffset;
   
   Pel* dstCb = dstPic->getCbAddr( partAddr );
   Pel* dstCr = dstPic->getCrAddr( partAddr );
@@ -613,6 +861,12 @@ Void TComPrediction::xPredInterChromaBlk( TComDataCU *cu, TComPicYuv *refPic, UI
   Int     yFrac  = mv->getVer() & 0x7;
   UInt    cxWidth  = width  >> 1;
   UInt    cxHeight = height >> 1;
+
+  if ( xLoadMCCache( orgCb, refStride, mv, MC_CACHE_BLK_SIZE >> 1, cxWidth, cxHeight, dstCb, dstStride, bi )
+    && xLoadMCCache( orgCr, refStride, mv, MC_CACHE_BLK_SIZE >> 1, cxWidth, cxHeight, dstCr, dstStride, bi ) )
+  {
+    return;
+  }
   
   Int     extStride = m_filteredBlockTmp[0].getStride();
   Short*  extY      = m_filteredBlockTmp[0].getLumaAddr();
@@ -639,6 +893,9 @@ Void TComPrediction::xPredInterChromaBlk( TComDataCU *cu, TComPicYuv *refPic, UI
     m_if.filterHorChroma(refCr - (halfFilterSize-1)*refStride, refStride, extY,  extStride, cxWidth, cxHeight+filterSize-1, xFrac, false);
     m_if.filterVerChroma(extY  + (halfFilterSize-1)*extStride, extStride, dstCr, dstStride, cxWidth, cxHeight  , yFrac, false, !bi);    
   }
+
+  xStoreMCCache( orgCb, refStride, mv, MC_CACHE_BLK_SIZE >> 1, cxWidth, cxHeight, dstCb, dstStride, bi );
+  xStoreMCCache( orgCr, refStride, mv, MC_CACHE_BLK_SIZE >> 1, cxWidth, cxHeight, dstCr, dstStride, bi );
 }
 
 Void TComPrediction::xWeightedAverage( TComYuv* pcYuvSrc0, TComYuv* pcYuvSrc1, Int iRefIdx0, Int iRefIdx1, UInt uiPartIdx, Int iWidth, Int iHeight, TComYuv*& rpcYuvDst )
@@ -685,7 +942,7 @@ Void TComPrediction::getMvPredAMVP( TComDataCU* pcCU, UInt uiPartIdx, UInt uiPar
  *
  * This function derives the prediction samples for planar mode (intra coding).
  */
-Void TComPrediction::xPredIntraPlanar( Int* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
+Void TComPrediction::xPredIntraPlanar( Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
 {
   assert(width == height);
 
@@ -718,8 +975,12 @@ Void TComPrediction::xPredIntraPlanar( Int* pSrc, Int srcStride, Pel* rpDst, Int
   // Generate prediction signal
   for (k=0;k<blkSize;k++)
   {
-    horPred = leftColumn[k] + offset2D;
-    for (l=0;l<blkSize;l++)
+    l = 0;
+#if ENABLE_SIMD_SSE2
+    l = predIntraPlanarLineSSE2(topRow, bottomRow, leftColumn[k] + offset2D, rightColumn[k], rpDst+k*dstStride, blkSize, shift2D);
+#endif
+    horPred = leftColumn[k] + offset2D + l*rightColumn[k];
+    for (;l<blkSize;l++)
     {
       horPred += rightColumn[k];
       topRow[l] += bottomRow[l];
@@ -738,7 +999,7 @@ Void TComPrediction::xPredIntraPlanar( Int* pSrc, Int srcStride, Pel* rpDst, Int
  *
  * This function performs filtering left and top edges of the prediction samples for DC mode (intra coding).
  */
-Void TComPrediction::xDCPredFiltering( Int* pSrc, Int iSrcStride, Pel*& rpDst, Int iDstStride, Int iWidth, Int iHeight )
+Void TComPrediction::xDCPredFiltering( Pel* pSrc, Int iSrcStride, Pel*& rpDst, Int iDstStride, Int iWidth, Int iHeight )
 {
   Pel* pDst = rpDst;
   Int x, y, iDstStride2, iSrcStride2;
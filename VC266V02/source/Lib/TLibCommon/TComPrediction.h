@@ -50,6 +50,24 @@
 //! \ingroup TLibCommon
 //! \{
 
+#define MC_CACHE_LOG2_SIZE  12      ///< log2 of number of entries in motion compensation cache
+#define MC_CACHE_BLK_SIZE    8      ///< luma block size of motion compensation cache entries
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// interpolated prediction of one 8x8 luma or 4x4 chroma block
+struct TComMCCacheBlk
+{
+  const Pel* pcOrg;                 ///< block position in the reference plane
+  Short      iMvHor;
+  Short      iMvVer;
+  Bool       bBi;                   ///< high precision output for bi-prediction
+  UInt       uiStamp;               ///< cache generation, older entries are invalid
+  Pel        aiPel[MC_CACHE_BLK_SIZE*MC_CACHE_BLK_SIZE];
+};
+
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
@@ -58,7 +76,7 @@
 class TComPrediction : public TComWeightPrediction
 {
 protected:
-  Int*      m_piYuvExt;
+  Pel*      m_piYuvExt;
   Int       m_iYuvExtStride;
   Int       m_iYuvExtHeight;
   
@@ -72,19 +90,25 @@ protected:
   Pel*   m_pLumaRecBuffer;       ///< array for downsampled reconstructed luma sample 
   Int    m_iLumaRecStride;       ///< stride of #m_pLumaRecBuffer array
 
-  Void xPredIntraAng            (Int bitDepth, Int* pSrc, Int srcStride, Pel*& rpDst, Int dstStride, UInt width, UInt height, UInt dirMode, Bool blkAboveAvailable, Bool blkLeftAvailable, Bool bFilter );
-  Void xPredIntraPlanar         ( Int* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height );
+  TComMCCacheBlk* m_pcMCCache;   ///< interpolated blocks of the current CTU, NULL if disabled
+  UInt   m_uiMCCacheStamp;       ///< current generation of #m_pcMCCache
+
+  Void xPredIntraAng            (Int bitDepth, Pel* pSrc, Int srcStride, Pel*& rpDst, Int dstStride, UInt width, UInt height, UInt dirMode, Bool blkAboveAvailable, Bool blkLeftAvailable, Bool bFilter );
+  Void xPredIntraPlanar         ( Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height );
   
   // motion compensation functions
   Void xPredInterUni            ( TComDataCU* pcCU,                          UInt uiPartAddr,               Int iWidth, Int iHeight, RefPicList eRefPicList, TComYuv*& rpcYuvPred, Bool bi=false          );
   Void xPredInterBi             ( TComDataCU* pcCU,                          UInt uiPartAddr,               Int iWidth, Int iHeight,                         TComYuv*& rpcYuvPred );
   Void xPredInterLumaBlk  ( TComDataCU *cu, TComPicYuv *refPic, UInt partAddr, TComMv *mv, Int width, Int height, TComYuv *&dstPic, Bool bi );
   Void xPredInterChromaBlk( TComDataCU *cu, TComPicYuv *refPic, UInt partAddr, TComMv *mv, Int width, Int height, TComYuv *&dstPic, Bool bi );
+  TComMCCacheBlk* xGetMCCacheBlk( const Pel* pcOrg, TComMv* pcMv, Bool bi );
+  Bool xLoadMCCache             ( const Pel* pcOrg, Int iOrgStride, TComMv* pcMv, Int iBlkSize, Int iWidth, Int iHeight, Pel* pcDst, Int iDstStride, Bool bi );
+  Void xStoreMCCache            ( const Pel* pcOrg, Int iOrgStride, TComMv* pcMv, Int iBlkSize, Int iWidth, Int iHeight, Pel* pcDst, Int iDstStride, Bool bi );
   Void xWeightedAverage         ( TComYuv* pcYuvSrc0, TComYuv* pcYuvSrc1, Int iRefIdx0, Int iRefIdx1, UInt uiPartAddr, Int iWidth, Int iHeight, TComYuv*& rpcYuvDst );
   
-  Void xGetLLSPrediction ( TComPattern* pcPattern, Int* pSrc0, Int iSrcStride, Pel* pDst0, Int iDstStride, UInt uiWidth, UInt uiHeight, UInt uiExt0 );
+  Void xGetLLSPrediction ( TComPattern* pcPattern, Pel* pSrc0, Int iSrcStride, Pel* pDst0, Int iDstStride, UInt uiWidth, UInt uiHeight, UInt uiExt0 );
 
-  Void xDCPredFiltering( Int* pSrc, Int iSrcStride, Pel*& rpDst, Int iDstStride, Int iWidth, Int iHeight );
+  Void xDCPredFiltering( Pel* pSrc, Int iSrcStride, Pel*& rpDst, Int iDstStride, Int iWidth, Int iHeight );
   Bool xCheckIdenticalMotion    ( TComDataCU* pcCU, UInt PartAddr);
 
 public:
@@ -93,6 +117,10 @@ public:
   
   Void    initTempBuff();
   
+  // motion compensation cache
+  Void    createMCCache();
+  Void    resetMCCache();
+  
   // inter
   Void motionCompensation         ( TComDataCU*  pcCU, TComYuv* pcYuvPred, RefPicList eRefPicList = REF_PIC_LIST_X, Int iPartIdx = -1 );
   
@@ -101,11 +129,11 @@ public:
   
   // Angular Intra
   Void predIntraLumaAng           ( TComPattern* pcTComPattern, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft );
-  Void predIntraChromaAng         ( Int* piSrc, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft );
+  Void predIntraChromaAng         ( Pel* piSrc, UInt uiDirMode, Pel* piPred, UInt uiStride, Int iWidth, Int iHeight, Bool bAbove, Bool bLeft );
   
-  Pel  predIntraGetPredValDC      ( Int* pSrc, Int iSrcStride, UInt iWidth, UInt iHeight, Bool bAbove, Bool bLeft );
+  Pel  predIntraGetPredValDC      ( Pel* pSrc, Int iSrcStride, UInt iWidth, UInt iHeight, Bool bAbove, Bool bLeft );
   
-  Int* getPredicBuf()             { return m_piYuvExt;      }
+  Pel* getPredicBuf()             { return m_piYuvExt;      }
   Int  getPredicBufWidth()        { return m_iYuvExtStride; }
   Int  getPredicBufHeight()       { return m_iYuvExtHeight; }
 
@@ -39,6 +39,11 @@
 #include <assert.h>
 #include "TComRom.h"
 #include "TComRdCost.h"
+#include "TComPicYuv.h"
+#include "TComThreadPool.h"
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -450,6 +455,134 @@ UInt TComRdCost::getDistPart(Int bitDepth, Pel* piCur, Int iCurStride,  Pel* piO
   }
 }
 
+// ====================================================================================================================
+// Plane distortion
+// ====================================================================================================================
+
+/** SSD of a rectangle of samples
+ * \param uiShift  every squared difference is shifted down by uiShift before it is added
+ */
+UInt64 TComRdCost::getPlaneSSD( Pel* piOrg, Int iOrgStride, Pel* piCur, Int iCurStride, Int iWidth, Int iHeight, UInt uiShift )
+{
+  UInt64 uiSSD = 0;
+#if ENABLE_SIMD_SSE2
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i shift = _mm_cvtsi32_si128( uiShift );
+  __m128i ssd = zero;
+#endif
+  
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+#if ENABLE_SIMD_SSE2
+    // squared differences are widened to 64 bits per vector
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      __m128i diff  = _mm_sub_epi16( _mm_loadu_si128( (const __m128i*)( piOrg + x ) ), _mm_loadu_si128( (const __m128i*)( piCur + x ) ) );
+      __m128i lo    = _mm_unpacklo_epi16( diff, zero );
+      __m128i hi    = _mm_unpackhi_epi16( diff, zero );
+      __m128i sq    = _mm_add_epi32( _mm_srl_epi32( _mm_madd_epi16( lo, lo ), shift ), _mm_srl_epi32( _mm_madd_epi16( hi, hi ), shift ) );
+      ssd = _mm_add_epi64( ssd, _mm_add_epi64( _mm_unpacklo_epi32( sq, zero ), _mm_unpackhi_epi32( sq, zero ) ) );
+    }
+#endif
+    for( ; x < iWidth; x++ )
+    {
+      Int iDiff = piOrg[x] - piCur[x];
+      uiSSD += ( iDiff * iDiff ) >> uiShift;
+    }
+    piOrg += iOrgStride;
+    piCur += iCurStride;
+  }
+  
+#if ENABLE_SIMD_SSE2
+  UInt64 auiSum[2];
+  _mm_storeu_si128( (__m128i*)auiSum, ssd );
+  uiSSD += auiSum[0] + auiSum[1];
+#endif
+  return uiSSD;
+}
+
+/// SSD of one CTU row of one plane per work item
+class TComPicSSDJob : public TComParallelJob
+{
+public:
+  TComPicSSDJob( TComPicYuv* pcPicOrg, TComPicYuv* pcPicCur, Int iWidth, Int iHeight, UInt uiShiftY, UInt uiShiftC )
+  : m_pcPicOrg( pcPicOrg ), m_pcPicCur( pcPicCur ), m_iWidth( iWidth ), m_iHeight( iHeight ), m_uiShiftY( uiShiftY ), m_uiShiftC( uiShiftC )
+  {
+    m_iNumRows = ( iHeight + g_uiMaxCUHeight - 1 ) / g_uiMaxCUHeight;
+    m_auiSSD.resize( 3 * m_iNumRows, 0 );
+  }
+  
+  Int  getNumItems() { return 3 * m_iNumRows; }
+  
+  Void runItem( Int itemIdx, Int threadIdx )
+  {
+    Int iComp     = itemIdx / m_iNumRows;
+    Int iRowStart = ( itemIdx % m_iNumRows ) * g_uiMaxCUHeight;
+    Int iRowEnd   = std::min( iRowStart + (Int)g_uiMaxCUHeight, m_iHeight );
+    if( iComp == 0 )
+    {
+      Int iOrgStride = m_pcPicOrg->getStride();
+      Int iCurStride = m_pcPicCur->getStride();
+      m_auiSSD[itemIdx] = TComRdCost::getPlaneSSD( m_pcPicOrg->getLumaAddr() + iRowStart*iOrgStride, iOrgStride, m_pcPicCur->getLumaAddr() + iRowStart*iCurStride, iCurStride,
+                                                   m_iWidth, iRowEnd - iRowStart, m_uiShiftY );
+    }
+    else
+    {
+      Int  iOrgStride = m_pcPicOrg->getCStride();
+      Int  iCurStride = m_pcPicCur->getCStride();
+      Pel* piOrg      = ( iComp == 1 ) ? m_pcPicOrg->getCbAddr() : m_pcPicOrg->getCrAddr();
+      Pel* piCur      = ( iComp == 1 ) ? m_pcPicCur->getCbAddr() : m_pcPicCur->getCrAddr();
+      iRowStart >>= 1;
+      iRowEnd   >>= 1;
+      m_auiSSD[itemIdx] = TComRdCost::getPlaneSSD( piOrg + iRowStart*iOrgStride, iOrgStride, piCur + iRowStart*iCurStride, iCurStride,
+                                                   m_iWidth >> 1, iRowEnd - iRowStart, m_uiShiftC );
+    }
+  }
+  
+  UInt64 getSSD( Int iComp )
+  {
+    UInt64 uiSSD = 0;
+    for( Int i = iComp * m_iNumRows; i < ( iComp + 1 ) * m_iNumRows; i++ )
+    {
+      uiSSD += m_auiSSD[i];
+    }
+    return uiSSD;
+  }
+  
+private:
+  TComPicYuv*         m_pcPicOrg;
+  TComPicYuv*         m_pcPicCur;
+  Int                 m_iWidth;
+  Int                 m_iHeight;
+  UInt                m_uiShiftY;
+  UInt                m_uiShiftC;
+  Int                 m_iNumRows;
+  std::vector<UInt64> m_auiSSD;
+};
+
+/** SSD of the three planes of the top-left iWidth x iHeight luma samples of two pictures
+ * \param auiSSD        receives the SSD of Y, Cb and Cr
+ * \param pcThreadPool  worker threads the CTU rows of the planes are spread over, the serial path is used if NULL
+ */
+Void TComRdCost::getPicSSD( TComPicYuv* pcPicOrg, TComPicYuv* pcPicCur, Int iWidth, Int iHeight, UInt64 auiSSD[3], TComThreadPool* pcThreadPool, UInt uiShiftY, UInt uiShiftC )
+{
+  if( pcThreadPool == NULL || pcThreadPool->getNumThreads() <= 1 )
+  {
+    auiSSD[0] = getPlaneSSD( pcPicOrg->getLumaAddr(), pcPicOrg->getStride(),  pcPicCur->getLumaAddr(), pcPicCur->getStride(),  iWidth,      iHeight,      uiShiftY );
+    auiSSD[1] = getPlaneSSD( pcPicOrg->getCbAddr(),   pcPicOrg->getCStride(), pcPicCur->getCbAddr(),   pcPicCur->getCStride(), iWidth >> 1, iHeight >> 1, uiShiftC );
+    auiSSD[2] = getPlaneSSD( pcPicOrg->getCrAddr(),   pcPicOrg->getCStride(), pcPicCur->getCrAddr(),   pcPicCur->getCStride(), iWidth >> 1, iHeight >> 1, uiShiftC );
+    return;
+  }
+  
+  TComPicSSDJob cJob( pcPicOrg, pcPicCur, iWidth, iHeight, uiShiftY, uiShiftC );
+  pcThreadPool->parallelFor( &cJob, cJob.getNumItems() );
+  for( Int iComp = 0; iComp < 3; iComp++ )
+  {
+    auiSSD[iComp] = cJob.getSSD( iComp );
+  }
+}
+
 // ====================================================================================================================
 // Distortion functions
 // ====================================================================================================================
@@ -53,6 +53,8 @@
 
 class DistParam;
 class TComPattern;
+class TComPicYuv;
+class TComThreadPool;
 
 // ====================================================================================================================
 // Type definition
@@ -229,6 +231,11 @@ private:
   
 public:
   UInt   getDistPart(Int bitDepth, Pel* piCur, Int iCurStride,  Pel* piOrg, Int iOrgStride, UInt uiBlkWidth, UInt uiBlkHeight, TextType eText = TEXT_LUMA, DFunc eDFunc = DF_SSE );
+  
+  // whole-plane distortion for picture metrics and filter decisions, each squared difference is scaled down by uiShift
+  static UInt64 getPlaneSSD( Pel* piOrg, Int iOrgStride, Pel* piCur, Int iCurStride, Int iWidth, Int iHeight, UInt uiShift = 0 );
+  static Void   getPicSSD  ( TComPicYuv* pcPicOrg, TComPicYuv* pcPicCur, Int iWidth, Int iHeight, UInt64 auiSSD[3],
+                             TComThreadPool* pcThreadPool, UInt uiShiftY = 0, UInt uiShiftC = 0 );
 
 };// END CLASS DEFINITION TComRdCost
 
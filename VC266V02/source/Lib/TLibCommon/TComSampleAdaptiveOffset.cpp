@@ -40,6 +40,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
@@ -111,9 +114,18 @@ TComSampleAdaptiveOffset::TComSampleAdaptiveOffset()
     m_offsetClipTable[compIdx] = NULL;
   }
 
-  m_lineBufWidth = 0;
-  m_signLineBuf1 = NULL;
-  m_signLineBuf2 = NULL;
+  m_pcThreadPool = NULL;
+  m_parallelStage = SAO_STAGE_OFFSET_CTU;
+  m_pcParallelPic = NULL;
+  for(Int compIdx=0; compIdx < NUM_SAO_COMPONENTS; compIdx++)
+  {
+    m_ctuLineAbove[compIdx] = NULL;
+    m_ctuLineBelow[compIdx] = NULL;
+    m_ctuColLeft  [compIdx] = NULL;
+    m_ctuColRight [compIdx] = NULL;
+  }
+  m_threadLineBuf = NULL;
+  m_numThreadLineBufs = 0;
 }
 
 
@@ -121,8 +133,7 @@ TComSampleAdaptiveOffset::~TComSampleAdaptiveOffset()
 {
   destroy();
   
-  if (m_signLineBuf1) delete[] m_signLineBuf1; m_signLineBuf1 = NULL;
-  if (m_signLineBuf2) delete[] m_signLineBuf2; m_signLineBuf2 = NULL;
+  if (m_threadLineBuf) delete[] m_threadLineBuf; m_threadLineBuf = NULL;
 }
 
 Void TComSampleAdaptiveOffset::create( Int picWidth, Int picHeight, UInt maxCUWidth, UInt maxCUHeight, UInt maxCUDepth )
@@ -138,11 +149,17 @@ Void TComSampleAdaptiveOffset::create( Int picWidth, Int picHeight, UInt maxCUWi
   m_numCTUInHeight= (m_picHeight/m_maxCUHeight) + ((m_picHeight % m_maxCUHeight)?1:0);
   m_numCTUsPic = m_numCTUInHeight*m_numCTUInWidth;
 
-  //temporary picture buffer
-  if ( !m_tempPicYuv )
+  //deblocked samples around the CTU boundaries, kept so that CTUs can be offset in place and in any order
+  for(Int compIdx =0; compIdx < NUM_SAO_COMPONENTS; compIdx++)
   {
-    m_tempPicYuv = new TComPicYuv;
-    m_tempPicYuv->create( m_picWidth, m_picHeight, m_maxCUWidth, m_maxCUHeight, maxCUDepth );
+    Int formatShift = (compIdx == SAO_Y)?0:1;
+    Int planeWidth  = m_picWidth  >> formatShift;
+    Int planeHeight = m_picHeight >> formatShift;
+
+    m_ctuLineAbove[compIdx] = new Pel[m_numCTUInHeight*(planeWidth+2)];
+    m_ctuLineBelow[compIdx] = new Pel[m_numCTUInHeight*(planeWidth+2)];
+    m_ctuColLeft  [compIdx] = new Pel[m_numCTUInWidth*planeHeight];
+    m_ctuColRight [compIdx] = new Pel[m_numCTUInWidth*planeHeight];
   }
 
   //bit-depth related
@@ -190,6 +207,13 @@ Void TComSampleAdaptiveOffset::destroy()
     {
       delete[] m_offsetClipTable[compIdx]; m_offsetClipTable[compIdx] = NULL;
     }
+    if(m_ctuLineAbove[compIdx])
+    {
+      delete[] m_ctuLineAbove[compIdx]; m_ctuLineAbove[compIdx] = NULL;
+      delete[] m_ctuLineBelow[compIdx]; m_ctuLineBelow[compIdx] = NULL;
+      delete[] m_ctuColLeft  [compIdx]; m_ctuColLeft  [compIdx] = NULL;
+      delete[] m_ctuColRight [compIdx]; m_ctuColRight [compIdx] = NULL;
+    }
   }
 }
 
@@ -334,225 +358,207 @@ Void TComSampleAdaptiveOffset::reconstructBlkSAOParams(TComPic* pic, SAOBlkParam
 }
 
 
-Void TComSampleAdaptiveOffset::offsetBlock(Int compIdx, Int typeIdx, Int* offset  
-                                          , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
-                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail)
+#if ENABLE_SIMD_SSE2
+/** edge offset of one line segment, 8 samples per iteration
+ * \param offset offsets indexed by edgeType+2
+ */
+static Int offsetLineEOSSE2(const Pel* srcLine, const Pel* srcNbA, const Pel* srcNbB, Pel* resLine, Int width, const Int* offset, Int maxSampleVal)
 {
-  if(m_lineBufWidth != m_maxCUWidth)
+  const __m128i zero    = _mm_setzero_si128();
+  const __m128i maxVal  = _mm_set1_epi16((Short)maxSampleVal);
+  const __m128i edgeM2  = _mm_set1_epi16(-2);
+  const __m128i edgeM1  = _mm_set1_epi16(-1);
+  const __m128i edgeP1  = _mm_set1_epi16( 1);
+  const __m128i edgeP2  = _mm_set1_epi16( 2);
+  const __m128i offM2   = _mm_set1_epi16((Short)offset[0]);
+  const __m128i offM1   = _mm_set1_epi16((Short)offset[1]);
+  const __m128i off0    = _mm_set1_epi16((Short)offset[2]);
+  const __m128i offP1   = _mm_set1_epi16((Short)offset[3]);
+  const __m128i offP2   = _mm_set1_epi16((Short)offset[4]);
+
+  Int x;
+  for (x=0; x+8 <= width; x+=8)
   {
-    m_lineBufWidth = m_maxCUWidth;
-    
-    if (m_signLineBuf1) delete[] m_signLineBuf1; m_signLineBuf1 = NULL;
-    m_signLineBuf1 = new Char[m_lineBufWidth+1];
-    
-    if (m_signLineBuf2) delete[] m_signLineBuf2; m_signLineBuf2 = NULL;
-    m_signLineBuf2 = new Char[m_lineBufWidth+1];
+    __m128i cur  = _mm_loadu_si128((const __m128i*)(srcLine+ x));
+    __m128i nbA  = _mm_loadu_si128((const __m128i*)(srcNbA + x));
+    __m128i nbB  = _mm_loadu_si128((const __m128i*)(srcNbB + x));
+
+    //sgn(cur - nb) = (nb > cur) - (cur > nb) with compare results being 0/-1
+    __m128i edge = _mm_sub_epi16(_mm_cmpgt_epi16(nbA, cur), _mm_cmpgt_epi16(cur, nbA));
+    edge = _mm_add_epi16(edge, _mm_sub_epi16(_mm_cmpgt_epi16(nbB, cur), _mm_cmpgt_epi16(cur, nbB)));
+
+    __m128i off = _mm_and_si128(_mm_cmpeq_epi16(edge, edgeM2), offM2);
+    off = _mm_or_si128(off, _mm_and_si128(_mm_cmpeq_epi16(edge, edgeM1), offM1));
+    off = _mm_or_si128(off, _mm_and_si128(_mm_cmpeq_epi16(edge, zero  ), off0 ));
+    off = _mm_or_si128(off, _mm_and_si128(_mm_cmpeq_epi16(edge, edgeP1), offP1));
+    off = _mm_or_si128(off, _mm_and_si128(_mm_cmpeq_epi16(edge, edgeP2), offP2));
+
+    __m128i res = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(cur, off), zero), maxVal);
+    _mm_storeu_si128((__m128i*)(resLine+ x), res);
   }
+  return x;
+}
 
-  Int* offsetClip = m_offsetClip[compIdx];
+/** band offset of one line segment, 8 samples per iteration
+ * \param bandIdx/bandOffset bands with non-zero offsets (at most 4 for a valid BO parameter set)
+ */
+static Int offsetLineBOSSE2(const Pel* srcLine, Pel* resLine, Int width, Int shiftBits, const Int* bandIdx, const Int* bandOffset, Int numBands, Int maxSampleVal)
+{
+  const __m128i zero   = _mm_setzero_si128();
+  const __m128i maxVal = _mm_set1_epi16((Short)maxSampleVal);
+  const __m128i shift  = _mm_cvtsi32_si128(shiftBits);
+  __m128i band[NUM_SAO_BO_CLASSES], bandOff[NUM_SAO_BO_CLASSES];
+  for (Int i=0; i< numBands; i++)
+  {
+    band   [i] = _mm_set1_epi16((Short)bandIdx[i]);
+    bandOff[i] = _mm_set1_epi16((Short)bandOffset[i]);
+  }
 
-  Int x,y, startX, startY, endX, endY, edgeType;
-  Int firstLineStartX, firstLineEndX, lastLineStartX, lastLineEndX;
-  Char signLeft, signRight, signDown;
+  Int x;
+  for (x=0; x+8 <= width; x+=8)
+  {
+    __m128i cur = _mm_loadu_si128((const __m128i*)(srcLine+ x));
+    __m128i curBand = _mm_srl_epi16(cur, shift);
+    __m128i off = zero;
+    for (Int i=0; i< numBands; i++)
+    {
+      off = _mm_or_si128(off, _mm_and_si128(_mm_cmpeq_epi16(curBand, band[i]), bandOff[i]));
+    }
+    __m128i res = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(cur, off), zero), maxVal);
+    _mm_storeu_si128((__m128i*)(resLine+ x), res);
+  }
+  return x;
+}
+#endif
 
-  Pel* srcLine = srcBlk;
-  Pel* resLine = resBlk;
+/** derive the range of samples in line y of a block that are modified by the given SAO type
+ * \returns startX >= endX if the whole line is left unchanged
+ */
+Void TComSampleAdaptiveOffset::getLineRange(Int typeIdx, Int y, Int width, Int height
+                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                                          , Int& startX, Int& endX)
+{
+  Bool isFirstLine = (y == 0);
+  Bool isLastLine  = (y == height-1);
+
+  startX = isLeftAvail ? 0 : 1;
+  endX   = isRightAvail ? width : (width -1);
 
   switch(typeIdx)
   {
   case SAO_TYPE_EO_0:
-    {
-      offset += 2;
-      startX = isLeftAvail ? 0 : 1;
-      endX   = isRightAvail ? width : (width -1);
-      for (y=0; y< height; y++)
-      {
-        signLeft = (Char)sgn(srcLine[startX] - srcLine[startX-1]);
-        for (x=startX; x< endX; x++)
-        {
-          signRight = (Char)sgn(srcLine[x] - srcLine[x+1]); 
-          edgeType =  signRight + signLeft;
-          signLeft  = -signRight;
-
-          resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-        }
-        srcLine  += srcStride;
-        resLine += resStride;
-      }
-
-    }
     break;
   case SAO_TYPE_EO_90:
     {
-      offset += 2;
-      Char *signUpLine = m_signLineBuf1;
-
-      startY = isAboveAvail ? 0 : 1;
-      endY   = isBelowAvail ? height : height-1;
-      if (!isAboveAvail)
-      {
-        srcLine += srcStride;
-        resLine += resStride;
-      }
-
-      Pel* srcLineAbove= srcLine- srcStride;
-      for (x=0; x< width; x++)
-      {
-        signUpLine[x] = (Char)sgn(srcLine[x] - srcLineAbove[x]);
-      }
-
-      Pel* srcLineBelow;
-      for (y=startY; y<endY; y++)
-      {
-        srcLineBelow= srcLine+ srcStride;
-
-        for (x=0; x< width; x++)
-        {
-          signDown  = (Char)sgn(srcLine[x] - srcLineBelow[x]);
-          edgeType = signDown + signUpLine[x];
-          signUpLine[x]= -signDown;
-
-          resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-        }
-        srcLine += srcStride;
-        resLine += resStride;
-      }
-
+      startX = 0;
+      endX   = ((isFirstLine && !isAboveAvail) || (isLastLine && !isBelowAvail)) ? 0 : width;
     }
     break;
   case SAO_TYPE_EO_135:
     {
-      offset += 2;
-      Char *signUpLine, *signDownLine, *signTmpLine;
-
-      signUpLine  = m_signLineBuf1;
-      signDownLine= m_signLineBuf2;
-
-      startX = isLeftAvail ? 0 : 1 ;
-      endX   = isRightAvail ? width : (width-1);
-
-      //prepare 2nd line's upper sign
-      Pel* srcLineBelow= srcLine+ srcStride;
-      for (x=startX; x< endX+1; x++)
-      {
-        signUpLine[x] = (Char)sgn(srcLineBelow[x] - srcLine[x- 1]);
-      }
-
-      //1st line
-      Pel* srcLineAbove= srcLine- srcStride;
-      firstLineStartX = isAboveLeftAvail ? 0 : 1;
-      firstLineEndX   = isAboveAvail? endX: 1;
-      for(x= firstLineStartX; x< firstLineEndX; x++)
-      {
-        edgeType  =  sgn(srcLine[x] - srcLineAbove[x- 1]) - signUpLine[x+1];
-        resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-      }
-      srcLine  += srcStride;
-      resLine  += resStride;
-
-      //middle lines
-      for (y= 1; y< height-1; y++)
+      if(isFirstLine)
       {
-        srcLineBelow= srcLine+ srcStride;
-
-        for (x=startX; x<endX; x++)
-        {
-          signDown =  (Char)sgn(srcLine[x] - srcLineBelow[x+ 1]);
-          edgeType =  signDown + signUpLine[x];
-          resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-
-          signDownLine[x+1] = -signDown; 
-        }
-        signDownLine[startX] = (Char)sgn(srcLineBelow[startX] - srcLine[startX-1]);
-        signTmpLine  = signUpLine;
-        signUpLine   = signDownLine;
-        signDownLine = signTmpLine;
-
-        srcLine += srcStride;
-        resLine += resStride;
+        endX   = isAboveAvail ? endX : 1;
+        startX = isAboveLeftAvail ? 0 : 1;
       }
-
-      //last line
-      srcLineBelow= srcLine+ srcStride;
-      lastLineStartX = isBelowAvail ? startX : (width -1);
-      lastLineEndX   = isBelowRightAvail ? width : (width -1);
-      for(x= lastLineStartX; x< lastLineEndX; x++)
+      else if(isLastLine)
       {
-        edgeType =  sgn(srcLine[x] - srcLineBelow[x+ 1]) + signUpLine[x];
-        resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-
+        startX = isBelowAvail ? startX : (width -1);
+        endX   = isBelowRightAvail ? width : (width -1);
       }
     }
     break;
   case SAO_TYPE_EO_45:
     {
-      offset += 2;
-      Char *signUpLine = m_signLineBuf1+1;
-
-      startX = isLeftAvail ? 0 : 1;
-      endX   = isRightAvail ? width : (width -1);
-
-      //prepare 2nd line upper sign
-      Pel* srcLineBelow= srcLine+ srcStride;
-      for (x=startX-1; x< endX; x++)
+      if(isFirstLine)
       {
-        signUpLine[x] = (Char)sgn(srcLineBelow[x] - srcLine[x+1]);
+        startX = isAboveAvail ? startX : (width -1);
+        endX   = isAboveRightAvail ? width : (width -1);
       }
-
-
-      //first line
-      Pel* srcLineAbove= srcLine- srcStride;
-      firstLineStartX = isAboveAvail ? startX : (width -1 );
-      firstLineEndX   = isAboveRightAvail ? width : (width-1);
-      for(x= firstLineStartX; x< firstLineEndX; x++)
+      else if(isLastLine)
       {
-        edgeType = sgn(srcLine[x] - srcLineAbove[x+1]) -signUpLine[x-1];
-        resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
+        endX   = isBelowAvail ? endX : 1;
+        startX = isBelowLeftAvail ? 0 : 1;
       }
-      srcLine += srcStride;
-      resLine += resStride;
+    }
+    break;
+  case SAO_TYPE_BO:
+    {
+      startX = 0;
+      endX   = width;
+    }
+    break;
+  default:
+    {
+      printf("Not a supported SAO types\n");
+      assert(0);
+      exit(-1);
+    }
+  }
+}
 
-      //middle lines
-      for (y= 1; y< height-1; y++)
-      {
-        srcLineBelow= srcLine+ srcStride;
+/** apply the offsets to samples [startX, endX) of one line
+ * \param srcLineAbove/srcLineBelow neighbouring source lines, only accessed by the vertical and diagonal EO types
+ */
+Void TComSampleAdaptiveOffset::offsetLine(Int compIdx, Int typeIdx, Int* offset
+                                         , Pel* srcLine, Pel* srcLineAbove, Pel* srcLineBelow, Pel* resLine, Int startX, Int endX)
+{
+  Int* offsetClip = m_offsetClip[compIdx];
+  Int  width = endX - startX;
+  Int  x = 0;
 
-        for(x= startX; x< endX; x++)
-        {
-          signDown =  (Char)sgn(srcLine[x] - srcLineBelow[x-1]);
-          edgeType =  signDown + signUpLine[x];
-          resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-          signUpLine[x-1] = -signDown; 
-        }
-        signUpLine[endX-1] = (Char)sgn(srcLineBelow[endX-1] - srcLine[endX]);
-        srcLine  += srcStride;
-        resLine += resStride;
-      }
+  srcLine += startX;
+  resLine += startX;
 
-      //last line
-      srcLineBelow= srcLine+ srcStride;
-      lastLineStartX = isBelowLeftAvail ? 0 : 1;
-      lastLineEndX   = isBelowAvail ? endX : 1;
-      for(x= lastLineStartX; x< lastLineEndX; x++)
+  if(typeIdx == SAO_TYPE_BO)
+  {
+    Int shiftBits = ((compIdx == SAO_Y)?g_bitDepthY:g_bitDepthC)- NUM_SAO_BO_CLASSES_LOG2;
+#if ENABLE_SIMD_SSE2
+    Int bandIdx[NUM_SAO_BO_CLASSES], bandOffset[NUM_SAO_BO_CLASSES];
+    Int numBands = 0;
+    for(Int band=0; band< NUM_SAO_BO_CLASSES; band++)
+    {
+      if(offset[band] != 0)
       {
-        edgeType = sgn(srcLine[x] - srcLineBelow[x-1]) + signUpLine[x];
-        resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
-
+        bandIdx[numBands] = band; bandOffset[numBands] = offset[band]; numBands++;
       }
     }
+    x = offsetLineBOSSE2(srcLine, resLine, width, shiftBits, bandIdx, bandOffset, numBands, ((compIdx == SAO_Y)?(1<<g_bitDepthY):(1<<g_bitDepthC))-1);
+#endif
+    for (; x< width; x++)
+    {
+      resLine[x] = offsetClip[ srcLine[x] + offset[srcLine[x] >> shiftBits] ];
+    }
+    return;
+  }
+
+  //neighbours a and b of the current sample along the EO direction
+  Pel* srcNbA;
+  Pel* srcNbB;
+  switch(typeIdx)
+  {
+  case SAO_TYPE_EO_0:
+    {
+      srcNbA = srcLine- 1;
+      srcNbB = srcLine+ 1;
+    }
     break;
-  case SAO_TYPE_BO:
+  case SAO_TYPE_EO_90:
     {
-      Int shiftBits = ((compIdx == SAO_Y)?g_bitDepthY:g_bitDepthC)- NUM_SAO_BO_CLASSES_LOG2;
-      for (y=0; y< height; y++)
-      {
-        for (x=0; x< width; x++)
-        {
-          resLine[x] = offsetClip[ srcLine[x] + offset[srcLine[x] >> shiftBits] ];
-        }
-        srcLine += srcStride;
-        resLine += resStride;
-      }
+      srcNbA = srcLineAbove+ startX;
+      srcNbB = srcLineBelow+ startX;
+    }
+    break;
+  case SAO_TYPE_EO_135:
+    {
+      srcNbA = srcLineAbove+ startX- 1;
+      srcNbB = srcLineBelow+ startX+ 1;
+    }
+    break;
+  case SAO_TYPE_EO_45:
+    {
+      srcNbA = srcLineAbove+ startX+ 1;
+      srcNbB = srcLineBelow+ startX- 1;
     }
     break;
   default:
@@ -563,7 +569,35 @@ Void TComSampleAdaptiveOffset::offsetBlock(Int compIdx, Int typeIdx, Int* offset
     }
   }
 
+  offset += 2;
+#if ENABLE_SIMD_SSE2
+  x = offsetLineEOSSE2(srcLine, srcNbA, srcNbB, resLine, width, offset- 2, ((compIdx == SAO_Y)?(1<<g_bitDepthY):(1<<g_bitDepthC))-1);
+#endif
+  for (; x< width; x++)
+  {
+    Int edgeType = sgn(srcLine[x] - srcNbA[x]) + sgn(srcLine[x] - srcNbB[x]);
+    resLine[x] = offsetClip[srcLine[x] + offset[edgeType]];
+  }
+}
 
+Void TComSampleAdaptiveOffset::offsetBlock(Int compIdx, Int typeIdx, Int* offset  
+                                          , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
+                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail)
+{
+  Int startX, endX;
+  Pel* srcLine = srcBlk;
+  Pel* resLine = resBlk;
+
+  for (Int y=0; y< height; y++)
+  {
+    getLineRange(typeIdx, y, width, height, isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail, startX, endX);
+    if(startX < endX)
+    {
+      offsetLine(compIdx, typeIdx, offset, srcLine, srcLine- srcStride, srcLine+ srcStride, resLine, startX, endX);
+    }
+    srcLine += srcStride;
+    resLine += resStride;
+  }
 }
 
 Void TComSampleAdaptiveOffset::offsetCTU(Int ctu, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic)
@@ -620,19 +654,245 @@ Void TComSampleAdaptiveOffset::offsetCTU(Int ctu, TComPicYuv* srcYuv, TComPicYuv
 }
 
 
+/** back up the deblocked samples needed by the CTUs of one CTU row from their neighbours
+ * \param ctuRow CTU row index
+ */
+Void TComSampleAdaptiveOffset::saveBoundaryLines(Int ctuRow, TComPicYuv* recYuv)
+{
+  for(Int compIdx= 0; compIdx < NUM_SAO_COMPONENTS; compIdx++)
+  {
+    if(!m_picSAOEnabled[compIdx])
+    {
+      continue;
+    }
+    Int  formatShift = (compIdx == SAO_Y)?0:1;
+    Int  planeWidth  = m_picWidth  >> formatShift;
+    Int  planeHeight = m_picHeight >> formatShift;
+    Int  ctuWidth    = m_maxCUWidth  >> formatShift;
+    Int  ctuHeight   = m_maxCUHeight >> formatShift;
+    Int  stride      = (compIdx == SAO_Y)?recYuv->getStride():recYuv->getCStride();
+    Pel* picBuf      = getPicBuf(recYuv, compIdx);
+
+    Int  yStart = ctuRow*ctuHeight;
+    Int  yEnd   = min(yStart + ctuHeight, planeHeight);
+
+    //lines above and below, including one sample of the picture margin on both sides for the corners
+    if(ctuRow > 0)
+    {
+      ::memcpy(m_ctuLineAbove[compIdx]+ ctuRow*(planeWidth+2), picBuf+ (yStart-1)*stride- 1, sizeof(Pel)*(planeWidth+2));
+    }
+    if(ctuRow < m_numCTUInHeight-1)
+    {
+      ::memcpy(m_ctuLineBelow[compIdx]+ ctuRow*(planeWidth+2), picBuf+ yEnd*stride- 1, sizeof(Pel)*(planeWidth+2));
+    }
+
+    //columns left and right of each CTU column, only the part covered by this CTU row
+    for(Int ctuCol= 0; ctuCol < m_numCTUInWidth; ctuCol++)
+    {
+      Int  xLeft    = ctuCol*ctuWidth- 1;
+      Int  xRight   = (ctuCol+1)*ctuWidth;
+      Pel* colLeft  = m_ctuColLeft [compIdx]+ ctuCol*planeHeight;
+      Pel* colRight = m_ctuColRight[compIdx]+ ctuCol*planeHeight;
+      for(Int y= yStart; y< yEnd; y++)
+      {
+        if(ctuCol > 0)
+        {
+          colLeft[y] = picBuf[y*stride+ xLeft];
+        }
+        if(ctuCol < m_numCTUInWidth-1)
+        {
+          colRight[y] = picBuf[y*stride+ xRight];
+        }
+      }
+    }
+  }
+}
+
+/** assemble line y (-1..blkHeight) of a CTU block and its left/right neighbours from the unmodified samples
+ * \param dstLine destination, valid from index -1 to blkWidth
+ */
+Void TComSampleAdaptiveOffset::loadCTULine(Int compIdx, Int ctuX, Int ctuY, Int y, Pel* recBlk, Int recStride, Int blkXPos, Int blkYPos, Int blkWidth, Int blkHeight, Pel* dstLine)
+{
+  Int formatShift = (compIdx == SAO_Y)?0:1;
+  Int planeWidth  = m_picWidth  >> formatShift;
+  Int planeHeight = m_picHeight >> formatShift;
+
+  if(y < 0)
+  {
+    if(ctuY > 0)
+    {
+      ::memcpy(dstLine- 1, m_ctuLineAbove[compIdx]+ ctuY*(planeWidth+2)+ blkXPos, sizeof(Pel)*(blkWidth+2));
+    }
+  }
+  else if(y >= blkHeight)
+  {
+    if(ctuY < m_numCTUInHeight-1)
+    {
+      ::memcpy(dstLine- 1, m_ctuLineBelow[compIdx]+ ctuY*(planeWidth+2)+ blkXPos, sizeof(Pel)*(blkWidth+2));
+    }
+  }
+  else
+  {
+    ::memcpy(dstLine, recBlk+ y*recStride, sizeof(Pel)*blkWidth);
+    if(ctuX > 0)
+    {
+      dstLine[-1] = m_ctuColLeft[compIdx][ctuX*planeHeight+ blkYPos+ y];
+    }
+    if(ctuX < m_numCTUInWidth-1)
+    {
+      dstLine[blkWidth] = m_ctuColRight[compIdx][ctuX*planeHeight+ blkYPos+ y];
+    }
+  }
+}
+
+/** apply SAO to one CTU of the deblocked picture in place
+ * \note Samples of neighbouring CTUs are taken from the lines saved by saveBoundaryLines(), so CTUs can be processed concurrently.
+ */
+Void TComSampleAdaptiveOffset::offsetCTUInPlace(Int ctu, Int threadIdx, TComPic* pPic)
+{
+  SAOBlkParam& saoblkParam = (pPic->getPicSym()->getSAOBlkParam())[ctu];
+  Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
+
+  if( 
+    (saoblkParam[SAO_Y ].modeIdc == SAO_MODE_OFF) &&
+    (saoblkParam[SAO_Cb].modeIdc == SAO_MODE_OFF) &&
+    (saoblkParam[SAO_Cr].modeIdc == SAO_MODE_OFF)
+    )
+  {
+    return;
+  }
+
+  //block boundary availability
+  pPic->getPicSym()->deriveLoopFilterBoundaryAvailibility(ctu, isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail);
+
+  TComPicYuv* recYuv = pPic->getPicYuvRec();
+  Int ctuY   = ctu / m_numCTUInWidth;
+  Int ctuX   = ctu % m_numCTUInWidth;
+  Int yPos   = ctuY*m_maxCUHeight;
+  Int xPos   = ctuX*m_maxCUWidth;
+  Int height = (yPos + m_maxCUHeight > m_picHeight)?(m_picHeight- yPos):m_maxCUHeight;
+  Int width  = (xPos + m_maxCUWidth  > m_picWidth )?(m_picWidth - xPos):m_maxCUWidth;
+
+  //rolling buffer of the unmodified lines y-1, y and y+1
+  Pel* lineBuf[3];
+  for(Int i=0; i< 3; i++)
+  {
+    lineBuf[i] = m_threadLineBuf+ (threadIdx*3 + i)*(m_maxCUWidth+2) + 1;
+  }
+
+  for(Int compIdx= 0; compIdx < NUM_SAO_COMPONENTS; compIdx++)
+  {
+    SAOOffset& ctbOffset = saoblkParam[compIdx];
+
+    if(ctbOffset.modeIdc == SAO_MODE_OFF)
+    {
+      continue;
+    }
+
+    Bool isLuma     = (compIdx == SAO_Y);
+    Int  formatShift= isLuma?0:1;
+    Int  blkWidth   = (width  >> formatShift);
+    Int  blkHeight  = (height >> formatShift);
+    Int  blkYPos    = (yPos   >> formatShift);
+    Int  blkXPos    = (xPos   >> formatShift);
+    Int  recStride  = isLuma?recYuv->getStride():recYuv->getCStride();
+    Pel* recBlk     = getPicBuf(recYuv, compIdx)+ blkYPos*recStride+ blkXPos;
+    Int  startX, endX;
+
+    if(ctbOffset.typeIdc == SAO_TYPE_BO)
+    {
+      //no neighbouring samples are involved
+      for(Int y= 0; y< blkHeight; y++)
+      {
+        offsetLine(compIdx, SAO_TYPE_BO, ctbOffset.offset, recBlk+ y*recStride, NULL, NULL, recBlk+ y*recStride, 0, blkWidth);
+      }
+      continue;
+    }
+
+    Pel* lineAbove = lineBuf[0];
+    Pel* lineCur   = lineBuf[1];
+    Pel* lineBelow = lineBuf[2];
+    loadCTULine(compIdx, ctuX, ctuY, -1, recBlk, recStride, blkXPos, blkYPos, blkWidth, blkHeight, lineAbove);
+    loadCTULine(compIdx, ctuX, ctuY,  0, recBlk, recStride, blkXPos, blkYPos, blkWidth, blkHeight, lineCur);
+
+    for(Int y= 0; y< blkHeight; y++)
+    {
+      loadCTULine(compIdx, ctuX, ctuY, y+1, recBlk, recStride, blkXPos, blkYPos, blkWidth, blkHeight, lineBelow);
+
+      getLineRange(ctbOffset.typeIdc, y, blkWidth, blkHeight, isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail, startX, endX);
+      if(startX < endX)
+      {
+        offsetLine(compIdx, ctbOffset.typeIdc, ctbOffset.offset, lineCur, lineAbove, lineBelow, recBlk+ y*recStride, startX, endX);
+      }
+
+      Pel* lineTmp = lineAbove;
+      lineAbove = lineCur;
+      lineCur   = lineBelow;
+      lineBelow = lineTmp;
+    }
+  } //compIdx
+}
+
+Void TComSampleAdaptiveOffset::runItem(Int itemIdx, Int threadIdx)
+{
+  switch(m_parallelStage)
+  {
+  case SAO_STAGE_SAVE_LINES:
+    {
+      saveBoundaryLines(itemIdx, m_pcParallelPic->getPicYuvRec());
+    }
+    break;
+  case SAO_STAGE_OFFSET_CTU:
+    {
+      offsetCTUInPlace(itemIdx, threadIdx, m_pcParallelPic);
+    }
+    break;
+  default:
+    {
+      printf("Not a supported SAO processing stage\n");
+      assert(0);
+      exit(-1);
+    }
+  }
+}
+
+/** run one stage over items [0, numItems), on the worker threads if a thread pool is attached
+ */
+Void TComSampleAdaptiveOffset::runParallelStage(Int stage, Int numItems)
+{
+  m_parallelStage = stage;
+  if(m_pcThreadPool != NULL)
+  {
+    m_pcThreadPool->parallelFor(this, numItems);
+  }
+  else
+  {
+    for(Int i= 0; i< numItems; i++)
+    {
+      runItem(i, 0);
+    }
+  }
+}
+
 Void TComSampleAdaptiveOffset::SAOProcess(TComPic* pDecPic)
 {
   if(!m_picSAOEnabled[SAO_Y] && !m_picSAOEnabled[SAO_Cb] && !m_picSAOEnabled[SAO_Cr])
   {
     return;
   }
-  TComPicYuv* resYuv = pDecPic->getPicYuvRec();
-  TComPicYuv* srcYuv = m_tempPicYuv;
-  resYuv->copyToPic(srcYuv);
-  for(Int ctu= 0; ctu < m_numCTUsPic; ctu++)
+
+  Int numThreads = (m_pcThreadPool != NULL)?m_pcThreadPool->getNumThreads():1;
+  if(m_numThreadLineBufs < numThreads)
   {
-    offsetCTU(ctu, srcYuv, resYuv, (pDecPic->getPicSym()->getSAOBlkParam())[ctu], pDecPic);
-  } //ctu
+    if (m_threadLineBuf) delete[] m_threadLineBuf;
+    m_threadLineBuf = new Pel[numThreads*3*(m_maxCUWidth+2)];
+    m_numThreadLineBufs = numThreads;
+  }
+
+  m_pcParallelPic = pDecPic;
+  runParallelStage(SAO_STAGE_SAVE_LINES, m_numCTUInHeight);
+  runParallelStage(SAO_STAGE_OFFSET_CTU, m_numCTUsPic);
+  m_pcParallelPic = NULL;
 }
 
 
@@ -674,20 +934,30 @@ Pel* TComSampleAdaptiveOffset::getPicBuf(TComPicYuv* pPicYuv, Int compIdx)
  */
 Void TComSampleAdaptiveOffset::PCMLFDisableProcess (TComPic* pcPic)
 {
-  xPCMRestoration(pcPic);
+  xPCMRestoration(pcPic, 0, pcPic->getNumCUsInFrame());
+}
+
+/** PCM restoration of the CUs of one CTU row
+ * \param pcPic   picture (TComPic) pointer
+ * \param ctuRow  CTU row index
+ */
+Void TComSampleAdaptiveOffset::PCMLFDisableProcessCtuRow (TComPic* pcPic, Int ctuRow)
+{
+  UInt uiStartCUAddr = ctuRow * pcPic->getFrameWidthInCU();
+  xPCMRestoration(pcPic, uiStartCUAddr, min(uiStartCUAddr + pcPic->getFrameWidthInCU(), pcPic->getNumCUsInFrame()));
 }
 
-/** Picture-level PCM restoration. 
+/** PCM restoration of the CUs [uiStartCUAddr, uiEndCUAddr). 
  * \param pcPic picture (TComPic) pointer
  * \returns Void
  */
-Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic)
+Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic, UInt uiStartCUAddr, UInt uiEndCUAddr)
 {
   Bool  bPCMFilter = (pcPic->getSlice(0)->getSPS()->getUsePCM() && pcPic->getSlice(0)->getSPS()->getPCMFilterDisableFlag())? true : false;
 
   if(bPCMFilter || pcPic->getSlice(0)->getPPS()->getTransquantBypassEnableFlag())
   {
-    for( UInt uiCUAddr = 0; uiCUAddr < pcPic->getNumCUsInFrame() ; uiCUAddr++ )
+    for( UInt uiCUAddr = uiStartCUAddr; uiCUAddr < uiEndCUAddr ; uiCUAddr++ )
     {
       TComDataCU* pcCU = pcPic->getCU(uiCUAddr);
 
@@ -40,6 +40,7 @@
 
 #include "CommonDef.h"
 #include "TComPic.h"
+#include "TComThreadPool.h"
 
 //! \ingroup TLibCommon
 //! \{
@@ -59,7 +60,7 @@ template <typename T> int sgn(T val)
   return (T(0) < val) - (val < T(0));
 }
 
-class TComSampleAdaptiveOffset
+class TComSampleAdaptiveOffset : public TComParallelJob
 {
 public:
   TComSampleAdaptiveOffset();
@@ -69,21 +70,39 @@ public:
   Void destroy();
   Void reconstructBlkSAOParams(TComPic* pic, SAOBlkParam* saoBlkParams);
   Void PCMLFDisableProcess (TComPic* pcPic);
+  Void PCMLFDisableProcessCtuRow (TComPic* pcPic, Int ctuRow);
+  Void setThreadPool(TComThreadPool* pcThreadPool) { m_pcThreadPool = pcThreadPool; }
+  virtual Void runItem(Int itemIdx, Int threadIdx);
 protected:
+  /// CTU-parallel stages dispatched through runItem()
+  enum ParallelStage
+  {
+    SAO_STAGE_SAVE_LINES = 0, ///< item = CTU row, back up the deblocked samples around the CTU boundaries
+    SAO_STAGE_OFFSET_CTU,     ///< item = CTU, apply the offsets in place
+    NUM_SAO_BASE_STAGES
+  };
   Void offsetBlock(Int compIdx, Int typeIdx, Int* offset, Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
                   , Bool isLeftAvail, Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail);
+  Void offsetLine(Int compIdx, Int typeIdx, Int* offset, Pel* srcLine, Pel* srcLineAbove, Pel* srcLineBelow, Pel* resLine, Int startX, Int endX);
+  Void getLineRange(Int typeIdx, Int y, Int width, Int height
+                  , Bool isLeftAvail, Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                  , Int& startX, Int& endX);
   Pel* getPicBuf(TComPicYuv* pPicYuv, Int compIdx);
   Void invertQuantOffsets(Int compIdx, Int typeIdc, Int typeAuxInfo, Int* dstOffsets, Int* srcOffsets);
   Void reconstructBlkSAOParam(SAOBlkParam& recParam, std::vector<SAOBlkParam*>& mergeList);
   Int  getMergeList(TComPic* pic, Int ctu, SAOBlkParam* blkParams, std::vector<SAOBlkParam*>& mergeList);
   Void offsetCTU(Int ctu, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic);
-  Void xPCMRestoration(TComPic* pcPic);
+  Void offsetCTUInPlace(Int ctu, Int threadIdx, TComPic* pPic);
+  Void saveBoundaryLines(Int ctuRow, TComPicYuv* recYuv);
+  Void loadCTULine(Int compIdx, Int ctuX, Int ctuY, Int y, Pel* recBlk, Int recStride, Int blkXPos, Int blkYPos, Int blkWidth, Int blkHeight, Pel* dstLine);
+  Void runParallelStage(Int stage, Int numItems);
+  Void xPCMRestoration(TComPic* pcPic, UInt uiStartCUAddr, UInt uiEndCUAddr);
   Void xPCMCURestoration ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth );
   Void xPCMSampleRestoration (TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, TextType ttText);
 protected:
   UInt m_offsetStepLog2[NUM_SAO_COMPONENTS]; //offset step  
   Int* m_offsetClip[NUM_SAO_COMPONENTS]; //clip table for fast operation
-  TComPicYuv*   m_tempPicYuv; //temporary buffer
+  TComPicYuv*   m_tempPicYuv; //temporary buffer (encoder only)
   Int m_picWidth;
   Int m_picHeight;
   Int m_maxCUWidth;
@@ -91,11 +110,17 @@ protected:
   Int m_numCTUInWidth;
   Int m_numCTUInHeight;
   Int m_numCTUsPic;
-  
-  
-  Int m_lineBufWidth;
-  Char* m_signLineBuf1;
-  Char* m_signLineBuf2;
+
+  //CTU-parallel processing
+  TComThreadPool* m_pcThreadPool;
+  Int             m_parallelStage;
+  TComPic*        m_pcParallelPic;  //picture processed by the current parallel stage
+  Pel*  m_ctuLineAbove[NUM_SAO_COMPONENTS]; //[ctuRow][-1..planeWidth] deblocked line above each CTU row
+  Pel*  m_ctuLineBelow[NUM_SAO_COMPONENTS]; //[ctuRow][-1..planeWidth] deblocked line below each CTU row
+  Pel*  m_ctuColLeft  [NUM_SAO_COMPONENTS]; //[ctuCol][planeHeight]    deblocked column left of each CTU column
+  Pel*  m_ctuColRight [NUM_SAO_COMPONENTS]; //[ctuCol][planeHeight]    deblocked column right of each CTU column
+  Pel*  m_threadLineBuf;                    //[thread][3][-1..maxCUWidth] rolling source lines of offsetCTUInPlace()
+  Int   m_numThreadLineBufs;
 private:
   Bool m_picSAOEnabled[NUM_SAO_COMPONENTS];
   Int*   m_offsetClipTable[NUM_SAO_COMPONENTS];
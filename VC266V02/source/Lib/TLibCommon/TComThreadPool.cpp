@@ -0,0 +1,342 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2014, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.cpp
+    \brief    worker thread pool used for CTU-parallel processing
+*/
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600   // condition variables need Vista or later
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <assert.h>
+#include "TComThreadPool.h"
+
+//! \ingroup TLibCommon
+//! \{
+
+struct TComWorkerParam
+{
+  TComThreadPool* pcPool;
+  Int             threadIdx;
+};
+
+/// platform dependent synchronisation objects, kept out of the header
+struct TComThreadPoolSync
+{
+#ifdef _WIN32
+  CRITICAL_SECTION    lock;
+  CONDITION_VARIABLE  workAvail;
+  CONDITION_VARIABLE  workDone;
+  Void  init()      { InitializeCriticalSection( &lock ); InitializeConditionVariable( &workAvail ); InitializeConditionVariable( &workDone ); }
+  Void  uninit()    { DeleteCriticalSection( &lock ); }
+  Void  enter()     { EnterCriticalSection( &lock ); }
+  Void  leave()     { LeaveCriticalSection( &lock ); }
+  Void  waitWork()  { SleepConditionVariableCS( &workAvail, &lock, INFINITE ); }
+  Void  waitDone()  { SleepConditionVariableCS( &workDone, &lock, INFINITE ); }
+  Void  wakeWork()  { WakeAllConditionVariable( &workAvail ); }
+  Void  wakeDone()  { WakeAllConditionVariable( &workDone ); }
+#else
+  pthread_mutex_t     lock;
+  pthread_cond_t      workAvail;
+  pthread_cond_t      workDone;
+  Void  init()      { pthread_mutex_init( &lock, NULL ); pthread_cond_init( &workAvail, NULL ); pthread_cond_init( &workDone, NULL ); }
+  Void  uninit()    { pthread_cond_destroy( &workDone ); pthread_cond_destroy( &workAvail ); pthread_mutex_destroy( &lock ); }
+  Void  enter()     { pthread_mutex_lock( &lock ); }
+  Void  leave()     { pthread_mutex_unlock( &lock ); }
+  Void  waitWork()  { pthread_cond_wait( &workAvail, &lock ); }
+  Void  waitDone()  { pthread_cond_wait( &workDone, &lock ); }
+  Void  wakeWork()  { pthread_cond_broadcast( &workAvail ); }
+  Void  wakeDone()  { pthread_cond_broadcast( &workDone ); }
+#endif
+  std::vector<TComWorkerParam> params;
+};
+
+// ====================================================================================================================
+// Constructor / destructor / create / destroy
+// ====================================================================================================================
+
+TComThreadPool::TComThreadPool()
+: m_numThreads   ( 1 )
+, m_pcSync       ( NULL )
+, m_bTerminate   ( false )
+, m_pcJob        ( NULL )
+, m_numItems     ( 0 )
+, m_nextItem     ( 0 )
+, m_numItemsDone ( 0 )
+{
+}
+
+TComThreadPool::~TComThreadPool()
+{
+  destroy();
+}
+
+/** create the pool
+ * \param numThreads total number of threads including the calling one; values below 2 disable the workers
+ */
+Void TComThreadPool::create( Int numThreads )
+{
+  destroy();
+
+  m_numThreads = numThreads > 1 ? numThreads : 1;
+  if ( m_numThreads == 1 )
+  {
+    return;
+  }
+
+  m_pcSync = new TComThreadPoolSync;
+  m_pcSync->init();
+  m_bTerminate = false;
+
+  m_pcSync->params.resize( m_numThreads );
+  m_threads.resize( m_numThreads, NULL );
+  for ( Int i = 1; i < m_numThreads; i++ )
+  {
+    m_pcSync->params[i].pcPool    = this;
+    m_pcSync->params[i].threadIdx = i;
+#ifdef _WIN32
+    m_threads[i] = CreateThread( NULL, 0, xThreadEntry, &m_pcSync->params[i], 0, NULL );
+#else
+    pthread_t* pThread = new pthread_t;
+    pthread_create( pThread, NULL, xThreadEntry, &m_pcSync->params[i] );
+    m_threads[i] = pThread;
+#endif
+  }
+}
+
+Void TComThreadPool::destroy()
+{
+  if ( m_pcSync )
+  {
+    m_pcSync->enter();
+    m_bTerminate = true;
+    m_pcSync->wakeWork();
+    m_pcSync->leave();
+
+    for ( Int i = 1; i < (Int)m_threads.size(); i++ )
+    {
+#ifdef _WIN32
+      WaitForSingleObject( (HANDLE)m_threads[i], INFINITE );
+      CloseHandle( (HANDLE)m_threads[i] );
+#else
+      pthread_t* pThread = (pthread_t*)m_threads[i];
+      pthread_join( *pThread, NULL );
+      delete pThread;
+#endif
+    }
+    m_threads.clear();
+
+    m_pcSync->uninit();
+    delete m_pcSync;
+    m_pcSync = NULL;
+  }
+  m_numThreads = 1;
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+Void TComThreadPool::parallelFor( TComParallelJob* pcJob, Int numItems )
+{
+  if ( m_numThreads == 1 || numItems < 2 )
+  {
+    for ( Int i = 0; i < numItems; i++ )
+    {
+      pcJob->runItem( i, 0 );
+    }
+    return;
+  }
+
+  startJob( pcJob, numItems );
+
+  while ( xRunNextItem( 0 ) )
+  {
+  }
+
+  waitJob();
+}
+
+Void TComThreadPool::startJob( TComParallelJob* pcJob, Int numItems )
+{
+  if ( m_numThreads == 1 )
+  {
+    for ( Int i = 0; i < numItems; i++ )
+    {
+      pcJob->runItem( i, 0 );
+    }
+    return;
+  }
+
+  m_pcSync->enter();
+  assert( m_pcJob == NULL ); // only one batch can be in flight
+  m_pcJob        = pcJob;
+  m_numItems     = numItems;
+  m_nextItem     = 0;
+  m_numItemsDone = 0;
+  m_pcSync->wakeWork();
+  m_pcSync->leave();
+}
+
+Void TComThreadPool::waitJob()
+{
+  if ( m_pcSync == NULL )
+  {
+    return;
+  }
+
+  m_pcSync->enter();
+  while ( m_pcJob != NULL && m_numItemsDone < m_numItems )
+  {
+    m_pcSync->waitDone();
+  }
+  m_pcJob = NULL;
+  m_pcSync->leave();
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+/** fetch and run one item of the current batch
+ * \returns false if no item was left
+ */
+Bool TComThreadPool::xRunNextItem( Int threadIdx )
+{
+  m_pcSync->enter();
+  if ( m_pcJob == NULL || m_nextItem >= m_numItems )
+  {
+    m_pcSync->leave();
+    return false;
+  }
+  Int itemIdx = m_nextItem++;
+  TComParallelJob* pcJob = m_pcJob;
+  m_pcSync->leave();
+
+  pcJob->runItem( itemIdx, threadIdx );
+
+  m_pcSync->enter();
+  if ( ++m_numItemsDone == m_numItems )
+  {
+    m_pcSync->wakeDone();
+  }
+  m_pcSync->leave();
+  return true;
+}
+
+Void TComThreadPool::xWorkerLoop( Int threadIdx )
+{
+  for (;;)
+  {
+    m_pcSync->enter();
+    while ( !m_bTerminate && ( m_pcJob == NULL || m_nextItem >= m_numItems ) )
+    {
+      m_pcSync->waitWork();
+    }
+    Bool bTerminate = m_bTerminate;
+    m_pcSync->leave();
+
+    if ( bTerminate )
+    {
+      return;
+    }
+    while ( xRunNextItem( threadIdx ) )
+    {
+    }
+  }
+}
+
+#ifdef _WIN32
+unsigned long __stdcall TComThreadPool::xThreadEntry( Void* param )
+#else
+Void* TComThreadPool::xThreadEntry( Void* param )
+#endif
+{
+  TComWorkerParam* pcParam = (TComWorkerParam*)param;
+  pcParam->pcPool->xWorkerLoop( pcParam->threadIdx );
+  return 0;
+}
+
+// ====================================================================================================================
+// TComProgressCounter
+// ====================================================================================================================
+
+TComProgressCounter::TComProgressCounter()
+: m_pcSync ( new TComThreadPoolSync )
+, m_iValue ( 0 )
+{
+  m_pcSync->init();
+}
+
+TComProgressCounter::~TComProgressCounter()
+{
+  m_pcSync->uninit();
+  delete m_pcSync;
+}
+
+Void TComProgressCounter::set( Int iValue )
+{
+  m_pcSync->enter();
+  m_iValue = iValue;
+  m_pcSync->wakeDone();
+  m_pcSync->leave();
+}
+
+Int TComProgressCounter::get()
+{
+  m_pcSync->enter();
+  Int iValue = m_iValue;
+  m_pcSync->leave();
+  return iValue;
+}
+
+Void TComProgressCounter::wait( Int iValue )
+{
+  m_pcSync->enter();
+  while ( m_iValue < iValue )
+  {
+    m_pcSync->waitDone();
+  }
+  m_pcSync->leave();
+}
+
+//! \}
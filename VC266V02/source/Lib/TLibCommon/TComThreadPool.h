@@ -0,0 +1,128 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2014, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComThreadPool.h
+    \brief    worker thread pool used for CTU-parallel processing (header)
+*/
+
+#ifndef __TCOMTHREADPOOL__
+#define __TCOMTHREADPOOL__
+
+#include "CommonDef.h"
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// work item that can be executed for a range of independent indices (e.g. CTUs or CTU rows)
+class TComParallelJob
+{
+public:
+  virtual ~TComParallelJob() {}
+
+  /// process item itemIdx; threadIdx identifies the executing thread (0 = calling thread) for per-thread scratch data
+  virtual Void runItem( Int itemIdx, Int threadIdx ) = 0;
+};
+
+struct TComThreadPoolSync;
+
+/// fixed-size pool of worker threads; the calling thread takes part in the work
+class TComThreadPool
+{
+public:
+  TComThreadPool();
+  virtual ~TComThreadPool();
+
+  Void  create        ( Int numThreads );
+  Void  destroy       ();
+
+  /// total number of threads taking part in parallelFor(), including the calling thread
+  Int   getNumThreads () { return m_numThreads; }
+
+  /// run pcJob->runItem() for all items in [0, numItems) and return when all of them are finished
+  Void  parallelFor   ( TComParallelJob* pcJob, Int numItems );
+
+  /// hand the items in [0, numItems) to the workers and return at once; runs them in place if there are no workers
+  Void  startJob      ( TComParallelJob* pcJob, Int numItems );
+  /// wait until the batch of the last startJob() call is finished
+  Void  waitJob       ();
+
+private:
+  Void  xWorkerLoop   ( Int threadIdx );
+  Bool  xRunNextItem  ( Int threadIdx );
+#ifdef _WIN32
+  static unsigned long __stdcall xThreadEntry( Void* param );
+#else
+  static Void*  xThreadEntry( Void* param );
+#endif
+
+  Int                   m_numThreads;
+  std::vector<Void*>    m_threads;        ///< platform thread handles of the workers
+  TComThreadPoolSync*   m_pcSync;         ///< platform lock and condition variables
+  Bool                  m_bTerminate;
+
+  // currently running parallelFor() batch
+  TComParallelJob*      m_pcJob;
+  Int                   m_numItems;
+  Int                   m_nextItem;
+  Int                   m_numItemsDone;
+};
+
+/// value published by one thread that other threads can block on until it reaches a given level
+class TComProgressCounter
+{
+public:
+  TComProgressCounter();
+  ~TComProgressCounter();
+
+  /// publish a new value and wake up the waiting threads
+  Void  set   ( Int iValue );
+  Int   get   ();
+  /// block until the published value is at least iValue
+  Void  wait  ( Int iValue );
+
+private:
+  TComProgressCounter( const TComProgressCounter& );
+  TComProgressCounter& operator= ( const TComProgressCounter& );
+
+  TComThreadPoolSync*   m_pcSync;
+  Int                   m_iValue;
+};
+
+//! \}
+
+#endif // __TCOMTHREADPOOL__
@@ -68,6 +68,8 @@
 
 #define ALLOW_RECOVERY_POINT_AS_RAP                   1
 
+#define ENABLE_SIMD_OPT                               1   ///< use SSE2 sample processing kernels on x86 targets (bit-exact with the C code)
+
 #define MAX_NESTING_NUM_OPS                           1024
 #define MAX_NESTING_NUM_LAYER                         64
 
@@ -118,6 +120,11 @@
 #define LOG2_SCAN_SET_SIZE                            4
 
 #define FAST_UDI_MAX_RDMODE_NUM                       35   ///< maximum number of RD comparison in fast-UDI estimation loop 
+#define FAST_INTRA_SEED_MODES                         3    ///< number of best modes of a PU passed on as seeds to its sub-blocks in the fast intra search
+#define FAST_INTRA_GRAD_MODES                         2    ///< number of dominant gradient directions used as seeds in the fast intra search
+#define FAST_CU_SPLIT_PARENT_RATIO                    1.0  ///< ratio to a quarter of the parent unsplit RD cost under which a CU is not split
+#define FAST_CU_SPLIT_COST_TH_INTRA                   0.5  ///< RD cost per sample in units of lambda under which an intra CU at the last splittable depth is not split
+#define FAST_CU_SPLIT_COST_TH_INTER                   0.15 ///< RD cost per sample in units of lambda under which an inter CU at the last splittable depth is not split
 
 #define NUM_INTRA_MODE                                36
 
@@ -42,6 +42,7 @@
 #include "TLibCommon/TComSlice.h"
 #include "SyntaxElementParser.h"
 #include "SEIread.h"
+#include "TDecSlice.h"
 
 //! \ingroup TLibDecoder
 //! \{
@@ -68,6 +69,12 @@ Void  xTraceSEIMessageType(SEI::PayloadType payloadType)
   case SEI::RECOVERY_POINT:
     fprintf( g_hTrace, "=========== Recovery point SEI message ===========\n");
     break;
+  case SEI::BUFFERING_PERIOD:
+    fprintf( g_hTrace, "=========== Buffering period SEI message ===========\n");
+    break;
+  case SEI::PICTURE_TIMING:
+    fprintf( g_hTrace, "=========== Picture timing SEI message ===========\n");
+    break;
   case SEI::TEMPORAL_LEVEL0_INDEX:
     fprintf( g_hTrace, "=========== Temporal Level Zero Index SEI message ===========\n");
     break;
@@ -84,14 +91,14 @@ Void  xTraceSEIMessageType(SEI::PayloadType payloadType)
 /**
  * unmarshal a single SEI message from bitstream bs
  */
-void SEIReader::parseSEImessage(TComInputBitstream* bs, SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps)
+void SEIReader::parseSEImessage(TComInputBitstream* bs, SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager)
 {
   setBitstream(bs);
 
   assert(!m_pcBitstream->getNumBitsUntilByteAligned());
   do
   {
-    xReadSEImessage(seis, nalUnitType, sps);
+    xReadSEImessage(seis, nalUnitType, sps, parameterSetManager);
     /* SEI messages are an integer number of bytes, something has failed
     * in the parsing if bitstream not byte-aligned */
     assert(!m_pcBitstream->getNumBitsUntilByteAligned());
@@ -102,7 +109,7 @@ void SEIReader::parseSEImessage(TComInputBitstream* bs, SEIMessages& seis, const
   assert(rbspTrailingBits == 0x80);
 }
 
-Void SEIReader::xReadSEImessage(SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps)
+Void SEIReader::xReadSEImessage(SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager)
 {
 #if ENC_DEC_TRACE
   xTraceSEIHeader();
@@ -150,6 +157,24 @@ Void SEIReader::xReadSEImessage(SEIMessages& seis, const NalUnitType nalUnitType
       sei = new SEIRecoveryPoint;
       xParseSEIRecoveryPoint((SEIRecoveryPoint&) *sei, payloadSize);
       break;
+    case SEI::BUFFERING_PERIOD:
+      sei = new SEIBufferingPeriod;
+      if (!xParseSEIBufferingPeriod((SEIBufferingPeriod&) *sei, payloadSize, parameterSetManager))
+      {
+        printf ("Warning: Found Buffering period SEI message, but no HRD parameters are available. Ignoring.\n");
+        delete sei;
+        sei = NULL;
+      }
+      break;
+    case SEI::PICTURE_TIMING:
+      sei = new SEIPictureTiming;
+      if (!xParseSEIPictureTiming((SEIPictureTiming&) *sei, payloadSize, sps, parameterSetManager))
+      {
+        printf ("Warning: Found Picture timing SEI message, but no HRD parameters are available. Ignoring.\n");
+        delete sei;
+        sei = NULL;
+      }
+      break;
     default:
       for (UInt i = 0; i < payloadSize; i++)
       {
@@ -279,6 +304,20 @@ Void SEIReader::xParseSEIDecodedPictureHash(SEIDecodedPictureHash& sei, UInt /*p
         sei.digest[yuvIdx][i] = val;
       }
     }
+    else if(SEIDecodedPictureHash::CRC == sei.method)
+    {
+      READ_CODE(16, val, "picture_crc");
+      sei.digest[yuvIdx][0] = val >> 8 & 0xFF;
+      sei.digest[yuvIdx][1] = val & 0xFF;
+    }
+    else if(SEIDecodedPictureHash::CHECKSUM == sei.method)
+    {
+      READ_CODE(32, val, "picture_checksum");
+      sei.digest[yuvIdx][0] = (val>>24) & 0xff;
+      sei.digest[yuvIdx][1] = (val>>16) & 0xff;
+      sei.digest[yuvIdx][2] = (val>>8)  & 0xff;
+      sei.digest[yuvIdx][3] =  val      & 0xff;
+    }
   }
 }
 Void SEIReader::xParseSEIRecoveryPoint(SEIRecoveryPoint& sei, UInt /*payloadSize*/)
@@ -291,6 +330,136 @@ Void SEIReader::xParseSEIRecoveryPoint(SEIRecoveryPoint& sei, UInt /*payloadSize
   xParseByteAlign();
 }
 
+/**
+ * HRD parameters of the VPS referred to by SPS spsId, NULL if the VPS carries
+ * none. The parameter sets may not be active yet as the first buffering period
+ * precedes the first slice of the sequence.
+ */
+TComHRD* SEIReader::xGetHrdParameters(Int spsId, ParameterSetManagerDecoder *parameterSetManager)
+{
+  if (parameterSetManager == NULL || spsId < 0)
+  {
+    return NULL;
+  }
+  TComSPS *sps = parameterSetManager->getPrefetchedSPS(spsId);
+  TComVPS *vps = sps != NULL ? parameterSetManager->getPrefetchedVPS(sps->getVPSId()) : NULL;
+  if (vps == NULL || !vps->getTimingInfo()->getTimingInfoPresentFlag() || vps->getNumHrdParameters() == 0)
+  {
+    return NULL;
+  }
+  return vps->getHrdParameters(0);
+}
+
+/**
+ * parse a buffering period SEI message. Returns false, with the payload left
+ * to the caller, if the HRD parameters it refers to are not available.
+ */
+Bool SEIReader::xParseSEIBufferingPeriod(SEIBufferingPeriod& sei, UInt /*payloadSize*/, ParameterSetManagerDecoder *parameterSetManager)
+{
+  Int i, nalOrVcl;
+  UInt code;
+
+  READ_UVLC( code, "bp_seq_parameter_set_id" );                         sei.m_bpSeqParameterSetId     = code;
+  TComHRD *hrd = xGetHrdParameters(sei.m_bpSeqParameterSetId, parameterSetManager);
+  if (hrd == NULL)
+  {
+    return false;
+  }
+  m_bpSPSId = sei.m_bpSeqParameterSetId;
+
+  if( !hrd->getSubPicCpbParamsPresentFlag() )
+  {
+    READ_FLAG( code, "rap_cpb_params_present_flag" );                   sei.m_rapCpbParamsPresentFlag = code;
+  }
+  if( sei.m_rapCpbParamsPresentFlag )
+  {
+    READ_CODE( hrd->getCpbRemovalDelayLengthMinus1() + 1, code, "cpb_delay_offset" );      sei.m_cpbDelayOffset = code;
+    READ_CODE( hrd->getDpbOutputDelayLengthMinus1()  + 1, code, "dpb_delay_offset" );      sei.m_dpbDelayOffset = code;
+  }
+  READ_FLAG( code, "concatenation_flag");                               sei.m_concatenationFlag = code;
+  READ_CODE( hrd->getCpbRemovalDelayLengthMinus1() + 1, code, "au_cpb_removal_delay_delta_minus1" );
+  sei.m_auCpbRemovalDelayDelta = code + 1;
+  for( nalOrVcl = 0; nalOrVcl < 2; nalOrVcl ++ )
+  {
+    if( ( ( nalOrVcl == 0 ) && ( hrd->getNalHrdParametersPresentFlag() ) ) ||
+        ( ( nalOrVcl == 1 ) && ( hrd->getVclHrdParametersPresentFlag() ) ) )
+    {
+      for( i = 0; i < ( hrd->getCpbCntMinus1( 0 ) + 1 ); i ++ )
+      {
+        READ_CODE( hrd->getInitialCpbRemovalDelayLengthMinus1() + 1, code, "initial_cpb_removal_delay" );
+        sei.m_initialCpbRemovalDelay[i][nalOrVcl] = code;
+        READ_CODE( hrd->getInitialCpbRemovalDelayLengthMinus1() + 1, code, "initial_cpb_removal_delay_offset" );
+        sei.m_initialCpbRemovalDelayOffset[i][nalOrVcl] = code;
+        if( hrd->getSubPicCpbParamsPresentFlag() || sei.m_rapCpbParamsPresentFlag )
+        {
+          READ_CODE( hrd->getInitialCpbRemovalDelayLengthMinus1() + 1, code, "initial_alt_cpb_removal_delay" );
+          sei.m_initialAltCpbRemovalDelay[i][nalOrVcl] = code;
+          READ_CODE( hrd->getInitialCpbRemovalDelayLengthMinus1() + 1, code, "initial_alt_cpb_removal_delay_offset" );
+          sei.m_initialAltCpbRemovalDelayOffset[i][nalOrVcl] = code;
+        }
+      }
+    }
+  }
+  xParseByteAlign();
+  return true;
+}
+
+/**
+ * parse a picture timing SEI message against the HRD of the last buffering
+ * period, or of the active SPS if no buffering period was seen.
+ */
+Bool SEIReader::xParseSEIPictureTiming(SEIPictureTiming& sei, UInt /*payloadSize*/, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager)
+{
+  UInt i;
+  UInt code;
+
+  TComHRD *hrd = xGetHrdParameters(m_bpSPSId >= 0 ? m_bpSPSId : ( sps != NULL ? sps->getSPSId() : -1 ), parameterSetManager);
+  if (hrd == NULL)
+  {
+    return false;
+  }
+
+  if( hrd->getCpbDpbDelaysPresentFlag() )
+  {
+    READ_CODE( hrd->getCpbRemovalDelayLengthMinus1() + 1, code, "au_cpb_removal_delay_minus1" );
+    sei.m_auCpbRemovalDelay = code + 1;
+    READ_CODE( hrd->getDpbOutputDelayLengthMinus1() + 1, code, "pic_dpb_output_delay" );
+    sei.m_picDpbOutputDelay = code;
+    if( hrd->getSubPicCpbParamsPresentFlag() )
+    {
+      READ_CODE( hrd->getDpbOutputDelayDuLengthMinus1() + 1, code, "pic_dpb_output_du_delay" );
+      sei.m_picDpbOutputDuDelay = code;
+    }
+    if( hrd->getSubPicCpbParamsPresentFlag() && hrd->getSubPicCpbParamsInPicTimingSEIFlag() )
+    {
+      READ_UVLC( code, "num_decoding_units_minus1" );
+      sei.m_numDecodingUnitsMinus1 = code;
+      READ_FLAG( code, "du_common_cpb_removal_delay_flag" );
+      sei.m_duCommonCpbRemovalDelayFlag = code;
+      if( sei.m_duCommonCpbRemovalDelayFlag )
+      {
+        READ_CODE( hrd->getDuCpbRemovalDelayLengthMinus1() + 1, code, "du_common_cpb_removal_delay_minus1" );
+        sei.m_duCommonCpbRemovalDelayMinus1 = code;
+      }
+      sei.m_numNalusInDuMinus1      = new UInt[ sei.m_numDecodingUnitsMinus1 + 1 ];
+      sei.m_duCpbRemovalDelayMinus1 = new UInt[ sei.m_numDecodingUnitsMinus1 + 1 ];
+      for( i = 0; i <= sei.m_numDecodingUnitsMinus1; i ++ )
+      {
+        READ_UVLC( code, "num_nalus_in_du_minus1" );
+        sei.m_numNalusInDuMinus1[ i ] = code;
+        sei.m_duCpbRemovalDelayMinus1[ i ] = 0;
+        if( ( !sei.m_duCommonCpbRemovalDelayFlag ) && ( i < sei.m_numDecodingUnitsMinus1 ) )
+        {
+          READ_CODE( hrd->getDuCpbRemovalDelayLengthMinus1() + 1, code, "du_cpb_removal_delay_minus1" );
+          sei.m_duCpbRemovalDelayMinus1[ i ] = code;
+        }
+      }
+    }
+  }
+  xParseByteAlign();
+  return true;
+}
+
 Void SEIReader::xParseByteAlign()
 {
   UInt code;
@@ -48,20 +48,27 @@
 
 #include "TLibCommon/SEI.h"
 class TComInputBitstream;
+class TComHRD;
+class ParameterSetManagerDecoder;
 
 
 class SEIReader: public SyntaxElementParser
 {
 public:
-  SEIReader() {};
+  SEIReader() : m_bpSPSId(-1) {};
   virtual ~SEIReader() {};
-  Void parseSEImessage(TComInputBitstream* bs, SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps);
+  Void parseSEImessage(TComInputBitstream* bs, SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager = NULL);
 protected:
-  Void xReadSEImessage                (SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps);
+  Void xReadSEImessage                (SEIMessages& seis, const NalUnitType nalUnitType, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager);
   Void xParseSEIuserDataUnregistered  (SEIuserDataUnregistered &sei, UInt payloadSize);
   Void xParseSEIDecodedPictureHash    (SEIDecodedPictureHash& sei, UInt payloadSize);
   Void xParseSEIRecoveryPoint         (SEIRecoveryPoint& sei, UInt payloadSize);
+  Bool xParseSEIBufferingPeriod       (SEIBufferingPeriod& sei, UInt payloadSize, ParameterSetManagerDecoder *parameterSetManager);
+  Bool xParseSEIPictureTiming         (SEIPictureTiming& sei, UInt payloadSize, TComSPS *sps, ParameterSetManagerDecoder *parameterSetManager);
+  TComHRD* xGetHrdParameters          (Int spsId, ParameterSetManagerDecoder *parameterSetManager);
   Void xParseByteAlign();
+
+  Int  m_bpSPSId;                     ///< SPS of the last buffering period, the picture timing refers to its HRD
 };
 
 
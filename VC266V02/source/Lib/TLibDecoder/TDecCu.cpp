@@ -391,9 +391,38 @@ Void TDecCu::xDecompressCU( TComDataCU* pcCU, UInt uiAbsPartIdx,  UInt uiDepth )
   xCopyToPic( m_ppcCU[uiDepth], pcPic, uiAbsPartIdx, uiDepth );
 }
 
+/** wait until the reference pictures used by an inter CU are final
+ *
+ * The filter stage publishes whole pictures, so only the reference pictures the prediction units actually use are
+ * waited for.
+ */
+Void TDecCu::xWaitForReferencePics( TComDataCU* pcCU )
+{
+  UInt uiPartAddr;
+  Int  iWidth, iHeight;
+
+  for ( Int iPartIdx = 0; iPartIdx < pcCU->getNumPartitions(); iPartIdx++ )
+  {
+    pcCU->getPartIndexAndSize( iPartIdx, uiPartAddr, iWidth, iHeight );
+
+    for ( Int iRefList = 0; iRefList < 2; iRefList++ )
+    {
+      RefPicList eRefPicList = RefPicList( iRefList );
+      Int        iRefIdx     = pcCU->getCUMvField( eRefPicList )->getRefIdx( uiPartAddr );
+      if ( iRefIdx >= 0 )
+      {
+        pcCU->getSlice()->getRefPic( eRefPicList, iRefIdx )->waitForFinished();
+      }
+    }
+  }
+}
+
 Void TDecCu::xReconInter( TComDataCU* pcCU, UInt uiDepth )
 {
   
+  // reference pictures may still be in the in-loop filter stage (frame-parallel decoding)
+  xWaitForReferencePics( pcCU );
+
   // inter prediction
   m_pcPrediction->motionCompensation( pcCU, m_ppcYuvReco[uiDepth] );
   
@@ -548,7 +577,7 @@ TDecCu::xIntraRecChromaBlk( TComDataCU* pcCU,
                                            m_pcPrediction->getPredicBufWidth  (),
                                            m_pcPrediction->getPredicBufHeight (),
                                            bAboveAvail, bLeftAvail );
-  Int* pPatChroma   = ( uiChromaId > 0 ? pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_pcPrediction->getPredicBuf() ) : pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_pcPrediction->getPredicBuf() ) );
+  Pel* pPatChroma   = ( uiChromaId > 0 ? pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_pcPrediction->getPredicBuf() ) : pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_pcPrediction->getPredicBuf() ) );
   
   //===== get prediction signal =====
   {
@@ -49,7 +49,7 @@ extern Bool g_md5_mismatch; ///< top level flag to signal when there is a decode
 
 //! \ingroup TLibDecoder
 //! \{
-static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash* pictureHashSEI);
+static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash* pictureHashSEI, TComThreadPool* pcThreadPool);
 // ====================================================================================================================
 // Constructor / destructor / initialization / destroy
 // ====================================================================================================================
@@ -57,6 +57,10 @@ static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash*
 TDecGop::TDecGop()
 {
   m_dDecTime = 0;
+  m_pcThreadPool = NULL;
+  m_pcFilterPic = NULL;
+  m_cFilterSliceType = 'I';
+  m_dFilterDecTime = 0;
   m_pcSbacDecoders = NULL;
   m_pcBinCABACs = NULL;
 }
@@ -74,6 +78,8 @@ Void TDecGop::create()
 
 Void TDecGop::destroy()
 {
+  waitForFilterStage();
+  m_cFilterThread.destroy();
 }
 
 Void TDecGop::init( TDecEntropy*            pcEntropyDecoder, 
@@ -148,9 +154,6 @@ Void TDecGop::decompressSlice(TComInputBitstream* pcBitstream, TComPic*& rpcPic)
       m_pcEntropyDecoder->setBitstream(ppcSubstreams[0]);
 #endif
       m_pcEntropyDecoder->resetEntropy(pcSlice);
-#if TSB_ALF_HEADER
-      m_pcAdaptiveLoopFilter->setNumCUsInFrame(rpcPic);
-#endif
       m_pcAdaptiveLoopFilter->allocALFParam(&m_cAlfParam);
       m_pcEntropyDecoder->decodeAlfParam(&m_cAlfParam);
 #if ALF_BITSTREAM
@@ -189,7 +192,58 @@ Void TDecGop::decompressSlice(TComInputBitstream* pcBitstream, TComPic*& rpcPic)
   m_dDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
 }
 
+/** hand a decoded picture to the filter stage
+ *
+ * Everything the filter stage needs from state that the decoding of the next picture changes (slice type
+ * character, decoding time, ALF parameters, picture marks) is taken here. In frame-parallel mode the stage runs
+ * on its own thread and the picture publishes its progress through TComPic::setMotionFinal() and
+ * TComPic::setFinished(); otherwise it has finished when this function returns.
+ */
 Void TDecGop::filterPicture(TComPic*& rpcPic)
+{
+  waitForFilterStage();
+
+  TComSlice*  pcSlice = rpcPic->getSlice(rpcPic->getCurrSliceIdx());
+
+  m_cFilterSliceType = (pcSlice->isIntra() ? 'I' : pcSlice->isInterP() ? 'P' : 'B');
+  if (!pcSlice->isReferenced()) m_cFilterSliceType += 32;
+  m_dFilterDecTime = m_dDecTime;
+  m_dDecTime       = 0;
+#if ALF_TEST_DECODER
+  m_cFilterAlfParam = m_cAlfParam;
+#endif
+
+  // every picture gets its margins in the filter stage, since a sub-layer non-reference picture can still be referenced
+  // by a higher temporal layer; the flag is set now so that the reference picture set handling of the next picture
+  // does not extend it concurrently
+  rpcPic->getPicYuvRec()->setBorderExtension(true);
+
+  rpcPic->setOutputMark(rpcPic->getSlice(0)->getPicOutputFlag() ? true : false);
+  rpcPic->setReconMark(true);
+
+  m_pcFilterPic = rpcPic;
+  m_cFilterThread.startJob( this, 1 );
+}
+
+Void TDecGop::setFrameParallel( Bool bFrameParallel )
+{
+  waitForFilterStage();
+  m_cFilterThread.create( bFrameParallel ? 2 : 1 );
+}
+
+/// wait until the picture handed to the filter stage, if any, is completely processed
+Void TDecGop::waitForFilterStage()
+{
+  m_cFilterThread.waitJob();
+  m_pcFilterPic = NULL;
+}
+
+Void TDecGop::runItem( Int itemIdx, Int threadIdx )
+{
+  xFilterPicture( m_pcFilterPic );
+}
+
+Void TDecGop::xFilterPicture(TComPic*& rpcPic)
 {
   TComSlice*  pcSlice = rpcPic->getSlice(rpcPic->getCurrSliceIdx());
 
@@ -232,6 +286,10 @@ Void TDecGop::filterPicture(TComPic*& rpcPic)
   m_pcLoopFilter->setCfg(bLFCrossTileBoundary);
   m_pcLoopFilter->loopFilterPic( rpcPic );
 
+  // the motion field is only read by the deblocking of this picture; compressed, it is the collocated motion of the next ones
+  rpcPic->compressMotion(); 
+  rpcPic->setMotionFinal(true);
+
   if( pcSlice->getSPS()->getUseSAO() )
   {
     m_pcSAO->reconstructBlkSAOParams(rpcPic, rpcPic->getPicSym()->getSAOBlkParam());
@@ -263,31 +321,32 @@ Void TDecGop::filterPicture(TComPic*& rpcPic)
       }
     }
 #endif
-    m_pcAdaptiveLoopFilter->ALFProcess(rpcPic, &m_cAlfParam);
+    m_pcAdaptiveLoopFilter->ALFProcess(rpcPic, &m_cFilterAlfParam);
 #if MTK_NONCROSS_INLOOP_FILTER
     if (m_pcAdaptiveLoopFilter->getUseNonCrossAlf())
     {
       m_pcAdaptiveLoopFilter->destroySlice();
     }
 #endif
-    m_pcAdaptiveLoopFilter->freeALFParam(&m_cAlfParam);
+    m_pcAdaptiveLoopFilter->freeALFParam(&m_cFilterAlfParam);
   }
 
 #endif
 
-  rpcPic->compressMotion(); 
-  Char c = (pcSlice->isIntra() ? 'I' : pcSlice->isInterP() ? 'P' : 'B');
-  if (!pcSlice->isReferenced()) c += 32;
+  // the picture gets its margins right away, spread over the CTU rows, instead of serially on first use
+  rpcPic->getPicYuvRec()->extendPicBorder( m_pcThreadPool );
+
+  // all filters work on the whole picture, so it is published at once
+  rpcPic->setFinished( true );
 
   //-- For time output for each slice
   printf("\nPOC %4d TId: %1d ( %c-SLICE, QP%3d ) ", pcSlice->getPOC(),
                                                     pcSlice->getTLayer(),
-                                                    c,
+                                                    m_cFilterSliceType,
                                                     pcSlice->getSliceQp() );
 
-  m_dDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
-  printf ("[DT %6.3f] ", m_dDecTime );
-  m_dDecTime  = 0;
+  m_dFilterDecTime += (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
+  printf ("[DT %6.3f] ", m_dFilterDecTime );
 
   for (Int iRefList = 0; iRefList < 2; iRefList++)
   {
@@ -306,12 +365,8 @@ Void TDecGop::filterPicture(TComPic*& rpcPic)
     {
       printf ("Warning: Got multiple decoded picture hash SEI messages. Using first.");
     }
-    calcAndPrintHashStatus(*rpcPic->getPicYuvRec(), hash);
+    calcAndPrintHashStatus(*rpcPic->getPicYuvRec(), hash, m_pcThreadPool);
   }
-
-  rpcPic->setOutputMark(rpcPic->getSlice(0)->getPicOutputFlag() ? true : false);
-  rpcPic->setReconMark(true);
-
 }
 
 /**
@@ -325,9 +380,9 @@ Void TDecGop::filterPicture(TComPic*& rpcPic)
  *            ***ERROR*** - calculated hash does not match the SEI message
  *            unk         - no SEI message was available for comparison
  */
-static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash* pictureHashSEI)
+static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash* pictureHashSEI, TComThreadPool* pcThreadPool)
 {
-  /* calculate MD5sum for entire reconstructed picture */
+  /* calculate the hash of the type in the SEI message for entire reconstructed picture, the planes in parallel */
   UChar recon_digest[3][16];
   Int numChar=0;
   const Char* hashType = "\0";
@@ -339,10 +394,24 @@ static void calcAndPrintHashStatus(TComPicYuv& pic, const SEIDecodedPictureHash*
     case SEIDecodedPictureHash::MD5:
       {
         hashType = "MD5";
-        calcMD5(pic, recon_digest);
+        calcMD5(pic, recon_digest, pcThreadPool);
         numChar = 16;
         break;
       }
+    case SEIDecodedPictureHash::CRC:
+      {
+        hashType = "CRC";
+        calcCRC(pic, recon_digest, pcThreadPool);
+        numChar = 2;
+        break;
+      }
+    case SEIDecodedPictureHash::CHECKSUM:
+      {
+        hashType = "Checksum";
+        calcChecksum(pic, recon_digest, pcThreadPool);
+        numChar = 4;
+        break;
+      }
     default:
       {
         assert (!"unknown hash type");
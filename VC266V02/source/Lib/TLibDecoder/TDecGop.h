@@ -66,7 +66,7 @@
 // ====================================================================================================================
 
 /// GOP decoder class
-class TDecGop
+class TDecGop : public TComParallelJob
 {
 private:
   TComList<TComPic*>    m_cListPic;         //  Dynamic buffer
@@ -85,11 +85,19 @@ private:
   // Adaptive Loop filter
   TComAdaptiveLoopFilter*       m_pcAdaptiveLoopFilter;
   ALFParam              m_cAlfParam;
+  ALFParam              m_cFilterAlfParam;  ///< ALF parameters of the picture in the filter stage
 #endif
 
   TComSampleAdaptiveOffset*     m_pcSAO;
+  TComThreadPool*       m_pcThreadPool;     ///< worker threads for the reference border extension and the hash check
   Double                m_dDecTime;
-  Int                   m_decodedPictureHashSEIEnabled;  ///< MD5(1)/disable(0) acting on decoded picture hash SEI message
+
+  // filter stage: in-loop filters, motion compression and hash check of one picture, optionally on its own thread
+  TComThreadPool        m_cFilterThread;    ///< runs the filter stage while the next picture is decoded (frame-parallel mode)
+  TComPic*              m_pcFilterPic;      ///< picture handed to the filter stage, NULL if none
+  Char                  m_cFilterSliceType; ///< slice type character of m_pcFilterPic, taken before later RPS changes
+  Double                m_dFilterDecTime;   ///< decoding time of m_pcFilterPic accumulated so far
+  Int                   m_decodedPictureHashSEIEnabled;  ///< check(1)/ignore(0) decoded picture hash SEI message of any hash type
 
 public:
   TDecGop();
@@ -111,8 +119,17 @@ public:
   Void  decompressSlice(TComInputBitstream* pcBitstream, TComPic*& rpcPic );
   Void  filterPicture  (TComPic*& rpcPic );
 
+  Void  setFrameParallel   ( Bool bFrameParallel );
+  Void  waitForFilterStage ();
+  Bool  isInFilterStage    ( TComPic* pcPic ) { return pcPic == m_pcFilterPic; }
+
+  Void  runItem( Int itemIdx, Int threadIdx );
+
   void setDecodedPictureHashSEIEnabled(Int enabled) { m_decodedPictureHashSEIEnabled = enabled; }
+  Void setThreadPool( TComThreadPool* pcThreadPool ) { m_pcThreadPool = pcThreadPool; }
 
+private:
+  Void  xFilterPicture ( TComPic*& rpcPic );
 };
 
 //! \}
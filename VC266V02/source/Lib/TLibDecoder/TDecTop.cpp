@@ -63,6 +63,9 @@ TDecTop::TDecTop()
   m_lastPOCNoOutputPriorPics = -1;
   m_craNoRaslOutputFlag = false;
   m_isNoOutputPriorPics = false;
+  m_bNewParameterSets = true;
+  m_pcLastActivatedSPS = NULL;
+  m_pcLastActivatedPPS = NULL;
 }
 
 TDecTop::~TDecTop()
@@ -87,6 +90,7 @@ Void TDecTop::destroy()
   m_apcSlicePilot = NULL;
   
   m_cSliceDecoder.destroy();
+  m_cThreadPool.destroy();
 }
 
 Void TDecTop::init()
@@ -100,10 +104,17 @@ Void TDecTop::init()
 #endif
   m_cSliceDecoder.init( &m_cEntropyDecoder, &m_cCuDecoder );
   m_cEntropyDecoder.init(&m_cPrediction);
+  m_cSAO.setThreadPool(&m_cThreadPool);
+#if ALF_TEST_DECODER
+  m_cAdaptiveLoopFilter.setThreadPool(&m_cThreadPool);
+#endif
+  m_cGopDecoder.setThreadPool(&m_cThreadPool);
 }
 
 Void TDecTop::deletePicBuffer ( )
 {
+  m_cGopDecoder.waitForFilterStage();
+
   TComList<TComPic*>::iterator  iterPic   = m_cListPic.begin();
   Int iSize = Int( m_cListPic.size() );
   
@@ -182,8 +193,13 @@ Void TDecTop::xGetNewPicBuffer ( TComSlice* pcSlice, TComPic*& rpcPic )
     rpcPic = new TComPic();
     m_cListPic.pushBack( rpcPic );
   }
-  rpcPic->destroy();
-  rpcPic->create ( pcSlice->getSPS()->getPicWidthInLumaSamples(), pcSlice->getSPS()->getPicHeightInLumaSamples(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth,
+  // a picture that is neither referenced nor waiting for output can still be in the filter stage
+  if ( m_cGopDecoder.isInFilterStage( rpcPic ) )
+  {
+    m_cGopDecoder.waitForFilterStage();
+  }
+  // keep the buffers of a recycled picture unless the SPS geometry changed
+  rpcPic->reinit ( pcSlice->getSPS()->getPicWidthInLumaSamples(), pcSlice->getSPS()->getPicHeightInLumaSamples(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth,
                    conformanceWindow, defaultDisplayWindow, numReorderPics, true);
 
 }
@@ -235,6 +251,7 @@ Void TDecTop::xCreateLostPicture(Int iLostPoc)
   cFillSlice.setPPS( m_parameterSetManagerDecoder.getFirstPPS() );
   cFillSlice.initSlice();
   TComPic *cFillPic;
+  m_cGopDecoder.waitForFilterStage();
   xGetNewPicBuffer(&cFillSlice,cFillPic);
   cFillPic->getSlice(0)->setSPS( m_parameterSetManagerDecoder.getFirstSPS() );
   cFillPic->getSlice(0)->setPPS( m_parameterSetManagerDecoder.getFirstPPS() );
@@ -270,6 +287,8 @@ Void TDecTop::xCreateLostPicture(Int iLostPoc)
   cFillPic->getSlice(0)->setPOC(iLostPoc);
   cFillPic->setReconMark(true);
   cFillPic->setOutputMark(true);
+  cFillPic->setMotionFinal(true);
+  cFillPic->setFinished(true);
   if(m_pocRandomAccess == MAX_INT)
   {
     m_pocRandomAccess = iLostPoc;
@@ -279,6 +298,11 @@ Void TDecTop::xCreateLostPicture(Int iLostPoc)
 
 Void TDecTop::xActivateParameterSets()
 {
+  if (m_bNewParameterSets)
+  {
+    // the prefetched parameter sets replace stored ones that the picture in the filter stage may still use
+    m_cGopDecoder.waitForFilterStage();
+  }
   m_parameterSetManagerDecoder.applyPrefetchedPS();
   
   TComPPS *pps = m_parameterSetManagerDecoder.getPPS(m_apcSlicePilot->getPPSId());
@@ -295,32 +319,46 @@ Void TDecTop::xActivateParameterSets()
 
   m_apcSlicePilot->setPPS(pps);
   m_apcSlicePilot->setSPS(sps);
-  pps->setSPS(sps);
-  pps->setNumSubstreams(pps->getEntropyCodingSyncEnabledFlag() ? ((sps->getPicHeightInLumaSamples() + sps->getMaxCUHeight() - 1) / sps->getMaxCUHeight()) : 1);
-  //pps->setNumSubstreams(pps->getEntropyCodingSyncEnabledFlag() ? ((sps->getPicHeightInLumaSamples() + sps->getMaxCUHeight() - 1) / sps->getMaxCUHeight()) * (pps->getNumTileColumnsMinus1() + 1) : 1);
-  pps->setMinCuDQPSize( sps->getMaxCUWidth() >> ( pps->getMaxCuDQPDepth()) );
-
-  g_bitDepthY     = sps->getBitDepthY();
-  g_bitDepthC     = sps->getBitDepthC();
-  g_uiMaxCUWidth  = sps->getMaxCUWidth();
-  g_uiMaxCUHeight = sps->getMaxCUHeight();
-  g_uiMaxCUDepth  = sps->getMaxCUDepth();
-  g_uiAddCUDepth  = max (0, sps->getLog2MinCodingBlockSize() - (Int)sps->getQuadtreeTULog2MinSize() );
 
-  for (Int i = 0; i < sps->getLog2DiffMaxMinCodingBlockSize(); i++)
+  // the derived state below only changes with the parameter sets, and it is shared with the filter stage
+  if (m_bNewParameterSets || pps != m_pcLastActivatedPPS)
   {
-    sps->setAMPAcc( i, sps->getUseAMP() );
+    pps->setSPS(sps);
+    pps->setNumSubstreams(pps->getEntropyCodingSyncEnabledFlag() ? ((sps->getPicHeightInLumaSamples() + sps->getMaxCUHeight() - 1) / sps->getMaxCUHeight()) : 1);
+    //pps->setNumSubstreams(pps->getEntropyCodingSyncEnabledFlag() ? ((sps->getPicHeightInLumaSamples() + sps->getMaxCUHeight() - 1) / sps->getMaxCUHeight()) * (pps->getNumTileColumnsMinus1() + 1) : 1);
+    pps->setMinCuDQPSize( sps->getMaxCUWidth() >> ( pps->getMaxCuDQPDepth()) );
   }
 
-  for (Int i = sps->getLog2DiffMaxMinCodingBlockSize(); i < sps->getMaxCUDepth(); i++)
+  if (m_bNewParameterSets || sps != m_pcLastActivatedSPS)
   {
-    sps->setAMPAcc( i, 0 );
-  }
+    m_cGopDecoder.waitForFilterStage();
 
-  m_cSAO.destroy();
+    g_bitDepthY     = sps->getBitDepthY();
+    g_bitDepthC     = sps->getBitDepthC();
+    g_uiMaxCUWidth  = sps->getMaxCUWidth();
+    g_uiMaxCUHeight = sps->getMaxCUHeight();
+    g_uiMaxCUDepth  = sps->getMaxCUDepth();
+    g_uiAddCUDepth  = max (0, sps->getLog2MinCodingBlockSize() - (Int)sps->getQuadtreeTULog2MinSize() );
+
+    for (Int i = 0; i < sps->getLog2DiffMaxMinCodingBlockSize(); i++)
+    {
+      sps->setAMPAcc( i, sps->getUseAMP() );
+    }
+
+    for (Int i = sps->getLog2DiffMaxMinCodingBlockSize(); i < sps->getMaxCUDepth(); i++)
+    {
+      sps->setAMPAcc( i, 0 );
+    }
+
+    m_cSAO.destroy();
+
+    m_cSAO.create( sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getMaxCUDepth() );
+    m_cLoopFilter.create( sps->getMaxCUDepth() );
+  }
 
-  m_cSAO.create( sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getMaxCUDepth() );
-  m_cLoopFilter.create( sps->getMaxCUDepth() );
+  m_bNewParameterSets  = false;
+  m_pcLastActivatedSPS = sps;
+  m_pcLastActivatedPPS = pps;
 }
 
 Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisplay )
@@ -597,6 +635,15 @@ Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisp
     m_cTrQuant.setUseScalingList(false);
   }
 
+  // the collocated motion of a reference picture that is still in the filter stage is final after its deblocking
+  for (Int iRefList = 0; iRefList < 2; iRefList++)
+  {
+    for (Int iRefIdx = 0; iRefIdx < pcSlice->getNumRefIdx(RefPicList(iRefList)); iRefIdx++)
+    {
+      pcSlice->getRefPic(RefPicList(iRefList), iRefIdx)->waitForMotionFinal();
+    }
+  }
+
   //  Decode a picture
   m_cGopDecoder.decompressSlice(nalu.m_Bitstream, pcPic);
 
@@ -609,6 +656,7 @@ Bool TDecTop::xDecodeSlice(InputNALUnit &nalu, Int &iSkipFrame, Int iPOCLastDisp
 Void TDecTop::xDecodeVPS()
 {
   TComVPS* vps = new TComVPS();
+  m_bNewParameterSets = true;
   
   m_cEntropyDecoder.decodeVPS( vps );
   m_parameterSetManagerDecoder.storePrefetchedVPS(vps);  
@@ -617,12 +665,14 @@ Void TDecTop::xDecodeVPS()
 Void TDecTop::xDecodeSPS()
 {
   TComSPS* sps = new TComSPS();
+  m_bNewParameterSets = true;
   m_cEntropyDecoder.decodeSPS( sps );
   m_parameterSetManagerDecoder.storePrefetchedSPS(sps);
 
 #if ALF_TEST_DECODER
-  // create ALF temporary buffer
-  m_cAdaptiveLoopFilter.create(sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth);
+  // create ALF buffers; the full-picture buffer is only needed by pictures filtered slice by slice
+  m_cGopDecoder.waitForFilterStage();
+  m_cAdaptiveLoopFilter.create(sps->getPicWidthInLumaSamples(), sps->getPicHeightInLumaSamples(), sps->getMaxCUWidth(), sps->getMaxCUHeight(), sps->getMaxCUDepth(), false);
 #endif
 
 }
@@ -630,6 +680,7 @@ Void TDecTop::xDecodeSPS()
 Void TDecTop::xDecodePPS()
 {
   TComPPS* pps = new TComPPS();
+  m_bNewParameterSets = true;
   m_cEntropyDecoder.decodePPS( pps );
   m_parameterSetManagerDecoder.storePrefetchedPPS( pps );
 }
@@ -638,11 +689,11 @@ Void TDecTop::xDecodeSEI( TComInputBitstream* bs, const NalUnitType nalUnitType
 {
   if(nalUnitType == NAL_UNIT_SUFFIX_SEI)
   {
-    m_seiReader.parseSEImessage( bs, m_pcPic->getSEIs(), nalUnitType, m_parameterSetManagerDecoder.getActiveSPS() );
+    m_seiReader.parseSEImessage( bs, m_pcPic->getSEIs(), nalUnitType, m_parameterSetManagerDecoder.getActiveSPS(), &m_parameterSetManagerDecoder );
   }
   else
   {
-    m_seiReader.parseSEImessage( bs, m_SEIs, nalUnitType, m_parameterSetManagerDecoder.getActiveSPS() );
+    m_seiReader.parseSEImessage( bs, m_SEIs, nalUnitType, m_parameterSetManagerDecoder.getActiveSPS(), &m_parameterSetManagerDecoder );
   }
 }
 
@@ -44,6 +44,7 @@
 #include "TLibCommon/TComPic.h"
 #include "TLibCommon/TComTrQuant.h"
 #include "TLibCommon/SEI.h"
+#include "TLibCommon/TComThreadPool.h"
 
 #include "TDecGop.h"
 #include "TDecEntropy.h"
@@ -92,6 +93,7 @@ private:
 #if ALF_TEST_DECODER
   TComAdaptiveLoopFilter  m_cAdaptiveLoopFilter;
 #endif
+  TComThreadPool          m_cThreadPool;      ///< worker threads for CTU-parallel loop filtering
 
   Bool isSkipPictureForBLA(Int& iPOCLastDisplay);
   Bool isRandomAccessSkipPicture(Int& iSkipFrame,  Int& iPOCLastDisplay);
@@ -108,6 +110,10 @@ private:
   Bool                    m_isNoOutputPriorPics;
   Bool                    m_craNoRaslOutputFlag;    //value of variable NoRaslOutputFlag of the last CRA pic
 
+  Bool                    m_bNewParameterSets;      ///< parameter sets were received since the last activation
+  TComSPS*                m_pcLastActivatedSPS;     ///< SPS the globals, SAO and deblocking buffers are set up for
+  TComPPS*                m_pcLastActivatedPPS;
+
 public:
   TDecTop();
   virtual ~TDecTop();
@@ -116,6 +122,11 @@ public:
   Void  destroy ();
 
   void setDecodedPictureHashSEIEnabled(Int enabled) { m_cGopDecoder.setDecodedPictureHashSEIEnabled(enabled); }
+  Void setNumWorkerThreads(Int numThreads) { m_cThreadPool.create(numThreads); }
+  /// overlap the in-loop filtering of each picture with the decoding of the next one
+  Void setFrameParallel(Bool bFrameParallel) { m_cGopDecoder.setFrameParallel(bFrameParallel); }
+  /// wait until the last picture handed to the in-loop filters is completely processed
+  Void waitForFilterStage() { m_cGopDecoder.waitForFilterStage(); }
 
   Void  init();
   Bool  decode(InputNALUnit& nalu, Int& iSkipFrame, Int& iPOCLastDisplay);
@@ -37,16 +37,19 @@
 #include "TLibCommon/SEI.h"
 
 class TComBitIf;
+class TComHRD;
 
 //! \ingroup TLibEncoder
 //! \{
 class SEIWriter:public SyntaxElementWriter
 {
 public:
-  SEIWriter() {};
+  SEIWriter() : m_pcHRD(NULL) {};
   virtual ~SEIWriter() {};
 
   void writeSEImessage(TComBitIf& bs, const SEI& sei, TComSPS *sps);
+  /// HRD parameters the buffering period and picture timing SEI messages refer to
+  Void setHrdParameters(TComHRD *hrd) { m_pcHRD = hrd; }
 
 protected:
   Void xWriteSEIpayloadData(TComBitIf& bs, const SEI& sei, TComSPS *sps);
@@ -54,6 +57,9 @@ protected:
   Void xWriteSEIDecodedPictureHash(const SEIDecodedPictureHash& sei);
   TComSPS *m_pSPS;
   Void xWriteSEIRecoveryPoint(const SEIRecoveryPoint& sei);
+  Void xWriteSEIBufferingPeriod(const SEIBufferingPeriod& sei);
+  Void xWriteSEIPictureTiming(const SEIPictureTiming& sei);
+  TComHRD *m_pcHRD;
   Void xWriteByteAlign();
 };
 
@@ -50,6 +50,12 @@
 // ====================================================================================================================
 
 #define ALF_NUM_OF_REDESIGN 3
+#define ALF_REUSE_GAIN_RATIO 0.8  ///< share of the last full-design gain a reused filter has to keep
+
+/** Offset of row i in a packed upper triangle of order n, biased by -i so that element (i,j), j>=i, is at [TRI_ROW(i,n)+j].
+ */
+#define TRI_ROW(i, n)  ((i)*(n) - (((i)*((i)+1))>>1))
+#define TRI_LENGTH(n)  (((n)*((n)+1))>>1)  ///< number of elements of a packed upper triangle of order n
 
 // ====================================================================================================================
 // Tables
@@ -175,12 +181,35 @@ TEncAdaptiveLoopFilter::TEncAdaptiveLoopFilter()
   m_pcTempAlfParam = NULL;
   m_pcPicYuvBest = NULL;
   m_pcPicYuvTmp = NULL;
+  m_pcParallelPicOrg = NULL;
+  m_yGlobalSym = NULL;
+  m_EGlobalSym = NULL;
+  m_pixAcc = NULL;
+  m_filterCoeffSymQuant = NULL;
+  m_y_merged = NULL;
+  m_E_merged = NULL;
+  m_diffFilterCoeffQuant = NULL;
+  m_FilterCoeffQuantTemp = NULL;
 #if MTK_NONCROSS_INLOOP_FILTER
   m_pcSliceYuvTmp = NULL;
 #endif
 #if MQT_BA_RA && MQT_ALF_NPASS
   m_aiFilterCoeffSaved = NULL;
 #endif
+#if MQT_BA_RA
+  m_bVarImgValid = false;
+#endif
+#if MQT_ALF_NPASS
+  m_bALFTemporalReuse = false;
+  for (Int i = 0; i < MAX_TLAYER; i++)
+  {
+    m_abReuseValid[i] = false;
+  }
+  m_bALFCtuRowMode = false;
+  m_bRowStatValid  = false;
+  m_bCtuRowFilter  = false;
+  m_iCtuRowFiltNo  = 0;
+#endif
 }
 
 // ====================================================================================================================
@@ -190,6 +219,16 @@ TEncAdaptiveLoopFilter::TEncAdaptiveLoopFilter()
 #if MQT_BA_RA && MQT_ALF_NPASS
 Void TEncAdaptiveLoopFilter::createAlfGlobalBuffers(Int iALFEncodePassReduction)
 {
+  // luma filter design statistics and scratch, reused by every picture
+  m_EGlobalSym = new Double[NO_TEST_FILT][NO_VAR_BINS][MAX_SQR_FILT_TRI_LENGTH];
+  m_yGlobalSym = new Double[NO_TEST_FILT][NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  m_pixAcc     = new Double[NO_VAR_BINS];
+  m_E_merged   = new Double[NO_VAR_BINS][MAX_SQR_FILT_TRI_LENGTH];
+  m_y_merged   = new Double[NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  initMatrix_int(&m_filterCoeffSymQuant, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);
+  initMatrix_int(&m_diffFilterCoeffQuant, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);
+  initMatrix_int(&m_FilterCoeffQuantTemp, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);
+
   if(iALFEncodePassReduction)
   {
     for(Int i=0; i< NUM_ALF_CLASS_METHOD; i++)
@@ -210,6 +249,18 @@ Void TEncAdaptiveLoopFilter::createAlfGlobalBuffers(Int iALFEncodePassReduction)
 
 Void TEncAdaptiveLoopFilter::destroyAlfGlobalBuffers()
 {
+  delete[] m_EGlobalSym;  m_EGlobalSym = NULL;
+  delete[] m_yGlobalSym;  m_yGlobalSym = NULL;
+  delete[] m_pixAcc;      m_pixAcc     = NULL;
+  delete[] m_E_merged;    m_E_merged   = NULL;
+  delete[] m_y_merged;    m_y_merged   = NULL;
+  destroyMatrix_int(m_filterCoeffSymQuant);
+  destroyMatrix_int(m_diffFilterCoeffQuant);
+  destroyMatrix_int(m_FilterCoeffQuantTemp);
+  m_filterCoeffSymQuant  = NULL;
+  m_diffFilterCoeffQuant = NULL;
+  m_FilterCoeffQuantTemp = NULL;
+
   if(m_iALFEncodePassReduction)
   {
     for(Int i=0; i< NUM_ALF_CLASS_METHOD; i++)
@@ -261,28 +312,15 @@ Void TEncAdaptiveLoopFilter::startALFEnc( TComPic* pcPic, TEncEntropy* pcEntropy
   m_im_width = iWidth;
   m_im_height = iHeight;
   
-  // init qc_filter
-  initMatrix4D_double(&m_EGlobalSym, NO_TEST_FILT,  NO_VAR_BINS, MAX_SQR_FILT_LENGTH, MAX_SQR_FILT_LENGTH);
-  initMatrix3D_double(&m_yGlobalSym, NO_TEST_FILT, NO_VAR_BINS, MAX_SQR_FILT_LENGTH); 
-  initMatrix_int(&m_filterCoeffSymQuant, NO_VAR_BINS, MAX_SQR_FILT_LENGTH); 
-  
-  m_pixAcc = (double *) calloc(NO_VAR_BINS, sizeof(double));
 #if !MQT_BA_RA
   get_mem2Dpel(&m_varImg, m_im_height, m_im_width);
 #endif
   get_mem2Dpel(&m_maskImg, m_im_height, m_im_width);
   
-  initMatrix_double(&m_E_temp, MAX_SQR_FILT_LENGTH, MAX_SQR_FILT_LENGTH);//
-  m_y_temp = (double *) calloc(MAX_SQR_FILT_LENGTH, sizeof(double));//
-  initMatrix3D_double(&m_E_merged, NO_VAR_BINS, MAX_SQR_FILT_LENGTH, MAX_SQR_FILT_LENGTH);//
-  initMatrix_double(&m_y_merged, NO_VAR_BINS, MAX_SQR_FILT_LENGTH); //
-  m_pixAcc_merged = (double *) calloc(NO_VAR_BINS, sizeof(double));//
-  
-  m_filterCoeffQuantMod = (int *) calloc(MAX_SQR_FILT_LENGTH, sizeof(int));//
-  m_filterCoeff = (double *) calloc(MAX_SQR_FILT_LENGTH, sizeof(double));//
-  m_filterCoeffQuant = (int *) calloc(MAX_SQR_FILT_LENGTH, sizeof(int));//
-  initMatrix_int(&m_diffFilterCoeffQuant, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);//
-  initMatrix_int(&m_FilterCoeffQuantTemp, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);//
+  // coefficient scratch is allocated once, start every picture from zero as before
+  ::memset(m_filterCoeffSymQuant[0],  0, sizeof(Int)*NO_VAR_BINS*MAX_SQR_FILT_LENGTH);
+  ::memset(m_diffFilterCoeffQuant[0], 0, sizeof(Int)*NO_VAR_BINS*MAX_SQR_FILT_LENGTH);
+  ::memset(m_FilterCoeffQuantTemp[0], 0, sizeof(Int)*NO_VAR_BINS*MAX_SQR_FILT_LENGTH);
   
   m_tempALFp = new ALFParam;
   allocALFParam(m_tempALFp);
@@ -314,30 +352,11 @@ Void TEncAdaptiveLoopFilter::endALFEnc()
   freeALFParam(m_pcTempAlfParam);
   delete m_pcBestAlfParam;
   delete m_pcTempAlfParam;
-  // delete qc filters
-  destroyMatrix4D_double(m_EGlobalSym, NO_TEST_FILT,  NO_VAR_BINS);
-  destroyMatrix3D_double(m_yGlobalSym, NO_TEST_FILT);
-  destroyMatrix_int(m_filterCoeffSymQuant);
-  
-  free(m_pixAcc);
 #if !MQT_BA_RA
   free_mem2Dpel(m_varImg);
 #endif
   free_mem2Dpel(m_maskImg);
   
-  destroyMatrix3D_double(m_E_merged, NO_VAR_BINS);
-  destroyMatrix_double(m_y_merged);
-  destroyMatrix_double(m_E_temp);
-  free(m_pixAcc_merged);
-  
-  free(m_filterCoeffQuantMod);
-  free(m_y_temp);
-  
-  free(m_filterCoeff);
-  free(m_filterCoeffQuant);
-  destroyMatrix_int(m_diffFilterCoeffQuant);
-  destroyMatrix_int(m_FilterCoeffQuantTemp);
-  
   freeALFParam(m_tempALFp);
   delete m_tempALFp;
 
@@ -394,6 +413,9 @@ Void TEncAdaptiveLoopFilter::ALFProcess( ALFParam* pcAlfParam, Double dLambda, U
 #if MTK_NONCROSS_INLOOP_FILTER
   }
 #endif  
+#if MQT_BA_RA
+  m_bVarImgValid = false;
+#endif
  
   // set min cost
   UInt64 uiMinRate = MAX_INT;
@@ -421,6 +443,11 @@ Void TEncAdaptiveLoopFilter::ALFProcess( ALFParam* pcAlfParam, Double dLambda, U
   
 #if MQT_ALF_NPASS
   setALFEncodingParam(m_pcPic);
+
+  // filters of the previous picture of the same layer, full design only when they lost too much gain
+  Bool bTemporalReuse = xTemporalReuseLuma_qc( pcPicOrg, pcPicYuvExtRec, pcPicYuvRec, dOrigCost, uiMinRate, uiMinDist, dMinCost );
+  if( !bTemporalReuse )
+  {
 #endif
 
   // adaptive in-loop wiener filtering
@@ -431,6 +458,9 @@ Void TEncAdaptiveLoopFilter::ALFProcess( ALFParam* pcAlfParam, Double dLambda, U
   
   // adaptive tap-length
   xFilterTapDecision_qc( pcPicOrg, pcPicYuvExtRec, pcPicYuvRec, uiMinRate, uiMinDist, dMinCost );
+#if MQT_ALF_NPASS
+  }
+#endif
   
   // compute RD cost
   xCalcRDCost( pcPicOrg, pcPicYuvRec, m_pcBestAlfParam, uiMinRate, uiMinDist, dMinCost );
@@ -458,6 +488,13 @@ Void TEncAdaptiveLoopFilter::ALFProcess( ALFParam* pcAlfParam, Double dLambda, U
     ruiBits = uiOrigRate;
     ruiDist = uiOrigDist;
   }
+
+#if MQT_ALF_NPASS
+  if( m_bALFTemporalReuse && !bTemporalReuse )
+  {
+    xStoreTemporalReuse( m_pcBestAlfParam->alf_flag ? dOrigCost - dMinCost : 0.0 );
+  }
+#endif
   
   // if ALF works
   if( m_pcBestAlfParam->alf_flag )
@@ -509,8 +546,9 @@ Void TEncAdaptiveLoopFilter::xEncALFChroma( UInt64 uiLumaRate, TComPicYuv* pcPic
   m_pcTempAlfParam->tap_chroma       = tap;
   m_pcTempAlfParam->num_coeff_chroma = num_coef;
   
-  // Adaptive in-loop wiener filtering for chroma
-  xFilteringFrameChroma(pcPicOrg, pcPicDec, pcPicRest);
+  // Adaptive in-loop wiener filtering for chroma, the unfiltered SSD comes with the correlation
+  UInt64 auiOrgDist[2];
+  xFilteringFrameChroma(pcPicOrg, pcPicDec, pcPicRest, auiOrgDist);
   
   // filter on/off decision for chroma
   Int iCWidth = (pcPicOrg->getWidth()>>1);
@@ -518,8 +556,8 @@ Void TEncAdaptiveLoopFilter::xEncALFChroma( UInt64 uiLumaRate, TComPicYuv* pcPic
   Int iCStride = pcPicOrg->getCStride();
   UInt64 uiFiltDistCb = xCalcSSD(pcPicOrg->getCbAddr(), pcPicRest->getCbAddr(), iCWidth, iCHeight, iCStride);
   UInt64 uiFiltDistCr = xCalcSSD(pcPicOrg->getCrAddr(), pcPicRest->getCrAddr(), iCWidth, iCHeight, iCStride);
-  UInt64 uiOrgDistCb = xCalcSSD(pcPicOrg->getCbAddr(), pcPicDec->getCbAddr(), iCWidth, iCHeight, iCStride);
-  UInt64 uiOrgDistCr = xCalcSSD(pcPicOrg->getCrAddr(), pcPicDec->getCrAddr(), iCWidth, iCHeight, iCStride);
+  UInt64 uiOrgDistCb = auiOrgDist[0];
+  UInt64 uiOrgDistCr = auiOrgDist[1];
   
   m_pcTempAlfParam->chroma_idc = 0;
   if(uiOrgDistCb > uiFiltDistCb)
@@ -724,6 +762,29 @@ Void TEncAdaptiveLoopFilter::xEncodeCUAlfCtrlFlag(TComDataCU* pcCU, UInt uiAbsPa
   
   m_pcEntropyCoder->encodeAlfCtrlFlag(pcCU, uiAbsPartIdx);
 }
+
+/// scan index of the filter positions of a tap size to the symmetric coefficients
+const Int* TEncAdaptiveLoopFilter::xGetSymmetricArray(Int iTap)
+{
+  switch(iTap)
+  {
+    case 5:
+      return m_aiSymmetricArray5x5;
+    case 7:
+      return m_aiSymmetricArray7x7;
+    case 9:
+      break;
+    default:
+      assert(0);
+      break;
+  }
+#if TI_ALF_MAX_VSIZE_7
+  return m_aiSymmetricArray9x7;
+#else
+  return m_aiSymmetricArray9x9;
+#endif
+}
+
 #if MTK_NONCROSS_INLOOP_FILTER
 Void TEncAdaptiveLoopFilter::xCalcCorrelationFunc(Int ypos, Int xpos, Pel* pOrg, Pel* pCmp, Int iTap, Int iWidth, Int iHeight, Int iOrgStride, Int iCmpStride, Bool bSymmCopyBlockMatrix)
 #else
@@ -742,32 +803,7 @@ Void TEncAdaptiveLoopFilter::xCalcCorrelationFunc(Pel* pOrg, Pel* pCmp, Int iTap
 #endif
   Int offset = iTap>>1;
   
-  const Int* pFiltPos;
-  
-  switch(iTap)
-  {
-    case 5:
-      pFiltPos = m_aiSymmetricArray5x5;
-      break;
-    case 7:
-      pFiltPos = m_aiSymmetricArray7x7;
-      break;
-    case 9:
-#if TI_ALF_MAX_VSIZE_7
-      pFiltPos = m_aiSymmetricArray9x7;
-#else
-      pFiltPos = m_aiSymmetricArray9x9;
-#endif
-      break;
-    default:
-#if TI_ALF_MAX_VSIZE_7
-      pFiltPos = m_aiSymmetricArray9x7;
-#else
-      pFiltPos = m_aiSymmetricArray9x9;
-#endif
-      assert(0);
-      break;
-  }
+  const Int* pFiltPos = xGetSymmetricArray(iTap);
   
   Pel* pTerm = new Pel[N];
   
@@ -832,6 +868,100 @@ Void TEncAdaptiveLoopFilter::xCalcCorrelationFunc(Pel* pOrg, Pel* pCmp, Int iTap
   pTerm = NULL;
 }
 
+/** Correlation of a whole chroma plane, gathered in the same pass as the SSD of the unfiltered plane.
+ * The sums are exact in 64-bit integers, so the planes can be accumulated separately and added afterwards
+ * with the same result as xCalcCorrelationFunc().
+ \param piCorr  upper triangle of the (N+1)x(N+2) correlation matrix with the DC terms, row stride N+2
+ \param ruiSSD  SSD between pOrg and pCmp as computed by xCalcSSD()
+ */
+Void TEncAdaptiveLoopFilter::xCalcCorrelationFuncChroma(Pel* pOrg, Pel* pCmp, Int iTap, Int iWidth, Int iHeight, Int iOrgStride, Int iCmpStride, Int64* piCorr, UInt64& ruiSSD)
+{
+#if TI_ALF_MAX_VSIZE_7
+  Int iTapV   = TComAdaptiveLoopFilter::ALFTapHToTapV(iTap);
+  Int N       = (iTap * iTapV + 1) >> 1;
+  Int offsetV = iTapV >> 1;
+#else
+  Int N       = (iTap*iTap+1)>>1;
+  Int offsetV = iTap>>1;
+#endif
+  Int offset  = iTap>>1;
+  Int iCorrStride = N + 2;
+  const Int* pFiltPos = xGetSymmetricArray(iTap);
+  
+  Int aiTerm[ALF_MAX_NUM_COEF];
+  Int i, j;
+  
+#if IBDI_DISTORTION
+  Int iShift  = g_uiBitIncrement;
+  Int iOffset = (g_uiBitIncrement>0)? (1<<(g_uiBitIncrement-1)):0;
+#else
+  UInt uiShift = g_uiBitIncrement<<1;
+#endif
+  UInt64 uiSSD = 0;
+  
+  memset(piCorr, 0, sizeof(Int64)*(N+1)*iCorrStride);
+  for (Int y = 0; y < iHeight; y++)
+  {
+    for (Int x = 0; x < iWidth; x++)
+    {
+      memset(aiTerm, 0, sizeof(Int)*N);
+      i = 0;
+      for (Int yy = y - offsetV; yy <= y + offsetV; yy++)
+      {
+        for (Int xx = x - offset; xx <= x + offset; xx++)
+        {
+          aiTerm[pFiltPos[i]] += pCmp[xx + yy*iCmpStride];
+          i++;
+        }
+      }
+      
+      Int iOrg = pOrg[x + y*iOrgStride];
+      for (j = 0; j < N; j++)
+      {
+        Int64* piRow = piCorr + j*iCorrStride;
+        Int    iTerm = aiTerm[j];
+        for (i = j; i < N; i++)
+        {
+          piRow[i] += iTerm*aiTerm[i];
+        }
+        // DC offset
+        piRow[N]   += iTerm;
+        piRow[N+1] += iOrg*iTerm;
+      }
+      // DC offset
+      Int64* piDC = piCorr + N*iCorrStride;
+      for (i = 0; i < N; i++)
+      {
+        piDC[i] += aiTerm[i];
+      }
+      piDC[N]   += 1;
+      piDC[N+1] += iOrg;
+      
+      Int iTemp;
+#if IBDI_DISTORTION
+      iTemp = ((iOrg+iOffset)>>iShift) - ((pCmp[x + y*iCmpStride]+iOffset)>>iShift); uiSSD += iTemp * iTemp;
+#else
+      iTemp = iOrg - pCmp[x + y*iCmpStride]; uiSSD += ( iTemp * iTemp ) >> uiShift;
+#endif
+    }
+  }
+  ruiSSD = uiSSD;
+}
+
+Void TEncAdaptiveLoopFilter::runItem(Int itemIdx, Int threadIdx)
+{
+  if(m_iParallelStage != ALF_STAGE_CHROMA_CORR)
+  {
+    TComAdaptiveLoopFilter::runItem(itemIdx, threadIdx);
+    return;
+  }
+  Int  iColor = m_aiParallelPlane[itemIdx] - 1;
+  Pel* pOrg   = iColor ? m_pcParallelPicOrg->getCrAddr() : m_pcParallelPicOrg->getCbAddr();
+  Pel* pCmp   = iColor ? m_pcParallelPicDec->getCrAddr() : m_pcParallelPicDec->getCbAddr();
+  xCalcCorrelationFuncChroma(pOrg, pCmp, m_iParallelTap, (m_pcParallelPicOrg->getWidth()>>1), (m_pcParallelPicOrg->getHeight()>>1),
+                             m_pcParallelPicOrg->getCStride(), m_pcParallelPicDec->getCStride(), m_aaiChromaCorr[iColor], m_auiChromaOrgDist[iColor]);
+}
+
 #if IBDI_DISTORTION
 UInt64 TEncAdaptiveLoopFilter::xCalcSSD(Pel* pOrg, Pel* pCmp, Int iWidth, Int iHeight, Int iStride )
 {
@@ -857,23 +987,7 @@ UInt64 TEncAdaptiveLoopFilter::xCalcSSD(Pel* pOrg, Pel* pCmp, Int iWidth, Int iH
 #else
 UInt64 TEncAdaptiveLoopFilter::xCalcSSD(Pel* pOrg, Pel* pCmp, Int iWidth, Int iHeight, Int iStride )
 {
-  UInt64 uiSSD = 0;
-  Int x, y;
-  
-  UInt uiShift = g_uiBitIncrement<<1;
-  Int iTemp;
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      iTemp = pOrg[x] - pCmp[x]; uiSSD += ( iTemp * iTemp ) >> uiShift;
-    }
-    pOrg += iStride;
-    pCmp += iStride;
-  }
-  
-  return uiSSD;;
+  return TComRdCost::getPlaneSSD(pOrg, iStride, pCmp, iStride, iWidth, iHeight, g_uiBitIncrement<<1);
 }
 #endif
 
@@ -1193,9 +1307,12 @@ Void TEncAdaptiveLoopFilter::xCalcRDCostChroma(TComPicYuv* pcPicOrg, TComPicYuv*
   rdCost  = (Double)(ruiRate) * m_dLambdaChroma + (Double)(ruiDist);
 }
 
-Void TEncAdaptiveLoopFilter::xFilteringFrameChroma(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest)
+/** Design and apply the chroma filter of m_pcTempAlfParam
+ \param puiOrgDist  if not NULL, receives the SSD of the unfiltered Cb and Cr planes selected by chroma_idc
+ */
+Void TEncAdaptiveLoopFilter::xFilteringFrameChroma(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, UInt64* puiOrgDist)
 {
-  Int    i, tap, N, err_code;
+  Int    i, j, tap, N, err_code;
   Int* qh;
   
   tap  = m_pcTempAlfParam->tap_chroma;
@@ -1206,31 +1323,57 @@ Void TEncAdaptiveLoopFilter::xFilteringFrameChroma(TComPicYuv* pcPicOrg, TComPic
   for(i=0; i<N; i++)
     memset(m_ppdAlfCorr[i], 0, sizeof(Double)*(N+1));
   
-  if ((m_pcTempAlfParam->chroma_idc>>1)&0x01)
-  {
-    Pel* pOrg = pcPicOrg->getCbAddr();
-    Pel* pCmp = pcPicDec->getCbAddr();
 #if MTK_NONCROSS_INLOOP_FILTER
-    if(!m_bUseNonCrossALF)
-      xCalcCorrelationFunc(0, 0, pOrg, pCmp, tap, (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride(), pcPicDec->getCStride(), true);
-    else
-      xCalcCorrelationFuncforChromaSlices(ALF_Cb, pOrg, pCmp, tap, pcPicOrg->getCStride(), pcPicDec->getCStride());
-#else        
-    xCalcCorrelationFunc(pOrg, pCmp, tap, (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride(), pcPicDec->getCStride());
-#endif
-  }
-  if ((m_pcTempAlfParam->chroma_idc)&0x01)
+  if(m_bUseNonCrossALF)
   {
-    Pel* pOrg = pcPicOrg->getCrAddr();
-    Pel* pCmp = pcPicDec->getCrAddr();
-#if MTK_NONCROSS_INLOOP_FILTER
-    if(!m_bUseNonCrossALF)
-      xCalcCorrelationFunc(0, 0, pOrg, pCmp, tap, (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride(), pcPicDec->getCStride(), true);
-    else
-      xCalcCorrelationFuncforChromaSlices(ALF_Cr, pOrg, pCmp, tap, pcPicOrg->getCStride(), pcPicDec->getCStride());
-#else
-    xCalcCorrelationFunc(pOrg, pCmp, tap, (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride(), pcPicDec->getCStride());
+    if ((m_pcTempAlfParam->chroma_idc>>1)&0x01)
+    {
+      xCalcCorrelationFuncforChromaSlices(ALF_Cb, pcPicOrg->getCbAddr(), pcPicDec->getCbAddr(), tap, pcPicOrg->getCStride(), pcPicDec->getCStride());
+      if(puiOrgDist)
+        puiOrgDist[0] = xCalcSSD(pcPicOrg->getCbAddr(), pcPicDec->getCbAddr(), (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride());
+    }
+    if ((m_pcTempAlfParam->chroma_idc)&0x01)
+    {
+      xCalcCorrelationFuncforChromaSlices(ALF_Cr, pcPicOrg->getCrAddr(), pcPicDec->getCrAddr(), tap, pcPicOrg->getCStride(), pcPicDec->getCStride());
+      if(puiOrgDist)
+        puiOrgDist[1] = xCalcSSD(pcPicOrg->getCrAddr(), pcPicDec->getCrAddr(), (pcPicOrg->getWidth()>>1), (pcPicOrg->getHeight()>>1), pcPicOrg->getCStride());
+    }
+  }
+  else
 #endif
+  {
+    // Cb and Cr are gathered concurrently into separate integer matrices, then added
+    Int iNumPlanes = 0;
+    if ((m_pcTempAlfParam->chroma_idc>>1)&0x01)
+      m_aiParallelPlane[iNumPlanes++] = 1;
+    if ((m_pcTempAlfParam->chroma_idc)&0x01)
+      m_aiParallelPlane[iNumPlanes++] = 2;
+    m_pcParallelPicOrg = pcPicOrg;
+    m_pcParallelPicDec = pcPicDec;
+    m_iParallelTap     = tap;
+    runParallelStage(ALF_STAGE_CHROMA_CORR, iNumPlanes);
+    m_pcParallelPicOrg = NULL;
+    m_pcParallelPicDec = NULL;
+    
+    // N-1 filter coefficients plus the DC row and column, see xCalcCorrelationFuncChroma()
+    Int iCorrStride = N + 1;
+    for(j=0; j<N; j++)
+    {
+      for(i=(j<N-1)?j:0; i<N+1; i++)
+      {
+        Int64 iSum = 0;
+        for(Int p=0; p<iNumPlanes; p++)
+          iSum += m_aaiChromaCorr[m_aiParallelPlane[p]-1][j*iCorrStride+i];
+        m_ppdAlfCorr[j][i] = (Double)iSum;
+        if(i > j && i < N-1)
+          m_ppdAlfCorr[i][j] = (Double)iSum;
+      }
+    }
+    if(puiOrgDist)
+    {
+      for(Int p=0; p<iNumPlanes; p++)
+        puiOrgDist[m_aiParallelPlane[p]-1] = m_auiChromaOrgDist[m_aiParallelPlane[p]-1];
+    }
   }
   
   err_code = xGauss(m_ppdAlfCorr, N);
@@ -1248,27 +1391,18 @@ Void TEncAdaptiveLoopFilter::xFilteringFrameChroma(TComPicYuv* pcPicOrg, TComPic
   }
   
   
-  if ((m_pcTempAlfParam->chroma_idc>>1)&0x01)
-  {
 #if MTK_NONCROSS_INLOOP_FILTER
-    if(! m_bUseNonCrossALF)
-      xFrameChroma(0, 0, (pcPicRest->getHeight() >> 1), (pcPicRest->getWidth() >>1), pcPicDec, pcPicRest, qh, tap, 0);
-    else
-      xFrameChromaforSlices(ALF_Cb, pcPicDec, pcPicRest, qh, tap);
-#else
-    xFrameChroma(pcPicDec, pcPicRest, qh, tap, 0);
-#endif
-  }
-  if ((m_pcTempAlfParam->chroma_idc)&0x01)
+  if(m_bUseNonCrossALF)
   {
-#if MTK_NONCROSS_INLOOP_FILTER
-    if(! m_bUseNonCrossALF)
-      xFrameChroma(0, 0, (pcPicRest->getHeight() >> 1), (pcPicRest->getWidth() >>1), pcPicDec, pcPicRest, qh, tap, 1);
-    else
+    if ((m_pcTempAlfParam->chroma_idc>>1)&0x01)
+      xFrameChromaforSlices(ALF_Cb, pcPicDec, pcPicRest, qh, tap);
+    if ((m_pcTempAlfParam->chroma_idc)&0x01)
       xFrameChromaforSlices(ALF_Cr, pcPicDec, pcPicRest, qh, tap);
-#else
-    xFrameChroma(pcPicDec, pcPicRest, qh, tap, 1);
+  }
+  else
 #endif
+  {
+    xFrameChromaPlanes(pcPicDec, pcPicRest, qh, tap, m_pcTempAlfParam->chroma_idc);
   }
   
   if(m_pcTempAlfParam->chroma_idc<3)
@@ -1835,16 +1969,14 @@ Void   TEncAdaptiveLoopFilter::xEncALFLuma_qc ( TComPicYuv* pcPicOrg, TComPicYuv
   static Int*   apiVarIndTabBest[NUM_ALF_CLASS_METHOD];
   static Int**  appiBestCoeffSet[NUM_ALF_CLASS_METHOD];
 
-  static Double***  adBestySym;
-  static Double**** adBestESym;
+  static Double     adBestySym[NUM_ALF_CLASS_METHOD][NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  static Double     adBestESym[NUM_ALF_CLASS_METHOD][NO_VAR_BINS][MAX_SQR_FILT_TRI_LENGTH];
   static Double**   adBestpixAcc;  
 
   if(bFirst)
   {
     if(m_iALFEncodePassReduction)
     {
-      initMatrix4D_double(&adBestESym,NUM_ALF_CLASS_METHOD,  NO_VAR_BINS, MAX_SQR_FILT_LENGTH, MAX_SQR_FILT_LENGTH);
-      initMatrix3D_double(&adBestySym,NUM_ALF_CLASS_METHOD,  NO_VAR_BINS, MAX_SQR_FILT_LENGTH); 
       initMatrix_double  (&adBestpixAcc,NUM_ALF_CLASS_METHOD,  NO_VAR_BINS );
 
       for(Int i=0; i< NUM_ALF_CLASS_METHOD; i++)
@@ -2086,7 +2218,7 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLuma(imgpel* ImgOrg, imgpel*
 {
 #if MTK_NONCROSS_INLOOP_FILTER
   if(!m_bUseNonCrossALF)
-    xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, true, ImgOrg, ImgDec, tap, Stride);
+    xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, ImgOrg, ImgDec, tap, Stride);
   else
     xstoreInBlockMatrixforSlices(ImgOrg, ImgDec, tap, Stride);
 #else
@@ -2099,7 +2231,7 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLuma(imgpel* ImgOrg, imgpel*
 
 
 #if MTK_NONCROSS_INLOOP_FILTER
-Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(Int ypos, Int xpos, Int iheight, Int iwidth, Bool bResetBlockMatrix, Bool bSymmCopyBlockMatrix, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride)
+Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(Int ypos, Int xpos, Int iheight, Int iwidth, Bool bResetBlockMatrix, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride)
 #else
 Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride)
 #endif
@@ -2123,7 +2255,7 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDe
   Int yLocal;
   Int *p_pattern;
   Int filtNo =2; 
-  double **E,*yy;
+  double *E,*yy;
 #if MTK_NONCROSS_INLOOP_FILTER
   static Int count_valid;
 #else
@@ -2145,10 +2277,7 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDe
   for (varInd=0; varInd<NO_VAR_BINS; varInd++)
   {
     memset(m_yGlobalSym[filtNo][varInd],0,sizeof(double)*MAX_SQR_FILT_LENGTH);
-    for (k=0; k<sqrFiltLength; k++)
-    {
-      memset(m_EGlobalSym[filtNo][varInd][k],0,sizeof(double)*MAX_SQR_FILT_LENGTH);
-    }
+    memset(m_EGlobalSym[filtNo][varInd],0,sizeof(double)*MAX_SQR_FILT_TRI_LENGTH);
   }
   for (i = fl2; i < m_im_height+fl2; i++)
   {
@@ -2222,10 +2351,11 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDe
           E= m_EGlobalSym[filtNo][varInd];
           yy= m_yGlobalSym[filtNo][varInd];
 
+          // E is symmetric, only the upper triangle is kept
           for (k=0; k<sqrFiltLength; k++)
           {
-            for (l=k; l<sqrFiltLength; l++)
-              E[k][l]+=(double)(ELocal[k]*ELocal[l]);
+            for (l=k; l<sqrFiltLength; l++, E++)
+              *E+=(double)(ELocal[k]*ELocal[l]);
             yy[k]+=(double)(ELocal[k]*yLocal);
           }
         }
@@ -2233,33 +2363,11 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDe
     }
   }
 
-#if MTK_NONCROSS_INLOOP_FILTER
-  if(bSymmCopyBlockMatrix)
-  {
-#endif
-
-  // Matrix EGlobalSeq is symmetric, only part of it is calculated
-  for (varInd=0; varInd<NO_VAR_BINS; varInd++)
-  {
-    double **pE = m_EGlobalSym[filtNo][varInd];
-    for (k=1; k<sqrFiltLength; k++)
-    {
-      for (l=0; l<k; l++)
-      {
-        pE[k][l]=pE[l][k];
-      }
-    }
-  }
-#if MTK_NONCROSS_INLOOP_FILTER
-  }
-#endif
-
 }
 
 Void   TEncAdaptiveLoopFilter::xFilteringFrameLuma_qc(imgpel* ImgOrg, imgpel* imgY_pad, imgpel* ImgFilt, ALFParam* ALFp, Int tap, Int Stride)
 {
   int  filtNo,filters_per_fr;
-  static double **ySym, ***ESym;
   int lambda_val = (Int) m_dLambdaLuma;
   lambda_val = lambda_val * (1<<(2*g_uiBitIncrement));
   if (tap==9)
@@ -2269,10 +2377,7 @@ Void   TEncAdaptiveLoopFilter::xFilteringFrameLuma_qc(imgpel* ImgOrg, imgpel* im
   else
     filtNo=2;
   
-  ESym=m_EGlobalSym[filtNo];  
-  ySym=m_yGlobalSym[filtNo];
-  
-  xfindBestFilterVarPred(ySym, ESym, m_pixAcc, m_filterCoeffSym, m_filterCoeffSymQuant, filtNo, &filters_per_fr,
+  xfindBestFilterVarPred(m_yGlobalSym[filtNo], m_EGlobalSym[filtNo], m_pixAcc, m_filterCoeffSym, m_filterCoeffSymQuant, filtNo, &filters_per_fr,
                          m_varIndTab, NULL, m_varImg, m_maskImg, NULL, lambda_val);
   
   // g_filterCoeffPrevSelected = g_filterCoeffSym
@@ -2442,12 +2547,11 @@ Void TEncAdaptiveLoopFilter::xfilterFrame_en(imgpel* ImgDec, imgpel* ImgRest,int
   }
 }
 
-Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESym, double *pixAcc, int **filterCoeffSym, int **filterCoeffSymQuant, int filtNo, int *filters_per_fr_best, int varIndTab[], imgpel **imgY_rec, imgpel **varImg, imgpel **maskImg, imgpel **imgY_pad, double lambda_val)
+Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double ySym[][MAX_SQR_FILT_LENGTH], double ESym[][MAX_SQR_FILT_TRI_LENGTH], double *pixAcc, int **filterCoeffSym, int **filterCoeffSymQuant, int filtNo, int *filters_per_fr_best, int varIndTab[], imgpel **imgY_rec, imgpel **varImg, imgpel **maskImg, imgpel **imgY_pad, double lambda_val)
 {
   int filters_per_fr, firstFilt, coded, forceCoeff0,
   interval[NO_VAR_BINS][2], intervalBest[NO_VAR_BINS][2];
-  int i, k, varInd;
-  static double ***E_temp, **y_temp, *pixAcc_temp;
+  int i, varInd;
   static int **FilterCoeffQuantTemp;
   double  error, lambda, lagrangian, lagrangianMin;
   
@@ -2466,9 +2570,6 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
   
   if (first==0)
   {
-    initMatrix3D_double(&E_temp, NO_VAR_BINS, MAX_SQR_FILT_LENGTH, MAX_SQR_FILT_LENGTH);
-    initMatrix_double(&y_temp, NO_VAR_BINS, MAX_SQR_FILT_LENGTH); 
-    pixAcc_temp = (double *) calloc(NO_VAR_BINS, sizeof(double));
     initMatrix_int(&FilterCoeffQuantTemp, NO_VAR_BINS, MAX_SQR_FILT_LENGTH);
     first=1;
   }
@@ -2479,13 +2580,7 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
   patternMap=m_patternMapTab[filtNo];  
   pattern=m_patternTab[filtNo];
   
-  memcpy(pixAcc_temp,pixAcc,sizeof(double)*NO_VAR_BINS);
-  for (varInd=0; varInd<NO_VAR_BINS; varInd++)
-  {
-    memcpy(y_temp[varInd],ySym[varInd],sizeof(double)*sqrFiltLength);
-    for (k=0; k<sqrFiltLength; k++)
-      memcpy(E_temp[varInd][k],ESym[varInd][k],sizeof(double)*sqrFiltLength);
-  }
+  xLoadClassStat(ESym, ySym, pixAcc, sqrFiltLength);
   
   // zero all variables 
   memset(varIndTab,0,sizeof(int)*NO_VAR_BINS);
@@ -2501,8 +2596,8 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
   
   while(filters_per_fr>=1)
   {
-    findFilterGroupingError(E_temp, y_temp, pixAcc_temp, interval, sqrFiltLength, filters_per_fr);
-    findFilterCoeff(E_temp, y_temp, pixAcc_temp, filterCoeffSym, filterCoeffSymQuant, interval,
+    findFilterGroupingError(interval, sqrFiltLength, filters_per_fr);
+    findFilterCoeff(filterCoeffSym, filterCoeffSymQuant, interval,
                     varIndTab, sqrFiltLength, filters_per_fr, weights, numBits=NUM_BITS,  errorForce0CoeffTab);
     lagrangian=xfindBestCoeffCodMethod(codedVarBins, &forceCoeff0, filterCoeffSymQuant, fl, 
                                        sqrFiltLength, filters_per_fr, errorForce0CoeffTab, &error, lambda);
@@ -2518,7 +2613,7 @@ Void TEncAdaptiveLoopFilter::xfindBestFilterVarPred(double **ySym, double ***ESy
     filters_per_fr--;
   }
   
-  findFilterCoeff(E_temp, y_temp, pixAcc_temp, filterCoeffSym, filterCoeffSymQuant, intervalBest,
+  findFilterCoeff(filterCoeffSym, filterCoeffSymQuant, intervalBest,
                   varIndTab, sqrFiltLength, (*filters_per_fr_best), weights, numBits=NUM_BITS, errorForce0CoeffTab);
   
   xfindBestCoeffCodMethod(codedVarBins, &forceCoeff0, filterCoeffSymQuant, fl, sqrFiltLength, 
@@ -2975,57 +3070,61 @@ Void TEncAdaptiveLoopFilter::xFilterTapDecision_qc(TComPicYuv* pcPicOrg, TComPic
     xCopyTmpAlfCtrlFlagsFrom();
   }
   
-  Bool bChanged = false;
-  for (Int iTap = ALF_MIN_NUM_TAP; iTap <= ALF_MAX_NUM_TAP; iTap += 2)
+  if (!m_pcBestAlfParam->cu_control_flag)
   {
-    copyALFParam(m_pcTempAlfParam, m_pcBestAlfParam);
-    m_pcTempAlfParam->tap = iTap;
+    Int    Height = pcPicOrg->getHeight();
+    Int    Width = pcPicOrg->getWidth();
+    for (Int i=0; i<Height; i++)
+    {
+      for (Int j=0; j<Width; j++)
+      {
+        m_maskImg[i][j] = 1;
+      }
+    }
+  }
+
+  // the tap length is chosen from estimated costs; only the selected tap is filtered and measured
+  Int iTap = xEstimateFilterTap_qc(pcPicOrg, pcPicDec);
+
+  Bool bChanged = false;
+  copyALFParam(m_pcTempAlfParam, m_pcBestAlfParam);
+  m_pcTempAlfParam->tap = iTap;
 #if TI_ALF_MAX_VSIZE_7
-    m_pcTempAlfParam->tapV = TComAdaptiveLoopFilter::ALFTapHToTapV(m_pcTempAlfParam->tap);
-    m_pcTempAlfParam->num_coeff = TComAdaptiveLoopFilter::ALFTapHToNumCoeff(m_pcTempAlfParam->tap); 
+  m_pcTempAlfParam->tapV = TComAdaptiveLoopFilter::ALFTapHToTapV(m_pcTempAlfParam->tap);
+  m_pcTempAlfParam->num_coeff = TComAdaptiveLoopFilter::ALFTapHToNumCoeff(m_pcTempAlfParam->tap); 
 #else
-    m_pcTempAlfParam->num_coeff = (Int)(iTap*iTap/4) + 2; 
+  m_pcTempAlfParam->num_coeff = (Int)(iTap*iTap/4) + 2; 
 #endif
-    
-    if (m_pcTempAlfParam->cu_control_flag)
-    {
-      xReDesignFilterCoeff_qc(pcPicOrg, pcPicDec, m_pcPicYuvTmp, false);
+  
+  if (m_pcTempAlfParam->cu_control_flag)
+  {
+    xReDesignFilterCoeff_qc(pcPicOrg, pcPicDec, m_pcPicYuvTmp, false);
 #if TSB_ALF_HEADER
-      xSetCUAlfCtrlFlags_qc(m_pcEntropyCoder->getMaxAlfCtrlDepth(), pcPicOrg, pcPicDec, m_pcPicYuvTmp, uiDist, m_pcTempAlfParam);
+    xSetCUAlfCtrlFlags_qc(m_pcEntropyCoder->getMaxAlfCtrlDepth(), pcPicOrg, pcPicDec, m_pcPicYuvTmp, uiDist, m_pcTempAlfParam);
 #else
-      xSetCUAlfCtrlFlags_qc(m_pcEntropyCoder->getMaxAlfCtrlDepth(), pcPicOrg, pcPicDec, m_pcPicYuvTmp, uiDist);
+    xSetCUAlfCtrlFlags_qc(m_pcEntropyCoder->getMaxAlfCtrlDepth(), pcPicOrg, pcPicDec, m_pcPicYuvTmp, uiDist);
 #endif
-      xCalcRDCost(m_pcTempAlfParam, uiRate, uiDist, dCost);
-    }
+    xCalcRDCost(m_pcTempAlfParam, uiRate, uiDist, dCost);
+  }
 
-    else
-    {
-      Int    Height = pcPicOrg->getHeight();
-      Int    Width = pcPicOrg->getWidth();
-      for (Int i=0; i<Height; i++)
-      {
-        for (Int j=0; j<Width; j++)
-        {
-          m_maskImg[i][j] = 1;
-        }
-      }
-      xReDesignFilterCoeff_qc(pcPicOrg, pcPicDec, m_pcPicYuvTmp, false);
+  else
+  {
+    xReDesignFilterCoeff_qc(pcPicOrg, pcPicDec, m_pcPicYuvTmp, false);
 
-      xCalcRDCost(pcPicOrg, m_pcPicYuvTmp, m_pcTempAlfParam, uiRate, uiDist, dCost);
-    }
+    xCalcRDCost(pcPicOrg, m_pcPicYuvTmp, m_pcTempAlfParam, uiRate, uiDist, dCost);
+  }
 
-    if (dCost < rdMinCost)
+  if (dCost < rdMinCost)
+  {
+    rdMinCost = dCost;
+    ruiMinDist = uiDist;
+    ruiMinRate = uiRate;
+    m_pcPicYuvTmp->copyToPicLuma(m_pcPicYuvBest);
+    copyALFParam(m_pcBestAlfParam, m_pcTempAlfParam);
+    bChanged = true;
+    if (m_pcTempAlfParam->cu_control_flag)
     {
-      rdMinCost = dCost;
-      ruiMinDist = uiDist;
-      ruiMinRate = uiRate;
-      m_pcPicYuvTmp->copyToPicLuma(m_pcPicYuvBest);
-      copyALFParam(m_pcBestAlfParam, m_pcTempAlfParam);
-      bChanged = true;
-      if (m_pcTempAlfParam->cu_control_flag)
-      {
-        xCopyTmpAlfCtrlFlagsFrom();
-      }
+      xCopyTmpAlfCtrlFlagsFrom();
     }
   }
   
@@ -3046,173 +3145,591 @@ Void TEncAdaptiveLoopFilter::xFilterTapDecision_qc(TComPicYuv* pcPicOrg, TComPic
   copyALFParam(m_pcTempAlfParam, m_pcBestAlfParam);
 }
 
+/** Estimate the best luma filter tap without filtering the picture.
+ * The 9x9 auto/cross-correlation is collected once under the current mask; the 7x7 and 5x5 statistics are
+ * taken out of it, and each tap is costed by its coefficient rate plus the distortion estimated from E and y.
+ * \returns the tap length with the lowest estimated cost
+ */
+Int TEncAdaptiveLoopFilter::xEstimateFilterTap_qc(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec)
+{
+  Int     Stride = pcPicOrg->getStride();
+  imgpel* ImgOrg = (imgpel*)pcPicOrg->getLumaAddr();
+  imgpel* ImgDec = (imgpel*)pcPicDec->getLumaAddr();
+  Double  dEstimatedMinCost;
 
-#define ROUND(a)  (((a) < 0)? (int)((a) - 0.5) : (int)((a) + 0.5))
-#define REG              0.0001
-#define REG_SQR          0.0000001
+#if MTK_NONCROSS_INLOOP_FILTER
+  if(!m_bUseNonCrossALF)
+    xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, ImgOrg, ImgDec, ALF_MAX_NUM_TAP, Stride);
+  else
+    xstoreInBlockMatrixforSlices(ImgOrg, ImgDec, ALF_MAX_NUM_TAP, Stride);
+#else
+  xstoreInBlockMatrix(ImgOrg, ImgDec, ALF_MAX_NUM_TAP, Stride);
+#endif
 
-//Find filter coeff related
-Int TEncAdaptiveLoopFilter::gnsCholeskyDec(double **inpMatr, double outMatr[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], int noEq)
-{ 
-  int 
-  i, j, k;     /* Looping Variables */
-  double 
-  scale;       /* scaling factor for each row */
-  double 
-  invDiag[MAX_SQR_FILT_LENGTH];  /* Vector of the inverse of diagonal entries of outMatr */
-  
-  
-  /*
-   *  Cholesky decomposition starts
-   */
-  
-  for(i = 0; i < noEq; i++)
+  return xEstimateFilterTapFromStat_qc(dEstimatedMinCost);
+}
+
+/** Estimate the best luma filter tap from the 9x9 statistics in m_EGlobalSym[0], m_yGlobalSym[0] and m_pixAcc.
+ * \param rdEstimatedMinCost estimated RD cost of the returned tap, distortion relative to the sum of squared originals
+ * \returns the tap length with the lowest estimated cost
+ */
+Int TEncAdaptiveLoopFilter::xEstimateFilterTapFromStat_qc(Double& rdEstimatedMinCost)
+{
+  Int     lambda_val = ((Int) m_dLambdaLuma) * (1<<(2*g_uiBitIncrement));
+  Int     filtNo, filters_per_fr;
+  Int     iBestTap = ALF_MAX_NUM_TAP;
+  Int64   iEstimatedDist;
+  UInt64  uiRate;
+  Double  dEstimatedCost, dEstimatedMinCost = MAX_DOUBLE;
+
+  m_iMatrixBaseFiltNo = 0;
+
+  for (Int iTap = ALF_MAX_NUM_TAP; iTap >= ALF_MIN_NUM_TAP; iTap -= 2)
   {
-    for(j = i; j < noEq; j++)
+    copyALFParam(m_pcTempAlfParam, m_pcBestAlfParam);
+    m_pcTempAlfParam->tap = iTap;
+#if TI_ALF_MAX_VSIZE_7
+    m_pcTempAlfParam->tapV      = TComAdaptiveLoopFilter::ALFTapHToTapV(iTap);
+    m_pcTempAlfParam->num_coeff = TComAdaptiveLoopFilter::ALFTapHToNumCoeff(iTap);
+#else
+    m_pcTempAlfParam->num_coeff = iTap*iTap/4 + 2;
+#endif
+    filtNo = (iTap == 9) ? 0 : ((iTap == 7) ? 1 : 2);
+
+    if (filtNo != m_iMatrixBaseFiltNo)
     {
-      /* Compute the scaling factor */
-      scale=inpMatr[i][j];
-      if ( i > 0) for( k = i - 1 ; k >= 0 ; k--)
-        scale -= outMatr[k][j] * outMatr[k][i];
-      
-      /* Compute i'th row of outMatr */
-      if(i==j)
+      xretriveBlockMatrix(m_pcTempAlfParam->num_coeff, m_iTapPosTabIn9x9Sym[filtNo], m_sqrFiltLengthTab[m_iMatrixBaseFiltNo],
+                          m_EGlobalSym[m_iMatrixBaseFiltNo], m_EGlobalSym[filtNo], 
+                          m_yGlobalSym[m_iMatrixBaseFiltNo], m_yGlobalSym[filtNo]);
+    }
+
+    xfindBestFilterVarPred(m_yGlobalSym[filtNo], m_EGlobalSym[filtNo], m_pixAcc, m_filterCoeffSym, m_filterCoeffSymQuant, filtNo, &filters_per_fr, 
+                           m_varIndTab, NULL, m_varImg, m_maskImg, NULL, lambda_val);
+
+    uiRate         = xcodeFiltCoeff(m_filterCoeffSymQuant, filtNo, m_varIndTab, filters_per_fr, 0, m_pcTempAlfParam);
+    iEstimatedDist = xEstimateFiltDist(filters_per_fr, m_varIndTab, m_EGlobalSym[filtNo], m_yGlobalSym[filtNo], m_filterCoeffSym, m_pcTempAlfParam->num_coeff);
+    dEstimatedCost = (Double)(uiRate) * m_dLambdaLuma + (Double)(iEstimatedDist);
+
+    if (dEstimatedCost < dEstimatedMinCost)
+    {
+      dEstimatedMinCost = dEstimatedCost;
+      iBestTap          = iTap;
+    }
+  }
+
+  rdEstimatedMinCost = dEstimatedMinCost;
+  return iBestTap;
+}
+
+#if MQT_ALF_NPASS
+/** Try the luma filters kept from the previous picture of the same temporal layer.
+ * The stored filters are applied as they are first, then refitted to this picture with the stored tap and class
+ * merging. A candidate is taken when it keeps ALF_REUSE_GAIN_RATIO of the gain of the last full design of the layer;
+ * CU on/off control and the tap decision are then skipped.
+ * \returns true when a reused filter was taken, m_pcBestAlfParam and pcPicRest hold the result
+ */
+Bool TEncAdaptiveLoopFilter::xTemporalReuseLuma_qc(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Double dOrigCost, UInt64& ruiMinRate, UInt64& ruiMinDist, Double& rdMinCost)
+{
+  UInt uiTLayer = m_pcPic->getTLayer();
+  if (!m_bALFTemporalReuse || m_eSliceType == I_SLICE || !m_abReuseValid[uiTLayer])
+  {
+    return false;
+  }
+
+  Int    filtNo         = m_aiReuseFiltNo[uiTLayer];
+  Int    filters_per_fr = m_aiReuseFiltersPerFr[uiTLayer];
+  Int    iTap           = (filtNo == 0) ? 9 : ((filtNo == 1) ? 7 : 5);
+  Double dMinGain       = m_adReuseGain[uiTLayer] * ALF_REUSE_GAIN_RATIO;
+  UInt64 uiRate, uiDist;
+  Double dCost;
+
+#if MQT_BA_RA
+  m_uiVarGenMethod = m_auiReuseVarMethod[uiTLayer];
+  m_varImg         = m_varImgMethods[m_uiVarGenMethod];
+#endif
+  setInitialMask(pcPicOrg, pcPicDec);
+
+  m_pcTempAlfParam->alf_flag            = 1;
+  m_pcTempAlfParam->cu_control_flag     = 0;
+  m_pcTempAlfParam->chroma_idc          = 0;
+  m_pcTempAlfParam->tap                 = iTap;
+#if TI_ALF_MAX_VSIZE_7
+  m_pcTempAlfParam->tapV                = TComAdaptiveLoopFilter::ALFTapHToTapV(iTap);
+  m_pcTempAlfParam->num_coeff           = TComAdaptiveLoopFilter::ALFTapHToNumCoeff(iTap);
+#else
+  m_pcTempAlfParam->num_coeff           = iTap*iTap/4 + 2;
+#endif
+#if MQT_BA_RA
+  m_pcTempAlfParam->alf_pcr_region_flag = m_uiVarGenMethod;
+#endif
+
+  ::memcpy(m_varIndTab, m_aaiReuseVarIndTab[uiTLayer], sizeof(Int)*NO_VAR_BINS);
+  for (Int i = 0; i < filters_per_fr; i++)
+  {
+    ::memcpy(m_filterCoeffSym[i],      m_aaaiReuseCoeff[uiTLayer][i], sizeof(Int)*MAX_SQR_FILT_LENGTH);
+    ::memcpy(m_filterCoeffSymQuant[i], m_aaaiReuseCoeff[uiTLayer][i], sizeof(Int)*MAX_SQR_FILT_LENGTH);
+  }
+  xFilterWithGroupCoeff_qc(pcPicOrg, pcPicDec, filtNo, filters_per_fr, uiRate, uiDist, dCost);
+
+  if (dOrigCost - dCost < dMinGain)
+  {
+    // refit the coefficients of the stored classes to this picture
+    Int    Stride = pcPicOrg->getStride();
+    imgpel* pOrg  = (imgpel*)pcPicOrg->getLumaAddr();
+    imgpel* pDec  = (imgpel*)pcPicDec->getLumaAddr();
+    Int    interval[NO_VAR_BINS][2];
+    double errorForce0CoeffTab[NO_VAR_BINS][2];
+
+#if MTK_NONCROSS_INLOOP_FILTER
+    if(!m_bUseNonCrossALF)
+      xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, pOrg, pDec, iTap, Stride);
+    else
+      xstoreInBlockMatrixforSlices(pOrg, pDec, iTap, Stride);
+#else
+    xstoreInBlockMatrix(pOrg, pDec, iTap, Stride);
+#endif
+    for (Int k = 0; k < NO_VAR_BINS; k++)
+    {
+      Int iGroup = m_varIndTab[k];
+      if (k == 0 || m_varIndTab[k-1] != iGroup)
       {
-        if(scale <= REG_SQR ) // if(scale <= 0 )  /* If inpMatr is singular */
-        {
-          return(0);
-        }
-        else              /* Normal operation */
-          invDiag[i] =  1.0/(outMatr[i][i]=sqrt(scale));
+        interval[iGroup][0] = k;
       }
-      else
-      {
-        outMatr[i][j] = scale*invDiag[i]; /* Upper triangular part          */
-        outMatr[j][i] = 0.0;              /* Lower triangular part set to 0 */
-      }                    
+      interval[iGroup][1] = k;
+    }
+    xLoadClassStat(m_EGlobalSym[filtNo], m_yGlobalSym[filtNo], m_pixAcc, m_sqrFiltLengthTab[filtNo]);
+    findFilterCoeff(m_filterCoeffSym, m_filterCoeffSymQuant, interval,
+                    m_varIndTab, m_sqrFiltLengthTab[filtNo], filters_per_fr, m_weightsTab[filtNo], NUM_BITS, errorForce0CoeffTab);
+    xFilterWithGroupCoeff_qc(pcPicOrg, pcPicDec, filtNo, filters_per_fr, uiRate, uiDist, dCost);
+
+    if (dOrigCost - dCost < dMinGain)
+    {
+      return false;
+    }
+    for (Int i = 0; i < filters_per_fr; i++)
+    {
+      ::memcpy(m_aaaiReuseCoeff[uiTLayer][i], m_filterCoeffSymQuant[i], sizeof(Int)*MAX_SQR_FILT_LENGTH);
     }
   }
-  return(1); /* Signal that Cholesky factorization is successfully performed */
+
+  ruiMinRate = uiRate;
+  ruiMinDist = uiDist;
+  rdMinCost  = dCost;
+  m_pcPicYuvTmp->copyToPicLuma(pcPicRest);
+  copyALFParam(m_pcBestAlfParam, m_pcTempAlfParam);
+  m_pcEntropyCoder->setAlfCtrl(false);
+  m_pcEntropyCoder->setMaxAlfCtrlDepth(0);
+
+  return true;
 }
 
+/** Filter the luma picture into m_pcPicYuvTmp with the filters of m_filterCoeffSym and m_varIndTab, code them into
+ * m_pcTempAlfParam and measure the RD cost
+ */
+Void TEncAdaptiveLoopFilter::xFilterWithGroupCoeff_qc(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, Int filtNo, Int filters_per_fr, UInt64& ruiRate, UInt64& ruiDist, Double& rdCost)
+{
+  Int     Stride = pcPicOrg->getStride();
+  imgpel* pDec   = (imgpel*)pcPicDec->getLumaAddr();
+  imgpel* pRest  = (imgpel*)m_pcPicYuvTmp->getLumaAddr();
 
-Void TEncAdaptiveLoopFilter::gnsTransposeBacksubstitution(double U[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], double rhs[], double x[], int order)
+  xcalcPredFilterCoeff(filtNo);
+#if MTK_NONCROSS_INLOOP_FILTER
+  if(!m_bUseNonCrossALF)
+    xfilterFrame_en(0, 0, m_im_height, m_im_width, pDec, pRest, filtNo, Stride);
+  else
+    xfilterSlices_en(pDec, pRest, filtNo, Stride);
+#else
+  xfilterFrame_en(pDec, pRest, filtNo, Stride);
+#endif
+  xcodeFiltCoeff(m_filterCoeffSymQuant, filtNo, m_varIndTab, filters_per_fr, 0, m_pcTempAlfParam);
+
+  xCalcRDCost(pcPicOrg, m_pcPicYuvTmp, m_pcTempAlfParam, ruiRate, ruiDist, rdCost);
+}
+
+/** Keep the luma filters of the current picture for the next picture of its temporal layer
+ * \param dGain RD gain of the filters over the unfiltered picture, 0 drops the stored filters
+ */
+Void TEncAdaptiveLoopFilter::xStoreTemporalReuse(Double dGain)
 {
-  int 
-  i,j;              /* Looping variables */
-  double 
-  sum;              /* Holds backsubstitution from already handled rows */
-  
-  /* Backsubstitution starts */
-  x[0] = rhs[0]/U[0][0];               /* First row of U'                   */
-  for (i = 1; i < order; i++)
-  {         /* For the rows 1..order-1           */
-    
-    for (j = 0, sum = 0.0; j < i; j++) /* Backsubst already solved unknowns */
-      sum += x[j]*U[j][i];
-    
-    x[i]=(rhs[i] - sum)/U[i][i];       /* i'th component of solution vect.  */
+  UInt      uiTLayer   = m_pcPic->getTLayer();
+  ALFParam* pcAlfParam = m_pcBestAlfParam;
+
+  if (dGain <= 0.0 || pcAlfParam->filtNo < 0)
+  {
+    m_abReuseValid[uiTLayer] = false;
+    return;
   }
+
+  reconstructFilterCoeffs(pcAlfParam, m_filterCoeffSym, NUM_BITS);
+  for (Int i = 0; i < pcAlfParam->filters_per_group; i++)
+  {
+    ::memset(m_aaaiReuseCoeff[uiTLayer][i], 0, sizeof(Int)*MAX_SQR_FILT_LENGTH);
+    ::memcpy(m_aaaiReuseCoeff[uiTLayer][i], m_filterCoeffSym[i], sizeof(Int)*pcAlfParam->num_coeff);
+  }
+
+  // the class merging is only signalled through filterPattern
+  m_aaiReuseVarIndTab[uiTLayer][0] = 0;
+  for (Int i = 1; i < NO_VAR_BINS; i++)
+  {
+    Int iNewGroup = (pcAlfParam->filters_per_group > 1 && pcAlfParam->filterPattern[i]) ? 1 : 0;
+    m_aaiReuseVarIndTab[uiTLayer][i] = m_aaiReuseVarIndTab[uiTLayer][i-1] + iNewGroup;
+  }
+
+  m_aiReuseFiltNo      [uiTLayer] = pcAlfParam->realfiltNo;
+  m_aiReuseFiltersPerFr[uiTLayer] = pcAlfParam->filters_per_group;
+#if MQT_BA_RA
+  m_auiReuseVarMethod  [uiTLayer] = pcAlfParam->alf_pcr_region_flag;
+#else
+  m_auiReuseVarMethod  [uiTLayer] = 0;
+#endif
+  m_adReuseGain        [uiTLayer] = dGain;
+  m_abReuseValid       [uiTLayer] = true;
 }
 
+/** Single-pass CTU-row ALF, start of a picture.
+ * The luma filter of a picture is designed from the statistics of the previously coded picture only, so the ALF
+ * header does not depend on the current picture and can be written before its first CTU. While the picture is coded,
+ * ALFProcessCtuRow() classifies, filters and measures it for the next design one CTU row at a time, so that no
+ * picture-wide analysis pass is needed. CU on/off control and chroma ALF stay off in this mode, both are decided on
+ * the whole current picture. Only one slice per picture is supported.
+ * \param pcAlfParam  output ALF parameters of the picture
+ * \param dLambda     lambda value of the luma design
+ */
+Void TEncAdaptiveLoopFilter::startCtuRowALF(ALFParam* pcAlfParam, Double dLambda)
+{
+  assert(m_bALFCtuRowMode);
+#if MTK_NONCROSS_INLOOP_FILTER
+  assert(!m_bUseNonCrossALF);
+#endif
+  Int tap = ALF_MAX_NUM_TAP;
+#if TI_ALF_MAX_VSIZE_7
+  Int tapV = TComAdaptiveLoopFilter::ALFTapHToTapV(tap);
+  Int num_coef = ((tap * tapV + 1) >> 1) + 1; // DC offset
+#else
+  Int num_coef = ((tap*tap+1)>>1) + 1;        // DC offset
+#endif
+
+  m_dLambdaLuma   = dLambda;
+  m_dLambdaChroma = dLambda;
+#if MQT_BA_RA
+  m_bVarImgValid = false;
+#endif
+  m_pcTempPicYuv->setBorderExtension( false );
+
+  m_pcBestAlfParam->alf_flag        = 0;
+  m_pcBestAlfParam->cu_control_flag = 0;
+
+  m_pcTempAlfParam->alf_flag        = 1;
+  m_pcTempAlfParam->tap             = tap;
+#if TI_ALF_MAX_VSIZE_7
+  m_pcTempAlfParam->tapV            = tapV;
+#endif
+  m_pcTempAlfParam->num_coeff       = num_coef;
+  m_pcTempAlfParam->chroma_idc      = 0;
+  m_pcTempAlfParam->cu_control_flag = 0;
 
+  setALFEncodingParam(m_pcPic);
+  xCtuRowDesignLuma_qc();
+  if (m_bCtuRowFilter)
+  {
+    copyALFParam(m_pcBestAlfParam, m_pcTempAlfParam);
+    predictALFCoeff(m_pcBestAlfParam);
+  }
+  else
+  {
+    m_pcBestAlfParam->alf_flag = 0;
+  }
+  copyALFParam(pcAlfParam, m_pcBestAlfParam);
+}
 
-Void  TEncAdaptiveLoopFilter::gnsBacksubstitution(double R[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], double z[MAX_SQR_FILT_LENGTH], int R_size, double A[MAX_SQR_FILT_LENGTH])
+/** Hand over CTU row iCtuRow once it is deblocked and SAO-processed; rows must come in increasing order.
+ * A row is classified, filtered and measured once the first ALF_WIN_MARGIN lines of the row below are available too,
+ * so row iCtuRow-1 is processed here, and the last row together with its predecessor.
+ */
+Void TEncAdaptiveLoopFilter::ALFProcessCtuRow(Int iCtuRow)
 {
-  int i, j;
-  double sum;
-  
-  R_size--;
-  
-  A[R_size] = z[R_size] / R[R_size][R_size];
-  
-  for (i = R_size-1; i >= 0; i--)
+  // the rows above are filtered in place already, the unfiltered samples are kept in m_pcTempPicYuv
+  m_pcPic->getPicYuvRec()->copyToPicCtuRow(m_pcTempPicYuv, iCtuRow);
+  m_pcTempPicYuv->extendPicBorderCtuRow(iCtuRow);
+
+  if (iCtuRow > 0)
   {
-    for (j = i+1, sum = 0.0; j <= R_size; j++)
-      sum += R[i][j] * A[j];
-    
-    A[i] = (z[i] - sum) / R[i][i];
+    xCtuRowFilterLuma_qc(iCtuRow - 1);
+  }
+  if (iCtuRow == m_pcTempPicYuv->getNumCtuRows() - 1)
+  {
+    xCtuRowFilterLuma_qc(iCtuRow);
   }
 }
 
+Void TEncAdaptiveLoopFilter::finishCtuRowALF()
+{
+#if MQT_BA_RA
+  m_bVarImgValid = true;
+#endif
+  xStoreRowStat();
+}
 
-Int TEncAdaptiveLoopFilter::gnsSolveByChol(double **LHS, double *rhs, double *x, int noEq)
-{ 
-  double aux[MAX_SQR_FILT_LENGTH];     /* Auxiliary vector */
-  double U[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH];    /* Upper triangular Cholesky factor of LHS */
-  int  i, singular;          /* Looping variable */
-  
-  /* The equation to be solved is LHSx = rhs */
-  
-  /* Compute upper triangular U such that U'*U = LHS */
-  if(gnsCholeskyDec(LHS, U, noEq)) /* If Cholesky decomposition has been successful */
+/** Luma filter of the current picture from the statistics of the previous one, m_pcTempAlfParam holds the result
+ * when m_bCtuRowFilter is set.
+ */
+Void TEncAdaptiveLoopFilter::xCtuRowDesignLuma_qc()
+{
+  Int     lambda_val = ((Int) m_dLambdaLuma) * (1<<(2*g_uiBitIncrement));
+  Int     filters_per_fr;
+
+  m_bCtuRowFilter = false;
+  m_iCtuRowFiltNo = 0;
+#if MQT_BA_RA
+  m_uiVarGenMethod = ALF_BA;
+  m_varImg         = m_varImgMethods[ALF_BA];
+  m_pcTempAlfParam->alf_pcr_region_flag = ALF_BA;
+#endif
+  for (Int y = 0; y < m_im_height; y++)
   {
-    singular=1;
-    /* Now, the equation is  U'*U*x = rhs, where U is upper triangular
-     * Solve U'*aux = rhs for aux
-     */
-    gnsTransposeBacksubstitution(U, rhs, aux, noEq);         
-    
-    /* The equation is now U*x = aux, solve it for x (new motion coefficients) */
-    gnsBacksubstitution(U, aux, noEq, x);   
-    
+    for (Int x = 0; x < m_im_width; x++)
+    {
+      m_maskImg[y][x] = 1;
+    }
   }
-  else /* LHS was singular */ 
+  m_pcEntropyCoder->setAlfCtrl(false);
+  m_pcEntropyCoder->setMaxAlfCtrlDepth(0);
+
+  if (!m_bRowStatValid)
   {
-    singular=0;
-    
-    /* Regularize LHS */
-    for(i=0; i<noEq; i++)
-      LHS[i][i] += REG;
-    /* Compute upper triangular U such that U'*U = regularized LHS */
-    singular = gnsCholeskyDec(LHS, U, noEq);
-    /* Solve  U'*aux = rhs for aux */  
-    gnsTransposeBacksubstitution(U, rhs, aux, noEq);   
-    
-    /* Solve U*x = aux for x */
-    gnsBacksubstitution(U, aux, noEq, x);
-  }  
-  return(singular);
+    return;
+  }
+
+  Int    aiCoeffNoFilter[MAX_SQR_FILT_LENGTH];
+  Int*   piCoeffNoFilter = aiCoeffNoFilter;
+  Int    aiVarIndTabNoFilter[NO_VAR_BINS];
+  Int    iNumCoeff9 = m_sqrFiltLengthTab[0];
+  Double dEstimatedCost, dEstimatedCostNoFilter;
+
+  xLoadRowStat();
+  copyALFParam(m_pcBestAlfParam, m_pcTempAlfParam);
+  Int iTap = xEstimateFilterTapFromStat_qc(dEstimatedCost);
+
+  // the unfiltered picture is the filter with only the centre tap
+  ::memset(aiCoeffNoFilter, 0, sizeof(Int)*MAX_SQR_FILT_LENGTH);
+  ::memset(aiVarIndTabNoFilter, 0, sizeof(Int)*NO_VAR_BINS);
+  aiCoeffNoFilter[iNumCoeff9-2] = 1<<(NUM_BITS-1);
+  dEstimatedCostNoFilter = (Double)xEstimateFiltDist(1, aiVarIndTabNoFilter, m_EGlobalSym[0], m_yGlobalSym[0], &piCoeffNoFilter, iNumCoeff9);
+
+  if (dEstimatedCost >= dEstimatedCostNoFilter)
+  {
+    return;
+  }
+  copyALFParam(m_pcTempAlfParam, m_pcBestAlfParam);
+  m_pcTempAlfParam->tap = iTap;
+#if TI_ALF_MAX_VSIZE_7
+  m_pcTempAlfParam->tapV      = TComAdaptiveLoopFilter::ALFTapHToTapV(iTap);
+  m_pcTempAlfParam->num_coeff = TComAdaptiveLoopFilter::ALFTapHToNumCoeff(iTap);
+#else
+  m_pcTempAlfParam->num_coeff = iTap*iTap/4 + 2;
+#endif
+  m_iCtuRowFiltNo = (iTap == 9) ? 0 : ((iTap == 7) ? 1 : 2);
+  xfindBestFilterVarPred(m_yGlobalSym[m_iCtuRowFiltNo], m_EGlobalSym[m_iCtuRowFiltNo], m_pixAcc, m_filterCoeffSym, m_filterCoeffSymQuant, m_iCtuRowFiltNo, &filters_per_fr, 
+                         m_varIndTab, NULL, m_varImg, m_maskImg, NULL, lambda_val);
+  xcodeFiltCoeff(m_filterCoeffSymQuant, m_iCtuRowFiltNo, m_varIndTab, filters_per_fr, 0, m_pcTempAlfParam);
+  xcalcPredFilterCoeff(m_iCtuRowFiltNo);
+  m_bCtuRowFilter = true;
+}
+
+/** Classification, filtering and statistics of the next design for CTU row iCtuRow
+ */
+Void TEncAdaptiveLoopFilter::xCtuRowFilterLuma_qc(Int iCtuRow)
+{
+  Int     Stride  = m_pcPic->getPicYuvOrg()->getStride();
+  imgpel* pOrg    = (imgpel*)m_pcPic->getPicYuvOrg()->getLumaAddr();
+  imgpel* pDec    = (imgpel*)m_pcTempPicYuv->getLumaAddr();
+  imgpel* pRest   = (imgpel*)m_pcPic->getPicYuvRec()->getLumaAddr();
+  Int     iRowY   = iCtuRow * g_uiMaxCUHeight;
+  Int     iHeight = min((Int)g_uiMaxCUHeight, m_im_height - iRowY);
+
+#if MTK_NONCROSS_INLOOP_FILTER
+  calcVar(iRowY, 0, m_varImg, pDec, 9/2, VAR_SIZE, iHeight, m_im_width, Stride);
+  if (m_bCtuRowFilter)
+  {
+    xfilterFrame_en(iRowY, 0, iHeight, m_im_width, pDec, pRest, m_iCtuRowFiltNo, Stride);
+  }
+  xstoreInBlockMatrix(iRowY, 0, iHeight, m_im_width, iRowY == 0, pOrg, pDec, ALF_MAX_NUM_TAP, Stride);
+#else
+  // without the row interfaces the whole picture is processed with its last row
+  if (iRowY + iHeight < m_im_height)
+  {
+    return;
+  }
+  calcVar(m_varImg, pDec, 9/2, VAR_SIZE, m_im_height, m_im_width, Stride);
+  if (m_bCtuRowFilter)
+  {
+    xfilterFrame_en(pDec, pRest, m_iCtuRowFiltNo, Stride);
+  }
+  xstoreInBlockMatrix(pOrg, pDec, ALF_MAX_NUM_TAP, Stride);
+#endif
 }
 
+/** Keep the 9x9 luma statistics of the current picture, m_EGlobalSym[0], m_yGlobalSym[0] and m_pixAcc, for the design
+ * of the next picture in CTU-row mode
+ */
+Void TEncAdaptiveLoopFilter::xStoreRowStat()
+{
+  Int iNumCoeff = m_sqrFiltLengthTab[0];
 
-//////////////////////////////////////////////////////////////////////////////////////////
+  for (Int varInd = 0; varInd < NO_VAR_BINS; varInd++)
+  {
+    ::memcpy(m_aadRowStatE[varInd], m_EGlobalSym[0][varInd], sizeof(Double)*TRI_LENGTH(iNumCoeff));
+    ::memcpy(m_aadRowStaty[varInd], m_yGlobalSym[0][varInd], sizeof(Double)*iNumCoeff);
+  }
+  ::memcpy(m_adRowStatPixAcc, m_pixAcc, sizeof(Double)*NO_VAR_BINS);
+  m_bRowStatValid = true;
+}
+
+/** Restore the statistics kept by xStoreRowStat into m_EGlobalSym[0], m_yGlobalSym[0] and m_pixAcc
+ */
+Void TEncAdaptiveLoopFilter::xLoadRowStat()
+{
+  Int iNumCoeff = m_sqrFiltLengthTab[0];
+
+  for (Int varInd = 0; varInd < NO_VAR_BINS; varInd++)
+  {
+    ::memcpy(m_EGlobalSym[0][varInd], m_aadRowStatE[varInd], sizeof(Double)*TRI_LENGTH(iNumCoeff));
+    ::memcpy(m_yGlobalSym[0][varInd], m_aadRowStaty[varInd], sizeof(Double)*iNumCoeff);
+  }
+  ::memcpy(m_pixAcc, m_adRowStatPixAcc, sizeof(Double)*NO_VAR_BINS);
+}
+#endif
 
 
-Void TEncAdaptiveLoopFilter::add_A(double **Amerged, double ***A, int start, int stop, int size)
-{ 
-  int
-  i, j, ind;          /* Looping variable */
+#define ROUND(a)  (((a) < 0)? (int)((a) - 0.5) : (int)((a) + 0.5))
+#define REG              0.0001
+#define REG_SQR          0.0000001
+
+//Find filter coeff related
+
+/** Solve LHS*x = rhs by Cholesky decomposition, LHS given as a packed upper triangle.
+ * N is the compile-time order (0: use noEq). A singular LHS is regularized in place and solved again.
+ * \returns 1 if the decomposition succeeded without regularization
+ */
+template<Int N>
+static Int gnsCholeskySolve(double *LHS, double *rhs, double *x, int noEq)
+{
+  const int n = N ? N : noEq;
+  double U[MAX_SQR_FILT_TRI_LENGTH];   /* Upper triangular Cholesky factor of LHS, packed */
+  double invDiag[MAX_SQR_FILT_LENGTH];
+  double aux[MAX_SQR_FILT_LENGTH];
+  double scale, sum;
+  int i, j, k, pass;
   
-  for (i=0; i<size; i++)
+  for (pass = 0; pass < 2; pass++)
   {
-    for (j=0; j<size; j++)
+    if (pass == 1)
+    {
+      /* LHS was singular: regularize */
+      for (i = 0; i < n; i++)
+        LHS[TRI_ROW(i, n) + i] += REG;
+    }
+    for (i = 0; i < n; i++)
     {
-      Amerged[i][j]=0;
-      for (ind=start; ind<=stop; ind++)
+      for (j = i; j < n; j++)
       {
-        Amerged[i][j]+=A[ind][i][j];
+        scale = LHS[TRI_ROW(i, n) + j];
+        for (k = i - 1; k >= 0; k--)
+          scale -= U[TRI_ROW(k, n) + j] * U[TRI_ROW(k, n) + i];
+        
+        if (i == j)
+        {
+          if (scale <= REG_SQR)
+            break;
+          invDiag[i] = 1.0/(U[TRI_ROW(i, n) + i] = sqrt(scale));
+        }
+        else
+          U[TRI_ROW(i, n) + j] = scale*invDiag[i];
       }
+      if (j < n)
+        break;
     }
+    if (i == n)
+      break;
+  }
+  if (pass == 2)
+  {
+    for (i = 0; i < n; i++)
+      x[i] = 0;
+    return 0;
+  }
+  
+  /* Solve U'*aux = rhs */
+  for (i = 0; i < n; i++)
+  {
+    for (j = 0, sum = 0.0; j < i; j++)
+      sum += aux[j]*U[TRI_ROW(j, n) + i];
+    aux[i] = (rhs[i] - sum)/U[TRI_ROW(i, n) + i];
   }
+  /* Solve U*x = aux */
+  for (i = n - 1; i >= 0; i--)
+  {
+    for (j = i + 1, sum = 0.0; j < n; j++)
+      sum += U[TRI_ROW(i, n) + j]*x[j];
+    x[i] = (aux[i] - sum)/U[TRI_ROW(i, n) + i];
+  }
+  return (pass == 0);
 }
 
-Void TEncAdaptiveLoopFilter::add_b(double *bmerged, double **b, int start, int stop, int size)
-{ 
-  int
-  i, ind;          /* Looping variable */
-  
-  for (i=0; i<size; i++)
+Int TEncAdaptiveLoopFilter::gnsSolveByChol(double *LHS, double *rhs, double *x, int noEq)
+{
+  switch (noEq)
   {
-    bmerged[i]=0;
-    for (ind=start; ind<=stop; ind++)
-    {
-      bmerged[i]+=b[ind][i];
-    }
+  case SQR_FILT_LENGTH_9SYM: return gnsCholeskySolve<SQR_FILT_LENGTH_9SYM>(LHS, rhs, x, noEq);
+  case SQR_FILT_LENGTH_7SYM: return gnsCholeskySolve<SQR_FILT_LENGTH_7SYM>(LHS, rhs, x, noEq);
+  case SQR_FILT_LENGTH_5SYM: return gnsCholeskySolve<SQR_FILT_LENGTH_5SYM>(LHS, rhs, x, noEq);
+  default:                   return gnsCholeskySolve<0>(LHS, rhs, x, noEq);
   }
 }
 
-double TEncAdaptiveLoopFilter::calculateErrorCoeffProvided(double **A, double *b, double *c, int size)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/** Pack per-class statistics into prefix sums over the variance classes.
+ * The statistics are integer valued, so any interval [start,stop] is recovered exactly by a difference of two prefixes.
+ */
+Void TEncAdaptiveLoopFilter::xLoadClassStat(double EGlobalSeq[][MAX_SQR_FILT_TRI_LENGTH], double yGlobalSeq[][MAX_SQR_FILT_LENGTH], double *pixAccGlobalSeq, int sqrFiltLength)
+{
+  int varInd, i, n;
+  int triLength = TRI_LENGTH(sqrFiltLength);
+  
+  memset(m_adPrefE[0], 0, sizeof(double)*MAX_SQR_FILT_TRI_LENGTH);
+  memset(m_adPrefy[0], 0, sizeof(double)*MAX_SQR_FILT_LENGTH);
+  m_adPrefPixAcc[0] = 0;
+  for (varInd = 0; varInd < NO_VAR_BINS; varInd++)
+  {
+    double *pPrev = m_adPrefE[varInd];
+    double *pCurr = m_adPrefE[varInd+1];
+    for (n = 0; n < triLength; n++)
+      pCurr[n] = pPrev[n] + EGlobalSeq[varInd][n];
+    for (i = 0; i < sqrFiltLength; i++)
+      m_adPrefy[varInd+1][i] = m_adPrefy[varInd][i] + yGlobalSeq[varInd][i];
+    m_adPrefPixAcc[varInd+1] = m_adPrefPixAcc[varInd] + pixAccGlobalSeq[varInd];
+  }
+  m_iPrefSqrFiltLength = sqrFiltLength;
+}
+
+Void TEncAdaptiveLoopFilter::xGetIntervalStat(int start, int stop, double *E, double *y, double *pixAcc)
+{
+  int i;
+  int sqrFiltLength = m_iPrefSqrFiltLength;
+  int triLength = sqrFiltLength*(sqrFiltLength+1)/2;
+  double *pLow  = m_adPrefE[start];
+  double *pHigh = m_adPrefE[stop+1];
+  
+  for (i = 0; i < triLength; i++)
+    E[i] = pHigh[i] - pLow[i];
+  for (i = 0; i < sqrFiltLength; i++)
+    y[i] = m_adPrefy[stop+1][i] - m_adPrefy[start][i];
+  *pixAcc = m_adPrefPixAcc[stop+1] - m_adPrefPixAcc[start];
+}
+
+double TEncAdaptiveLoopFilter::calculateErrorCoeffProvided(double *E, double *b, double *c, int size)
 {
   int i, j;
   double error, sum=0;
@@ -3220,22 +3737,23 @@ double TEncAdaptiveLoopFilter::calculateErrorCoeffProvided(double **A, double *b
   error=0;
   for (i=0; i<size; i++)   //diagonal
   {
+    double *pE = E + TRI_ROW(i, size);
     sum=0;
     for (j=i+1; j<size; j++)
-      sum+=(A[j][i]+A[i][j])*c[j];
-    error+=(A[i][i]*c[i]+sum-2*b[i])*c[i];
+      sum+=(2*pE[j])*c[j];
+    error+=(pE[i]*c[i]+sum-2*b[i])*c[i];
   }
   
   return(error);
 }
 
-double TEncAdaptiveLoopFilter::calculateErrorAbs(double **A, double *b, double y, int size)
+double TEncAdaptiveLoopFilter::calculateErrorAbs(double *E, double *b, double y, int size)
 {
   int i;
   double error, sum;
   double c[MAX_SQR_FILT_LENGTH];
   
-  gnsSolveByChol(A, b, c, size);
+  gnsSolveByChol(E, b, c, size);
   
   sum=0;
   for (i=0; i<size; i++)
@@ -3247,52 +3765,39 @@ double TEncAdaptiveLoopFilter::calculateErrorAbs(double **A, double *b, double y
   return(error);
 }
 
-double TEncAdaptiveLoopFilter::mergeFiltersGreedy(double **yGlobalSeq, double ***EGlobalSeq, double *pixAccGlobalSeq, int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int noIntervals)
+double TEncAdaptiveLoopFilter::calculateIntervalError(int start, int stop, int size)
 {
-  int first, ind, ind1, ind2, i, j, bestToMerge ;
-  double error, error1, error2, errorMin;
-  static double pixAcc_temp, error_tab[NO_VAR_BINS],error_comb_tab[NO_VAR_BINS];
-  static int indexList[NO_VAR_BINS], available[NO_VAR_BINS], noRemaining;
+  double E[MAX_SQR_FILT_TRI_LENGTH], y[MAX_SQR_FILT_LENGTH], pixAcc;
+  
+  xGetIntervalStat(start, stop, E, y, &pixAcc);
+  return calculateErrorAbs(E, y, pixAcc, size);
+}
+
+/** Greedy merge of adjacent variance classes down to noIntervals groups; statistics come from xLoadClassStat.
+ * The grouping is kept between calls, which must be made with noIntervals counting down from NO_FILTERS.
+ */
+double TEncAdaptiveLoopFilter::mergeFiltersGreedy(int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int noIntervals)
+{
+  int first, ind, bestToMerge;
+  double error, errorMin;
+  static double error_tab[NO_VAR_BINS], error_comb_tab[NO_VAR_BINS];
+  static int indexList[NO_VAR_BINS+1], noRemaining;
+  
+  // Try merging different matrices
   if (noIntervals == NO_FILTERS)
   {
     noRemaining=NO_VAR_BINS;
-    for (ind=0; ind<NO_VAR_BINS; ind++)
+    for (ind=0; ind<=NO_VAR_BINS; ind++)
     {
       indexList[ind]=ind; 
-      available[ind]=1;
-      m_pixAcc_merged[ind]=pixAccGlobalSeq[ind];
-      memcpy(m_y_merged[ind],yGlobalSeq[ind],sizeof(double)*sqrFiltLength);
-      for (i=0; i<sqrFiltLength; i++)
-      {
-        memcpy(m_E_merged[ind][i],EGlobalSeq[ind][i],sizeof(double)*sqrFiltLength);
-      }
     }
-  }
-  // Try merging different matrices
-  if (noIntervals == NO_FILTERS)
-  {
     for (ind=0; ind<NO_VAR_BINS; ind++)
     {
-      error_tab[ind]=calculateErrorAbs(m_E_merged[ind], m_y_merged[ind], m_pixAcc_merged[ind], sqrFiltLength);
+      error_tab[ind]=calculateIntervalError(ind, ind, sqrFiltLength);
     }
     for (ind=0; ind<NO_VAR_BINS-1; ind++)
     {
-      ind1=indexList[ind];
-      ind2=indexList[ind+1];
-      
-      error1=error_tab[ind1];
-      error2=error_tab[ind2];
-      
-      pixAcc_temp=m_pixAcc_merged[ind1]+m_pixAcc_merged[ind2];
-      for (i=0; i<sqrFiltLength; i++)
-      {
-        m_y_temp[i]=m_y_merged[ind1][i]+m_y_merged[ind2][i];
-        for (j=0; j<sqrFiltLength; j++)
-        {
-          m_E_temp[i][j]=m_E_merged[ind1][i][j]+m_E_merged[ind2][i][j];
-        }
-      }
-      error_comb_tab[ind1]=calculateErrorAbs(m_E_temp, m_y_temp, pixAcc_temp, sqrFiltLength)-error1-error2;
+      error_comb_tab[ind]=calculateIntervalError(ind, ind+1, sqrFiltLength)-error_tab[ind]-error_tab[ind+1];
     }
   }
   while (noRemaining>noIntervals)
@@ -3309,66 +3814,28 @@ double TEncAdaptiveLoopFilter::mergeFiltersGreedy(double **yGlobalSeq, double **
         first=0;
       }
     }
-    ind1=indexList[bestToMerge];
-    ind2=indexList[bestToMerge+1];
-    m_pixAcc_merged[ind1]+=m_pixAcc_merged[ind2];
-    for (i=0; i<sqrFiltLength; i++)
+    error_tab[indexList[bestToMerge]]=error_comb_tab[indexList[bestToMerge]]+error_tab[indexList[bestToMerge]]+error_tab[indexList[bestToMerge+1]];
+    
+    // indexList[noRemaining] stays NO_VAR_BINS, so indexList[ind+1]-1 is the end of group ind
+    for (ind=bestToMerge+1; ind<noRemaining; ind++)
     {
-      m_y_merged[ind1][i]+=m_y_merged[ind2][i];
-      for (j=0; j<sqrFiltLength; j++)
-      {
-        m_E_merged[ind1][i][j]+=m_E_merged[ind2][i][j];
-      }
+      indexList[ind]=indexList[ind+1];
     }
-    available[ind2]=0;
+    noRemaining--;
     
     //update error tables
-    error_tab[ind1]=error_comb_tab[ind1]+error_tab[ind1]+error_tab[ind2];
-    if (indexList[bestToMerge] > 0)
-    {
-      ind1=indexList[bestToMerge-1];
-      ind2=indexList[bestToMerge];
-      error1=error_tab[ind1];
-      error2=error_tab[ind2];
-      pixAcc_temp=m_pixAcc_merged[ind1]+m_pixAcc_merged[ind2];
-      for (i=0; i<sqrFiltLength; i++)
-      {
-        m_y_temp[i]=m_y_merged[ind1][i]+m_y_merged[ind2][i];
-        for (j=0; j<sqrFiltLength; j++)
-        {
-          m_E_temp[i][j]=m_E_merged[ind1][i][j]+m_E_merged[ind2][i][j];
-        }
-      }
-      error_comb_tab[ind1]=calculateErrorAbs(m_E_temp, m_y_temp, pixAcc_temp, sqrFiltLength)-error1-error2;
-    }
-    if (indexList[bestToMerge+1] < NO_VAR_BINS-1)
+    if (bestToMerge > 0)
     {
-      ind1=indexList[bestToMerge];
-      ind2=indexList[bestToMerge+2];
-      error1=error_tab[ind1];
-      error2=error_tab[ind2];
-      pixAcc_temp=m_pixAcc_merged[ind1]+m_pixAcc_merged[ind2];
-      for (i=0; i<sqrFiltLength; i++)
-      {
-        m_y_temp[i]=m_y_merged[ind1][i]+m_y_merged[ind2][i];
-        for (j=0; j<sqrFiltLength; j++)
-        {
-          m_E_temp[i][j]=m_E_merged[ind1][i][j]+m_E_merged[ind2][i][j];
-        }
-      }
-      error_comb_tab[ind1]=calculateErrorAbs(m_E_temp, m_y_temp, pixAcc_temp, sqrFiltLength)-error1-error2;
+      ind=bestToMerge-1;
+      error_comb_tab[indexList[ind]]=calculateIntervalError(indexList[ind], indexList[ind+2]-1, sqrFiltLength)
+                                     -error_tab[indexList[ind]]-error_tab[indexList[ind+1]];
     }
-    
-    ind=0;
-    for (i=0; i<NO_VAR_BINS; i++)
+    if (bestToMerge < noRemaining-1)
     {
-      if (available[i]==1)
-      {
-        indexList[ind]=i;
-        ind++;
-      }
+      ind=bestToMerge;
+      error_comb_tab[indexList[ind]]=calculateIntervalError(indexList[ind], indexList[ind+2]-1, sqrFiltLength)
+                                     -error_tab[indexList[ind]]-error_tab[indexList[ind+1]];
     }
-    noRemaining--;
   }
   
   
@@ -3378,26 +3845,23 @@ double TEncAdaptiveLoopFilter::mergeFiltersGreedy(double **yGlobalSeq, double **
     errorMin+=error_tab[indexList[ind]];
   }
   
-  for (ind=0; ind<noIntervals-1; ind++)
+  for (ind=0; ind<noIntervals; ind++)
   {
     intervalBest[ind][0]=indexList[ind]; intervalBest[ind][1]=indexList[ind+1]-1;
   }
   
-  intervalBest[noIntervals-1][0]=indexList[noIntervals-1]; 
-  intervalBest[noIntervals-1][1]=NO_VAR_BINS-1;
-  
   return(errorMin);
 }
 
 
 
-double TEncAdaptiveLoopFilter::findFilterGroupingError(double ***EGlobalSeq, double **yGlobalSeq, double *pixAccGlobalSeq, int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int filters_per_fr)
+double TEncAdaptiveLoopFilter::findFilterGroupingError(int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int filters_per_fr)
 {
   double error;
   
   // find best filters for each frame group
   error = 0;
-  error += mergeFiltersGreedy(yGlobalSeq, EGlobalSeq, pixAccGlobalSeq, intervalBest, sqrFiltLength, filters_per_fr);
+  error += mergeFiltersGreedy(intervalBest, sqrFiltLength, filters_per_fr);
   
   return(error);
 }
@@ -3418,7 +3882,7 @@ Void TEncAdaptiveLoopFilter::roundFiltCoeff(int *FilterCoeffQuan, double *Filter
   }
 }
 
-Double TEncAdaptiveLoopFilter::QuantizeIntegerFilterPP(double *filterCoeff, int *filterCoeffQuant, double **E, double *y, int sqrFiltLength, int *weights, int bit_depth)
+Double TEncAdaptiveLoopFilter::QuantizeIntegerFilterPP(double *filterCoeff, int *filterCoeffQuant, double *E, double *y, int sqrFiltLength, int *weights, int bit_depth)
 {
   double error;
   
@@ -3521,24 +3985,22 @@ Double TEncAdaptiveLoopFilter::QuantizeIntegerFilterPP(double *filterCoeff, int
   return(error);
 }
 
-Double TEncAdaptiveLoopFilter::findFilterCoeff(double ***EGlobalSeq, double **yGlobalSeq, double *pixAccGlobalSeq, int **filterCoeffSeq, int **filterCoeffQuantSeq, int intervalBest[NO_VAR_BINS][2], int varIndTab[NO_VAR_BINS], int sqrFiltLength, int filters_per_fr, int *weights, int bit_depth, double errorTabForce0Coeff[NO_VAR_BINS][2])
+/** Design the quantized filter of each interval from the statistics loaded by xLoadClassStat.
+ */
+Double TEncAdaptiveLoopFilter::findFilterCoeff(int **filterCoeffSeq, int **filterCoeffQuantSeq, int intervalBest[NO_VAR_BINS][2], int varIndTab[NO_VAR_BINS], int sqrFiltLength, int filters_per_fr, int *weights, int bit_depth, double errorTabForce0Coeff[NO_VAR_BINS][2])
 {
-  static double pixAcc_temp;
+  double pixAcc_temp;
+  double E_temp[MAX_SQR_FILT_TRI_LENGTH], y_temp[MAX_SQR_FILT_LENGTH];
   double error;
   int k, filtNo;
   
   error = 0;
   for(filtNo = 0; filtNo < filters_per_fr; filtNo++)
   {
-    add_A(m_E_temp, EGlobalSeq, intervalBest[filtNo][0], intervalBest[filtNo][1], sqrFiltLength);
-    add_b(m_y_temp, yGlobalSeq, intervalBest[filtNo][0], intervalBest[filtNo][1], sqrFiltLength);
-    
-    pixAcc_temp = 0;    
-    for(k = intervalBest[filtNo][0]; k <= intervalBest[filtNo][1]; k++)
-      pixAcc_temp += pixAccGlobalSeq[k];
+    xGetIntervalStat(intervalBest[filtNo][0], intervalBest[filtNo][1], E_temp, y_temp, &pixAcc_temp);
     
     // Find coeffcients
-    errorTabForce0Coeff[filtNo][1] = pixAcc_temp + QuantizeIntegerFilterPP(m_filterCoeff, m_filterCoeffQuant, m_E_temp, m_y_temp, sqrFiltLength, weights, bit_depth);
+    errorTabForce0Coeff[filtNo][1] = pixAcc_temp + QuantizeIntegerFilterPP(m_filterCoeff, m_filterCoeffQuant, E_temp, y_temp, sqrFiltLength, weights, bit_depth);
     errorTabForce0Coeff[filtNo][0] = pixAcc_temp;
     error += errorTabForce0Coeff[filtNo][1];
     
@@ -3655,6 +4117,11 @@ Void TEncAdaptiveLoopFilter::setInitialMask(TComPicYuv* pcPicOrg, TComPicYuv* pc
   Int LumaStride = pcPicOrg->getStride();
   imgpel* pDec = (imgpel*)pcPicDec->getLumaAddr();
 
+#if MQT_BA_RA
+  // the class map only depends on the decoded picture, all passes of a picture share it
+  if(m_uiVarGenMethod == ALF_BA && !m_bVarImgValid)
+  {
+#endif
 #if MTK_NONCROSS_INLOOP_FILTER
   if(!m_bUseNonCrossALF)
     calcVar(0, 0, m_varImg, pDec, 9/2, VAR_SIZE, Height, Width, LumaStride);
@@ -3663,6 +4130,10 @@ Void TEncAdaptiveLoopFilter::setInitialMask(TComPicYuv* pcPicOrg, TComPicYuv* pc
 #else
   calcVar(m_varImg, pDec, 9/2, VAR_SIZE, Height, Width, LumaStride);
 #endif
+#if MQT_BA_RA
+    m_bVarImgValid = true;
+  }
+#endif
 
   if(!m_iALFEncodePassReduction || !m_iUsePreviousFilter)
   {
@@ -3782,8 +4253,8 @@ Void  TEncAdaptiveLoopFilter::xFirstEstimateFilteringFrameLumaAllTap(imgpel* Img
                                                                      Int** ppiBestCoeffSet,
                                                                      Int& ibestfiltNo,
                                                                      Int& ibestfilters_per_fr,
-                                                                     Double**  ppdBesty,
-                                                                     Double*** pppdBestE,
+                                                                     Double    ppdBesty[][MAX_SQR_FILT_LENGTH],
+                                                                     Double    pppdBestE[][MAX_SQR_FILT_TRI_LENGTH],
                                                                      Double*   pdBestpixAcc,
                                                                      UInt64& ruiRate,
                                                                      Int64& riDist,
@@ -3797,7 +4268,8 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, im
   static Bool bFirst = true;
   static Int  aiVarIndTabBest[NO_VAR_BINS];
 #endif
-  static Double **ySym, ***ESym;
+  Double (*ySym)[MAX_SQR_FILT_LENGTH];
+  Double (*ESym)[MAX_SQR_FILT_TRI_LENGTH];
 #if !MQT_BA_RA
   static Int**  ppiBestCoeffSet;
 
@@ -3851,7 +4323,7 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, im
 
     if( bMatrixBaseReady )
     {
-      xretriveBlockMatrix(m_pcTempAlfParam->num_coeff, m_iTapPosTabIn9x9Sym[filtNo], 
+      xretriveBlockMatrix(m_pcTempAlfParam->num_coeff, m_iTapPosTabIn9x9Sym[filtNo], m_sqrFiltLengthTab[m_iMatrixBaseFiltNo],
                           m_EGlobalSym[m_iMatrixBaseFiltNo], ESym, 
                           m_yGlobalSym[m_iMatrixBaseFiltNo], ySym);
 
@@ -3860,7 +4332,7 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, im
 #if MTK_NONCROSS_INLOOP_FILTER
     {
       if(!m_bUseNonCrossALF)
-        xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, true, ImgOrg, ImgDec, iTap, Stride);
+        xstoreInBlockMatrix(0, 0, m_im_height, m_im_width, true, ImgOrg, ImgDec, iTap, Stride);
       else
         xstoreInBlockMatrixforSlices(ImgOrg, ImgDec, iTap, Stride);
     }
@@ -3918,27 +4390,12 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, im
 #if MQT_BA_RA
 
 
-  ::memset( pdBestpixAcc, 0,sizeof(double)*NO_VAR_BINS);
-  for (Int varInd=0; varInd<NO_VAR_BINS; varInd++)
-  {
-    ::memset(ppdBesty[varInd],0,sizeof(double)*MAX_SQR_FILT_LENGTH);
-    for (Int k=0; k< pcAlfSaved->num_coeff; k++)
-    {
-      ::memset(pppdBestE[varInd][k],0,sizeof(double)*MAX_SQR_FILT_LENGTH);
-    }
-  }
   ESym     = m_EGlobalSym     [filtNo];
   ySym     = m_yGlobalSym     [filtNo];
 
   ::memcpy( pdBestpixAcc, m_pixAcc ,sizeof(double)*NO_VAR_BINS);
-  for (Int varInd=0; varInd<NO_VAR_BINS; varInd++)
-  {
-    ::memcpy(ppdBesty[varInd],ySym[varInd],sizeof(double)*MAX_SQR_FILT_LENGTH);
-    for (Int k=0; k< pcAlfSaved->num_coeff; k++)
-    {
-      ::memcpy(pppdBestE[varInd][k],ESym[varInd][k],sizeof(double)*MAX_SQR_FILT_LENGTH);
-    }
-  }
+  ::memcpy( ppdBesty, ySym, sizeof(double)*NO_VAR_BINS*MAX_SQR_FILT_LENGTH);
+  ::memcpy( pppdBestE, ESym, sizeof(double)*NO_VAR_BINS*MAX_SQR_FILT_TRI_LENGTH);
 
 
 #else
@@ -3967,21 +4424,22 @@ Void   TEncAdaptiveLoopFilter::xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, im
 
 Void TEncAdaptiveLoopFilter::xretriveBlockMatrix(Int iNumTaps, 
                                                  Int* piTapPosInMaxFilter, 
-                                                 Double*** pppdEBase, Double*** pppdETarget, 
-                                                 Double**  ppdyBase,  Double** ppdyTarget )
+                                                 Int iNumTapsBase,
+                                                 Double pppdEBase[][MAX_SQR_FILT_TRI_LENGTH], Double pppdETarget[][MAX_SQR_FILT_TRI_LENGTH], 
+                                                 Double ppdyBase[][MAX_SQR_FILT_LENGTH],  Double ppdyTarget[][MAX_SQR_FILT_LENGTH] )
 {
   Int varInd;
   Int i, j, r, c;
 
-  Double** ppdSrcE;
-  Double** ppdDstE;
+  Double*  pdSrcE;
+  Double*  pdDstE;
   Double*  pdSrcy;
   Double*  pdDsty;
 
   for (varInd=0; varInd< NO_VAR_BINS; varInd++)
   {
-    ppdSrcE = pppdEBase  [varInd];
-    ppdDstE = pppdETarget[varInd];
+    pdSrcE  = pppdEBase  [varInd];
+    pdDstE  = pppdETarget[varInd];
     pdSrcy  = ppdyBase   [varInd];
     pdDsty  = ppdyTarget [varInd];
 
@@ -3993,8 +4451,8 @@ Void TEncAdaptiveLoopFilter::xretriveBlockMatrix(Int iNumTaps,
       {
         c = piTapPosInMaxFilter[i];
 
-        //auto-correlation retrieval
-        ppdDstE[j][i] = ppdSrcE[r][c];
+        //auto-correlation retrieval, both matrices are packed upper triangles
+        pdDstE[TRI_ROW(j, iNumTaps) + i] = (r <= c)? pdSrcE[TRI_ROW(r, iNumTapsBase) + c] : pdSrcE[TRI_ROW(c, iNumTapsBase) + r];
 
       }
 
@@ -4002,17 +4460,11 @@ Void TEncAdaptiveLoopFilter::xretriveBlockMatrix(Int iNumTaps,
       pdDsty[j] = pdSrcy[r];
 
     }
-
-    //symmetric copy
-    for(j=1; j< iNumTaps; j++)
-      for(i=0; i< j; i++)
-        ppdDstE[j][i] = ppdDstE[i][j];
-
   }
 
 }
 
-Int64 TEncAdaptiveLoopFilter::xFastFiltDistEstimation(Double** ppdE, Double* pdy, Int* piCoeff, Int iFiltLength)
+Int64 TEncAdaptiveLoopFilter::xFastFiltDistEstimation(Double* pdE, Double* pdy, Int* piCoeff, Int iFiltLength)
 {
   //static memory
   static Bool     bFirst = true;
@@ -4036,9 +4488,10 @@ Int64 TEncAdaptiveLoopFilter::xFastFiltDistEstimation(Double** ppdE, Double* pdy
   dDist =0;
   for(i=0; i< iFiltLength; i++)
   {
-    dsum= ((Double)ppdE[i][i]) * pdcoeff[i];
+    Double* pdERow = pdE + TRI_ROW(i, iFiltLength);
+    dsum= ((Double)pdERow[i]) * pdcoeff[i];
     for(j=i+1; j< iFiltLength; j++)
-      dsum += (Double)(2*ppdE[i][j])* pdcoeff[j];
+      dsum += (Double)(2*pdERow[j])* pdcoeff[j];
 
     dDist += ((dsum - 2.0 * pdy[i])* pdcoeff[i] );
   }
@@ -4059,49 +4512,41 @@ Int64 TEncAdaptiveLoopFilter::xFastFiltDistEstimation(Double** ppdE, Double* pdy
 }
 
 Int64 TEncAdaptiveLoopFilter::xEstimateFiltDist(Int filters_per_fr, Int* VarIndTab, 
-                                                Double*** pppdE, Double** ppdy, 
+                                                Double pppdE[][MAX_SQR_FILT_TRI_LENGTH], Double ppdy[][MAX_SQR_FILT_LENGTH], 
                                                 Int** ppiCoeffSet, Int iFiltLength)
 
 {
   Int64     iDist;
-  Double**  ppdDstE;
-  Double**  ppdSrcE;
+  Double*   pdDstE;
+  Double*   pdSrcE;
   Double*   pdDsty;  
   Double*   pdSrcy;
   Int       f, j, i, varInd;
   Int*      piCoeff;
+  Int       iTriLength = TRI_LENGTH(iFiltLength);
 
   //clean m_E_merged & m_y_merged
   for(f=0; f< filters_per_fr; f++)
   {
-    for(j =0; j < iFiltLength; j++)
-    {
-      //clean m_E_merged one line
-      for(i=0; i < iFiltLength; i++)
-        m_E_merged[f][j][i] = 0;
-
-      //clean m_y_merged
-      m_y_merged[f][j] = 0;
-    }
+    ::memset(m_E_merged[f], 0, sizeof(Double)*iTriLength);
+    ::memset(m_y_merged[f], 0, sizeof(Double)*iFiltLength);
   }
 
 
   //merge correlation values
   for (varInd=0; varInd< NO_VAR_BINS; varInd++)
   {
-    ppdSrcE = pppdE[varInd];
-    ppdDstE = m_E_merged[ VarIndTab[varInd] ];
+    pdSrcE  = pppdE[varInd];
+    pdDstE  = m_E_merged[ VarIndTab[varInd] ];
 
     pdSrcy  = ppdy[varInd];
     pdDsty  = m_y_merged[ VarIndTab[varInd] ];
 
-    for(j=0; j< iFiltLength; j++)
-    {
-      for(i=0; i< iFiltLength; i++)
-        ppdDstE[j][i] += ppdSrcE[j][i];
+    for(i=0; i< iTriLength; i++)
+      pdDstE[i] += pdSrcE[i];
 
+    for(j=0; j< iFiltLength; j++)
       pdDsty[j] += pdSrcy[j];
-    }
   }
 
   //estimate distortion reduction by using FFDE (JCTVC-C143)
@@ -4109,10 +4554,10 @@ Int64 TEncAdaptiveLoopFilter::xEstimateFiltDist(Int filters_per_fr, Int* VarIndT
   for(f=0; f< filters_per_fr; f++)
   {
     piCoeff = ppiCoeffSet[f];
-    ppdDstE = m_E_merged [f];
+    pdDstE  = m_E_merged [f];
     pdDsty  = m_y_merged [f];
 
-    iDist += xFastFiltDistEstimation(ppdDstE, pdDsty, piCoeff, iFiltLength);
+    iDist += xFastFiltDistEstimation(pdDstE, pdDsty, piCoeff, iFiltLength);
   }
 
 
@@ -4196,15 +4641,14 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrixforSlices(imgpel* ImgOrg, imgp
     CAlfSlice* pSlice = &(m_pSlice[s]);
     pSlice->copySliceLuma(pPicSlice, pPicSrc, iStride);
     pSlice->extendSliceBorderLuma(pPicSlice, iStride, (UInt)EXTEND_NUM_PEL);
-    xstoreInBlockMatrixforOneSlice(pSlice, ImgOrg, (imgpel*)pPicSlice, tap, iStride, (s==0), (s== m_uiNumSlicesInPic-1));
+    xstoreInBlockMatrixforOneSlice(pSlice, ImgOrg, (imgpel*)pPicSlice, tap, iStride, (s==0));
   }
 }
 
 Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrixforOneSlice(CAlfSlice* pSlice, 
                                                               imgpel* ImgOrg, imgpel* ImgDec, 
                                                               Int tap, Int iStride, 
-                                                              Bool bFirstSlice, 
-                                                              Bool bLastSlice
+                                                              Bool bFirstSlice
                                                               )
 {
 
@@ -4213,12 +4657,11 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrixforOneSlice(CAlfSlice* pSlice,
 
   Int iHeight, iWidth;
   Int ypos, xpos;
-  Bool bFirstLCU, bLastLCU;
+  Bool bFirstLCU;
 
   for(UInt i=0; i< uiNumLCUs; i++)
   {
     bFirstLCU = (i==0);
-    bLastLCU  = (i== uiNumLCUs -1);
 
     CAlfCU* pcAlfCU = &((*pSlice)[i]);
     ypos    = pcAlfCU->getCU()->getCUPelY();
@@ -4227,7 +4670,7 @@ Void   TEncAdaptiveLoopFilter::xstoreInBlockMatrixforOneSlice(CAlfSlice* pSlice,
     iWidth  = pcAlfCU->getWidth();
 
     xstoreInBlockMatrix(ypos, xpos, iHeight, iWidth, 
-      (bFirstSlice && bFirstLCU),(bLastSlice && bLastLCU),
+      (bFirstSlice && bFirstLCU),
       ImgOrg, ImgDec,tap, iStride);
   }
 }
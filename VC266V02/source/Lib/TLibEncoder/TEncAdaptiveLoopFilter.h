@@ -102,6 +102,15 @@ private:
   Double** m_ppdAlfCorr;
   Double* m_pdDoubleAlfCoeff;
   
+  /// stage of the encoder, after the common ones: item = chroma plane, correlation and unfiltered SSD
+  enum EncParallelStage
+  {
+    ALF_STAGE_CHROMA_CORR = NUM_ALF_BASE_STAGES
+  };
+  TComPicYuv* m_pcParallelPicOrg;                                         ///< original picture of #ALF_STAGE_CHROMA_CORR
+  Int64       m_aaiChromaCorr[2][ALF_MAX_NUM_COEF*(ALF_MAX_NUM_COEF+1)];  ///< correlation of Cb and Cr, see xCalcCorrelationFuncChroma()
+  UInt64      m_auiChromaOrgDist[2];                                      ///< SSD of the unfiltered Cb and Cr
+  
   SliceType m_eSliceType;
   Int m_iPicNalReferenceIdc;
   
@@ -120,26 +129,34 @@ private:
   UInt m_uiNumSCUInCU;
   
   Int m_varIndTab[NO_VAR_BINS];
-  double ***m_yGlobalSym;
-  double ****m_EGlobalSym;
-  double *m_pixAcc;
+  // luma statistics per filter support and variance class, allocated once in createAlfGlobalBuffers;
+  // E is a packed upper triangle of order m_sqrFiltLengthTab[filtNo], element (i,j), j>=i, at [TRI_ROW(i,n)+j]
+  Double (*m_yGlobalSym)[NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  Double (*m_EGlobalSym)[NO_VAR_BINS][MAX_SQR_FILT_TRI_LENGTH];
+  Double *m_pixAcc;
   Int **m_filterCoeffSymQuant;
   imgpel **m_varImg;
+#if MQT_BA_RA
+  Bool m_bVarImgValid;                ///< BA class map of the current picture is computed
+#endif
   imgpel **m_maskImg;
   Int m_im_width;
   Int m_im_height;
   ALFParam *m_tempALFp;
   TEncEntropy* m_pcDummyEntropyCoder;
   
-  double **m_y_merged;
-  double ***m_E_merged;
-  double *m_pixAcc_merged;
-  double *m_y_temp;
-  double **m_E_temp;
+  Double (*m_y_merged)[MAX_SQR_FILT_LENGTH];
+  Double (*m_E_merged)[MAX_SQR_FILT_TRI_LENGTH];
   
-  Int *m_filterCoeffQuantMod;
-  double *m_filterCoeff;
-  Int *m_filterCoeffQuant;
+  // luma filter design statistics: packed upper triangles, prefix-summed over variance classes
+  Double m_adPrefE[NO_VAR_BINS+1][MAX_SQR_FILT_TRI_LENGTH];
+  Double m_adPrefy[NO_VAR_BINS+1][MAX_SQR_FILT_LENGTH];
+  Double m_adPrefPixAcc[NO_VAR_BINS+1];
+  Int    m_iPrefSqrFiltLength;
+  
+  Int m_filterCoeffQuantMod[MAX_SQR_FILT_LENGTH];
+  double m_filterCoeff[MAX_SQR_FILT_LENGTH];
+  Int m_filterCoeffQuant[MAX_SQR_FILT_LENGTH];
   Int **m_diffFilterCoeffQuant;
   Int **m_FilterCoeffQuantTemp;
   
@@ -156,6 +173,21 @@ private:
   Int  m_iGOPSize;
   Int  m_iCurrentPOC;
   Int  m_iALFEncodePassReduction;
+  Bool   m_bALFTemporalReuse;                                          ///< start from the filters of the previous picture of the same layer
+  Bool   m_abReuseValid       [MAX_TLAYER];
+  Int    m_aiReuseFiltNo      [MAX_TLAYER];
+  Int    m_aiReuseFiltersPerFr[MAX_TLAYER];
+  UInt   m_auiReuseVarMethod  [MAX_TLAYER];
+  Int    m_aaiReuseVarIndTab  [MAX_TLAYER][NO_VAR_BINS];
+  Int    m_aaaiReuseCoeff     [MAX_TLAYER][NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  Double m_adReuseGain        [MAX_TLAYER];                          ///< luma RD gain of the last full design of the layer
+  Bool   m_bALFCtuRowMode;                                             ///< design from the previous picture, filter row by row in one pass
+  Bool   m_bRowStatValid;
+  Bool   m_bCtuRowFilter;                                              ///< luma filter of the current picture is on
+  Int    m_iCtuRowFiltNo;
+  Double m_aadRowStatE        [NO_VAR_BINS][MAX_SQR_FILT_TRI_LENGTH];  ///< 9x9 luma statistics of the previous picture, packed
+  Double m_aadRowStaty        [NO_VAR_BINS][MAX_SQR_FILT_LENGTH];
+  Double m_adRowStatPixAcc    [NO_VAR_BINS];
   Int  m_iALFNumOfRedesign;
   Int  m_iMatrixBaseFiltNo;
 
@@ -194,6 +226,8 @@ private:
 #else
   Void xCalcCorrelationFunc   ( Pel* pOrg, Pel* pCmp, Int iTap, Int iWidth, Int iHeight, Int iOrgStride, Int iCmpStride);
 #endif
+  Void xCalcCorrelationFuncChroma( Pel* pOrg, Pel* pCmp, Int iTap, Int iWidth, Int iHeight, Int iOrgStride, Int iCmpStride, Int64* piCorr, UInt64& ruiSSD );
+  static const Int* xGetSymmetricArray( Int iTap );
 
   // functions related to filtering
   Void xFilterCoefQuickSort   ( Double *coef_data, Int *coef_num, Int upper, Int lower );
@@ -201,7 +235,7 @@ private:
   Void xClearFilterCoefInt    ( Int* qh, Int N );
   Void xCopyDecToRestCUs      ( TComPicYuv* pcPicDec, TComPicYuv* pcPicRest );
   Void xCopyDecToRestCU       ( TComDataCU* pcCU, UInt uiAbsPartIdx, UInt uiDepth, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest );
-  Void xFilteringFrameChroma  ( TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest );
+  Void xFilteringFrameChroma  ( TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, UInt64* puiOrgDist = NULL );
   
   // distortion / misc functions
   UInt64 xCalcSSD             ( Pel* pOrg, Pel* pCmp, Int iWidth, Int iHeight, Int iStride );
@@ -211,24 +245,26 @@ private:
   Int    xGauss               ( Double **a, Int N );
   
 #if MQT_ALF_NPASS
-  Void  xretriveBlockMatrix    (Int iNumTaps, Int* piTapPosInMaxFilter, Double*** pppdEBase, Double*** pppdETarget, Double** ppdyBase, Double** ppdyTarget );
+  Void  xretriveBlockMatrix    (Int iNumTaps, Int* piTapPosInMaxFilter, Int iNumTapsBase,
+                                Double pppdEBase[][MAX_SQR_FILT_TRI_LENGTH], Double pppdETarget[][MAX_SQR_FILT_TRI_LENGTH],
+                                Double ppdyBase[][MAX_SQR_FILT_LENGTH], Double ppdyTarget[][MAX_SQR_FILT_LENGTH] );
   Void  xcalcPredFilterCoeffPrev(Int filtNo);
   Void  setALFEncodingParam(TComPic *pcPic);
   Void  setFilterIdx(Int index);
   Void  setInitialMask(TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec);
 #if MQT_BA_RA
-  Void  xFirstEstimateFilteringFrameLumaAllTap(imgpel* ImgOrg, imgpel* ImgDec, Int Stride, ALFParam* pcAlfSaved,Int* aiVarIndTabBest,Int** ppiBestCoeffSet, Int& ibestfiltNo,Int& ibestfilters_per_fr, Double** ppdBesty,Double*** pppdBestE,Double* pdBestpixAcc,UInt64& ruiRate,Int64& riDist,Double& rdCost);  
+  Void  xFirstEstimateFilteringFrameLumaAllTap(imgpel* ImgOrg, imgpel* ImgDec, Int Stride, ALFParam* pcAlfSaved,Int* aiVarIndTabBest,Int** ppiBestCoeffSet, Int& ibestfiltNo,Int& ibestfilters_per_fr, Double ppdBesty[][MAX_SQR_FILT_LENGTH],Double pppdBestE[][MAX_SQR_FILT_TRI_LENGTH],Double* pdBestpixAcc,UInt64& ruiRate,Int64& riDist,Double& rdCost);  
 #else
   Void  xFirstFilteringFrameLumaAllTap(imgpel* ImgOrg, imgpel* ImgDec, imgpel* ImgRest, Int Stride);
 #endif
-  Int64 xFastFiltDistEstimation(Double** ppdE, Double* pdy, Int* piCoeff, Int iFiltLength);
-  Int64 xEstimateFiltDist      (Int filters_per_fr, Int* VarIndTab, Double*** pppdE, Double** ppdy, Int** ppiCoeffSet, Int iFiltLength);
+  Int64 xFastFiltDistEstimation(Double* pdE, Double* pdy, Int* piCoeff, Int iFiltLength);
+  Int64 xEstimateFiltDist      (Int filters_per_fr, Int* VarIndTab, Double pppdE[][MAX_SQR_FILT_TRI_LENGTH], Double ppdy[][MAX_SQR_FILT_LENGTH], Int** ppiCoeffSet, Int iFiltLength);
 #endif
 
 
 #if MTK_NONCROSS_INLOOP_FILTER
   Void xstoreInBlockMatrixforSlices  (imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int iStride);
-  Void xstoreInBlockMatrixforOneSlice(CAlfSlice* pSlice, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int iStride, Bool bFirstSlice, Bool bLastSlice);
+  Void xstoreInBlockMatrixforOneSlice(CAlfSlice* pSlice, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int iStride, Bool bFirstSlice);
   Void xfilterSlices_en              (imgpel* ImgDec, imgpel* ImgRest,int filtNo, int Stride);
   Void xfilterOneSlice_en            (CAlfSlice* pSlice, imgpel* ImgDec, imgpel* ImgRest,int filtNo, int iStride);
   Void calcVarforSlices              (imgpel **varmap, imgpel *imgY_pad, Int pad_size, Int fl, Int img_stride);
@@ -247,6 +283,8 @@ public:
   TEncAdaptiveLoopFilter          ();
   virtual ~TEncAdaptiveLoopFilter () {}
   
+  virtual Void runItem( Int itemIdx, Int threadIdx );
+  
   /// allocate temporal memory
   Void startALFEnc(TComPic* pcPic, TEncEntropy* pcEntropyCoder);
   
@@ -255,6 +293,14 @@ public:
   
   /// estimate ALF parameters
   Void ALFProcess(ALFParam* pcAlfParam, Double dLambda, UInt64& ruiDist, UInt64& ruiBits, UInt& ruiMaxAlfCtrlDepth );
+#if MQT_ALF_NPASS
+  /// CTU-row mode: luma filter of the picture from the statistics of the previous picture, before its first CTU
+  Void startCtuRowALF(ALFParam* pcAlfParam, Double dLambda);
+  /// CTU-row mode: hand over reconstructed CTU row iCtuRow, filters the rows that are complete
+  Void ALFProcessCtuRow(Int iCtuRow);
+  /// CTU-row mode: keep the statistics of the picture for the next design
+  Void finishCtuRowALF();
+#endif
   /// test ALF for luma
   Void xEncALFLuma_qc                  ( TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, UInt64& ruiMinRate, 
                                          UInt64& ruiMinDist, Double& rdMinCost );
@@ -274,9 +320,22 @@ public:
   Void xReDesignFilterCoeff_qc          (TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec,  TComPicYuv* pcPicRest, Bool bReadCorr);
   Void xFilterTapDecision_qc            (TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, UInt64& ruiMinRate, 
                                          UInt64& ruiMinDist, Double& rdMinCost);
+  Int  xEstimateFilterTap_qc            (TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec);
+  Int  xEstimateFilterTapFromStat_qc    (Double& rdEstimatedMinCost);
+#if MQT_ALF_NPASS
+  Bool xTemporalReuseLuma_qc            (TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, TComPicYuv* pcPicRest, Double dOrigCost,
+                                         UInt64& ruiMinRate, UInt64& ruiMinDist, Double& rdMinCost);
+  Void xFilterWithGroupCoeff_qc         (TComPicYuv* pcPicOrg, TComPicYuv* pcPicDec, Int filtNo, Int filters_per_fr,
+                                         UInt64& ruiRate, UInt64& ruiDist, Double& rdCost);
+  Void xStoreTemporalReuse              (Double dGain);
+  Void xCtuRowDesignLuma_qc             ();
+  Void xCtuRowFilterLuma_qc             (Int iCtuRow);
+  Void xStoreRowStat                    ();
+  Void xLoadRowStat                     ();
+#endif
   Void xFirstFilteringFrameLuma         (imgpel* ImgOrg, imgpel* ImgDec, imgpel* ImgRest, ALFParam* ALFp, Int tap,  Int Stride);
 #if MTK_NONCROSS_INLOOP_FILTER
-  Void xstoreInBlockMatrix(Int ypos, Int xpos, Int iheight, Int iwidth, Bool bResetBlockMatrix, Bool bSymmCopyBlockMatrix, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride);
+  Void xstoreInBlockMatrix(Int ypos, Int xpos, Int iheight, Int iwidth, Bool bResetBlockMatrix, imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride);
 #else
   Void xstoreInBlockMatrix(imgpel* ImgOrg, imgpel* ImgDec, Int tap, Int Stride);
 #endif
@@ -292,7 +351,7 @@ public:
 #else
   Void xcodeFiltCoeff(Int **filterCoeffSymQuant, Int filtNo, Int varIndTab[], Int filters_per_fr_best, Int frNo, ALFParam* ALFp);
 #endif
-  Void xfindBestFilterVarPred(double **ySym, double ***ESym, double *pixAcc, Int **filterCoeffSym, Int **filterCoeffSymQuant,
+  Void xfindBestFilterVarPred(double ySym[][MAX_SQR_FILT_LENGTH], double ESym[][MAX_SQR_FILT_TRI_LENGTH], double *pixAcc, Int **filterCoeffSym, Int **filterCoeffSymQuant,
                               Int filtNo, Int *filters_per_fr_best, Int varIndTab[], imgpel **imgY_rec, imgpel **varImg, 
                               imgpel **maskImg, imgpel **imgY_pad, double lambda_val);
   double xfindBestCoeffCodMethod(int codedVarBins[NO_VAR_BINS], int *forceCoeff0, 
@@ -315,29 +374,24 @@ public:
   Int lengthFilterCoeffs(int sqrFiltLength, int filters_per_group, int pDepthInt[], 
                          int **FilterCoeff, int kMinTab[], int createBitstream);
   //cholesky related
-  Double findFilterCoeff(double ***EGlobalSeq, double **yGlobalSeq, double *pixAccGlobalSeq, int **filterCoeffSeq,
-                         int **filterCoeffQuantSeq, int intervalBest[NO_VAR_BINS][2], int varIndTab[NO_VAR_BINS], int sqrFiltLength, 
-                         int filters_per_fr, int *weights, int bit_depth, double errorTabForce0Coeff[NO_VAR_BINS][2]);
-  Double QuantizeIntegerFilterPP(double *filterCoeff, int *filterCoeffQuant, double **E, double *y, 
+  Void xLoadClassStat(double EGlobalSeq[][MAX_SQR_FILT_TRI_LENGTH], double yGlobalSeq[][MAX_SQR_FILT_LENGTH], double *pixAccGlobalSeq, int sqrFiltLength);
+  Void xGetIntervalStat(int start, int stop, double *E, double *y, double *pixAcc);
+  Double findFilterCoeff(int **filterCoeffSeq, int **filterCoeffQuantSeq, int intervalBest[NO_VAR_BINS][2], int varIndTab[NO_VAR_BINS], 
+                         int sqrFiltLength, int filters_per_fr, int *weights, int bit_depth, double errorTabForce0Coeff[NO_VAR_BINS][2]);
+  Double QuantizeIntegerFilterPP(double *filterCoeff, int *filterCoeffQuant, double *E, double *y, 
                                  int sqrFiltLength, int *weights, int bit_depth);
   Void roundFiltCoeff(int *FilterCoeffQuan, double *FilterCoeff, int sqrFiltLength, int factor);
-  double findFilterGroupingError(double ***EGlobalSeq, double **yGlobalSeq, double *pixAccGlobalSeq, 
-                                 int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int filters_per_fr);
-  double mergeFiltersGreedy(double **yGlobalSeq, double ***EGlobalSeq, double *pixAccGlobalSeq, 
-                            int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int noIntervals);
-  double calculateErrorAbs(double **A, double *b, double y, int size);
-  double calculateErrorCoeffProvided(double **A, double *b, double *c, int size);
-  Void add_b(double *bmerged, double **b, int start, int stop, int size);
-  Void add_A(double **Amerged, double ***A, int start, int stop, int size);
-  Int gnsSolveByChol(double **LHS, double *rhs, double *x, int noEq);
-  Void  gnsBacksubstitution(double R[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], double z[MAX_SQR_FILT_LENGTH], 
-                            int R_size, double A[MAX_SQR_FILT_LENGTH]);
-  Void gnsTransposeBacksubstitution(double U[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], double rhs[], double x[],
-                                    int order);
-  Int gnsCholeskyDec(double **inpMatr, double outMatr[MAX_SQR_FILT_LENGTH][MAX_SQR_FILT_LENGTH], int noEq);
+  double findFilterGroupingError(int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int filters_per_fr);
+  double mergeFiltersGreedy(int intervalBest[NO_VAR_BINS][2], int sqrFiltLength, int noIntervals);
+  double calculateErrorAbs(double *E, double *b, double y, int size);
+  double calculateIntervalError(int start, int stop, int size);
+  double calculateErrorCoeffProvided(double *E, double *b, double *c, int size);
+  Int gnsSolveByChol(double *LHS, double *rhs, double *x, int noEq);
 #if MQT_ALF_NPASS
   Void  setGOPSize(Int val) { m_iGOPSize = val; }
   Void  setALFEncodePassReduction (Int iVal) {m_iALFEncodePassReduction = iVal;}
+  Void  setALFTemporalReuse       (Bool b)   {m_bALFTemporalReuse = b;}
+  Void  setALFCtuRowMode          (Bool b)   {m_bALFCtuRowMode = b;}
 
 #if MQT_BA_RA
   Void createAlfGlobalBuffers(Int iALFEncodePassReduction);
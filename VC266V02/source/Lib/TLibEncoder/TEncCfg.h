@@ -104,6 +104,8 @@ protected:
   Int       m_iSourceHeight;
   Window    m_conformanceWindow;
   Int       m_framesToBeEncoded;
+  Int       m_numWorkerThreads;
+  Bool      m_bAsyncMetrics;
 
   /* profile & level */
   Profile::Name m_profile;
@@ -168,6 +170,11 @@ protected:
   Bool      m_useFastDecisionForMerge;
   Bool      m_bUseCbfFastMode;
   Bool      m_useEarlySkipDetection;
+  Bool      m_useFastIntraSearch;
+  Bool      m_useFastCUSplit;
+  Double    m_fastCUSplitScale;
+  Bool      m_useFastMergeRD;
+  Int       m_fastMergeRDCands;
   Bool      m_useTransformSkip;
   Bool      m_useTransformSkipFast;
   Int*      m_aidQP;
@@ -176,6 +183,8 @@ protected:
   Bool      m_bUseALF;
 #if MQT_ALF_NPASS
   Int       m_iALFEncodePassReduction;
+  Bool      m_bALFTemporalReuse;
+  Bool      m_bALFCtuRowMode;
 #endif
 #endif
 
@@ -198,6 +207,7 @@ protected:
   //====== Weighted Prediction ========
   Bool      m_useWeightedPred;       //< Use of Weighting Prediction (P_SLICE)
   Bool      m_useWeightedBiPred;    //< Use of Bi-directional Weighting Prediction (B_SLICE)
+  Int       m_iWPSADSubsample;      //< sample and line step of the SAD check of the WP parameters
   UInt      m_log2ParallelMergeLevelMinus2;       ///< Parallel merge estimation region
   UInt      m_maxNumMergeCand;                    ///< Maximum number of merge candidates
   Int       m_TMVPModeId;
@@ -209,6 +219,9 @@ protected:
   Bool      m_RCUseLCUSeparateModel;
   Int       m_RCInitialQP;
   Bool      m_RCForceIntraQP;
+  Bool      m_RCLookahead;
+  Int       m_RCCpbSize;
+  Int       m_RCCpbMaxBitrate;
   Bool      m_TransquantBypassEnableFlag;                     ///< transquant_bypass_enable_flag setting in PPS.
   Bool      m_CUTransquantBypassFlagForce;                    ///< if transquant_bypass_enable_flag, then, if true, all CU transquant bypass flags will be set to true.
   TComVPS   m_cVPS;
@@ -238,6 +251,8 @@ public:
   Void      setConformanceWindow (Int confLeft, Int confRight, Int confTop, Int confBottom ) { m_conformanceWindow.setWindow (confLeft, confRight, confTop, confBottom); }
 
   Void      setFramesToBeEncoded            ( Int   i )      { m_framesToBeEncoded = i; }
+  Void      setNumWorkerThreads             ( Int   i )      { m_numWorkerThreads = i; }
+  Void      setAsyncMetrics                 ( Bool  b )      { m_bAsyncMetrics = b; }
   
   //====== Coding Structure ========
   Void      setIntraPeriod                  ( Int   i )      { m_uiIntraPeriod = (UInt)i; }
@@ -292,6 +307,8 @@ public:
   Int       getSourceWidth                  ()      { return  m_iSourceWidth; }
   Int       getSourceHeight                 ()      { return  m_iSourceHeight; }
   Int       getFramesToBeEncoded            ()      { return  m_framesToBeEncoded; }
+  Int       getNumWorkerThreads             ()      { return  m_numWorkerThreads; }
+  Bool      getAsyncMetrics                 ()      { return  m_bAsyncMetrics; }
 
   //==== Coding Structure ========
   UInt      getIntraPeriod                  ()      { return  m_uiIntraPeriod; }
@@ -335,6 +352,11 @@ public:
   Void      setUseFastDecisionForMerge      ( Bool  b )     { m_useFastDecisionForMerge = b; }
   Void      setUseCbfFastMode            ( Bool  b )     { m_bUseCbfFastMode = b; }
   Void      setUseEarlySkipDetection        ( Bool  b )     { m_useEarlySkipDetection = b; }
+  Void      setUseFastIntraSearch           ( Bool  b )     { m_useFastIntraSearch = b; }
+  Void      setUseFastCUSplit               ( Bool  b )     { m_useFastCUSplit = b; }
+  Void      setFastCUSplitScale             ( Double d )    { m_fastCUSplitScale = d; }
+  Void      setUseFastMergeRD               ( Bool  b )     { m_useFastMergeRD = b; }
+  Void      setFastMergeRDCands             ( Int   i )     { m_fastMergeRDCands = i; }
   Void      setUseConstrainedIntraPred      ( Bool  b )     { m_bUseConstrainedIntraPred = b; }
   Void      setPCMInputBitDepthFlag         ( Bool  b )     { m_bPCMInputBitDepthFlag = b; }
   Void      setPCMFilterDisableFlag         ( Bool  b )     {  m_bPCMFilterDisableFlag = b; }
@@ -351,6 +373,11 @@ public:
   Bool      getUseFastDecisionForMerge      ()      { return m_useFastDecisionForMerge; }
   Bool      getUseCbfFastMode           ()      { return m_bUseCbfFastMode; }
   Bool      getUseEarlySkipDetection        ()      { return m_useEarlySkipDetection; }
+  Bool      getUseFastIntraSearch           ()      { return m_useFastIntraSearch; }
+  Bool      getUseFastCUSplit               ()      { return m_useFastCUSplit; }
+  Double    getFastCUSplitScale             ()      { return m_fastCUSplitScale; }
+  Bool      getUseFastMergeRD               ()      { return m_useFastMergeRD; }
+  Int       getFastMergeRDCands             ()      { return m_fastMergeRDCands; }
   Bool      getUseConstrainedIntraPred      ()      { return m_bUseConstrainedIntraPred; }
   Bool      getPCMInputBitDepthFlag         ()      { return m_bPCMInputBitDepthFlag;   }
   Bool      getPCMFilterDisableFlag         ()      { return m_bPCMFilterDisableFlag;   } 
@@ -387,6 +414,8 @@ public:
   Void      setWPBiPred            ( Bool b )    { m_useWeightedBiPred = b;    }
   Bool      getUseWP               ()            { return m_useWeightedPred;   }
   Bool      getWPBiPred            ()            { return m_useWeightedBiPred; }
+  Void      setWPSADSubsample      ( Int i )     { m_iWPSADSubsample   = i;    }
+  Int       getWPSADSubsample      ()            { return m_iWPSADSubsample;   }
   Void      setLog2ParallelMergeLevelMinus2   ( UInt u )    { m_log2ParallelMergeLevelMinus2       = u;    }
   UInt      getLog2ParallelMergeLevelMinus2   ()            { return m_log2ParallelMergeLevelMinus2;       }
   Void      setMaxNumMergeCand                ( UInt u )    { m_maxNumMergeCand = u;      }
@@ -409,6 +438,12 @@ public:
   Void      setInitialQP           ( Int QP )      { m_RCInitialQP = QP;             }
   Bool      getForceIntraQP        ()              { return m_RCForceIntraQP;        }
   Void      setForceIntraQP        ( Bool b )      { m_RCForceIntraQP = b;           }
+  Bool      getRCLookahead         ()              { return m_RCLookahead;           }
+  Void      setRCLookahead         ( Bool b )      { m_RCLookahead = b;              }
+  Int       getCpbSize             ()              { return m_RCCpbSize;             }
+  Void      setCpbSize             ( Int size )    { m_RCCpbSize = size;             }
+  Int       getCpbMaxBitrate       ()              { return m_RCCpbMaxBitrate;       }
+  Void      setCpbMaxBitrate       ( Int bitrate ) { m_RCCpbMaxBitrate = bitrate;    }
   Bool      getTransquantBypassEnableFlag()           { return m_TransquantBypassEnableFlag; }
   Void      setTransquantBypassEnableFlag(Bool flag)  { m_TransquantBypassEnableFlag = flag; }
   Bool      getCUTransquantBypassFlagForceValue()          { return m_CUTransquantBypassFlagForce; }
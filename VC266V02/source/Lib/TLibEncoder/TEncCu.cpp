@@ -71,6 +71,7 @@ Void TEncCu::create(UChar uhTotalDepth, UInt uiMaxWidth, UInt uiMaxHeight)
   m_ppcResiYuvTemp = new TComYuv*[m_uhTotalDepth-1];
   m_ppcRecoYuvTemp = new TComYuv*[m_uhTotalDepth-1];
   m_ppcOrigYuv     = new TComYuv*[m_uhTotalDepth-1];
+  m_pppcMergeCandPredYuv = new TComYuv**[m_uhTotalDepth-1];
   
   UInt uiNumPartitions;
   for( i=0 ; i<m_uhTotalDepth-1 ; i++)
@@ -91,6 +92,12 @@ Void TEncCu::create(UChar uhTotalDepth, UInt uiMaxWidth, UInt uiMaxHeight)
     m_ppcRecoYuvTemp[i] = new TComYuv; m_ppcRecoYuvTemp[i]->create(uiWidth, uiHeight);
     
     m_ppcOrigYuv    [i] = new TComYuv; m_ppcOrigYuv    [i]->create(uiWidth, uiHeight);
+
+    m_pppcMergeCandPredYuv[i] = new TComYuv*[MRG_MAX_NUM_CANDS];
+    for( Int j = 0; j < MRG_MAX_NUM_CANDS; j++ )
+    {
+      m_pppcMergeCandPredYuv[i][j] = new TComYuv; m_pppcMergeCandPredYuv[i][j]->create(uiWidth, uiHeight);
+    }
   }
   
   m_bEncodeDQP = false;
@@ -146,6 +153,14 @@ Void TEncCu::destroy()
     {
       m_ppcOrigYuv[i]->destroy();     delete m_ppcOrigYuv[i];     m_ppcOrigYuv[i] = NULL;
     }
+    if(m_pppcMergeCandPredYuv[i])
+    {
+      for( Int j = 0; j < MRG_MAX_NUM_CANDS; j++ )
+      {
+        m_pppcMergeCandPredYuv[i][j]->destroy(); delete m_pppcMergeCandPredYuv[i][j];
+      }
+      delete [] m_pppcMergeCandPredYuv[i]; m_pppcMergeCandPredYuv[i] = NULL;
+    }
   }
   if(m_ppcBestCU)
   {
@@ -193,6 +208,11 @@ Void TEncCu::destroy()
     delete [] m_ppcOrigYuv;
     m_ppcOrigYuv = NULL;
   }
+  if(m_pppcMergeCandPredYuv)
+  {
+    delete [] m_pppcMergeCandPredYuv;
+    m_pppcMergeCandPredYuv = NULL;
+  }
 }
 
 /** \param    pcEncTop      pointer of encoder class
@@ -214,6 +234,11 @@ Void TEncCu::init( TEncTop* pcEncTop )
   m_pcRDGoOnSbacCoder = pcEncTop->getRDGoOnSbacCoder();
   
   m_pcRateCtrl        = pcEncTop->getRateCtrl();
+
+  // Every sub-CU writes its best residual and reconstruction to the picture before its parent evaluates the split.
+  // With a single QP tested per CU nothing overwrites them before the parent's decision, so a split candidate
+  // does not need its own copy. Multiple QP candidates re-run the split and would clobber the picture data.
+  m_bDeferSplitCopies = !m_pcEncCfg->getTransquantBypassEnableFlag() && ( m_pcEncCfg->getUseRateCtrl() || m_pcEncCfg->getMaxDeltaQP() == 0 );
 }
 
 // ====================================================================================================================
@@ -228,6 +253,10 @@ Void TEncCu::compressCU( TComDataCU*& rpcCU )
   m_ppcBestCU[0]->initCU( rpcCU->getPic(), rpcCU->getAddr() );
   m_ppcTempCU[0]->initCU( rpcCU->getPic(), rpcCU->getAddr() );
 
+  // interpolated blocks and intra search seeds are only reused within the CTU
+  m_pcPredSearch->resetMCCache();
+  m_pcPredSearch->resetIntraSeeds();
+
   // analysis of CU
   xCompressCU( m_ppcBestCU[0], m_ppcTempCU[0], 0 );
 
@@ -356,6 +385,7 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt u
   Bool earlyDetectionSkipMode = false;
 
   Bool bBoundary = false;
+  Bool bSplitIsBest = false;
   UInt uiLPelX   = rpcBestCU->getCUPelX();
   UInt uiRPelX   = uiLPelX + rpcBestCU->getWidth(0)  - 1;
   UInt uiTPelY   = rpcBestCU->getCUPelY();
@@ -660,10 +690,18 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt u
     {
       bSubBranch = true;
     }
+
+    // model based split termination
+    m_adUnsplitCost[uiDepth] = rpcBestCU->getTotalCost();
+    if( bSubBranch && m_pcEncCfg->getUseFastCUSplit() && uiDepth < g_uiMaxCUDepth - g_uiAddCUDepth )
+    {
+      bSubBranch = !xCheckEarlySplitTermination( rpcBestCU, uiDepth );
+    }
   }
   else
   {
     bBoundary = true;
+    m_adUnsplitCost[uiDepth] = MAX_DOUBLE;
   }
 
   // copy orginal YUV samples to PCM buffer
@@ -741,13 +779,16 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt u
           xCompressCU( pcSubBestPartCU, pcSubTempPartCU, uhNextDepth );
 #endif
 
-          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth );         // Keep best part data to current temporary data.
-          xCopyYuv2Tmp( pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx, uhNextDepth );
+          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, !m_bDeferSplitCopies ); // Keep best part data to current temporary data.
+          if ( !m_bDeferSplitCopies )
+          {
+            xCopyYuv2Tmp( pcSubBestPartCU->getTotalNumPart()*uiPartUnitIdx, uhNextDepth );
+          }
         }
         else
         {
           pcSubBestPartCU->copyToPic( uhNextDepth );
-          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth );
+          rpcTempCU->copyPartFrom( pcSubBestPartCU, uiPartUnitIdx, uhNextDepth, !m_bDeferSplitCopies );
         }
       }
 
@@ -795,13 +836,18 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt u
 
       m_pppcRDSbacCoder[uhNextDepth][CI_NEXT_BEST]->store(m_pppcRDSbacCoder[uiDepth][CI_TEMP_BEST]);
 
+      TComDataCU* pcSplitCU = rpcTempCU;
       xCheckBestMode( rpcBestCU, rpcTempCU, uiDepth);                                  // RD compare current larger prediction
-    }                                                                                  // with sub partitioned prediction.
+      bSplitIsBest = m_bDeferSplitCopies && rpcBestCU == pcSplitCU;                    // with sub partitioned prediction.
+    }
   }
 
-  rpcBestCU->copyToPic(uiDepth);                                                     // Copy Best data to Picture for next partition prediction.
+  rpcBestCU->copyToPic( uiDepth, !bSplitIsBest );                                    // Copy Best data to Picture for next partition prediction.
 
-  xCopyYuv2Pic( rpcBestCU->getPic(), rpcBestCU->getAddr(), rpcBestCU->getZorderIdxInCU(), uiDepth, uiDepth, rpcBestCU, uiLPelX, uiTPelY );   // Copy Yuv data to picture Yuv
+  if ( !bSplitIsBest )                                                               // a winning split already left its samples there
+  {
+    xCopyYuv2Pic( rpcBestCU->getPic(), rpcBestCU->getAddr(), rpcBestCU->getZorderIdxInCU(), uiDepth, uiDepth, rpcBestCU, uiLPelX, uiTPelY );   // Copy Yuv data to picture Yuv
+  }
   if( bBoundary)
   {
     return;
@@ -1134,9 +1180,23 @@ Void TEncCu::xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTem
   rpcTempCU->getInterMergeCandidates( 0, 0, cMvFieldNeighbours,uhInterDirNeighbours, numValidMergeCand );
   
   Int mergeCandBuffer[MRG_MAX_NUM_CANDS];
+  Bool mergeCandPredAvailable[MRG_MAX_NUM_CANDS];
+  Bool mergeCandForRD[MRG_MAX_NUM_CANDS];
   for( UInt ui = 0; ui < numValidMergeCand; ++ui )
   {
     mergeCandBuffer[ui] = 0;
+    mergeCandPredAvailable[ui] = false;
+    mergeCandForRD[ui] = true;
+  }
+
+  if( m_pcEncCfg->getUseFastMergeRD() && !rpcTempCU->isLosslessCoded(0) && numValidMergeCand > m_pcEncCfg->getFastMergeRDCands() )
+  {
+    // stage one: predict all candidates and keep the cheapest ones for the full RD check
+    xSelectMergeCandsForRD( rpcTempCU, cMvFieldNeighbours, uhInterDirNeighbours, numValidMergeCand, bTransquantBypassFlag, mergeCandForRD );
+    for( UInt ui = 0; ui < numValidMergeCand; ++ui )
+    {
+      mergeCandPredAvailable[ui] = true;
+    }
   }
 
   Bool bestIsSkip = false;
@@ -1155,22 +1215,20 @@ Void TEncCu::xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTem
   {
     for( UInt uiMergeCand = 0; uiMergeCand < numValidMergeCand; ++uiMergeCand )
     {
-      if(!(uiNoResidual==1 && mergeCandBuffer[uiMergeCand]==1))
+      if(!(uiNoResidual==1 && mergeCandBuffer[uiMergeCand]==1) && mergeCandForRD[uiMergeCand])
       {
         if( !(bestIsSkip && uiNoResidual == 0) )
         {
           // set MC parameters
-          rpcTempCU->setPredModeSubParts( MODE_INTER, 0, uhDepth ); // interprets depth relative to LCU level
-          rpcTempCU->setCUTransquantBypassSubParts( bTransquantBypassFlag,     0, uhDepth );
-          rpcTempCU->setPartSizeSubParts( SIZE_2Nx2N, 0, uhDepth ); // interprets depth relative to LCU level
-          rpcTempCU->setMergeFlagSubParts( true, 0, 0, uhDepth ); // interprets depth relative to LCU level
-          rpcTempCU->setMergeIndexSubParts( uiMergeCand, 0, 0, uhDepth ); // interprets depth relative to LCU level
-          rpcTempCU->setInterDirSubParts( uhInterDirNeighbours[uiMergeCand], 0, 0, uhDepth ); // interprets depth relative to LCU level
-          rpcTempCU->getCUMvField( REF_PIC_LIST_0 )->setAllMvField( cMvFieldNeighbours[0 + 2*uiMergeCand], SIZE_2Nx2N, 0, 0 ); // interprets depth relative to rpcTempCU level
-          rpcTempCU->getCUMvField( REF_PIC_LIST_1 )->setAllMvField( cMvFieldNeighbours[1 + 2*uiMergeCand], SIZE_2Nx2N, 0, 0 ); // interprets depth relative to rpcTempCU level
+          xSetMergeCandidate( rpcTempCU, uiMergeCand, cMvFieldNeighbours, uhInterDirNeighbours, bTransquantBypassFlag );
           
-          // do MC
-          m_pcPredSearch->motionCompensation ( rpcTempCU, m_ppcPredYuvTemp[uhDepth] );
+          // do MC once per candidate, the residual and the skip check share the prediction
+          if( !mergeCandPredAvailable[uiMergeCand] )
+          {
+            m_pcPredSearch->motionCompensation ( rpcTempCU, m_pppcMergeCandPredYuv[uhDepth][uiMergeCand] );
+            mergeCandPredAvailable[uiMergeCand] = true;
+          }
+          m_pppcMergeCandPredYuv[uhDepth][uiMergeCand]->copyToPartYuv( m_ppcPredYuvTemp[uhDepth], 0 );
           // estimate residual and encode everything
           m_pcPredSearch->encodeResAndCalcRdInterCU( rpcTempCU,
                                                     m_ppcOrigYuv    [uhDepth],
@@ -1233,6 +1291,60 @@ Void TEncCu::xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTem
   }
 }
 
+/** set the 2Nx2N merge candidate uiMergeCand as the motion of pcCU
+ */
+Void TEncCu::xSetMergeCandidate( TComDataCU* pcCU, UInt uiMergeCand, TComMvField* pcMvFieldNeighbours, UChar* puhInterDirNeighbours, Bool bTransquantBypassFlag )
+{
+  UChar uhDepth = pcCU->getDepth( 0 );
+  pcCU->setPredModeSubParts( MODE_INTER, 0, uhDepth ); // interprets depth relative to LCU level
+  pcCU->setCUTransquantBypassSubParts( bTransquantBypassFlag,     0, uhDepth );
+  pcCU->setPartSizeSubParts( SIZE_2Nx2N, 0, uhDepth ); // interprets depth relative to LCU level
+  pcCU->setMergeFlagSubParts( true, 0, 0, uhDepth ); // interprets depth relative to LCU level
+  pcCU->setMergeIndexSubParts( uiMergeCand, 0, 0, uhDepth ); // interprets depth relative to LCU level
+  pcCU->setInterDirSubParts( puhInterDirNeighbours[uiMergeCand], 0, 0, uhDepth ); // interprets depth relative to LCU level
+  pcCU->getCUMvField( REF_PIC_LIST_0 )->setAllMvField( pcMvFieldNeighbours[0 + 2*uiMergeCand], SIZE_2Nx2N, 0, 0 ); // interprets depth relative to pcCU level
+  pcCU->getCUMvField( REF_PIC_LIST_1 )->setAllMvField( pcMvFieldNeighbours[1 + 2*uiMergeCand], SIZE_2Nx2N, 0, 0 ); // interprets depth relative to pcCU level
+}
+
+/** predict all merge candidates into the candidate prediction buffers and keep the getFastMergeRDCands() ones
+ *  with the lowest SATD plus merge index cost for the full RD check
+ */
+Void TEncCu::xSelectMergeCandsForRD( TComDataCU* pcCU, TComMvField* pcMvFieldNeighbours, UChar* puhInterDirNeighbours, Int numValidMergeCand, Bool bTransquantBypassFlag, Bool* pbCandForRD )
+{
+  UChar    uhDepth   = pcCU->getDepth( 0 );
+  TComYuv* pcOrgYuv  = m_ppcOrigYuv[uhDepth];
+  Int      iWidth    = pcCU->getWidth ( 0 );
+  Int      iHeight   = pcCU->getHeight( 0 );
+  UInt     uiMaxIdx  = pcCU->getSlice()->getMaxNumMergeCand() - 1;
+  Double   adCost[MRG_MAX_NUM_CANDS];
+
+  for( Int iCand = 0; iCand < numValidMergeCand; iCand++ )
+  {
+    TComYuv* pcPredYuv = m_pppcMergeCandPredYuv[uhDepth][iCand];
+    xSetMergeCandidate( pcCU, iCand, pcMvFieldNeighbours, puhInterDirNeighbours, bTransquantBypassFlag );
+    m_pcPredSearch->motionCompensation( pcCU, pcPredYuv );
+
+    UInt uiSATD = m_pcRdCost->calcHAD( g_bitDepthY, pcOrgYuv->getLumaAddr(), pcOrgYuv->getStride(),  pcPredYuv->getLumaAddr(), pcPredYuv->getStride(),  iWidth,      iHeight      )
+                + m_pcRdCost->calcHAD( g_bitDepthC, pcOrgYuv->getCbAddr(),   pcOrgYuv->getCStride(), pcPredYuv->getCbAddr(),   pcPredYuv->getCStride(), iWidth >> 1, iHeight >> 1 )
+                + m_pcRdCost->calcHAD( g_bitDepthC, pcOrgYuv->getCrAddr(),   pcOrgYuv->getCStride(), pcPredYuv->getCrAddr(),   pcPredYuv->getCStride(), iWidth >> 1, iHeight >> 1 );
+    // merge_idx is truncated unary coded
+    UInt uiIdxBits = ( (UInt)iCand < uiMaxIdx ) ? iCand + 1 : iCand;
+    adCost[iCand]  = uiSATD + m_pcRdCost->getSqrtLambda() * uiIdxBits;
+  }
+
+  for( Int iCand = 0; iCand < numValidMergeCand; iCand++ )
+  {
+    Int iRank = 0;
+    for( Int i = 0; i < numValidMergeCand; i++ )
+    {
+      if( adCost[i] < adCost[iCand] || ( adCost[i] == adCost[iCand] && i < iCand ) )
+      {
+        iRank++;
+      }
+    }
+    pbCandForRD[iCand] = iRank < m_pcEncCfg->getFastMergeRDCands();
+  }
+}
 
 #if AMP_MRG
 Void TEncCu::xCheckRDCostInter( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, PartSize ePartSize, Bool bUseMRG)
@@ -1393,6 +1505,70 @@ Void TEncCu::xCheckBestMode( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UIn
   }
 }
 
+/** decide whether the split of the current CU can be skipped after its unsplit modes have been tested
+ * \param pcBestCU best unsplit coding of the current CU
+ * \param uiDepth  depth of the current CU
+ * \returns true if the sub-CUs need not be tested
+ *
+ * Small decision tree over features that are already available: the depths of the left, above and co-located
+ * CUs, the RD cost of the best unsplit mode relative to a quarter of the unsplit cost of the parent CU, and at the
+ * last splittable depth the residual of the best mode and its RD cost per sample in units of lambda.
+ */
+Bool TEncCu::xCheckEarlySplitTermination( TComDataCU* pcBestCU, UInt uiDepth )
+{
+  UInt uiAbsZorderIdx = pcBestCU->getZorderIdxInCU();
+  Int  iNumNeighbours = 0;
+  Int  iNumDeeper     = 0;
+
+  UInt uiNbPartIdx;
+  TComDataCU* pcNbCU = pcBestCU->getPULeft( uiNbPartIdx, uiAbsZorderIdx );
+  if( pcNbCU )
+  {
+    iNumNeighbours++;
+    iNumDeeper += pcNbCU->getDepth( uiNbPartIdx ) > uiDepth;
+  }
+  pcNbCU = pcBestCU->getPUAbove( uiNbPartIdx, uiAbsZorderIdx );
+  if( pcNbCU )
+  {
+    iNumNeighbours++;
+    iNumDeeper += pcNbCU->getDepth( uiNbPartIdx ) > uiDepth;
+  }
+  pcNbCU = pcBestCU->getPic()->getCU( pcBestCU->getAddr() )->getCUColocated( REF_PIC_LIST_0 );
+  if( pcNbCU )
+  {
+    iNumNeighbours++;
+    iNumDeeper += pcNbCU->getDepth( uiAbsZorderIdx ) > uiDepth;
+  }
+
+  // any deeper neighbour votes for testing the split
+  if( iNumNeighbours == 0 || iNumDeeper > 0 )
+  {
+    return false;
+  }
+
+  Double dScale = m_pcEncCfg->getFastCUSplitScale();
+  Double dCost  = pcBestCU->getTotalCost();
+
+  // cheaper than an average quarter of the parent CU
+  if( uiDepth > 0 && m_adUnsplitCost[uiDepth-1] < MAX_DOUBLE && dCost < dScale * FAST_CU_SPLIT_PARENT_RATIO * 0.25 * m_adUnsplitCost[uiDepth-1] )
+  {
+    return true;
+  }
+
+  // last splittable depth: residual free or cheap per sample
+  if( uiDepth + 1 == g_uiMaxCUDepth - g_uiAddCUDepth )
+  {
+    Double dNormCost = dCost / ( m_pcRdCost->getLambda() * pcBestCU->getWidth( 0 ) * pcBestCU->getHeight( 0 ) );
+    Double dCostTh   = pcBestCU->isIntra( 0 ) ? FAST_CU_SPLIT_COST_TH_INTRA : FAST_CU_SPLIT_COST_TH_INTER;
+    if( pcBestCU->getQtRootCbf( 0 ) == 0 || dNormCost < dScale * dCostTh )
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 Void TEncCu::xCheckDQP( TComDataCU* pcCU )
 {
   UInt uiDepth = pcCU->getDepth( 0 );
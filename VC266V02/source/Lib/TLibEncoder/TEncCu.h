@@ -77,9 +77,11 @@ private:
   TComYuv**               m_ppcResiYuvTemp; ///< Temporary Residual Yuv for each depth
   TComYuv**               m_ppcRecoYuvTemp; ///< Temporary Reconstruction Yuv for each depth
   TComYuv**               m_ppcOrigYuv;     ///< Original Yuv for each depth
+  TComYuv***              m_pppcMergeCandPredYuv; ///< 2Nx2N prediction of each merge candidate for each depth
   
   //  Data : encoder control
   Bool                    m_bEncodeDQP;
+  Bool                    m_bDeferSplitCopies;  ///< residual and reconstruction of a winning split are left in the picture
   
   //  Access channel
   TEncCfg*                m_pcEncCfg;
@@ -97,6 +99,8 @@ private:
   TEncSbac***             m_pppcRDSbacCoder;
   TEncSbac*               m_pcRDGoOnSbacCoder;
   TEncRateCtrl*           m_pcRateCtrl;
+
+  Double                  m_adUnsplitCost[MAX_CU_DEPTH+1]; ///< RD cost of the best unsplit mode for each depth of the current CU branch
 public:
   /// copy parameters from encoder class
   Void  init                ( TEncTop* pcEncTop );
@@ -126,8 +130,11 @@ protected:
   
   Int   xComputeQP          ( TComDataCU* pcCU, UInt uiDepth );
   Void  xCheckBestMode      ( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, UInt uiDepth        );
+  Bool  xCheckEarlySplitTermination( TComDataCU* pcBestCU, UInt uiDepth );
   
   Void  xCheckRDCostMerge2Nx2N( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, Bool *earlyDetectionSkipMode);
+  Void  xSetMergeCandidate    ( TComDataCU* pcCU, UInt uiMergeCand, TComMvField* pcMvFieldNeighbours, UChar* puhInterDirNeighbours, Bool bTransquantBypassFlag );
+  Void  xSelectMergeCandsForRD( TComDataCU* pcCU, TComMvField* pcMvFieldNeighbours, UChar* puhInterDirNeighbours, Int numValidMergeCand, Bool bTransquantBypassFlag, Bool* pbCandForRD );
 
 #if AMP_MRG
   Void  xCheckRDCostInter   ( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, PartSize ePartSize, Bool bUseMRG = false  );
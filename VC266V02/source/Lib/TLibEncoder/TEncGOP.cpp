@@ -87,6 +87,10 @@ TEncGOP::TEncGOP()
   m_pcSbacCoder         = NULL;
   m_pcBinCABAC          = NULL;
   
+  m_bFilterCtuRows      = false;
+  m_iDeblockedCtuRows   = 0;
+  m_iFilteredCtuRows    = 0;
+  
   m_bSeqFirst           = true;
   
   m_bRefreshPending     = 0;
@@ -98,6 +102,7 @@ TEncGOP::TEncGOP()
   m_lastBPSEI         = 0;
   m_associatedIRAPType = NAL_UNIT_CODED_SLICE_IDR_N_LP;
   m_associatedIRAPPOC  = 0;
+  m_pcMetricsPic       = NULL;
   return;
 }
 
@@ -115,6 +120,8 @@ Void  TEncGOP::create()
 
 Void  TEncGOP::destroy()
 {
+  finishMetrics();
+  m_cMetricsThread.destroy();
 }
 
 Void TEncGOP::init ( TEncTop* pcTEncTop )
@@ -142,6 +149,7 @@ Void TEncGOP::init ( TEncTop* pcTEncTop )
   m_lastBPSEI          = 0;
   m_totalCoded         = 0;
 
+  m_cMetricsThread.create( m_pcCfg->getAsyncMetrics() ? 2 : 1 );
 }
 
 
@@ -604,6 +612,15 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     m_storedStartCUAddrForEncodingSlice.push_back (nextCUAddr);
     startCUAddrSliceIdx++;
     
+#if ALF_TEST && MQT_ALF_NPASS
+    // CTU-row ALF: deblocking, SAO and ALF follow the CTU rows while they are coded, the ALF header goes first
+    m_bFilterCtuRows = pcSlice->getSPS()->getUseALF() && m_pcEncTop->getALFCtuRowMode();
+    if ( m_bFilterCtuRows )
+    {
+      xStartCtuRowFilters( pcPic, pcSubstreamsOut, iNumSubstreams );
+    }
+#endif
+
     //compress one slice
     pcSlice->setNextSlice       ( false );
     assert(pcPic->getNumAllocatedSlice() == startCUAddrSliceIdx);
@@ -629,7 +646,10 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     {
       dblMetric(pcPic, uiNumSlices);
     }
-    m_pcLoopFilter->loopFilterPic( pcPic );
+    if ( !m_bFilterCtuRows )
+    {
+      m_pcLoopFilter->loopFilterPic( pcPic );
+    }
 
 #if ALF_TEST
 #if MTK_NONCROSS_INLOOP_FILTER
@@ -709,6 +729,10 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       m_bSeqFirst = false;
     }
     m_cpbRemovalDelay ++;
+    if ( m_pcCfg->getUseRateCtrl() && m_pcRateCtrl->getRCSeq()->getUseCpb() )
+    {
+      xCreateHrdSEIMessages( accessUnit, pcSlice );
+    }
     if( ( m_pcEncTop->getRecoveryPointSEIEnabled() ) && ( pcSlice->getSliceType() == I_SLICE ) )
     {
       // Recovery point SEI
@@ -978,6 +1002,12 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
           break;
         case EXECUTE_INLOOPFILTER:
         {
+          if ( m_bFilterCtuRows )
+          {
+            // filtered during compressSlice, the ALF parameters are in pcSubstreamsOut already
+            processingState = ENCODE_SLICE;
+            break;
+          }
           // set entropy coder for RD
           m_pcEntropyCoder->setEntropyCoder ( m_pcSbacCoder, pcSlice );
           if ( pcSlice->getSPS()->getUseSAO() )
@@ -1026,47 +1056,8 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 #endif
             m_pcAdaptiveLoopFilter->endALFEnc();
 
-            // set entropy coder for writing
-            m_pcSbacCoder->init((TEncBinIf*)m_pcBinCABAC);
-
-#if ALF_BITSTREAM
-            pcSlice->allocSubstreamSizes(iNumSubstreams);
-            for (UInt ui = 0; ui < iNumSubstreams; ui++)
-            {
-              pcSubstreamsOut[ui].clear();
-            }
-#endif
-
-            m_pcEntropyCoder->setEntropyCoder(m_pcSbacCoder, pcSlice);
-            m_pcEntropyCoder->resetEntropy();
-            m_pcEntropyCoder->setBitstream(pcSubstreamsOut);
-            if (cAlfParam.cu_control_flag)
-            {
-              m_pcEntropyCoder->setAlfCtrl(true);
-              m_pcEntropyCoder->setMaxAlfCtrlDepth(uiMaxAlfCtrlDepth);
-            }
-            else
-            {
-              m_pcEntropyCoder->setAlfCtrl(false);
-            }
-
-            if (pcSlice->getSPS()->getUseALF())
-              m_pcEntropyCoder->encodeAlfParam(&cAlfParam);
-
-#if TSB_ALF_HEADER
-            if (cAlfParam.cu_control_flag)
-            {
-              m_pcEntropyCoder->encodeAlfCtrlParam(&cAlfParam);
-            }
-#endif
-
+            xWriteALFParam(pcSlice, &cAlfParam, uiMaxAlfCtrlDepth, pcSubstreamsOut, iNumSubstreams);
             m_pcAdaptiveLoopFilter->freeALFParam(&cAlfParam);
-
-#if ALF_BITSTREAM
-            m_pcEntropyCoder->encodeTerminatingBit(1);
-            m_pcEntropyCoder->encodeSliceFinish();
-            pcSubstreamsOut->writeByteAlignment();
-#endif
           }
 #endif
           processingState = ENCODE_SLICE;
@@ -1096,16 +1087,35 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     //-- For time output for each slice
     Double dEncTime = (Double)(clock()-iBeforeTime) / CLOCKS_PER_SEC;
     
+    // the metrics stage only reads the original and the final reconstruction; it overlaps with the hash below and,
+    // in async-metrics mode, with the encoding of the next picture
+    xStartPicMetrics( pcPic, accessUnit, dEncTime );
+
     const Char* digestStr = NULL;
     if (m_pcCfg->getDecodedPictureHashSEIEnabled())
     {
-      /* calculate MD5sum for entire reconstructed picture */
+      /* calculate MD5sum, CRC or checksum for entire reconstructed picture, the planes in parallel */
       SEIDecodedPictureHash sei_recon_picture_digest;
       if(m_pcCfg->getDecodedPictureHashSEIEnabled() == 1)
       {
         sei_recon_picture_digest.method = SEIDecodedPictureHash::MD5;
-        calcMD5(*pcPic->getPicYuvRec(), sei_recon_picture_digest.digest);
+        calcMD5(*pcPic->getPicYuvRec(), sei_recon_picture_digest.digest, m_pcEncTop->getThreadPool());
         digestStr = digestToString(sei_recon_picture_digest.digest, 16);
+        m_sMetricsDigest = "MD5:";
+      }
+      else if(m_pcCfg->getDecodedPictureHashSEIEnabled() == 2)
+      {
+        sei_recon_picture_digest.method = SEIDecodedPictureHash::CRC;
+        calcCRC(*pcPic->getPicYuvRec(), sei_recon_picture_digest.digest, m_pcEncTop->getThreadPool());
+        digestStr = digestToString(sei_recon_picture_digest.digest, 2);
+        m_sMetricsDigest = "CRC:";
+      }
+      else if(m_pcCfg->getDecodedPictureHashSEIEnabled() == 3)
+      {
+        sei_recon_picture_digest.method = SEIDecodedPictureHash::CHECKSUM;
+        calcChecksum(*pcPic->getPicYuvRec(), sei_recon_picture_digest.digest, m_pcEncTop->getThreadPool());
+        digestStr = digestToString(sei_recon_picture_digest.digest, 4);
+        m_sMetricsDigest = "Checksum:";
       }
       OutputNALUnit nalu(NAL_UNIT_SUFFIX_SEI, pcSlice->getTLayer());
       
@@ -1117,15 +1127,15 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       accessUnit.insert(accessUnit.end(), new NALUnitEBSP(nalu));
     }
     
-    xCalculateAddPSNR( pcPic, pcPic->getPicYuvRec(), accessUnit, dEncTime );
-
     if (digestStr)
     {
-      if(m_pcCfg->getDecodedPictureHashSEIEnabled() == 1)
-      {
-        printf(" [MD5:%s]", digestStr);
-      }
+      m_sMetricsDigest += digestStr;
     }
+    if (!m_pcCfg->getAsyncMetrics())
+    {
+      finishMetrics();
+    }
+
     if ( m_pcCfg->getUseRateCtrl() )
     {
       Double avgQP     = m_pcRateCtrl->getRCPic()->calAverageQP();
@@ -1138,6 +1148,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
       m_pcRateCtrl->getRCPic()->addToPictureLsit( m_pcRateCtrl->getPicList() );
       
       m_pcRateCtrl->getRCSeq()->updateAfterPic( actualTotalBits );
+      m_pcRateCtrl->getRCSeq()->updateCpb( xGetAccessUnitBits( accessUnit ) );
       if ( pcSlice->getSliceType() != I_SLICE )
       {
         m_pcRateCtrl->getRCGOP()->updateAfterPicture( actualTotalBits );
@@ -1154,9 +1165,6 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     m_bFirst = false;
     m_iNumPicCoded++;
     m_totalCoded ++;
-    /* logging: insert a newline at end of picture period */
-    printf("\n");
-    fflush(stdout);
     
     delete[] pcSubstreamsOut;
   }
@@ -1170,6 +1178,7 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 
 Void TEncGOP::printOutSummary(UInt uiNumAllPicCoded)
 {
+  finishMetrics();
   assert (uiNumAllPicCoded == m_gcAnalyzeAll.getNumPic());
   
   
@@ -1242,10 +1251,149 @@ Void TEncGOP::preLoopFilterPicAll( TComPic* pcPic, UInt64& ruiDist, UInt64& ruiB
     ruiDist = xFindDistortionFrame(pcPic->getPicYuvOrg(), pcPic->getPicYuvRec());
 }
 
+/** In-loop filters of the CTU rows that became final with the coding of CTU rows [0, iNumCodedRows), called by the
+ * slice encoder at the end of each CTU row in CTU-row ALF mode.
+ * A row is deblocked once the row below is coded, since intra prediction reads its unfiltered bottom line, and gets
+ * SAO once the row below is deblocked; ALF keeps one more row of lag internally.
+ */
+Void TEncGOP::filterCtuRows( TComPic* pcPic, Int iNumCodedRows )
+{
+  if ( !m_bFilterCtuRows )
+  {
+    return;
+  }
+  TComSlice* pcSlice   = pcPic->getSlice(0);
+  Int        iNumRows  = pcPic->getFrameHeightInCU();
+  Int        iDeblockEnd = ( iNumCodedRows == iNumRows ) ? iNumRows : iNumCodedRows - 1;
+
+  for ( ; m_iDeblockedCtuRows < iDeblockEnd; m_iDeblockedCtuRows++ )
+  {
+    m_pcLoopFilter->loopFilterCtuRow( pcPic, m_iDeblockedCtuRows );
+  }
+
+  Int iFilterEnd = ( m_iDeblockedCtuRows == iNumRows ) ? iNumRows : m_iDeblockedCtuRows - 1;
+  for ( ; m_iFilteredCtuRows < iFilterEnd; m_iFilteredCtuRows++ )
+  {
+    if ( pcSlice->getSPS()->getUseSAO() )
+    {
+      m_pcSAO->SAOProcessCtuRow( pcPic, m_iFilteredCtuRows );
+      m_pcSAO->PCMLFDisableProcessCtuRow( pcPic, m_iFilteredCtuRows );
+    }
+#if ALF_TEST && MQT_ALF_NPASS
+    m_pcAdaptiveLoopFilter->ALFProcessCtuRow( m_iFilteredCtuRows );
+#endif
+  }
+
+  if ( m_iFilteredCtuRows == iNumRows )
+  {
+    if ( pcSlice->getSPS()->getUseSAO() )
+    {
+      m_pcSAO->SAOFinishCtuRows( pcPic );
+    }
+#if ALF_TEST && MQT_ALF_NPASS
+    m_pcAdaptiveLoopFilter->finishCtuRowALF();
+    m_pcAdaptiveLoopFilter->endALFEnc();
+#endif
+  }
+}
+
 // ====================================================================================================================
 // Protected member functions
 // ====================================================================================================================
 
+#if ALF_TEST
+/** Set up the CTU-row in-loop filters of a picture before its first CTU is coded and write its ALF parameters, which
+ * only depend on previous pictures, to the first substream.
+ * The slice-level SAO flags are decided here as well. One slice per picture, SaoLcuBoundary and
+ * DeblockingFilterMetric off.
+ */
+Void TEncGOP::xStartCtuRowFilters( TComPic* pcPic, TComOutputBitstream* pcSubstreamsOut, Int iNumSubstreams )
+{
+  TComSlice* pcSlice = pcPic->getSlice(0);
+
+  m_iDeblockedCtuRows = 0;
+  m_iFilteredCtuRows  = 0;
+  m_pcLoopFilter->setCfg( pcSlice->getPPS()->getLoopFilterAcrossTilesEnabledFlag() );
+
+  // set entropy coder for RD
+  m_pcSbacCoder->init( (TEncBinIf*)m_pcBinCABAC );
+  m_pcEntropyCoder->setEntropyCoder ( m_pcSbacCoder, pcSlice );
+  m_pcEntropyCoder->setBitstream    ( m_pcBitCounter );
+  if ( pcSlice->getSPS()->getUseSAO() )
+  {
+    Bool sliceEnabled[NUM_SAO_COMPONENTS];
+    // the go-on coder gets its bitstream from the slice encoder only once the first CTU is coded
+    m_pcEncTop->getRDGoOnSbacCoder()->setBitstream( m_pcBitCounter );
+    m_pcSAO->initRDOCabacCoder( m_pcEncTop->getRDGoOnSbacCoder(), pcSlice );
+    m_pcSAO->SAOStartCtuRows( pcPic, sliceEnabled, pcSlice->getLambdas() );
+    pcSlice->setSaoEnabledFlag( sliceEnabled[SAO_Y] );
+    assert( sliceEnabled[SAO_Cb] == sliceEnabled[SAO_Cr] );
+    pcSlice->setSaoEnabledFlagChroma( sliceEnabled[SAO_Cb] );
+  }
+
+#if MQT_ALF_NPASS
+  ALFParam cAlfParam;
+#if MTK_NONCROSS_INLOOP_FILTER
+  m_pcAdaptiveLoopFilter->setUseNonCrossAlf( false );
+#endif
+#if TSB_ALF_HEADER
+  m_pcAdaptiveLoopFilter->setNumCUsInFrame( pcPic );
+#endif
+  m_pcAdaptiveLoopFilter->allocALFParam( &cAlfParam );
+  m_pcAdaptiveLoopFilter->startALFEnc( pcPic, m_pcEntropyCoder );
+  m_pcAdaptiveLoopFilter->startCtuRowALF( &cAlfParam, pcSlice->getLambdas()[0] );
+
+  xWriteALFParam( pcSlice, &cAlfParam, 0, pcSubstreamsOut, iNumSubstreams );
+  m_pcAdaptiveLoopFilter->freeALFParam( &cAlfParam );
+#endif
+}
+
+/** Write the ALF parameters of the picture at the start of the first substream
+ */
+Void TEncGOP::xWriteALFParam( TComSlice* pcSlice, ALFParam* pcAlfParam, UInt uiMaxAlfCtrlDepth, TComOutputBitstream* pcSubstreamsOut, Int iNumSubstreams )
+{
+  // set entropy coder for writing
+  m_pcSbacCoder->init((TEncBinIf*)m_pcBinCABAC);
+
+#if ALF_BITSTREAM
+  pcSlice->allocSubstreamSizes(iNumSubstreams);
+  for (UInt ui = 0; ui < iNumSubstreams; ui++)
+  {
+    pcSubstreamsOut[ui].clear();
+  }
+#endif
+
+  m_pcEntropyCoder->setEntropyCoder(m_pcSbacCoder, pcSlice);
+  m_pcEntropyCoder->resetEntropy();
+  m_pcEntropyCoder->setBitstream(pcSubstreamsOut);
+  if (pcAlfParam->cu_control_flag)
+  {
+    m_pcEntropyCoder->setAlfCtrl(true);
+    m_pcEntropyCoder->setMaxAlfCtrlDepth(uiMaxAlfCtrlDepth);
+  }
+  else
+  {
+    m_pcEntropyCoder->setAlfCtrl(false);
+  }
+
+  if (pcSlice->getSPS()->getUseALF())
+    m_pcEntropyCoder->encodeAlfParam(pcAlfParam);
+
+#if TSB_ALF_HEADER
+  if (pcAlfParam->cu_control_flag)
+  {
+    m_pcEntropyCoder->encodeAlfCtrlParam(pcAlfParam);
+  }
+#endif
+
+#if ALF_BITSTREAM
+  m_pcEntropyCoder->encodeTerminatingBit(1);
+  m_pcEntropyCoder->encodeSliceFinish();
+  pcSubstreamsOut->writeByteAlignment();
+#endif
+}
+#endif
+
 
 Void TEncGOP::xInitGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut )
 {
@@ -1306,60 +1454,11 @@ Void TEncGOP::xGetBuffer( TComList<TComPic*>&      rcListPic,
 
 UInt64 TEncGOP::xFindDistortionFrame (TComPicYuv* pcPic0, TComPicYuv* pcPic1)
 {
-  Int     x, y;
-  Pel*  pSrc0   = pcPic0 ->getLumaAddr();
-  Pel*  pSrc1   = pcPic1 ->getLumaAddr();
-  UInt  uiShift = 2 * DISTORTION_PRECISION_ADJUSTMENT(g_bitDepthY-8);
-  Int   iTemp;
-  
-  Int   iStride = pcPic0->getStride();
-  Int   iWidth  = pcPic0->getWidth();
-  Int   iHeight = pcPic0->getHeight();
-  
-  UInt64  uiTotalDiff = 0;
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      iTemp = pSrc0[x] - pSrc1[x]; uiTotalDiff += (iTemp*iTemp) >> uiShift;
-    }
-    pSrc0 += iStride;
-    pSrc1 += iStride;
-  }
-  
-  uiShift = 2 * DISTORTION_PRECISION_ADJUSTMENT(g_bitDepthC-8);
-  iHeight >>= 1;
-  iWidth  >>= 1;
-  iStride >>= 1;
-  
-  pSrc0  = pcPic0->getCbAddr();
-  pSrc1  = pcPic1->getCbAddr();
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      iTemp = pSrc0[x] - pSrc1[x]; uiTotalDiff += (iTemp*iTemp) >> uiShift;
-    }
-    pSrc0 += iStride;
-    pSrc1 += iStride;
-  }
-  
-  pSrc0  = pcPic0->getCrAddr();
-  pSrc1  = pcPic1->getCrAddr();
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      iTemp = pSrc0[x] - pSrc1[x]; uiTotalDiff += (iTemp*iTemp) >> uiShift;
-    }
-    pSrc0 += iStride;
-    pSrc1 += iStride;
-  }
+  UInt64 auiSSD[3];
+  TComRdCost::getPicSSD( pcPic0, pcPic1, pcPic0->getWidth(), pcPic0->getHeight(), auiSSD, m_pcEncTop->getThreadPool(),
+                         2 * DISTORTION_PRECISION_ADJUSTMENT(g_bitDepthY-8), 2 * DISTORTION_PRECISION_ADJUSTMENT(g_bitDepthC-8) );
   
-  return uiTotalDiff;
+  return auiSSD[0] + auiSSD[1] + auiSSD[2];
 }
 
 #if VERBOSE_RATE
@@ -1397,21 +1496,85 @@ static const Char* nalUnitTypeToString(NalUnitType type)
 }
 #endif
 
-Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const AccessUnit& accessUnit, Double dEncTime )
+/** hand a coded picture to the metrics stage, after the picture handed to it before is reported
+ * \param pcPic      coded picture with its final reconstruction
+ * \param accessUnit access unit of the picture, SEI NAL units are not counted
+ * \param dEncTime   encoding time of the picture
+ * The slice data printed in the log is taken here, because the reference marking of the picture changes while the
+ * next picture is encoded.
+ */
+Void TEncGOP::xStartPicMetrics( TComPic* pcPic, const AccessUnit& accessUnit, Double dEncTime )
+{
+  finishMetrics();
+
+  /* calculate the size of the access unit, excluding:
+   *  - any AnnexB contributions (start_code_prefix, zero_byte, etc.,)
+   *  - SEI NAL units
+   */
+  UInt numRBSPBytes = 0;
+  for (AccessUnit::const_iterator it = accessUnit.begin(); it != accessUnit.end(); it++)
+  {
+    UInt numRBSPBytes_nal = UInt((*it)->m_nalUnitData.str().size());
+#if VERBOSE_RATE
+    printf("*** %6s numBytesInNALunit: %u\n", nalUnitTypeToString((*it)->m_nalUnitType), numRBSPBytes_nal);
+#endif
+    if ((*it)->m_nalUnitType != NAL_UNIT_PREFIX_SEI && (*it)->m_nalUnitType != NAL_UNIT_SUFFIX_SEI)
+    {
+      numRBSPBytes += numRBSPBytes_nal;
+    }
+  }
+
+  UInt uibits = numRBSPBytes * 8;
+  m_vRVM_RP.push_back( uibits );
+
+  TComSlice*  pcSlice = pcPic->getSlice(0);
+  m_dMetricsEncTime    = dEncTime;
+  m_uiMetricsBits      = uibits;
+  m_eMetricsSliceType  = pcSlice->getSliceType();
+  m_bMetricsReferenced = pcSlice->isReferenced();
+  m_iMetricsPOC        = pcSlice->getPOC()-pcSlice->getLastIDR();
+  m_iMetricsTId        = pcSlice->getTLayer();
+  m_iMetricsQP         = pcSlice->getSliceQp();
+  for (Int iRefList = 0; iRefList < 2; iRefList++)
+  {
+    m_aiMetricsRefPOC[iRefList].clear();
+    for (Int iRefIndex = 0; iRefIndex < pcSlice->getNumRefIdx(RefPicList(iRefList)); iRefIndex++)
+    {
+      m_aiMetricsRefPOC[iRefList].push_back( pcSlice->getRefPOC(RefPicList(iRefList), iRefIndex)-pcSlice->getLastIDR() );
+    }
+  }
+  m_sMetricsDigest.clear();
+
+  m_pcMetricsPic = pcPic;
+  m_cMetricsThread.startJob( this, 1 );
+}
+
+/// wait until the picture handed to the metrics stage, if any, is measured, then add and print its results
+Void TEncGOP::finishMetrics()
+{
+  m_cMetricsThread.waitJob();
+  if (m_pcMetricsPic)
+  {
+    xReportPicMetrics();
+    m_pcMetricsPic = NULL;
+  }
+}
+
+Void TEncGOP::runItem( Int itemIdx, Int threadIdx )
+{
+  // the encoder pool is busy with the next picture in async-metrics mode
+  xCalculatePicMetrics( m_pcMetricsPic, m_pcMetricsPic->getPicYuvRec(), m_pcCfg->getAsyncMetrics() ? NULL : m_pcEncTop->getThreadPool() );
+}
+
+Void TEncGOP::xCalculatePicMetrics( TComPic* pcPic, TComPicYuv* pcPicD, TComThreadPool* pcThreadPool )
 {
-  Int     x, y;
   UInt64 uiSSDY  = 0;
   UInt64 uiSSDU  = 0;
   UInt64 uiSSDV  = 0;
   
-  Double  dYPSNR  = 0.0;
-  Double  dUPSNR  = 0.0;
-  Double  dVPSNR  = 0.0;
-  
   //===== calculate PSNR =====
-  Pel*  pOrg    = pcPic ->getPicYuvOrg()->getLumaAddr();
-  Pel*  pRec    = pcPicD->getLumaAddr();
-  Int   iStride = pcPicD->getStride();
+  Pel*  pOrg;
+  Pel*  pRec;
   
   Int   iWidth;
   Int   iHeight;
@@ -1421,58 +1584,22 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   
   Int   iSize   = iWidth*iHeight;
   
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      Int iDiff = (Int)( pOrg[x] - pRec[x] );
-      uiSSDY   += iDiff * iDiff;
-    }
-    pOrg += iStride;
-    pRec += iStride;
-  }
-  
-  iHeight >>= 1;
-  iWidth  >>= 1;
-  iStride >>= 1;
-  pOrg  = pcPic ->getPicYuvOrg()->getCbAddr();
-  pRec  = pcPicD->getCbAddr();
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      Int iDiff = (Int)( pOrg[x] - pRec[x] );
-      uiSSDU   += iDiff * iDiff;
-    }
-    pOrg += iStride;
-    pRec += iStride;
-  }
-  
-  pOrg  = pcPic ->getPicYuvOrg()->getCrAddr();
-  pRec  = pcPicD->getCrAddr();
-  
-  for( y = 0; y < iHeight; y++ )
-  {
-    for( x = 0; x < iWidth; x++ )
-    {
-      Int iDiff = (Int)( pOrg[x] - pRec[x] );
-      uiSSDV   += iDiff * iDiff;
-    }
-    pOrg += iStride;
-    pRec += iStride;
-  }
+  UInt64 auiSSD[3];
+  TComRdCost::getPicSSD( pcPic->getPicYuvOrg(), pcPicD, iWidth, iHeight, auiSSD, pcThreadPool );
+  uiSSDY = auiSSD[0];
+  uiSSDU = auiSSD[1];
+  uiSSDV = auiSSD[2];
   
   Int maxvalY = 255 << (g_bitDepthY-8);
   Int maxvalC = 255 << (g_bitDepthC-8);
   Double fRefValueY = (Double) maxvalY * maxvalY * iSize;
   Double fRefValueC = (Double) maxvalC * maxvalC * iSize / 4.0;
-  dYPSNR            = ( uiSSDY ? 10.0 * log10( fRefValueY / (Double)uiSSDY ) : 99.99 );
-  dUPSNR            = ( uiSSDU ? 10.0 * log10( fRefValueC / (Double)uiSSDU ) : 99.99 );
-  dVPSNR            = ( uiSSDV ? 10.0 * log10( fRefValueC / (Double)uiSSDV ) : 99.99 );
+  m_adMetricsPSNR[0] = ( uiSSDY ? 10.0 * log10( fRefValueY / (Double)uiSSDY ) : 99.99 );
+  m_adMetricsPSNR[1] = ( uiSSDU ? 10.0 * log10( fRefValueC / (Double)uiSSDU ) : 99.99 );
+  m_adMetricsPSNR[2] = ( uiSSDV ? 10.0 * log10( fRefValueC / (Double)uiSSDV ) : 99.99 );
+  m_dMetricsMsSSIM   = 0.0;
 
 #if _Cal_SSIM_
-  double dCurMsSSIM = 0.0;
   if(m_pcCfg->getPrintSSIM())
   {
     //===== calculate SSIM/MS-SSIM =====
@@ -1523,7 +1650,7 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
       double dTmpMsSSIM = scale( i );
       dMsSSIM *= pow( dTmpMsSSIM, (double)exponent[i-1] );
     }
-    dCurMsSSIM = dMsSSIM;
+    m_dMetricsMsSSIM = dMsSSIM;
 
 #if DOWN_SAMPLE_LP
     delete [] m_piPicLastScale1;
@@ -1536,42 +1663,37 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   }
 #endif //_Cal_SSIM_
 
-  /* calculate the size of the access unit, excluding:
-   *  - any AnnexB contributions (start_code_prefix, zero_byte, etc.,)
-   *  - SEI NAL units
-   */
-  UInt numRBSPBytes = 0;
-  for (AccessUnit::const_iterator it = accessUnit.begin(); it != accessUnit.end(); it++)
-  {
-    UInt numRBSPBytes_nal = UInt((*it)->m_nalUnitData.str().size());
-#if VERBOSE_RATE
-    printf("*** %6s numBytesInNALunit: %u\n", nalUnitTypeToString((*it)->m_nalUnitType), numRBSPBytes_nal);
-#endif
-    if ((*it)->m_nalUnitType != NAL_UNIT_PREFIX_SEI && (*it)->m_nalUnitType != NAL_UNIT_SUFFIX_SEI)
-    {
-      numRBSPBytes += numRBSPBytes_nal;
-    }
-  }
+}
 
-  UInt uibits = numRBSPBytes * 8;
-  m_vRVM_RP.push_back( uibits );
+/// add the results of the metrics stage to the statistics and print the log line of the picture
+Void TEncGOP::xReportPicMetrics()
+{
+  Double  dYPSNR  = m_adMetricsPSNR[0];
+  Double  dUPSNR  = m_adMetricsPSNR[1];
+  Double  dVPSNR  = m_adMetricsPSNR[2];
+  UInt    uibits  = m_uiMetricsBits;
+#if _Cal_SSIM_
+  Double  dCurMsSSIM = m_dMetricsMsSSIM;
+#endif
+  Bool    bIntra  = m_eMetricsSliceType == I_SLICE;
+  Bool    bInterP = m_eMetricsSliceType == P_SLICE;
+  Bool    bInterB = m_eMetricsSliceType == B_SLICE;
 
   //===== add PSNR =====
 #if _Cal_SSIM_
-  TComSlice*  pcSlice = pcPic->getSlice(0);
   if(m_pcCfg->getPrintSSIM())
   {
     m_gcAnalyzeAll.addSSIMResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits, m_dCurSSIM, dCurMsSSIM);
 
-    if (pcSlice->isIntra())
+    if (bIntra)
     {
       m_gcAnalyzeI.addSSIMResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits, m_dCurSSIM, dCurMsSSIM);
     }
-    if (pcSlice->isInterP())
+    if (bInterP)
     {
       m_gcAnalyzeP.addSSIMResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits, m_dCurSSIM, dCurMsSSIM);
     }
-    if (pcSlice->isInterB())
+    if (bInterB)
     {
       m_gcAnalyzeB.addSSIMResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits, m_dCurSSIM, dCurMsSSIM);
     }
@@ -1580,15 +1702,15 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   {
     m_gcAnalyzeAll.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
 
-    if (pcSlice->isIntra())
+    if (bIntra)
     {
       m_gcAnalyzeI.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
     }
-    if (pcSlice->isInterP())
+    if (bInterP)
     {
       m_gcAnalyzeP.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
     }
-    if (pcSlice->isInterB())
+    if (bInterB)
     {
       m_gcAnalyzeB.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
     }
@@ -1596,29 +1718,28 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
 #else //_Cal_SSIM_
 
   m_gcAnalyzeAll.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
-  TComSlice*  pcSlice = pcPic->getSlice(0);
-  if (pcSlice->isIntra())
+  if (bIntra)
   {
     m_gcAnalyzeI.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
   }
-  if (pcSlice->isInterP())
+  if (bInterP)
   {
     m_gcAnalyzeP.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
   }
-  if (pcSlice->isInterB())
+  if (bInterB)
   {
     m_gcAnalyzeB.addResult (dYPSNR, dUPSNR, dVPSNR, (Double)uibits);
   }
 #endif //_Cal_SSIM_
 
-  Char c = (pcSlice->isIntra() ? 'I' : pcSlice->isInterP() ? 'P' : 'B');
-  if (!pcSlice->isReferenced()) c += 32;
+  Char c = (bIntra ? 'I' : bInterP ? 'P' : 'B');
+  if (!m_bMetricsReferenced) c += 32;
 
   printf("POC %4d TId: %1d ( %c-SLICE, QP %d ) %10d bits",
-    pcSlice->getPOC()-pcSlice->getLastIDR(),
-    pcSlice->getTLayer(),
+    m_iMetricsPOC,
+    m_iMetricsTId,
     c,
-    pcSlice->getSliceQp(),
+    m_iMetricsQP,
     uibits );
 
 #if _Cal_SSIM_
@@ -1627,31 +1748,39 @@ Void TEncGOP::xCalculateAddPSNR( TComPic* pcPic, TComPicYuv* pcPicD, const Acces
   else
     printf(" [Y %6.4lf dB    U %6.4lf dB    V %6.4lf dB]", dYPSNR, dUPSNR, dVPSNR );
 
-  printf(" [ET %5.0f ]", dEncTime );
+  printf(" [ET %5.0f ]", m_dMetricsEncTime );
   
   for (Int iRefList = 0; iRefList < 2; iRefList++)
   {
     printf(" [L%d ", iRefList);
-    for (Int iRefIndex = 0; iRefIndex < pcSlice->getNumRefIdx(RefPicList(iRefList)); iRefIndex++)
+    for (Int iRefIndex = 0; iRefIndex < (Int)m_aiMetricsRefPOC[iRefList].size(); iRefIndex++)
     {
-      printf ("%d ", pcSlice->getRefPOC(RefPicList(iRefList), iRefIndex)-pcSlice->getLastIDR());
+      printf ("%d ", m_aiMetricsRefPOC[iRefList][iRefIndex]);
     }
     printf("]");
   }
 #else  //_Cal_SSIM_
   printf(" [Y %6.4lf dB    U %6.4lf dB    V %6.4lf dB]", dYPSNR, dUPSNR, dVPSNR );
-  printf(" [ET %5.0f ]", dEncTime );
+  printf(" [ET %5.0f ]", m_dMetricsEncTime );
 
   for (Int iRefList = 0; iRefList < 2; iRefList++)
   {
     printf(" [L%d ", iRefList);
-    for (Int iRefIndex = 0; iRefIndex < pcSlice->getNumRefIdx(RefPicList(iRefList)); iRefIndex++)
+    for (Int iRefIndex = 0; iRefIndex < (Int)m_aiMetricsRefPOC[iRefList].size(); iRefIndex++)
     {
-      printf ("%d ", pcSlice->getRefPOC(RefPicList(iRefList), iRefIndex)-pcSlice->getLastIDR());
+      printf ("%d ", m_aiMetricsRefPOC[iRefList][iRefIndex]);
     }
     printf("]");
   }
 #endif //_Cal_SSIM_
+
+  if (!m_sMetricsDigest.empty())
+  {
+    printf(" [%s]", m_sMetricsDigest.c_str());
+  }
+  /* logging: insert a newline at end of picture period */
+  printf("\n");
+  fflush(stdout);
 }
 
 
@@ -1895,6 +2024,59 @@ Int TEncGOP::xGetFirstSeiLocation(AccessUnit &accessUnit)
   return seiStartPos;
 }
 
+/** write the buffering period SEI message at IRAP pictures and the picture timing SEI message at every picture,
+ *  with the CPB state of the rate control
+ */
+Void TEncGOP::xCreateHrdSEIMessages( AccessUnit &accessUnit, TComSlice *pcSlice )
+{
+  TComHRD *hrd = m_pcEncTop->getVPS()->getHrdParameters( 0 );
+  m_seiWriter.setHrdParameters( hrd );
+  m_pcEntropyCoder->setEntropyCoder( m_pcCavlcCoder, pcSlice );
+
+  if ( pcSlice->getRapPicFlag() )
+  {
+    OutputNALUnit nalu( NAL_UNIT_PREFIX_SEI );
+    m_pcEntropyCoder->setBitstream( &nalu.m_Bitstream );
+
+    SEIBufferingPeriod sei_buffering_period;
+    UInt initialCpbRemovalDelay = m_pcRateCtrl->getRCSeq()->getInitialCpbRemovalDelay();
+    sei_buffering_period.m_bpSeqParameterSetId           = pcSlice->getSPS()->getSPSId();
+    sei_buffering_period.m_initialCpbRemovalDelay[0][0]       = initialCpbRemovalDelay;
+    sei_buffering_period.m_initialCpbRemovalDelayOffset[0][0] = 0;
+    m_seiWriter.writeSEImessage( nalu.m_Bitstream, sei_buffering_period, pcSlice->getSPS() );
+    writeRBSPTrailingBits( nalu.m_Bitstream );
+    accessUnit.push_back( new NALUnitEBSP( nalu ) );
+
+    m_lastBPSEI = m_totalCoded;
+  }
+
+  OutputNALUnit nalu( NAL_UNIT_PREFIX_SEI, pcSlice->getTLayer() );
+  m_pcEntropyCoder->setBitstream( &nalu.m_Bitstream );
+
+  SEIPictureTiming sei_picture_timing;
+  UInt maxDelay = ( 1u << ( hrd->getCpbRemovalDelayLengthMinus1() + 1 ) ) - 1;
+  Int  numReorderPics = pcSlice->getSPS()->getNumReorderPics( pcSlice->getSPS()->getMaxTLayers() - 1 );
+  sei_picture_timing.m_auCpbRemovalDelay = min( max( 1u, m_totalCoded - m_lastBPSEI ), maxDelay );
+  sei_picture_timing.m_picDpbOutputDelay = max( 0, numReorderPics + pcSlice->getPOC() - (Int)m_totalCoded );
+  m_seiWriter.writeSEImessage( nalu.m_Bitstream, sei_picture_timing, pcSlice->getSPS() );
+  writeRBSPTrailingBits( nalu.m_Bitstream );
+  accessUnit.push_back( new NALUnitEBSP( nalu ) );
+}
+
+/** size of the access unit in the byte stream, as seen by the NAL HRD: start codes are counted as written by writeAnnexB()
+ */
+UInt TEncGOP::xGetAccessUnitBits( const AccessUnit &accessUnit )
+{
+  UInt numBytes = 0;
+  for ( AccessUnit::const_iterator it = accessUnit.begin(); it != accessUnit.end(); it++ )
+  {
+    NalUnitType nalUnitType = (*it)->m_nalUnitType;
+    Bool zeroByte = it == accessUnit.begin() || nalUnitType == NAL_UNIT_VPS || nalUnitType == NAL_UNIT_SPS || nalUnitType == NAL_UNIT_PPS;
+    numBytes += ( zeroByte ? 4 : 3 ) + UInt( (*it)->m_nalUnitData.str().size() );
+  }
+  return numBytes * 8;
+}
+
 Void TEncGOP::dblMetric( TComPic* pcPic, UInt uiNumSlices )
 {
   TComPicYuv* pcPicYuvRec = pcPic->getPicYuvRec();
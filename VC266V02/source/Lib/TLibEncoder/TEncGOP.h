@@ -39,6 +39,7 @@
 #define __TENCGOP__
 
 #include <list>
+#include <string>
 
 #include <stdlib.h>
 
@@ -72,7 +73,7 @@ class TEncTop;
 // ====================================================================================================================
 
 /// GOP encoder class
-class TEncGOP
+class TEncGOP : public TComParallelJob
 {
 private:
   //  Data
@@ -107,6 +108,10 @@ private:
   // Adaptive Loop filter
   TEncAdaptiveLoopFilter* m_pcAdaptiveLoopFilter;
 #endif
+  // in-loop filters driven by the slice encoder one CTU row at a time (CTU-row ALF mode)
+  Bool                    m_bFilterCtuRows;     ///< in-loop filters of the current picture run during compressSlice
+  Int                     m_iDeblockedCtuRows;
+  Int                     m_iFilteredCtuRows;   ///< CTU rows handed to SAO and ALF
 
   //--Adaptive Loop filter
   TEncSampleAdaptiveOffset*  m_pcSAO;
@@ -129,6 +134,21 @@ private:
   UInt                    m_tl0Idx;
   UInt                    m_rapIdx;
 
+  // metrics stage: PSNR/SSIM of one picture, optionally on its own thread while the next picture is encoded
+  TComThreadPool          m_cMetricsThread;     ///< runs the metrics stage (async-metrics mode)
+  TComPic*                m_pcMetricsPic;       ///< picture handed to the metrics stage, NULL if none
+  Double                  m_dMetricsEncTime;    ///< encoding time of m_pcMetricsPic
+  UInt                    m_uiMetricsBits;      ///< coded bits of m_pcMetricsPic, SEI excluded
+  SliceType               m_eMetricsSliceType;  ///< slice data of m_pcMetricsPic, taken before later RPS changes
+  Bool                    m_bMetricsReferenced;
+  Int                     m_iMetricsPOC;
+  Int                     m_iMetricsTId;
+  Int                     m_iMetricsQP;
+  std::vector<Int>        m_aiMetricsRefPOC[2];
+  std::string             m_sMetricsDigest;     ///< decoded picture hash type and string, empty if not computed
+  Double                  m_adMetricsPSNR[3];   ///< results of the metrics stage
+  Double                  m_dMetricsMsSSIM;
+
 #if _Cal_SSIM_
   /* Input options */
   int             m_iWidth;
@@ -178,7 +198,13 @@ public:
   
   Void  printOutSummary      ( UInt uiNumAllPicCoded );
   Void  preLoopFilterPicAll  ( TComPic* pcPic, UInt64& ruiDist, UInt64& ruiBits );
+  Bool  getFilterCtuRows     ()                 { return m_bFilterCtuRows; }
+  Void  filterCtuRows        ( TComPic* pcPic, Int iNumCodedRows );
   
+  Void  finishMetrics        ();
+  Bool  isInMetricsStage     ( TComPic* pcPic ) { return pcPic == m_pcMetricsPic; }
+  Void  runItem              ( Int itemIdx, Int threadIdx );
+
   TEncSlice*  getSliceEncoder()   { return m_pcSliceEncoder; }
   NalUnitType getNalUnitType( Int pocCurr, Int lastIdr );
   Void arrangeLongtermPicturesInRPS(TComSlice *, TComList<TComPic*>& );
@@ -196,7 +222,9 @@ protected:
   Void  xInitGOP          ( Int iPOC, Int iNumPicRcvd, TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut );
   Void  xGetBuffer        ( TComList<TComPic*>& rcListPic, TComList<TComPicYuv*>& rcListPicYuvRecOut, Int iNumPicRcvd, Int iTimeOffset, TComPic*& rpcPic, TComPicYuv*& rpcPicYuvRecOut, Int pocCurr );
   
-  Void  xCalculateAddPSNR ( TComPic* pcPic, TComPicYuv* pcPicD, const AccessUnit&, Double dEncTime );
+  Void  xStartPicMetrics  ( TComPic* pcPic, const AccessUnit&, Double dEncTime );
+  Void  xCalculatePicMetrics ( TComPic* pcPic, TComPicYuv* pcPicD, TComThreadPool* pcThreadPool );
+  Void  xReportPicMetrics ();
   
   UInt64 xFindDistortionFrame (TComPicYuv* pcPic0, TComPicYuv* pcPic1);
 
@@ -204,7 +232,13 @@ protected:
 
   Void xCreateLeadingSEIMessages (/*SEIMessages seiMessages,*/ AccessUnit &accessUnit, TComSPS *sps);
   Int xGetFirstSeiLocation (AccessUnit &accessUnit);
+  Void xCreateHrdSEIMessages (AccessUnit &accessUnit, TComSlice *pcSlice);
+  UInt xGetAccessUnitBits (const AccessUnit &accessUnit);
   Void dblMetric( TComPic* pcPic, UInt uiNumSlices );
+#if ALF_TEST
+  Void xStartCtuRowFilters ( TComPic* pcPic, TComOutputBitstream* pcSubstreamsOut, Int iNumSubstreams );
+  Void xWriteALFParam      ( TComSlice* pcSlice, ALFParam* pcAlfParam, UInt uiMaxAlfCtrlDepth, TComOutputBitstream* pcSubstreamsOut, Int iNumSubstreams );
+#endif
 };// END CLASS DEFINITION TEncGOP
 
 // ====================================================================================================================
@@ -66,6 +66,10 @@ TEncRCSeq::TEncRCSeq()
   m_useLCUSeparateModel = false;
   m_adaptiveBit         = 0;
   m_lastLambda          = 0.0;
+  m_lookaheadRefCost    = NULL;
+  m_cpbSize             = 0;
+  m_cpbBitrate          = 0;
+  m_cpbFullness         = 0.0;
 }
 
 TEncRCSeq::~TEncRCSeq()
@@ -153,6 +157,12 @@ Void TEncRCSeq::create( Int totalFrames, Int targetBitrate, Int frameRate, Int G
     }
   }
 
+  m_lookaheadRefCost = new Double[m_numberOfLevel];
+  for ( Int i=0; i<m_numberOfLevel; i++ )
+  {
+    m_lookaheadRefCost[i] = -1.0;
+  }
+
   m_framesLeft = m_totalFrames;
   m_bitsLeft   = m_targetBits;
   m_adaptiveBit = adaptiveBit;
@@ -188,6 +198,12 @@ Void TEncRCSeq::destroy()
     delete[] m_LCUPara;
     m_LCUPara = NULL;
   }
+
+  if ( m_lookaheadRefCost != NULL )
+  {
+    delete[] m_lookaheadRefCost;
+    m_lookaheadRefCost = NULL;
+  }
 }
 
 Void TEncRCSeq::initBitsRatio( Int bitsRatio[])
@@ -281,11 +297,37 @@ Void TEncRCSeq::setAllBitRatio( Double basicLambda, Double* equaCoeffA, Double*
   delete[] bitsRatio;
 }
 
+Void TEncRCSeq::initCpb( Int cpbSize, Int cpbBitrate )
+{
+  m_cpbSize     = cpbSize;
+  m_cpbBitrate  = cpbBitrate;
+  m_cpbFullness = g_RCCpbInitialFullness * m_cpbSize;
+}
+
+/** remove the access unit of bits from the CPB and refill it for one picture period at the CPB bitrate
+ */
+Void TEncRCSeq::updateCpb( Int bits )
+{
+  if ( m_cpbSize <= 0 )
+  {
+    return;
+  }
+
+  m_cpbFullness -= bits;
+  if ( m_cpbFullness < 0.0 )
+  {
+    printf( "\nWarning: CPB underflow by %d bits\n", Int( -m_cpbFullness ) );
+    m_cpbFullness = 0.0;
+  }
+  m_cpbFullness = min( (Double)m_cpbSize, m_cpbFullness + (Double)m_cpbBitrate / (Double)m_frameRate );
+}
+
 //GOP level
 TEncRCGOP::TEncRCGOP()
 {
   m_encRCSeq  = NULL;
   m_picTargetBitInGOP = NULL;
+  m_avgLookaheadCost = 0.0;
   m_numPic     = 0;
   m_targetBits = 0;
   m_picLeft    = 0;
@@ -297,9 +339,26 @@ TEncRCGOP::~TEncRCGOP()
   destroy();
 }
 
-Void TEncRCGOP::create( TEncRCSeq* encRCSeq, Int numPic )
+Void TEncRCGOP::create( TEncRCSeq* encRCSeq, Int numPic, TRCLookaheadPic* lookaheadPics )
 {
   destroy();
+
+  m_avgLookaheadCost = 0.0;
+  if ( lookaheadPics != NULL )
+  {
+    Int numCosts = 0;
+    m_lookaheadPics.assign( lookaheadPics, lookaheadPics + numPic );
+    for ( Int i=0; i<numPic; i++ )
+    {
+      if ( lookaheadPics[i].m_cost > 0.0 )
+      {
+        m_avgLookaheadCost += lookaheadPics[i].m_cost;
+        numCosts++;
+      }
+    }
+    m_avgLookaheadCost = numCosts > 0 ? m_avgLookaheadCost / numCosts : 0.0;
+  }
+
   Int targetBits = xEstGOPTargetBits( encRCSeq, numPic );
 
   if ( encRCSeq->getAdaptiveBits() > 0 && encRCSeq->getLastLambda() > 0.1 )
@@ -362,21 +421,21 @@ Void TEncRCGOP::create( TEncRCSeq* encRCSeq, Int numPic )
     delete []equaCoeffB;
   }
 
+  m_encRCSeq    = encRCSeq;
   m_picTargetBitInGOP = new Int[numPic];
   Int i;
-  Int totalPicRatio = 0;
-  Int currPicRatio = 0;
+  Double totalPicRatio = 0;
+  Double currPicRatio = 0;
   for ( i=0; i<numPic; i++ )
   {
-    totalPicRatio += encRCSeq->getBitRatio( i );
+    totalPicRatio += encRCSeq->getBitRatio( i ) * getPicCostWeight( i );
   }
   for ( i=0; i<numPic; i++ )
   {
-    currPicRatio = encRCSeq->getBitRatio( i );
+    currPicRatio = encRCSeq->getBitRatio( i ) * getPicCostWeight( i );
     m_picTargetBitInGOP[i] = (Int)( ((Double)targetBits) * currPicRatio / totalPicRatio );
   }
 
-  m_encRCSeq    = encRCSeq;
   m_numPic       = numPic;
   m_targetBits   = targetBits;
   m_picLeft      = m_numPic;
@@ -437,6 +496,21 @@ Void TEncRCGOP::destroy()
     delete[] m_picTargetBitInGOP;
     m_picTargetBitInGOP = NULL;
   }
+  m_lookaheadPics.clear();
+}
+
+/** scale of the hierarchical bit ratio of picture i in coding order by its complexity relative to the GOP
+ * \param i position of the picture in the GOP
+ * \returns 1.0 if no lookahead result is available
+ */
+Double TEncRCGOP::getPicCostWeight( Int i )
+{
+  TRCLookaheadPic* lookaheadPic = getLookaheadPic( i );
+  if ( lookaheadPic == NULL || m_avgLookaheadCost <= 0.0 )
+  {
+    return 1.0;
+  }
+  return pow( lookaheadPic->m_cost / m_avgLookaheadCost, g_RCLookaheadPicCostExp );
 }
 
 Void TEncRCGOP::updateAfterPicture( Int bitsCost )
@@ -483,6 +557,11 @@ TEncRCPic::TEncRCPic()
   m_picActualBits       = 0;
   m_picQP               = 0;
   m_picLambda           = 0.0;
+  m_lookaheadCost       = -1.0;
+  m_lookaheadCostRatio  = 1.0;
+  m_maxTargetBits       = -1;
+  m_maxPicBits          = -1;
+  m_LCUBitsCoded        = 0;
 }
 
 TEncRCPic::~TEncRCPic()
@@ -497,11 +576,11 @@ Int TEncRCPic::xEstPicTargetBits( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP )
 
   Int i;
   Int currPicPosition = encRCGOP->getNumPic()-encRCGOP->getPicLeft();
-  Int currPicRatio    = encRCSeq->getBitRatio( currPicPosition );
-  Int totalPicRatio   = 0;
+  Double currPicRatio  = encRCSeq->getBitRatio( currPicPosition ) * encRCGOP->getPicCostWeight( currPicPosition );
+  Double totalPicRatio = 0;
   for ( i=currPicPosition; i<encRCGOP->getNumPic(); i++ )
   {
-    totalPicRatio += encRCSeq->getBitRatio( i );
+    totalPicRatio += encRCSeq->getBitRatio( i ) * encRCGOP->getPicCostWeight( i );
   }
 
   targetBits  = Int( ((Double)GOPbitsLeft) * currPicRatio / totalPicRatio );
@@ -570,6 +649,16 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
     targetBits = estHeaderBits + 100;   // at least allocate 100 bits for picture data
   }
 
+  m_maxTargetBits = -1;
+  m_maxPicBits    = -1;
+  if ( encRCSeq->getUseCpb() )
+  {
+    // plan at most a share of the bits in the CPB, and bound the coded picture below its fullness
+    m_maxTargetBits = max( estHeaderBits + 100, Int( encRCSeq->getCpbFullness() * g_RCCpbMaxTargetRatio ) );
+    m_maxPicBits    = max( m_maxTargetBits,     Int( encRCSeq->getCpbFullness() * g_RCCpbMaxPicRatio ) );
+    targetBits      = min( targetBits, m_maxTargetBits );
+  }
+
   m_frameLevel       = frameLevel;
   m_numberOfPixel    = encRCSeq->getNumPixel();
   m_numberOfLCU      = encRCSeq->getNumberOfLCU();
@@ -587,6 +676,11 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
   m_LCULeft         = m_numberOfLCU;
   m_bitsLeft       -= m_estHeaderBits;
   m_pixelsLeft      = m_numberOfPixel;
+  m_LCUBitsCoded    = 0;
+
+  TRCLookaheadPic* lookaheadPic = encRCGOP->getLookaheadPic( encRCGOP->getNumPic() - encRCGOP->getPicLeft() );
+  m_lookaheadCost      = lookaheadPic != NULL ? lookaheadPic->m_cost : -1.0;
+  m_lookaheadCostRatio = 1.0;
 
   m_LCUs           = new TRCLCU[m_numberOfLCU];
   Int i, j;
@@ -601,6 +695,7 @@ Void TEncRCPic::create( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP, Int frameLevel
       m_LCUs[LCUIdx].m_lambda     = 0.0;
       m_LCUs[LCUIdx].m_targetBits = 0;
       m_LCUs[LCUIdx].m_bitWeight  = 1.0;
+      m_LCUs[LCUIdx].m_lookaheadCost = lookaheadPic != NULL ? lookaheadPic->m_LCUCost[LCUIdx] : -1.0;
       Int currWidth  = ( (i == picWidthInLCU -1) ? picWidth  - LCUWidth *(picWidthInLCU -1) : LCUWidth  );
       Int currHeight = ( (j == picHeightInLCU-1) ? picHeight - LCUHeight*(picHeightInLCU-1) : LCUHeight );
       m_LCUs[LCUIdx].m_numberOfPixel = currWidth * currHeight;
@@ -636,7 +731,13 @@ Double TEncRCPic::estimatePicLambda( list<TEncRCPic*>& listPreviousPictures, Sli
   }
   else
   {
-    estLambda = alpha * pow( bpp, beta );
+    // with lookahead, the model works on the bpp scaled to the complexity of the pictures it was fitted to
+    Double refCost = m_encRCSeq->getLookaheadRefCost( m_frameLevel );
+    if ( m_lookaheadCost > 0.0 && refCost > 0.0 )
+    {
+      m_lookaheadCostRatio = Clip3( 1.0/g_RCLookaheadMaxCostRatio, g_RCLookaheadMaxCostRatio, refCost / m_lookaheadCost );
+    }
+    estLambda = alpha * pow( bpp * m_lookaheadCostRatio, beta );
   }
   
   Double lastLevelLambda = -1.0;
@@ -686,6 +787,11 @@ Double TEncRCPic::estimatePicLambda( list<TEncRCPic*>& listPreviousPictures, Sli
   m_estPicLambda = estLambda;
 
   Double totalWeight = 0.0;
+  Double avgLCUCost  = 0.0;
+  if ( m_lookaheadCost > 0.0 )
+  {
+    avgLCUCost = m_lookaheadCost / m_numberOfPixel;
+  }
   // initial BU bit allocation weight
   for ( Int i=0; i<m_numberOfLCU; i++ )
   {
@@ -702,6 +808,11 @@ Double TEncRCPic::estimatePicLambda( list<TEncRCPic*>& listPreviousPictures, Sli
     }
 
     m_LCUs[i].m_bitWeight =  m_LCUs[i].m_numberOfPixel * pow( estLambda/alphaLCU, 1.0/betaLCU );
+    if ( avgLCUCost > 0.0 )
+    {
+      Double LCUCost = Clip3( 0.01 * avgLCUCost, 100.0 * avgLCUCost, m_LCUs[i].m_lookaheadCost / m_LCUs[i].m_numberOfPixel );
+      m_LCUs[i].m_bitWeight *= pow( LCUCost / avgLCUCost, g_RCLookaheadLCUCostExp );
+    }
 
     if ( m_LCUs[i].m_bitWeight < 0.01 )
     {
@@ -851,6 +962,8 @@ Double TEncRCPic::getLCUEstLambda( Double bpp )
     estLambda = 0.1;
   }
 
+  estLambda *= pow( 2.0, xGetCpbQPOffset() / 3.0 );
+
   return estLambda;
 }
 
@@ -870,16 +983,36 @@ Int TEncRCPic::getLCUEstQP( Double lambda, Int clipPicQP )
     }
   }
 
+  // lambda already carries the CPB QP offset (getLCUEstLambda), so only the clip range is shifted by it
+  Int cpbQPOffset = xGetCpbQPOffset();
   if ( clipNeighbourQP > g_RCInvalidQPValue )
   {
-    estQP = Clip3( clipNeighbourQP - 1, clipNeighbourQP + 1, estQP );
+    estQP = Clip3( clipNeighbourQP - 1 + cpbQPOffset, clipNeighbourQP + 1 + cpbQPOffset, estQP );
   }
 
-  estQP = Clip3( clipPicQP - 2, clipPicQP + 2, estQP );
+  estQP = Clip3( clipPicQP - 2 + cpbQPOffset, clipPicQP + 2 + cpbQPOffset, estQP );
 
   return estQP;
 }
 
+/** QP increase that brings the bits of the picture, projected from the LCUs coded so far, back below the CPB bound
+ */
+Int TEncRCPic::xGetCpbQPOffset()
+{
+  if ( m_maxPicBits <= 0 || m_pixelsLeft >= m_numberOfPixel || m_LCUBitsCoded <= 0 )
+  {
+    return 0;
+  }
+
+  Double projectedBits = m_estHeaderBits + (Double)m_LCUBitsCoded * m_numberOfPixel / ( m_numberOfPixel - m_pixelsLeft );
+  if ( projectedBits <= m_maxPicBits )
+  {
+    return 0;
+  }
+  // the bits roughly halve for every 6 QP
+  return Int( ceil( 6.0 * log( projectedBits / m_maxPicBits ) / log( 2.0 ) ) );
+}
+
 Void TEncRCPic::updateAfterLCU( Int LCUIdx, Int bits, Int QP, Double lambda, Bool updateLCUParameter )
 {
   m_LCUs[LCUIdx].m_actualBits = bits;
@@ -889,6 +1022,7 @@ Void TEncRCPic::updateAfterLCU( Int LCUIdx, Int bits, Int QP, Double lambda, Boo
   m_LCULeft--;
   m_bitsLeft   -= bits;
   m_pixelsLeft -= m_LCUs[LCUIdx].m_numberOfPixel;
+  m_LCUBitsCoded += bits;
 
   if ( !updateLCUParameter )
   {
@@ -1018,7 +1152,7 @@ Void TEncRCPic::updateAfterPicture( Int actualHeaderBits, Int actualTotalBits, D
   {
     // update parameters
     Double picActualBits = ( Double )m_picActualBits;
-    Double picActualBpp  = picActualBits/(Double)m_numberOfPixel;
+    Double picActualBpp  = picActualBits/(Double)m_numberOfPixel * m_lookaheadCostRatio;
     Double calLambda     = alpha * pow( picActualBpp, beta );
     Double inputLambda   = m_picLambda;
 
@@ -1053,6 +1187,13 @@ Void TEncRCPic::updateAfterPicture( Int actualHeaderBits, Int actualTotalBits, D
 
   m_encRCSeq->setPicPara( m_frameLevel, rcPara );
 
+  if ( eSliceType != I_SLICE && m_lookaheadCost > 0.0 )
+  {
+    Double refCost = m_encRCSeq->getLookaheadRefCost( m_frameLevel );
+    refCost = refCost > 0.0 ? g_RCWeightHistoryCost * refCost + ( 1.0 - g_RCWeightHistoryCost ) * m_lookaheadCost : m_lookaheadCost;
+    m_encRCSeq->setLookaheadRefCost( m_frameLevel, refCost );
+  }
+
   if ( m_frameLevel == 1 )
   {
     Double currLambda = Clip3( 0.1, 10000.0, m_picLambda );
@@ -1139,6 +1280,11 @@ Double TEncRCPic::getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP)
     minQP = max(clipNeighbourQP - 1, minQP); 
   }
 
+  Int cpbQPOffset = xGetCpbQPOffset();
+  minQP     += cpbQPOffset;
+  maxQP     += cpbQPOffset;
+  estLambda *= pow( 2.0, cpbQPOffset / 3.0 );
+
   Double maxLambda=exp(((Double)(maxQP+0.49)-13.7122)/4.2005);
   Double minLambda=exp(((Double)(minQP-0.49)-13.7122)/4.2005);
 
@@ -1150,11 +1296,239 @@ Double TEncRCPic::getLCUEstLambdaAndQP(Double bpp, Int clipPicQP, Int *estQP)
   return estLambda;
 }
 
+//lookahead
+TEncRCLookahead::TEncRCLookahead()
+{
+  m_pcPic         = NULL;
+  m_prevPOC       = -1;
+  m_pLowres[0]    = NULL;
+  m_pLowres[1]    = NULL;
+  m_lowresWidth   = 0;
+  m_lowresHeight  = 0;
+  m_picWidth      = 0;
+  m_picHeight     = 0;
+  m_LCUWidth      = 0;
+  m_LCUHeight     = 0;
+  m_picWidthInLCU = 0;
+  m_numberOfLCU   = 0;
+}
+
+TEncRCLookahead::~TEncRCLookahead()
+{
+  destroy();
+}
+
+Void TEncRCLookahead::create( Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight )
+{
+  destroy();
+  m_picWidth      = picWidth;
+  m_picHeight     = picHeight;
+  m_LCUWidth      = LCUWidth;
+  m_LCUHeight     = LCUHeight;
+  m_picWidthInLCU = ( picWidth + LCUWidth - 1 ) / LCUWidth;
+  m_numberOfLCU   = m_picWidthInLCU * ( ( picHeight + LCUHeight - 1 ) / LCUHeight );
+  m_lowresWidth   = ( ( picWidth  + 1 ) / 2 + 7 ) & ~7;
+  m_lowresHeight  = ( ( picHeight + 1 ) / 2 + 7 ) & ~7;
+  m_pLowres[0]    = new Pel[m_lowresWidth * m_lowresHeight];
+  m_pLowres[1]    = new Pel[m_lowresWidth * m_lowresHeight];
+  m_prevPOC       = -1;
+  m_cThread.create( 2 );
+}
+
+Void TEncRCLookahead::destroy()
+{
+  m_cThread.waitJob();
+  m_cThread.destroy();
+  for ( Int i=0; i<2; i++ )
+  {
+    if ( m_pLowres[i] != NULL )
+    {
+      delete[] m_pLowres[i];
+      m_pLowres[i] = NULL;
+    }
+  }
+  m_results.clear();
+  m_pcPic = NULL;
+}
+
+Void TEncRCLookahead::addPicture( TComPic* pcPic )
+{
+  m_cThread.waitJob();
+  m_pcPic = pcPic;
+  m_cThread.startJob( this, 1 );
+}
+
+Void TEncRCLookahead::waitForAnalysis()
+{
+  m_cThread.waitJob();
+}
+
+Bool TEncRCLookahead::takeResult( Int POC, TRCLookaheadPic& rcPic )
+{
+  std::map<Int, TRCLookaheadPic>::iterator it = m_results.find( POC );
+  if ( it == m_results.end() )
+  {
+    return false;
+  }
+  rcPic = it->second;
+  m_results.erase( it );
+  return true;
+}
+
+/** analyse m_pcPic: half-resolution intra and inter SATD of each 8x8 block, i.e. 16x16 at full resolution
+ */
+Void TEncRCLookahead::runItem( Int itemIdx, Int threadIdx )
+{
+  Int POC = m_pcPic->getPOC();
+  xDownsample( m_pcPic->getPicYuvOrg(), m_pLowres[0] );
+  Bool hasPrev = ( m_prevPOC >= 0 && m_prevPOC == POC - 1 );
+
+  TRCLookaheadPic& rcResult = m_results[POC];
+  rcResult.m_POC  = POC;
+  rcResult.m_cost = 0.0;
+  rcResult.m_LCUCost.assign( m_numberOfLCU, 0.0 );
+
+  Int shift = g_bitDepthY - 8, offset = ( shift > 0 ) ? ( 1 << ( shift - 1 ) ) : 0;
+  for ( Int blkY=0; blkY < m_lowresHeight; blkY+=8 )
+  {
+    for ( Int blkX=0; blkX < m_lowresWidth; blkX+=8 )
+    {
+      if ( 2*blkX >= m_picWidth || 2*blkY >= m_picHeight )
+      {
+        continue;
+      }
+      UInt cost = xGetIntraCost( blkX, blkY );
+      if ( hasPrev )
+      {
+        cost = min( cost, xGetInterCost( blkX, blkY ) );
+      }
+      // at least one unit per block, so that flat areas still get a share of the bits
+      Double blkCost = (Double)( ( cost + offset ) >> shift ) + 1.0;
+      rcResult.m_cost += blkCost;
+      rcResult.m_LCUCost[( 2*blkY / m_LCUHeight ) * m_picWidthInLCU + 2*blkX / m_LCUWidth] += blkCost;
+    }
+  }
+
+  std::swap( m_pLowres[0], m_pLowres[1] );
+  m_prevPOC = POC;
+}
+
+Void TEncRCLookahead::xDownsample( TComPicYuv* pcPicYuv, Pel* pDst )
+{
+  Pel* pSrc      = pcPicYuv->getLumaAddr();
+  Int  srcStride = pcPicYuv->getStride();
+  Int  width     = m_picWidth  / 2;
+  Int  height    = m_picHeight / 2;
+
+  for ( Int y=0; y<height; y++ )
+  {
+    Pel* pLine0 = pSrc + 2*y*srcStride;
+    Pel* pLine1 = pLine0 + srcStride;
+    Pel* pOut   = pDst + y*m_lowresWidth;
+    for ( Int x=0; x<width; x++ )
+    {
+      pOut[x] = ( pLine0[2*x] + pLine0[2*x+1] + pLine1[2*x] + pLine1[2*x+1] + 2 ) >> 2;
+    }
+    for ( Int x=width; x<m_lowresWidth; x++ )
+    {
+      pOut[x] = pOut[width-1];
+    }
+  }
+  for ( Int y=height; y<m_lowresHeight; y++ )
+  {
+    ::memcpy( pDst + y*m_lowresWidth, pDst + (height-1)*m_lowresWidth, sizeof(Pel)*m_lowresWidth );
+  }
+}
+
+/** SATD of the block against the DC of its left and above neighbours, or against its own mean at the picture corner
+ */
+UInt TEncRCLookahead::xGetIntraCost( Int blkX, Int blkY )
+{
+  Pel* pOrg = m_pLowres[0] + blkY*m_lowresWidth + blkX;
+  Int  sum  = 0;
+  Int  num  = 0;
+  if ( blkY > 0 )
+  {
+    for ( Int x=0; x<8; x++ )
+    {
+      sum += pOrg[x - m_lowresWidth];
+    }
+    num += 8;
+  }
+  if ( blkX > 0 )
+  {
+    for ( Int y=0; y<8; y++ )
+    {
+      sum += pOrg[y*m_lowresWidth - 1];
+    }
+    num += 8;
+  }
+  if ( num == 0 )
+  {
+    for ( Int y=0; y<8; y++ )
+    {
+      for ( Int x=0; x<8; x++ )
+      {
+        sum += pOrg[y*m_lowresWidth + x];
+      }
+    }
+    num = 64;
+  }
+
+  Pel dc = ( sum + num/2 ) / num;
+  for ( Int i=0; i<64; i++ )
+  {
+    m_pred[i] = dc;
+  }
+  return m_cRdCost.calcHAD( g_bitDepthY, pOrg, m_lowresWidth, m_pred, 8, 8, 8 );
+}
+
+/** SATD of the block against the best SAD match of a full search in the previous picture
+ */
+UInt TEncRCLookahead::xGetInterCost( Int blkX, Int blkY )
+{
+  Pel* pOrg   = m_pLowres[0] + blkY*m_lowresWidth + blkX;
+  Pel* pRef   = m_pLowres[1] + blkY*m_lowresWidth + blkX;
+  Int  minX   = -min( g_RCLookaheadSearchRange, blkX );
+  Int  maxX   =  min( g_RCLookaheadSearchRange, m_lowresWidth  - 8 - blkX );
+  Int  minY   = -min( g_RCLookaheadSearchRange, blkY );
+  Int  maxY   =  min( g_RCLookaheadSearchRange, m_lowresHeight - 8 - blkY );
+  Int  bestX  = 0;
+  Int  bestY  = 0;
+  UInt bestSad = MAX_UINT;
+
+  for ( Int mvY=minY; mvY<=maxY; mvY++ )
+  {
+    for ( Int mvX=minX; mvX<=maxX; mvX++ )
+    {
+      Pel* pCand = pRef + mvY*m_lowresWidth + mvX;
+      UInt sad   = 0;
+      for ( Int y=0; y<8 && sad<bestSad; y++ )
+      {
+        for ( Int x=0; x<8; x++ )
+        {
+          sad += abs( pOrg[y*m_lowresWidth + x] - pCand[y*m_lowresWidth + x] );
+        }
+      }
+      // prefer the shorter vector on ties
+      if ( sad < bestSad || ( sad == bestSad && abs( mvX ) + abs( mvY ) < abs( bestX ) + abs( bestY ) ) )
+      {
+        bestSad = sad;
+        bestX   = mvX;
+        bestY   = mvY;
+      }
+    }
+  }
+
+  return m_cRdCost.calcHAD( g_bitDepthY, pOrg, m_lowresWidth, pRef + bestY*m_lowresWidth + bestX, m_lowresWidth, 8, 8 );
+}
+
 TEncRateCtrl::TEncRateCtrl()
 {
   m_encRCSeq = NULL;
   m_encRCGOP = NULL;
   m_encRCPic = NULL;
+  m_encRCLookahead = NULL;
 }
 
 TEncRateCtrl::~TEncRateCtrl()
@@ -1164,6 +1538,11 @@ TEncRateCtrl::~TEncRateCtrl()
 
 Void TEncRateCtrl::destroy()
 {
+  if ( m_encRCLookahead != NULL )
+  {
+    delete m_encRCLookahead;
+    m_encRCLookahead = NULL;
+  }
   if ( m_encRCSeq != NULL )
   {
     delete m_encRCSeq;
@@ -1182,7 +1561,7 @@ Void TEncRateCtrl::destroy()
   }
 }
 
-Void TEncRateCtrl::init( Int totalFrames, Int targetBitrate, Int frameRate, Int GOPSize, Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight, Int keepHierBits, Bool useLCUSeparateModel, GOPEntry  GOPList[MAX_GOP] )
+Void TEncRateCtrl::init( Int totalFrames, Int targetBitrate, Int frameRate, Int GOPSize, Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight, Int keepHierBits, Bool useLCUSeparateModel, GOPEntry  GOPList[MAX_GOP], Bool useLookahead )
 {
   destroy();
 
@@ -1371,6 +1750,16 @@ Void TEncRateCtrl::init( Int totalFrames, Int targetBitrate, Int frameRate, Int
 
   delete[] bitsRatio;
   delete[] GOPID2Level;
+
+  for ( Int i=0; i<GOPSize; i++ )
+  {
+    m_GOPPOC[i] = GOPList[i].m_POC;
+  }
+  if ( useLookahead )
+  {
+    m_encRCLookahead = new TEncRCLookahead;
+    m_encRCLookahead->create( picWidth, picHeight, LCUWidth, LCUHeight );
+  }
 }
 
 Void TEncRateCtrl::initRCPic( Int frameLevel )
@@ -1379,10 +1768,41 @@ Void TEncRateCtrl::initRCPic( Int frameLevel )
   m_encRCPic->create( m_encRCSeq, m_encRCGOP, frameLevel, m_listRCPictures );
 }
 
-Void TEncRateCtrl::initRCGOP( Int numberOfPictures )
+Void TEncRateCtrl::initRCGOP( Int numberOfPictures, Int POCLast )
 {
   m_encRCGOP = new TEncRCGOP;
-  m_encRCGOP->create( m_encRCSeq, numberOfPictures );
+  if ( m_encRCLookahead == NULL )
+  {
+    m_encRCGOP->create( m_encRCSeq, numberOfPictures );
+    return;
+  }
+
+  // collect the lookahead results in the coding order of TEncGOP::compressGOP()
+  m_encRCLookahead->waitForAnalysis();
+  std::vector<TRCLookaheadPic> lookaheadPics( numberOfPictures );
+  Int picIdx = 0;
+  for ( Int GOPid=0; GOPid<m_encRCSeq->getGOPSize() && picIdx<numberOfPictures; GOPid++ )
+  {
+    Int POC = POCLast == 0 ? 0 : POCLast - numberOfPictures + m_GOPPOC[GOPid];
+    if ( POC > POCLast )
+    {
+      continue;
+    }
+    if ( !m_encRCLookahead->takeResult( POC, lookaheadPics[picIdx] ) )
+    {
+      lookaheadPics[picIdx].m_cost = -1.0;
+    }
+    picIdx++;
+  }
+  m_encRCGOP->create( m_encRCSeq, numberOfPictures, &lookaheadPics[0] );
+}
+
+Void TEncRateCtrl::addLookaheadPicture( TComPic* pcPic )
+{
+  if ( m_encRCLookahead != NULL )
+  {
+    m_encRCLookahead->addPicture( pcPic );
+  }
 }
 
 Void TEncRateCtrl::destroyRCGOP()
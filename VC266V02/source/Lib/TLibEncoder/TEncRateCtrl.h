@@ -45,6 +45,9 @@
 
 #include "../TLibCommon/CommonDef.h"
 #include "../TLibCommon/TComDataCU.h"
+#include "../TLibCommon/TComPic.h"
+#include "../TLibCommon/TComRdCost.h"
+#include "../TLibCommon/TComThreadPool.h"
 
 #include <vector>
 #include <algorithm>
@@ -56,6 +59,7 @@ using namespace std;
 
 #include "../TLibEncoder/TEncCfg.h"
 #include <list>
+#include <map>
 #include <cassert>
 
 const Int g_RCInvalidQPValue = -999;
@@ -71,6 +75,14 @@ const Double g_RCAlphaMinValue = 0.05;
 const Double g_RCAlphaMaxValue = 500.0;
 const Double g_RCBetaMinValue  = -3.0;
 const Double g_RCBetaMaxValue  = -0.1;
+const Int g_RCLookaheadSearchRange = 4;         // +/- range of the half-resolution motion search
+const Double g_RCLookaheadPicCostExp = 0.5;     // strength of the complexity weighting of picture target bits
+const Double g_RCLookaheadLCUCostExp = 0.5;     // strength of the complexity weighting of LCU target bits
+const Double g_RCLookaheadMaxCostRatio = 4.0;   // clip of the complexity normalisation of the R-lambda model
+const Double g_RCWeightHistoryCost = 0.5;
+const Double g_RCCpbInitialFullness = 0.9;      // CPB fullness at the removal of the first picture
+const Double g_RCCpbMaxTargetRatio  = 0.5;      // max share of the CPB fullness planned for one picture
+const Double g_RCCpbMaxPicRatio     = 0.9;      // max share of the CPB fullness one picture may use
 
 #define ALPHA     6.7542;
 #define BETA1     1.2517
@@ -86,6 +98,7 @@ struct TRCLCU
   Int m_numberOfPixel;
   Double m_costIntra;
   Int m_targetBitsLeft;
+  Double m_lookaheadCost;   // complexity from the lookahead, negative if not available
 };
 
 struct TRCParameter
@@ -94,6 +107,56 @@ struct TRCParameter
   Double m_beta;
 };
 
+/// complexity of one input picture, measured ahead of coding on a half-resolution luma copy
+struct TRCLookaheadPic
+{
+  Int                 m_POC;
+  Double              m_cost;       ///< sum over 16x16 blocks of the smaller of the intra and the inter SATD
+  std::vector<Double> m_LCUCost;    ///< the same cost split into LCUs
+};
+
+/// complexity analysis of the input pictures, run on a background thread while the next pictures are read
+class TEncRCLookahead : public TComParallelJob
+{
+public:
+  TEncRCLookahead();
+  ~TEncRCLookahead();
+
+public:
+  Void create( Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight );
+  Void destroy();
+
+  /// finish the analysis in flight and start the one of pcPic
+  Void addPicture( TComPic* pcPic );
+  Void waitForAnalysis();
+  /// move the result of picture POC to rcPic; false if the picture was not analysed
+  Bool takeResult( Int POC, TRCLookaheadPic& rcPic );
+
+  virtual Void runItem( Int itemIdx, Int threadIdx );
+
+private:
+  Void xDownsample   ( TComPicYuv* pcPicYuv, Pel* pDst );
+  UInt xGetIntraCost ( Int blkX, Int blkY );
+  UInt xGetInterCost ( Int blkX, Int blkY );
+
+private:
+  TComThreadPool m_cThread;
+  TComRdCost     m_cRdCost;
+  TComPic*       m_pcPic;           ///< picture handed to the background thread
+  Int            m_prevPOC;         ///< POC of the picture in m_pLowres[1], -1 if none
+  Pel*           m_pLowres[2];      ///< half-resolution luma of the current and the previous picture
+  Pel            m_pred[64];
+  Int            m_lowresWidth;     ///< padded to a multiple of the 8x8 block size
+  Int            m_lowresHeight;
+  Int            m_picWidth;
+  Int            m_picHeight;
+  Int            m_LCUWidth;
+  Int            m_LCUHeight;
+  Int            m_picWidthInLCU;
+  Int            m_numberOfLCU;
+  std::map<Int, TRCLookaheadPic> m_results;
+};
+
 class TEncRCSeq
 {
 public:
@@ -109,6 +172,8 @@ public:
   Void initLCUPara( TRCParameter** LCUPara = NULL );    // NULL to initial with default value
   Void updateAfterPic ( Int bits );
   Void setAllBitRatio( Double basicLambda, Double* equaCoeffA, Double* equaCoeffB );
+  Void initCpb  ( Int cpbSize, Int cpbBitrate );
+  Void updateCpb( Int bits );
 
 public:
   Int  getTotalFrames()                 { return m_totalFrames; }
@@ -149,6 +214,14 @@ public:
   Int    getAdaptiveBits()              { return m_adaptiveBit;  }
   Double getLastLambda()                { return m_lastLambda;   }
   Void   setLastLambda( Double lamdba ) { m_lastLambda = lamdba; }
+  Double getLookaheadRefCost( Int level )               { assert( level < m_numberOfLevel ); return m_lookaheadRefCost[level]; }
+  Void   setLookaheadRefCost( Int level, Double cost )  { assert( level < m_numberOfLevel ); m_lookaheadRefCost[level] = cost; }
+
+  Bool   getUseCpb()                    { return m_cpbSize > 0; }
+  Int    getCpbSize()                   { return m_cpbSize; }
+  Int    getCpbBitrate()                { return m_cpbBitrate; }
+  Double getCpbFullness()               { return m_cpbFullness; }
+  UInt   getInitialCpbRemovalDelay()    { return max( 1u, UInt( m_cpbFullness * 90000.0 / m_cpbBitrate ) ); }   // in units of the 90 kHz clock
 
 private:
   Int m_totalFrames;
@@ -179,6 +252,11 @@ private:
 
   Int m_adaptiveBit;
   Double m_lastLambda;
+  Double* m_lookaheadRefCost;   // per level complexity the R-lambda model is fitted to
+
+  Int    m_cpbSize;             // 0: no CPB constraint
+  Int    m_cpbBitrate;
+  Double m_cpbFullness;         // bits in the CPB at the removal of the next picture
 };
 
 class TEncRCGOP
@@ -188,9 +266,10 @@ public:
   ~TEncRCGOP();
 
 public:
-  Void create( TEncRCSeq* encRCSeq, Int numPic );
+  Void create( TEncRCSeq* encRCSeq, Int numPic, TRCLookaheadPic* lookaheadPics = NULL );
   Void destroy();
   Void updateAfterPicture( Int bitsCost );
+  Double getPicCostWeight( Int i );
 
 private:
   Int  xEstGOPTargetBits( TEncRCSeq* encRCSeq, Int GOPSize );
@@ -204,10 +283,13 @@ public:
   Int  getPicLeft()               { return m_picLeft; }
   Int  getBitsLeft()              { return m_bitsLeft; }
   Int  getTargetBitInGOP( Int i ) { return m_picTargetBitInGOP[i]; }
+  TRCLookaheadPic* getLookaheadPic( Int i ) { return ( i < (Int)m_lookaheadPics.size() && m_lookaheadPics[i].m_cost > 0.0 ) ? &m_lookaheadPics[i] : NULL; }
 
 private:
   TEncRCSeq* m_encRCSeq;
   Int* m_picTargetBitInGOP;
+  std::vector<TRCLookaheadPic> m_lookaheadPics;   // lookahead results in coding order, empty without lookahead
+  Double m_avgLookaheadCost;
   Int m_numPic;
   Int m_targetBits;
   Int m_picLeft;
@@ -246,6 +328,7 @@ public:
 private:
   Int xEstPicTargetBits( TEncRCSeq* encRCSeq, TEncRCGOP* encRCGOP );
   Int xEstPicHeaderBits( list<TEncRCPic*>& listPreviousPictures, Int frameLevel );
+  Int xGetCpbQPOffset();
 
 public:
   TEncRCSeq*      getRCSequence()                         { return m_encRCSeq; }
@@ -264,7 +347,7 @@ public:
   TRCLCU* getLCU()                                        { return m_LCUs; }
   TRCLCU& getLCU( Int LCUIdx )                            { return m_LCUs[LCUIdx]; }
   Int  getPicActualHeaderBits()                           { return m_picActualHeaderBits; }
-  Void setTargetBits( Int bits )                          { m_targetBits = bits; m_bitsLeft = bits;}
+  Void setTargetBits( Int bits )                          { m_targetBits = m_maxTargetBits > 0 ? min( bits, m_maxTargetBits ) : bits; m_bitsLeft = m_targetBits; }
   Void setTotalIntraCost(Double cost)                     { m_totalCostIntra = cost; }
   Void getLCUInitTargetBits();
 
@@ -299,6 +382,11 @@ private:
   Int m_picActualBits;          // the whole picture, including header
   Int m_picQP;                  // in integer form
   Double m_picLambda;
+  Double m_lookaheadCost;       // complexity from the lookahead, negative if not available
+  Double m_lookaheadCostRatio;  // normalisation of the bpp in the R-lambda model to the complexity of the model
+  Int m_maxTargetBits;          // CPB bound of the target bits, -1 without CPB
+  Int m_maxPicBits;             // CPB bound of the coded bits, -1 without CPB
+  Int m_LCUBitsCoded;           // actual bits of the LCUs coded so far
 };
 
 class TEncRateCtrl
@@ -308,10 +396,11 @@ public:
   ~TEncRateCtrl();
 
 public:
-  Void init( Int totalFrames, Int targetBitrate, Int frameRate, Int GOPSize, Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight, Int keepHierBits, Bool useLCUSeparateModel, GOPEntry GOPList[MAX_GOP] );
+  Void init( Int totalFrames, Int targetBitrate, Int frameRate, Int GOPSize, Int picWidth, Int picHeight, Int LCUWidth, Int LCUHeight, Int keepHierBits, Bool useLCUSeparateModel, GOPEntry GOPList[MAX_GOP], Bool useLookahead = false );
   Void destroy();
   Void initRCPic( Int frameLevel );
-  Void initRCGOP( Int numberOfPictures );
+  Void initRCGOP( Int numberOfPictures, Int POCLast );
+  Void addLookaheadPicture( TComPic* pcPic );
   Void destroyRCGOP();
 
 public:
@@ -326,8 +415,10 @@ private:
   TEncRCSeq* m_encRCSeq;
   TEncRCGOP* m_encRCGOP;
   TEncRCPic* m_encRCPic;
+  TEncRCLookahead* m_encRCLookahead;
   list<TEncRCPic*> m_listRCPictures;
   Int        m_RCQP;
+  Int        m_GOPPOC[MAX_GOP];   // POC offsets of the GOP entries, to map coding order to lookahead results
 };
 
 #endif
@@ -40,6 +40,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibEncoder
 //! \{
@@ -65,6 +68,12 @@ TEncSampleAdaptiveOffset::TEncSampleAdaptiveOffset()
   m_pppcBinCoderCABAC = NULL;    
   m_statData = NULL;
   m_preDBFstatData = NULL;
+  m_statsBlkStats = NULL;
+  m_statsOrgYuv = NULL;
+  m_statsSrcYuv = NULL;
+  m_statsPreDBFSamples = false;
+  m_statsStartCTU = 0;
+  m_ctuRowReconParams = NULL;
 }
 
 TEncSampleAdaptiveOffset::~TEncSampleAdaptiveOffset()
@@ -74,6 +83,12 @@ TEncSampleAdaptiveOffset::~TEncSampleAdaptiveOffset()
 
 Void TEncSampleAdaptiveOffset::createEncData(Bool isPreDBFSamplesUsed)
 {
+  //temporary picture buffer holding the deblocked picture for statistics and RDO
+  if ( !m_tempPicYuv )
+  {
+    m_tempPicYuv = new TComPicYuv;
+    m_tempPicYuv->create( m_picWidth, m_picHeight, m_maxCUWidth, m_maxCUHeight, g_uiMaxCUDepth );
+  }
 
   //cabac coder for RDO
   m_pppcRDSbacCoder = new TEncSbac* [NUM_SAO_CABACSTATE_LABELS];
@@ -178,6 +193,13 @@ Void TEncSampleAdaptiveOffset::createEncData(Bool isPreDBFSamplesUsed)
 
 Void TEncSampleAdaptiveOffset::destroyEncData()
 {
+  if ( m_tempPicYuv )
+  {
+    m_tempPicYuv->destroy();
+    delete m_tempPicYuv;
+    m_tempPicYuv = NULL;
+  }
+
   if(m_pppcRDSbacCoder != NULL)
   {
     for (Int cs = 0; cs < NUM_SAO_CABACSTATE_LABELS; cs ++ )
@@ -246,7 +268,7 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
   srcYuv->extendPicBorder();
 
   //collect statistics
-  getStatistics(m_statData, orgYuv, srcYuv, pPic);
+  getStatistics(m_statData, orgYuv, srcYuv, pPic, 0, m_numCTUsPic);
   if(isPreDBFSamplesUsed)
   {
     addPreDBFStatistics(m_statData);
@@ -256,14 +278,62 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
 
   //block on/off 
   SAOBlkParam* reconParams = new SAOBlkParam[m_numCTUsPic]; //temporary parameter buffer for storing reconstructed SAO parameters
-  decideBlkParams(pPic, sliceEnabled, m_statData, srcYuv, resYuv, reconParams, pPic->getPicSym()->getSAOBlkParam());
+  decideBlkParams(pPic, sliceEnabled, m_statData, srcYuv, resYuv, reconParams, pPic->getPicSym()->getSAOBlkParam(), 0, m_numCTUsPic);
+#if SAO_ENCODING_CHOICE
+  updateDisabledRate(pPic, reconParams);
+#endif
   delete[] reconParams;
 
 }
 
+/** start the CTU-row SAO of a picture whose rows are handed over by SAOProcessCtuRow() while it is being coded
+ * \param sliceEnabled  output slice-level on/off flags, they only depend on previous pictures
+ */
+Void TEncSampleAdaptiveOffset::SAOStartCtuRows(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas)
+{
+  m_lambda[SAO_Y]= lambdas[0]; m_lambda[SAO_Cb]= lambdas[1]; m_lambda[SAO_Cr]= lambdas[2];
+
+  decidePicParams(sliceEnabled, pPic->getSlice(0)->getDepth());
+  for (Int compIdx = 0; compIdx < NUM_SAO_COMPONENTS; compIdx++)
+  {
+    m_ctuRowSliceEnabled[compIdx] = sliceEnabled[compIdx];
+  }
+  m_ctuRowReconParams = new SAOBlkParam[m_numCTUsPic];
+}
+
+/** SAO of CTU row ctuRow, SAOProcess() restricted to the CTUs of the row
+ * Needs the deblocked rows ctuRow and ctuRow+1; the RDO cabac state carries over from the previous row.
+ */
+Void TEncSampleAdaptiveOffset::SAOProcessCtuRow(TComPic* pPic, Int ctuRow)
+{
+  TComPicYuv* orgYuv = pPic->getPicYuvOrg();
+  TComPicYuv* resYuv = pPic->getPicYuvRec();
+  TComPicYuv* srcYuv = m_tempPicYuv;
+  Int         startCTU = ctuRow * m_numCTUInWidth;
+
+  //row ctuRow-1 was copied before it got its offsets, the first line of row ctuRow+1 is already final
+  for (Int row = ctuRow; row <= ctuRow + 1 && row < m_numCTUInHeight; row++)
+  {
+    resYuv->copyToPicCtuRow(srcYuv, row);
+    srcYuv->extendPicBorderCtuRow(row);
+  }
+
+  getStatistics(m_statData, orgYuv, srcYuv, pPic, startCTU, m_numCTUInWidth);
+  decideBlkParams(pPic, m_ctuRowSliceEnabled, m_statData, srcYuv, resYuv, m_ctuRowReconParams, pPic->getPicSym()->getSAOBlkParam(), startCTU, startCTU + m_numCTUInWidth);
+}
+
+Void TEncSampleAdaptiveOffset::SAOFinishCtuRows(TComPic* pPic)
+{
+#if SAO_ENCODING_CHOICE
+  updateDisabledRate(pPic, m_ctuRowReconParams);
+#endif
+  delete[] m_ctuRowReconParams;
+  m_ctuRowReconParams = NULL;
+}
+
 Void TEncSampleAdaptiveOffset::getPreDBFStatistics(TComPic* pPic)
 {
-  getStatistics(m_preDBFstatData, pPic->getPicYuvOrg(), pPic->getPicYuvRec(), pPic, true);
+  getStatistics(m_preDBFstatData, pPic->getPicYuvOrg(), pPic->getPicYuvRec(), pPic, 0, m_numCTUsPic, true);
 }
 
 Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats)
@@ -281,44 +351,66 @@ Void TEncSampleAdaptiveOffset::addPreDBFStatistics(SAOStatData*** blkStats)
 }
 
 
-Void TEncSampleAdaptiveOffset::getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic , Bool isCalculatePreDeblockSamples )
+Void TEncSampleAdaptiveOffset::getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Int startCTU, Int numCTUs, Bool isCalculatePreDeblockSamples )
 {
-  Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
+  //CTU statistics are independent of each other, gather them CTU-parallel
+  m_pcParallelPic     = pPic;
+  m_statsBlkStats     = blkStats;
+  m_statsOrgYuv       = orgYuv;
+  m_statsSrcYuv       = srcYuv;
+  m_statsPreDBFSamples= isCalculatePreDeblockSamples;
+  m_statsStartCTU     = startCTU;
+  runParallelStage(SAO_STAGE_ENC_STATS, min(numCTUs, m_numCTUsPic - startCTU));
+  m_pcParallelPic     = NULL;
+}
 
-  for(Int ctu= 0; ctu < m_numCTUsPic; ctu++)
+Void TEncSampleAdaptiveOffset::runItem(Int itemIdx, Int threadIdx)
+{
+  if(m_parallelStage == SAO_STAGE_ENC_STATS)
   {
-    Int yPos   = (ctu / m_numCTUInWidth)*m_maxCUHeight;
-    Int xPos   = (ctu % m_numCTUInWidth)*m_maxCUWidth;
-    Int height = (yPos + m_maxCUHeight > m_picHeight)?(m_picHeight- yPos):m_maxCUHeight;
-    Int width  = (xPos + m_maxCUWidth  > m_picWidth )?(m_picWidth - xPos):m_maxCUWidth;
+    Int ctu = m_statsStartCTU + itemIdx;
+    getCTUStatistics(ctu, m_statsBlkStats[ctu], m_statsOrgYuv, m_statsSrcYuv, m_pcParallelPic, m_statsPreDBFSamples);
+  }
+  else
+  {
+    TComSampleAdaptiveOffset::runItem(itemIdx, threadIdx);
+  }
+}
 
-    pPic->getPicSym()->deriveLoopFilterBoundaryAvailibility(ctu, isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail);
+Void TEncSampleAdaptiveOffset::getCTUStatistics(Int ctu, SAOStatData** ctuStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Bool isCalculatePreDeblockSamples)
+{
+  Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
 
-    //NOTE: The number of skipped lines during gathering CTU statistics depends on the slice boundary availabilities.
-    //For simplicity, here only picture boundaries are considered.
+  Int yPos   = (ctu / m_numCTUInWidth)*m_maxCUHeight;
+  Int xPos   = (ctu % m_numCTUInWidth)*m_maxCUWidth;
+  Int height = (yPos + m_maxCUHeight > m_picHeight)?(m_picHeight- yPos):m_maxCUHeight;
+  Int width  = (xPos + m_maxCUWidth  > m_picWidth )?(m_picWidth - xPos):m_maxCUWidth;
 
-    isRightAvail      = (xPos + m_maxCUWidth  < m_picWidth );
-    isBelowAvail      = (yPos + m_maxCUHeight < m_picHeight);
-    isBelowRightAvail = (isRightAvail && isBelowAvail);
-    isBelowLeftAvail  = ((xPos > 0) && (isBelowAvail));
-    isAboveRightAvail = ((yPos > 0) && (isRightAvail));
+  pPic->getPicSym()->deriveLoopFilterBoundaryAvailibility(ctu, isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail);
 
-    for(Int compIdx=0; compIdx< NUM_SAO_COMPONENTS; compIdx++)
-    {
-      Bool isLuma     = (compIdx == SAO_Y);
-      Int  formatShift= isLuma?0:1;
+  //NOTE: The number of skipped lines during gathering CTU statistics depends on the slice boundary availabilities.
+  //For simplicity, here only picture boundaries are considered.
+
+  isRightAvail      = (xPos + m_maxCUWidth  < m_picWidth );
+  isBelowAvail      = (yPos + m_maxCUHeight < m_picHeight);
+  isBelowRightAvail = (isRightAvail && isBelowAvail);
+  isBelowLeftAvail  = ((xPos > 0) && (isBelowAvail));
+  isAboveRightAvail = ((yPos > 0) && (isRightAvail));
 
-      Int  srcStride = isLuma?srcYuv->getStride():srcYuv->getCStride();
-      Pel* srcBlk    = getPicBuf(srcYuv, compIdx)+ (yPos >> formatShift)*srcStride+ (xPos >> formatShift);
+  for(Int compIdx=0; compIdx< NUM_SAO_COMPONENTS; compIdx++)
+  {
+    Bool isLuma     = (compIdx == SAO_Y);
+    Int  formatShift= isLuma?0:1;
 
-      Int  orgStride  = isLuma?orgYuv->getStride():orgYuv->getCStride();
-      Pel* orgBlk     = getPicBuf(orgYuv, compIdx)+ (yPos >> formatShift)*orgStride+ (xPos >> formatShift);
+    Int  srcStride = isLuma?srcYuv->getStride():srcYuv->getCStride();
+    Pel* srcBlk    = getPicBuf(srcYuv, compIdx)+ (yPos >> formatShift)*srcStride+ (xPos >> formatShift);
 
-      getBlkStats(compIdx, blkStats[ctu][compIdx]  
-                , srcBlk, orgBlk, srcStride, orgStride, (width  >> formatShift), (height >> formatShift)
-                , isLeftAvail,  isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail, isCalculatePreDeblockSamples);
+    Int  orgStride  = isLuma?orgYuv->getStride():orgYuv->getCStride();
+    Pel* orgBlk     = getPicBuf(orgYuv, compIdx)+ (yPos >> formatShift)*orgStride+ (xPos >> formatShift);
 
-    }
+    getBlkStats(compIdx, ctuStats[compIdx]  
+              , srcBlk, orgBlk, srcStride, orgStride, (width  >> formatShift), (height >> formatShift)
+              , isLeftAvail,  isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail, isCalculatePreDeblockSamples);
   }
 }
 
@@ -730,7 +822,9 @@ Void TEncSampleAdaptiveOffset::deriveModeMergeRDO(Int ctu, std::vector<SAOBlkPar
 
 }
 
-Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams)
+/** decide and apply the SAO parameters of CTUs [startCTU, endCTU), the CTUs before startCTU must be decided already
+ */
+Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams, Int startCTU, Int endCTU)
 {
   Bool isAllBlksDisabled = false;
   if(!sliceEnabled[SAO_Y] && !sliceEnabled[SAO_Cb] && !sliceEnabled[SAO_Cr])
@@ -738,12 +832,13 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     isAllBlksDisabled = true;
   }
 
-  m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ SAO_CABACSTATE_PIC_INIT ]);
+  m_pcRDGoOnSbacCoder->load(m_pppcRDSbacCoder[ (startCTU == 0) ? SAO_CABACSTATE_PIC_INIT : SAO_CABACSTATE_BLK_NEXT ]);
 
   SAOBlkParam modeParam;
   Double minCost, modeCost;
 
-  for(Int ctu=0; ctu< m_numCTUsPic; ctu++)
+  endCTU = min(endCTU, m_numCTUsPic);
+  for(Int ctu=startCTU; ctu< endCTU; ctu++)
   {
     if(isAllBlksDisabled)
     {
@@ -801,8 +896,13 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     reconstructBlkSAOParam(reconParams[ctu], mergeList);
     offsetCTU(ctu, srcYuv, resYuv, reconParams[ctu], pic);
   } //ctu
+}
 
 #if SAO_ENCODING_CHOICE 
+/** slice on/off statistics of the current picture for decidePicParams() of the next pictures
+ */
+Void TEncSampleAdaptiveOffset::updateDisabledRate(TComPic* pic, SAOBlkParam* reconParams)
+{
   Int picTempLayer = pic->getSlice(0)->getDepth();
   Int numLcusForSAOOff[NUM_SAO_COMPONENTS];
   numLcusForSAOOff[SAO_Y ] = numLcusForSAOOff[SAO_Cb]= numLcusForSAOOff[SAO_Cr]= 0;
@@ -828,387 +928,276 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     m_saoDisabledRate[SAO_Y][0] = (Double)(numLcusForSAOOff[SAO_Y]+numLcusForSAOOff[SAO_Cb]+numLcusForSAOOff[SAO_Cr])/(Double)(m_numCTUsPic*3);
   }
 #endif                                              
-#endif
 }
+#endif
 
-
-Void TEncSampleAdaptiveOffset::getBlkStats(Int compIdx, SAOStatData* statsDataTypes  
-                        , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
-                        , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail, Bool isCalculatePreDeblockSamples)
+/** sample range [startX, endX) of line y that contributes to the statistics of SAO type typeIdx
+ * \param skipLinesR/skipLinesB number of right columns/bottom lines that are not yet deblocked
+ * \param isCalculatePreDeblockSamples true: only the skipped right/bottom areas, false: the remaining area
+ */
+Void TEncSampleAdaptiveOffset::getStatsLineRange(Int typeIdx, Int y, Int width, Int height, Int skipLinesR, Int skipLinesB
+                                               , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                                               , Bool isCalculatePreDeblockSamples, Int& startX, Int& endX)
 {
-  if(m_lineBufWidth != m_maxCUWidth)
-  {
-    m_lineBufWidth = m_maxCUWidth;
-
-    if (m_signLineBuf1) delete[] m_signLineBuf1; m_signLineBuf1 = NULL;
-    m_signLineBuf1 = new Char[m_lineBufWidth+1]; 
+  startX = endX = 0;
 
-    if (m_signLineBuf2) delete[] m_signLineBuf2; m_signLineBuf2 = NULL;
-    m_signLineBuf2 = new Char[m_lineBufWidth+1];
-  }
-
-  Int x,y, startX, startY, endX, endY, edgeType, firstLineStartX, firstLineEndX;
-  Char signLeft, signRight, signDown;
-  Int64 *diff, *count;
-  Pel *srcLine, *orgLine;
-  Int* skipLinesR = m_skipLinesR[compIdx];
-  Int* skipLinesB = m_skipLinesB[compIdx];
-
-  for(Int typeIdx=0; typeIdx< NUM_SAO_NEW_TYPES; typeIdx++)
+  switch(typeIdx)
   {
-    SAOStatData& statsData= statsDataTypes[typeIdx];
-    statsData.reset();
-
-    srcLine = srcBlk;
-    orgLine = orgBlk;
-    diff    = statsData.diff;
-    count   = statsData.count;
-    switch(typeIdx)
+  case SAO_TYPE_EO_0:
+  case SAO_TYPE_BO:
     {
-    case SAO_TYPE_EO_0:
+      Int firstX = (typeIdx == SAO_TYPE_BO) ? 0     : (isLeftAvail ? 0 : 1);
+      Int lastX  = (typeIdx == SAO_TYPE_BO) ? width : (isRightAvail ? width : (width - 1));
+      Int endY   = isBelowAvail ? (height - skipLinesB) : height;
+      if (y < endY)
       {
-        diff +=2;
-        count+=2;
-        endY   = (isBelowAvail) ? (height - skipLinesB[typeIdx]) : height;
-        startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
-                                                 : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
-                                                 ;
-        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
-                                                 : (isRightAvail ? width : (width - 1))
-                                                 ;
-        for (y=0; y<endY; y++)
-        {
-          signLeft = (Char)sgn(srcLine[startX] - srcLine[startX-1]);
-          for (x=startX; x<endX; x++)
-          {
-            signRight =  (Char)sgn(srcLine[x] - srcLine[x+1]);
-            edgeType  =  signRight + signLeft;
-            signLeft  = -signRight;
-
-            diff [edgeType] += (orgLine[x] - srcLine[x]);
-            count[edgeType] ++;
-          }
-          srcLine  += srcStride;
-          orgLine  += orgStride;
-        }
-        if(isCalculatePreDeblockSamples)
-        {
-          if(isBelowAvail)
-          {
-            startX = isLeftAvail  ? 0 : 1;
-            endX   = isRightAvail ? width : (width -1);
-
-            for(y=0; y<skipLinesB[typeIdx]; y++)
-            {
-              signLeft = (Char)sgn(srcLine[startX] - srcLine[startX-1]);
-              for (x=startX; x<endX; x++)
-              {
-                signRight =  (Char)sgn(srcLine[x] - srcLine[x+1]);
-                edgeType  =  signRight + signLeft;
-                signLeft  = -signRight;
-
-                diff [edgeType] += (orgLine[x] - srcLine[x]);
-                count[edgeType] ++;
-              }
-              srcLine  += srcStride;
-              orgLine  += orgStride;
-            }
-          }
-        }
+        startX = (!isCalculatePreDeblockSamples) ? firstX : (isRightAvail ? (width - skipLinesR) : lastX);
+        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR) : lastX) : lastX;
       }
-      break;
-    case SAO_TYPE_EO_90:
+      else if (isCalculatePreDeblockSamples && isBelowAvail && (y < endY + skipLinesB))
       {
-        diff +=2;
-        count+=2;
-        Char *signUpLine = m_signLineBuf1;
-
-        startX = (!isCalculatePreDeblockSamples) ? 0
-                                                 : (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
-                                                 ;
-        startY = isAboveAvail ? 0 : 1;
-        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : width) 
-                                                 : width
-                                                 ;
-        endY   = isBelowAvail ? (height - skipLinesB[typeIdx]) : (height - 1);
-        if (!isAboveAvail)
-        {
-          srcLine += srcStride;
-          orgLine += orgStride;
-        }
-
-        Pel* srcLineAbove = srcLine - srcStride;
-        for (x=startX; x<endX; x++) 
-        {
-          signUpLine[x] = (Char)sgn(srcLine[x] - srcLineAbove[x]);
-        }
-
-        Pel* srcLineBelow;
-        for (y=startY; y<endY; y++)
+        startX = firstX;
+        endX   = lastX;
+      }
+    }
+    break;
+  case SAO_TYPE_EO_90:
+    {
+      Int startY = isAboveAvail ? 0 : 1;
+      Int endY   = isBelowAvail ? (height - skipLinesB) : (height - 1);
+      if (y >= startY && y < endY)
+      {
+        startX = (!isCalculatePreDeblockSamples) ? 0 : (isRightAvail ? (width - skipLinesR) : width);
+        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR) : width) : width;
+      }
+      else if (isCalculatePreDeblockSamples && isBelowAvail && (y >= max(startY, endY)) && (y < max(startY, endY) + skipLinesB))
+      {
+        startX = 0;
+        endX   = width;
+      }
+    }
+    break;
+  case SAO_TYPE_EO_135:
+  case SAO_TYPE_EO_45:
+    {
+      Int firstX = isLeftAvail  ? 0 : 1;
+      Int lastX  = isRightAvail ? width : (width - 1);
+      Int endY   = isBelowAvail ? (height - skipLinesB) : (height - 1);
+      Int midStartX = (!isCalculatePreDeblockSamples) ? firstX : (isRightAvail ? (width - skipLinesR) : lastX);
+      Int midEndX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR) : lastX) : lastX;
+      if (y == 0)
+      {
+        //the first line is always visited; its range depends on the above (-left/-right) CTUs
+        startX = midStartX;
+        endX   = midEndX;
+        if (!isCalculatePreDeblockSamples)
         {
-          srcLineBelow = srcLine + srcStride;
-
-          for (x=startX; x<endX; x++)
+          if (typeIdx == SAO_TYPE_EO_135)
           {
-            signDown  = (Char)sgn(srcLine[x] - srcLineBelow[x]); 
-            edgeType  = signDown + signUpLine[x];
-            signUpLine[x]= -signDown;
-
-            diff [edgeType] += (orgLine[x] - srcLine[x]);
-            count[edgeType] ++;
+            startX = isAboveLeftAvail ? 0 : 1;
+            endX   = isAboveAvail ? midEndX : 1;
           }
-          srcLine += srcStride;
-          orgLine += orgStride;
-        }
-        if(isCalculatePreDeblockSamples)
-        {
-          if(isBelowAvail)
+          else
           {
-            startX = 0;
-            endX   = width;
-
-            for(y=0; y<skipLinesB[typeIdx]; y++)
-            {
-              srcLineBelow = srcLine + srcStride;
-              srcLineAbove = srcLine - srcStride;
-
-              for (x=startX; x<endX; x++)
-              {
-                edgeType = sgn(srcLine[x] - srcLineBelow[x]) + sgn(srcLine[x] - srcLineAbove[x]);
-                diff [edgeType] += (orgLine[x] - srcLine[x]);
-                count[edgeType] ++;
-              }
-              srcLine  += srcStride;
-              orgLine  += orgStride;
-            }
+            startX = isAboveAvail ? midStartX : midEndX;
+            endX   = (!isRightAvail && isAboveRightAvail) ? width : midEndX;
           }
         }
-
       }
-      break;
-    case SAO_TYPE_EO_135:
+      else if (y < endY)
       {
-        diff +=2;
-        count+=2;
-        Char *signUpLine, *signDownLine, *signTmpLine;
-
-        signUpLine  = m_signLineBuf1;
-        signDownLine= m_signLineBuf2;
-
-        startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
-                                                 : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
-                                                 ;
-
-        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]): (width - 1))
-                                                 : (isRightAvail ? width : (width - 1))
-                                                 ;
-        endY   = isBelowAvail ? (height - skipLinesB[typeIdx]) : (height - 1);
-
-        //prepare 2nd line's upper sign
-        Pel* srcLineBelow = srcLine + srcStride;
-        for (x=startX; x<endX+1; x++)
-        {
-          signUpLine[x] = (Char)sgn(srcLineBelow[x] - srcLine[x-1]);
-        }
-
-        //1st line
-        Pel* srcLineAbove = srcLine - srcStride;
-        firstLineStartX = (!isCalculatePreDeblockSamples) ? (isAboveLeftAvail ? 0    : 1) : startX;
-        firstLineEndX   = (!isCalculatePreDeblockSamples) ? (isAboveAvail     ? endX : 1) : endX;
-        for(x=firstLineStartX; x<firstLineEndX; x++)
-        {
-          edgeType = sgn(srcLine[x] - srcLineAbove[x-1]) - signUpLine[x+1];
-          diff [edgeType] += (orgLine[x] - srcLine[x]);
-          count[edgeType] ++;
-        }
-        srcLine  += srcStride;
-        orgLine  += orgStride;
-
-        //middle lines
-        for (y=1; y<endY; y++)
-        {
-          srcLineBelow = srcLine + srcStride;
+        startX = midStartX;
+        endX   = midEndX;
+      }
+      else if (isCalculatePreDeblockSamples && isBelowAvail && (y >= max(1, endY)) && (y < max(1, endY) + skipLinesB))
+      {
+        startX = firstX;
+        endX   = lastX;
+      }
+    }
+    break;
+  default:
+    {
+      printf("Not a supported SAO types\n");
+      assert(0);
+      exit(-1);
+    }
+  }
+}
 
-          for (x=startX; x<endX; x++)
-          {
-            signDown = (Char)sgn(srcLine[x] - srcLineBelow[x+1]);
-            edgeType = signDown + signUpLine[x];
-            diff [edgeType] += (orgLine[x] - srcLine[x]);
-            count[edgeType] ++;
+#if ENABLE_SIMD_SSE2
+/** edge offset statistics of all EO types for one line, 8 samples per iteration
+ * \param startX/endX    per-type sample ranges of the line (empty ranges are skipped)
+ * \param accDiff/accCnt per-type and per-class 32-bit accumulators, indexed by edgeType+2
+ * \returns first sample position that has not been processed
+ */
+static Int getLineStatsEOSSE2(const Pel* srcLine, const Pel* orgLine, Int srcStride, const Int* startX, const Int* endX, Int lineStartX, Int lineEndX
+                            , __m128i accDiff[SAO_TYPE_START_BO][NUM_SAO_EO_CLASSES], __m128i accCnt[SAO_TYPE_START_BO][NUM_SAO_EO_CLASSES])
+{
+  const Pel*    srcLineAbove = srcLine - srcStride;
+  const Pel*    srcLineBelow = srcLine + srcStride;
+  const __m128i ones     = _mm_set1_epi16(1);
+  const __m128i laneIdx  = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  __m128i edgeVal[NUM_SAO_EO_CLASSES], rangeStart[SAO_TYPE_START_BO], rangeEnd[SAO_TYPE_START_BO];
+  for (Int edgeIdx=0; edgeIdx< NUM_SAO_EO_CLASSES; edgeIdx++)
+  {
+    edgeVal[edgeIdx] = _mm_set1_epi16((Short)(edgeIdx- 2));
+  }
+  for (Int typeIdx=0; typeIdx< SAO_TYPE_START_BO; typeIdx++)
+  {
+    rangeStart[typeIdx] = _mm_set1_epi16((Short)(startX[typeIdx]- 1));
+    rangeEnd  [typeIdx] = _mm_set1_epi16((Short) endX [typeIdx]);
+  }
 
-            signDownLine[x+1] = -signDown; 
-          }
-          signDownLine[startX] = (Char)sgn(srcLineBelow[startX] - srcLine[startX-1]);
-          signTmpLine  = signUpLine;
-          signUpLine   = signDownLine;
-          signDownLine = signTmpLine;
+  Int x;
+  for (x=lineStartX; x+8 <= lineEndX; x+=8)
+  {
+    __m128i cur  = _mm_loadu_si128((const __m128i*)(srcLine+ x));
+    __m128i diff = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)(orgLine+ x)), cur);
+    __m128i pos  = _mm_add_epi16(_mm_set1_epi16((Short)x), laneIdx);
 
-          srcLine += srcStride;
-          orgLine += orgStride;
-        }
-        if(isCalculatePreDeblockSamples)
-        {
-          if(isBelowAvail)
-          {
-            startX = isLeftAvail  ? 0     : 1 ;
-            endX   = isRightAvail ? width : (width -1);
-
-            for(y=0; y<skipLinesB[typeIdx]; y++)
-            {
-              srcLineBelow = srcLine + srcStride;
-              srcLineAbove = srcLine - srcStride;
-
-              for (x=startX; x< endX; x++)
-              {
-                edgeType = sgn(srcLine[x] - srcLineBelow[x+1]) + sgn(srcLine[x] - srcLineAbove[x-1]);
-                diff [edgeType] += (orgLine[x] - srcLine[x]);
-                count[edgeType] ++;
-              }
-              srcLine  += srcStride;
-              orgLine  += orgStride;
-            }
-          }
-        }
+    for (Int typeIdx=0; typeIdx< SAO_TYPE_START_BO; typeIdx++)
+    {
+      if (startX[typeIdx] >= endX[typeIdx] || startX[typeIdx] >= x+8 || endX[typeIdx] <= x)
+      {
+        continue;
       }
-      break;
-    case SAO_TYPE_EO_45:
+      const Pel *nbA, *nbB;
+      switch(typeIdx)
       {
-        diff +=2;
-        count+=2;
-        Char *signUpLine = m_signLineBuf1+1;
-
-        startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
-                                                 : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
-                                                 ;
-        endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
-                                                 : (isRightAvail ? width : (width - 1))
-                                                 ;
-        endY   = isBelowAvail ? (height - skipLinesB[typeIdx]) : (height - 1);
-
-        //prepare 2nd line upper sign
-        Pel* srcLineBelow = srcLine + srcStride;
-        for (x=startX-1; x<endX; x++)
-        {
-          signUpLine[x] = (Char)sgn(srcLineBelow[x] - srcLine[x+1]);
-        }
+      case SAO_TYPE_EO_0:   nbA = srcLine     + x- 1; nbB = srcLine     + x+ 1; break;
+      case SAO_TYPE_EO_90:  nbA = srcLineAbove+ x;    nbB = srcLineBelow+ x;    break;
+      case SAO_TYPE_EO_135: nbA = srcLineAbove+ x- 1; nbB = srcLineBelow+ x+ 1; break;
+      default:              nbA = srcLineAbove+ x+ 1; nbB = srcLineBelow+ x- 1; break;
+      }
+      __m128i a = _mm_loadu_si128((const __m128i*)nbA);
+      __m128i b = _mm_loadu_si128((const __m128i*)nbB);
 
+      //sgn(cur - nb) = (nb > cur) - (cur > nb) with compare results being 0/-1
+      __m128i edge  = _mm_sub_epi16(_mm_cmpgt_epi16(a, cur), _mm_cmpgt_epi16(cur, a));
+      edge          = _mm_add_epi16(edge, _mm_sub_epi16(_mm_cmpgt_epi16(b, cur), _mm_cmpgt_epi16(cur, b)));
+      __m128i valid = _mm_and_si128(_mm_cmpgt_epi16(pos, rangeStart[typeIdx]), _mm_cmplt_epi16(pos, rangeEnd[typeIdx]));
 
-        //first line
-        Pel* srcLineAbove = srcLine - srcStride;
-        firstLineStartX = (!isCalculatePreDeblockSamples) ? (isAboveAvail ? startX : endX)
-                                                          : startX
-                                                          ;
-        firstLineEndX   = (!isCalculatePreDeblockSamples) ? ((!isRightAvail && isAboveRightAvail) ? width : endX)
-                                                          : endX
-                                                          ;
-        for(x=firstLineStartX; x<firstLineEndX; x++)
-        {
-          edgeType = sgn(srcLine[x] - srcLineAbove[x+1]) - signUpLine[x-1];
-          diff [edgeType] += (orgLine[x] - srcLine[x]);
-          count[edgeType] ++;
-        }
+      for (Int edgeIdx=0; edgeIdx< NUM_SAO_EO_CLASSES; edgeIdx++)
+      {
+        __m128i mask = _mm_and_si128(_mm_cmpeq_epi16(edge, edgeVal[edgeIdx]), valid);
+        accDiff[typeIdx][edgeIdx] = _mm_add_epi32(accDiff[typeIdx][edgeIdx], _mm_madd_epi16(_mm_and_si128(diff, mask), ones));
+        accCnt [typeIdx][edgeIdx] = _mm_sub_epi32(accCnt [typeIdx][edgeIdx], _mm_madd_epi16(mask, ones));
+      }
+    }
+  }
+  return x;
+}
+#endif
 
-        srcLine += srcStride;
-        orgLine += orgStride;
+/** statistics of all SAO types of one CTU component
+ * Each line is visited once: the sample ranges of all types are derived first and then
+ * the EO classes of all four directions and the band index are gathered in the same sweep.
+ */
+Void TEncSampleAdaptiveOffset::getBlkStats(Int compIdx, SAOStatData* statsDataTypes  
+                        , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
+                        , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail, Bool isCalculatePreDeblockSamples)
+{
+  Int* skipLinesR = m_skipLinesR[compIdx];
+  Int* skipLinesB = m_skipLinesB[compIdx];
+  Int  shiftBits  = ((compIdx == SAO_Y)?g_bitDepthY:g_bitDepthC)- NUM_SAO_BO_CLASSES_LOG2;
+  Int  startX[NUM_SAO_NEW_TYPES], endX[NUM_SAO_NEW_TYPES];
+  Int64 *diff[NUM_SAO_NEW_TYPES], *count[NUM_SAO_NEW_TYPES];
 
-        //middle lines
-        for (y=1; y<endY; y++)
-        {
-          srcLineBelow = srcLine + srcStride;
+  for(Int typeIdx=0; typeIdx< NUM_SAO_NEW_TYPES; typeIdx++)
+  {
+    statsDataTypes[typeIdx].reset();
+    //EO statistics are indexed by edgeType (-2..2)
+    diff [typeIdx] = statsDataTypes[typeIdx].diff  + ((typeIdx == SAO_TYPE_BO)?0:2);
+    count[typeIdx] = statsDataTypes[typeIdx].count + ((typeIdx == SAO_TYPE_BO)?0:2);
+  }
 
-          for(x=startX; x<endX; x++)
-          {
-            signDown = (Char)sgn(srcLine[x] - srcLineBelow[x-1]);
-            edgeType = signDown + signUpLine[x];
+#if ENABLE_SIMD_SSE2
+  __m128i accDiff[SAO_TYPE_START_BO][NUM_SAO_EO_CLASSES], accCnt[SAO_TYPE_START_BO][NUM_SAO_EO_CLASSES];
+  for (Int typeIdx=0; typeIdx< SAO_TYPE_START_BO; typeIdx++)
+  {
+    for (Int edgeIdx=0; edgeIdx< NUM_SAO_EO_CLASSES; edgeIdx++)
+    {
+      accDiff[typeIdx][edgeIdx] = accCnt[typeIdx][edgeIdx] = _mm_setzero_si128();
+    }
+  }
+#endif
 
-            diff [edgeType] += (orgLine[x] - srcLine[x]);
-            count[edgeType] ++;
+  Pel* srcLine = srcBlk;
+  Pel* orgLine = orgBlk;
+  for (Int y=0; y< height; y++)
+  {
+    Int lineStartX = width, lineEndX = 0;
+    for(Int typeIdx=0; typeIdx< NUM_SAO_NEW_TYPES; typeIdx++)
+    {
+      getStatsLineRange(typeIdx, y, width, height, skipLinesR[typeIdx], skipLinesB[typeIdx]
+                      , isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail
+                      , isCalculatePreDeblockSamples, startX[typeIdx], endX[typeIdx]);
+      if (startX[typeIdx] < endX[typeIdx] && typeIdx != SAO_TYPE_BO)
+      {
+        lineStartX = min(lineStartX, startX[typeIdx]);
+        lineEndX   = max(lineEndX  , endX  [typeIdx]);
+      }
+    }
 
-            signUpLine[x-1] = -signDown; 
-          }
-          signUpLine[endX-1] = (Char)sgn(srcLineBelow[endX-1] - srcLine[endX]);
-          srcLine  += srcStride;
-          orgLine  += orgStride;
-        }
-        if(isCalculatePreDeblockSamples)
-        {
-          if(isBelowAvail)
-          {
-            startX = isLeftAvail  ? 0     : 1 ;
-            endX   = isRightAvail ? width : (width -1);
-
-            for(y=0; y<skipLinesB[typeIdx]; y++)
-            {
-              srcLineBelow = srcLine + srcStride;
-              srcLineAbove = srcLine - srcStride;
-
-              for (x=startX; x<endX; x++)
-              {
-                edgeType = sgn(srcLine[x] - srcLineBelow[x-1]) + sgn(srcLine[x] - srcLineAbove[x+1]);
-                diff [edgeType] += (orgLine[x] - srcLine[x]);
-                count[edgeType] ++;
-              }
-              srcLine  += srcStride;
-              orgLine  += orgStride;
-            }
-          }
-        }
+    Int x = lineStartX;
+#if ENABLE_SIMD_SSE2
+    x = getLineStatsEOSSE2(srcLine, orgLine, srcStride, startX, endX, lineStartX, lineEndX, accDiff, accCnt);
+#endif
+    Pel* srcLineAbove = srcLine - srcStride;
+    Pel* srcLineBelow = srcLine + srcStride;
+    for (; x< lineEndX; x++)
+    {
+      Int sampleDiff = orgLine[x] - srcLine[x];
+      Int edgeType;
+      if (x >= startX[SAO_TYPE_EO_0] && x < endX[SAO_TYPE_EO_0])
+      {
+        edgeType = sgn(srcLine[x] - srcLine[x-1]) + sgn(srcLine[x] - srcLine[x+1]);
+        diff [SAO_TYPE_EO_0][edgeType] += sampleDiff;
+        count[SAO_TYPE_EO_0][edgeType] ++;
       }
-      break;
-    case SAO_TYPE_BO:
+      if (x >= startX[SAO_TYPE_EO_90] && x < endX[SAO_TYPE_EO_90])
       {
-        startX = (!isCalculatePreDeblockSamples)?0
-                                                :( isRightAvail?(width- skipLinesR[typeIdx]):width)
-                                                ;
-        endX   = (!isCalculatePreDeblockSamples)?(isRightAvail ? (width - skipLinesR[typeIdx]) : width )
-                                                :width
-                                                ;
-        endY = isBelowAvail ? (height- skipLinesB[typeIdx]) : height;
-        Int shiftBits = ((compIdx == SAO_Y)?g_bitDepthY:g_bitDepthC)- NUM_SAO_BO_CLASSES_LOG2;
-        for (y=0; y< endY; y++)
-        {
-          for (x=startX; x< endX; x++)
-          {
-
-            Int bandIdx= srcLine[x] >> shiftBits; 
-            diff [bandIdx] += (orgLine[x] - srcLine[x]);
-            count[bandIdx] ++;
-          }
-          srcLine += srcStride;
-          orgLine += orgStride;
-        }
-        if(isCalculatePreDeblockSamples)
-        {
-          if(isBelowAvail)
-          {
-            startX = 0;
-            endX   = width;
-
-            for(y= 0; y< skipLinesB[typeIdx]; y++)
-            {
-              for (x=startX; x< endX; x++)
-              {
-                Int bandIdx= srcLine[x] >> shiftBits; 
-                diff [bandIdx] += (orgLine[x] - srcLine[x]);
-                count[bandIdx] ++;
-              }
-              srcLine  += srcStride;
-              orgLine  += orgStride;
-
-            }
-
-          }
-        }
+        edgeType = sgn(srcLine[x] - srcLineAbove[x]) + sgn(srcLine[x] - srcLineBelow[x]);
+        diff [SAO_TYPE_EO_90][edgeType] += sampleDiff;
+        count[SAO_TYPE_EO_90][edgeType] ++;
       }
-      break;
-    default:
+      if (x >= startX[SAO_TYPE_EO_135] && x < endX[SAO_TYPE_EO_135])
       {
-        printf("Not a supported SAO types\n");
-        assert(0);
-        exit(-1);
+        edgeType = sgn(srcLine[x] - srcLineAbove[x-1]) + sgn(srcLine[x] - srcLineBelow[x+1]);
+        diff [SAO_TYPE_EO_135][edgeType] += sampleDiff;
+        count[SAO_TYPE_EO_135][edgeType] ++;
+      }
+      if (x >= startX[SAO_TYPE_EO_45] && x < endX[SAO_TYPE_EO_45])
+      {
+        edgeType = sgn(srcLine[x] - srcLineAbove[x+1]) + sgn(srcLine[x] - srcLineBelow[x-1]);
+        diff [SAO_TYPE_EO_45][edgeType] += sampleDiff;
+        count[SAO_TYPE_EO_45][edgeType] ++;
       }
     }
+    for (x=startX[SAO_TYPE_BO]; x< endX[SAO_TYPE_BO]; x++)
+    {
+      Int bandIdx= srcLine[x] >> shiftBits; 
+      diff [SAO_TYPE_BO][bandIdx] += (orgLine[x] - srcLine[x]);
+      count[SAO_TYPE_BO][bandIdx] ++;
+    }
+    srcLine += srcStride;
+    orgLine += orgStride;
   }
+
+#if ENABLE_SIMD_SSE2
+  for (Int typeIdx=0; typeIdx< SAO_TYPE_START_BO; typeIdx++)
+  {
+    for (Int edgeIdx=0; edgeIdx< NUM_SAO_EO_CLASSES; edgeIdx++)
+    {
+      Int sumDiff[4], sumCnt[4];
+      _mm_storeu_si128((__m128i*)sumDiff, accDiff[typeIdx][edgeIdx]);
+      _mm_storeu_si128((__m128i*)sumCnt , accCnt [typeIdx][edgeIdx]);
+      diff [typeIdx][edgeIdx- 2] += (Int64)sumDiff[0] + sumDiff[1] + sumDiff[2] + sumDiff[3];
+      count[typeIdx][edgeIdx- 2] += (Int64)sumCnt [0] + sumCnt [1] + sumCnt [2] + sumCnt [3];
+    }
+  }
+#endif
 }
 
 //! \}
@@ -103,13 +103,28 @@ public:
   Void destroyEncData();
   Void initRDOCabacCoder(TEncSbac* pcRDGoOnSbacCoder, TComSlice* pcSlice) ;
   Void SAOProcess(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas , Bool isPreDBFSamplesUsed); 
+  Void SAOStartCtuRows(TComPic* pPic, Bool* sliceEnabled, const Double *lambdas);
+  Void SAOProcessCtuRow(TComPic* pPic, Int ctuRow);
+  Void SAOFinishCtuRows(TComPic* pPic);
+  virtual Void runItem(Int itemIdx, Int threadIdx);
 public: //methods
   Void getPreDBFStatistics(TComPic* pPic); 
 private: //methods
-  Void getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv,TComPic* pPic, Bool isCalculatePreDeblockSamples = false);
+  enum EncParallelStage
+  {
+    SAO_STAGE_ENC_STATS = NUM_SAO_BASE_STAGES ///< item = CTU, gather the statistics of all SAO types
+  };
+  Void getStatistics(SAOStatData*** blkStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv,TComPic* pPic, Int startCTU, Int numCTUs, Bool isCalculatePreDeblockSamples = false);
+  Void getCTUStatistics(Int ctu, SAOStatData** ctuStats, TComPicYuv* orgYuv, TComPicYuv* srcYuv, TComPic* pPic, Bool isCalculatePreDeblockSamples);
   Void decidePicParams(Bool* sliceEnabled, Int picTempLayer);
-  Void decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams);
+  Void decideBlkParams(TComPic* pic, Bool* sliceEnabled, SAOStatData*** blkStats, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam* reconParams, SAOBlkParam* codedParams, Int startCTU, Int endCTU);
+#if SAO_ENCODING_CHOICE
+  Void updateDisabledRate(TComPic* pic, SAOBlkParam* reconParams);
+#endif
   Void getBlkStats(Int compIdx, SAOStatData* statsDataTypes, Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height, Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail , Bool isCalculatePreDeblockSamples );
+  Void getStatsLineRange(Int typeIdx, Int y, Int width, Int height, Int skipLinesR, Int skipLinesB
+                       , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                       , Bool isCalculatePreDeblockSamples, Int& startX, Int& endX);
   Void deriveModeNewRDO(Int ctu, std::vector<SAOBlkParam*>& mergeList, Bool* sliceEnabled, SAOStatData*** blkStats, SAOBlkParam& modeParam, Double& modeNormCost, TEncSbac** cabacCoderRDO, Int inCabacLabel);
   Void deriveModeMergeRDO(Int ctu, std::vector<SAOBlkParam*>& mergeList, Bool* sliceEnabled, SAOStatData*** blkStats, SAOBlkParam& modeParam, Double& modeNormCost, TEncSbac** cabacCoderRDO, Int inCabacLabel);
   Int64 getDistortion(Int ctu, Int compIdx, Int typeIdc, Int typeAuxInfo, Int* offsetVal, SAOStatData& statData);
@@ -127,6 +142,14 @@ private: //members
   //statistics
   SAOStatData***         m_statData; //[ctu][comp][classes]
   SAOStatData***         m_preDBFstatData;
+  SAOStatData***         m_statsBlkStats;      //destination of the running CTU-parallel statistics stage
+  TComPicYuv*            m_statsOrgYuv;
+  TComPicYuv*            m_statsSrcYuv;
+  Bool                   m_statsPreDBFSamples;
+  Int                    m_statsStartCTU;
+  //CTU-row mode
+  Bool                   m_ctuRowSliceEnabled[NUM_SAO_COMPONENTS];
+  SAOBlkParam*           m_ctuRowReconParams;
 #if SAO_ENCODING_CHOICE
   Double                 m_saoDisabledRate[NUM_SAO_COMPONENTS][MAX_TLAYER];
 #endif
@@ -98,6 +98,7 @@ TEncSearch::TEncSearch()
   m_puhQTTempTransformSkipFlag[0] = NULL;
   m_puhQTTempTransformSkipFlag[1] = NULL;
   m_puhQTTempTransformSkipFlag[2] = NULL;
+  resetIntraSeeds();
   setWpScalingDistParam( NULL, -1, REF_PIC_LIST_X );
 }
 
@@ -195,6 +196,7 @@ void TEncSearch::init(TEncCfg*      pcEncCfg,
   }
   
   initTempBuff();
+  createMCCache();
   
   m_pTempPel = new Pel[g_uiMaxCUWidth*g_uiMaxCUHeight];
   
@@ -233,6 +235,17 @@ void TEncSearch::init(TEncCfg*      pcEncCfg,
   m_tmpYuvPred.create(MAX_CU_SIZE, MAX_CU_SIZE);
 }
 
+/** Forget the fast intra search seeds, called per CTU.
+ * The seeds are keyed on the CTU address only, so they must not survive into the next picture.
+ */
+Void TEncSearch::resetIntraSeeds()
+{
+  for( Int i = 0; i <= MAX_CU_DEPTH; i++ )
+  {
+    m_intraSeedNum[i] = 0;
+  }
+}
+
 #define FIRSTSEARCHSTOP     1
 
 #define TZ_SEARCH_CONFIGURATION                                                                                 \
@@ -1158,7 +1171,7 @@ TEncSearch::xIntraCodingChromaBlk( TComDataCU* pcCU,
     pcCU->getPattern()->initPattern         ( pcCU, uiTrDepth, uiAbsPartIdx );
 
     pcCU->getPattern()->initAdiPatternChroma( pcCU, uiAbsPartIdx, uiTrDepth, m_piYuvExt, m_iYuvExtStride, m_iYuvExtHeight, bAboveAvail, bLeftAvail );
-    Int*  pPatChroma  = ( uiChromaId > 0 ? pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_piYuvExt ) : pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_piYuvExt ) );
+    Pel*  pPatChroma  = ( uiChromaId > 0 ? pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_piYuvExt ) : pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_piYuvExt ) );
 
     //===== get prediction signal =====
     {
@@ -2204,8 +2217,8 @@ TEncSearch::preestChromaPredMode( TComDataCU* pcCU,
   Bool  bLeftAvail  = false;
   pcCU->getPattern()->initPattern         ( pcCU, 0, 0 );
   pcCU->getPattern()->initAdiPatternChroma( pcCU, 0, 0, m_piYuvExt, m_iYuvExtStride, m_iYuvExtHeight, bAboveAvail, bLeftAvail );
-  Int*  pPatChromaU = pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_piYuvExt );
-  Int*  pPatChromaV = pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_piYuvExt );
+  Pel*  pPatChromaU = pcCU->getPattern()->getAdiCbBuf( uiWidth, uiHeight, m_piYuvExt );
+  Pel*  pPatChromaV = pcCU->getPattern()->getAdiCrBuf( uiWidth, uiHeight, m_piYuvExt );
   
   //===== get best prediction modes (using SAD) =====
   UInt  uiMinMode   = 0;
@@ -2293,19 +2306,20 @@ TEncSearch::estIntraPredQT( TComDataCU* pcCU,
       }
       CandNum = 0;
       
-      for( Int modeIdx = 0; modeIdx < numModesAvailable; modeIdx++ )
+      if( m_pcEncCfg->getUseFastIntraSearch() )
       {
-        UInt uiMode = modeIdx;
-
-        predIntraLumaAng( pcCU->getPattern(), uiMode, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
-        
-        // use hadamard transform here
-        UInt uiSad = m_pcRdCost->calcHAD(g_bitDepthY, piOrg, uiStride, piPred, uiStride, uiWidth, uiHeight );
-        
-        UInt   iModeBits = xModeBitsIntra( pcCU, uiMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth );
-        Double cost      = (Double)uiSad + (Double)iModeBits * m_pcRdCost->getSqrtLambda();
-        
-        CandNum += xUpdateCandList( uiMode, cost, numModesForFullRD, uiRdModeList, CandCostList );
+        CandNum = xFastIntraModeSearch( pcCU, uiPU, uiPartOffset, uiDepth, uiInitTrDepth, piOrg, piPred, uiStride, uiWidth, uiHeight,
+                                        bAboveAvail, bLeftAvail, numModesForFullRD, uiRdModeList, CandCostList );
+      }
+      else
+      {
+        for( Int modeIdx = 0; modeIdx < numModesAvailable; modeIdx++ )
+        {
+          UInt   uiMode = modeIdx;
+          Double cost   = xGetIntraModeCostHAD( pcCU, uiMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth, piOrg, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
+          
+          CandNum += xUpdateCandList( uiMode, cost, numModesForFullRD, uiRdModeList, CandCostList );
+        }
       }
 
       Int uiPreds[3] = {-1, -1, -1};
@@ -5021,6 +5035,192 @@ UInt TEncSearch::xUpdateCandList( UInt uiMode, Double uiCost, UInt uiFastCandNum
   return 0;
 }
 
+/** SATD based cost of one intra luma mode, used for the pre-selection of the RD candidates
+ */
+Double TEncSearch::xGetIntraModeCostHAD( TComDataCU* pcCU, UInt uiMode, UInt uiPU, UInt uiPartOffset, UInt uiDepth, UInt uiInitTrDepth,
+                                         Pel* piOrg, Pel* piPred, UInt uiStride, UInt uiWidth, UInt uiHeight, Bool bAboveAvail, Bool bLeftAvail )
+{
+  predIntraLumaAng( pcCU->getPattern(), uiMode, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
+  
+  // use hadamard transform here
+  UInt uiSad = m_pcRdCost->calcHAD(g_bitDepthY, piOrg, uiStride, piPred, uiStride, uiWidth, uiHeight );
+  
+  UInt   iModeBits = xModeBitsIntra( pcCU, uiMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth );
+  return (Double)uiSad + (Double)iModeBits * m_pcRdCost->getSqrtLambda();
+}
+
+/** dominant edge directions of the original block, as angular intra modes
+ * The Sobel gradient of each inner sample votes with its magnitude for the angular mode whose
+ * prediction direction is closest to the edge direction (perpendicular to the gradient).
+ * \returns number of modes written to puiModes, sorted by decreasing weight
+ */
+Int TEncSearch::xGetGradientModes( Pel* piOrg, UInt uiStride, UInt uiWidth, UInt uiHeight, UInt* puiModes, Int iMaxModes )
+{
+  // nearest index in the intra angle table {0, 2, 5, 9, 13, 17, 21, 26, 32} for |angle| = 0..32
+  static const Int aiAngToOffset[33] = { 0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 8, 8, 8 };
+  UInt auiHist[NUM_INTRA_MODE];
+  ::memset( auiHist, 0, sizeof(auiHist) );
+  
+  for( UInt y = 1; y + 1 < uiHeight; y++ )
+  {
+    Pel* piAbove = piOrg + (y-1)*uiStride;
+    Pel* piCur   = piAbove + uiStride;
+    Pel* piBelow = piCur   + uiStride;
+    for( UInt x = 1; x + 1 < uiWidth; x++ )
+    {
+      Int iGradX = (piAbove[x+1] + 2*piCur[x+1] + piBelow[x+1]) - (piAbove[x-1] + 2*piCur[x-1] + piBelow[x-1]);
+      Int iGradY = (piBelow[x-1] + 2*piBelow[x] + piBelow[x+1]) - (piAbove[x-1] + 2*piAbove[x] + piAbove[x+1]);
+      if( iGradX == 0 && iGradY == 0 )
+      {
+        continue;
+      }
+      Int iMode;
+      if( abs(iGradX) >= abs(iGradY) )
+      {
+        // near-vertical edge: prediction angle of the vertical modes
+        Int iAngle = ( 32*iGradY ) / iGradX;
+        iMode = VER_IDX + ( iAngle < 0 ? -aiAngToOffset[-iAngle] : aiAngToOffset[iAngle] );
+      }
+      else
+      {
+        // near-horizontal edge: prediction angle of the horizontal modes
+        Int iAngle = ( 32*iGradX ) / iGradY;
+        iMode = HOR_IDX - ( iAngle < 0 ? -aiAngToOffset[-iAngle] : aiAngToOffset[iAngle] );
+      }
+      auiHist[iMode] += abs(iGradX) + abs(iGradY);
+    }
+  }
+  
+  Int iNumModes = 0;
+  for( Int i = 0; i < iMaxModes; i++ )
+  {
+    UInt uiBestMode = 0;
+    for( UInt uiMode = 2; uiMode < NUM_INTRA_MODE-1; uiMode++ )
+    {
+      if( auiHist[uiMode] > auiHist[uiBestMode] )
+      {
+        uiBestMode = uiMode;
+      }
+    }
+    if( auiHist[uiBestMode] == 0 )
+    {
+      break;
+    }
+    puiModes[iNumModes++] = uiBestMode;
+    auiHist[uiBestMode]   = 0;
+  }
+  return iNumModes;
+}
+
+/** fast pre-selection of the intra luma RD candidates
+ * Instead of all 35 modes, SATD costs are computed for planar, DC, the MPMs, the dominant
+ * gradient directions of the block and the best modes of the enclosing PU. The best angular
+ * candidates are then refined with their +-2 and +-1 neighbours.
+ * \returns number of candidates in puiRdModeList
+ */
+UInt TEncSearch::xFastIntraModeSearch( TComDataCU* pcCU, UInt uiPU, UInt uiPartOffset, UInt uiDepth, UInt uiInitTrDepth,
+                                       Pel* piOrg, Pel* piPred, UInt uiStride, UInt uiWidth, UInt uiHeight, Bool bAboveAvail, Bool bLeftAvail,
+                                       Int iNumModesForFullRD, UInt* puiRdModeList, Double* pdCandCostList )
+{
+  const Int iNumModesAvailable = 35;
+  Bool abModeTested[NUM_INTRA_MODE];
+  ::memset( abModeTested, 0, sizeof(abModeTested) );
+  UInt uiCandNum = 0;
+  Int  iNumTested = 0;
+  
+  //===== seeds =====
+  UInt auiSeeds[2 + 3 + FAST_INTRA_GRAD_MODES + FAST_INTRA_SEED_MODES];
+  Int  iNumSeeds = 0;
+  auiSeeds[iNumSeeds++] = PLANAR_IDX;
+  auiSeeds[iNumSeeds++] = DC_IDX;
+  
+  Int aiPreds[3] = {-1, -1, -1};
+  pcCU->getIntraDirLumaPredictor( uiPartOffset, aiPreds );
+  for( Int i = 0; i < 3; i++ )
+  {
+    auiSeeds[iNumSeeds++] = aiPreds[i];
+  }
+  
+  iNumSeeds += xGetGradientModes( piOrg, uiStride, uiWidth, uiHeight, auiSeeds + iNumSeeds, FAST_INTRA_GRAD_MODES );
+  
+  UInt uiPUDepth = uiDepth + uiInitTrDepth;
+  UInt uiAbsPart = pcCU->getZorderIdxInCU() + uiPartOffset;
+  if( uiPUDepth > 0 && m_intraSeedNum[uiPUDepth-1] > 0 && m_intraSeedCUAddr[uiPUDepth-1] == pcCU->getAddr() )
+  {
+    UInt uiParentParts = pcCU->getPic()->getNumPartInCU() >> ( (uiPUDepth-1) << 1 );
+    if( uiAbsPart >= m_intraSeedAbsPart[uiPUDepth-1] && uiAbsPart < m_intraSeedAbsPart[uiPUDepth-1] + uiParentParts )
+    {
+      for( Int i = 0; i < m_intraSeedNum[uiPUDepth-1]; i++ )
+      {
+        auiSeeds[iNumSeeds++] = m_intraSeedModes[uiPUDepth-1][i];
+      }
+    }
+  }
+  
+  for( Int i = 0; i < iNumSeeds; i++ )
+  {
+    UInt uiMode = auiSeeds[i];
+    if( !abModeTested[uiMode] )
+    {
+      Double cost = xGetIntraModeCostHAD( pcCU, uiMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth, piOrg, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
+      uiCandNum += xUpdateCandList( uiMode, cost, iNumModesForFullRD, puiRdModeList, pdCandCostList );
+      abModeTested[uiMode] = true;
+      iNumTested++;
+    }
+  }
+  
+  //===== refinement around the two best angular candidates =====
+  for( Int iStep = 2; iStep > 0; iStep-- )
+  {
+    UInt auiCenter[2];
+    Int  iNumCenters = 0;
+    for( Int i = 0; i < min( iNumTested, iNumModesForFullRD ) && iNumCenters < 2; i++ )
+    {
+      if( puiRdModeList[i] > DC_IDX )
+      {
+        auiCenter[iNumCenters++] = puiRdModeList[i];
+      }
+    }
+    for( Int i = 0; i < iNumCenters; i++ )
+    {
+      for( Int iSign = -1; iSign <= 1; iSign += 2 )
+      {
+        Int iMode = (Int)auiCenter[i] + iSign*iStep;
+        if( iMode > DC_IDX && iMode < iNumModesAvailable && !abModeTested[iMode] )
+        {
+          Double cost = xGetIntraModeCostHAD( pcCU, iMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth, piOrg, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
+          uiCandNum += xUpdateCandList( iMode, cost, iNumModesForFullRD, puiRdModeList, pdCandCostList );
+          abModeTested[iMode] = true;
+          iNumTested++;
+        }
+      }
+    }
+  }
+  
+  //===== make sure that the candidate list is filled =====
+  for( Int iMode = 0; iMode < iNumModesAvailable && iNumTested < iNumModesForFullRD; iMode++ )
+  {
+    if( !abModeTested[iMode] )
+    {
+      Double cost = xGetIntraModeCostHAD( pcCU, iMode, uiPU, uiPartOffset, uiDepth, uiInitTrDepth, piOrg, piPred, uiStride, uiWidth, uiHeight, bAboveAvail, bLeftAvail );
+      uiCandNum += xUpdateCandList( iMode, cost, iNumModesForFullRD, puiRdModeList, pdCandCostList );
+      abModeTested[iMode] = true;
+      iNumTested++;
+    }
+  }
+  
+  //===== remember the best modes as seeds for the sub-blocks of this PU =====
+  m_intraSeedCUAddr [uiPUDepth] = pcCU->getAddr();
+  m_intraSeedAbsPart[uiPUDepth] = uiAbsPart;
+  m_intraSeedNum    [uiPUDepth] = min( iNumModesForFullRD, FAST_INTRA_SEED_MODES );
+  for( Int i = 0; i < m_intraSeedNum[uiPUDepth]; i++ )
+  {
+    m_intraSeedModes[uiPUDepth][i] = puiRdModeList[i];
+  }
+  
+  return uiCandNum;
+}
+
 /** add inter-prediction syntax elements for a CU block
  * \param pcCU
  * \param uiQp
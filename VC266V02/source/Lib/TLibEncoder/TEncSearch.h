@@ -111,6 +111,12 @@ protected:
   // AMVP cost computation
   // UInt            m_auiMVPIdxCost[AMVP_MAX_NUM_CANDS+1][AMVP_MAX_NUM_CANDS];
   UInt            m_auiMVPIdxCost[AMVP_MAX_NUM_CANDS+1][AMVP_MAX_NUM_CANDS+1]; //th array bounds
+
+  // fast intra search: best modes of the last searched PU at each PU depth, used as seeds for its sub-blocks
+  UInt            m_intraSeedCUAddr [MAX_CU_DEPTH+1];
+  UInt            m_intraSeedAbsPart[MAX_CU_DEPTH+1];
+  Int             m_intraSeedNum    [MAX_CU_DEPTH+1];
+  UInt            m_intraSeedModes  [MAX_CU_DEPTH+1][FAST_INTRA_SEED_MODES];
   
 public:
   TEncSearch();
@@ -127,6 +133,8 @@ public:
             TEncSbac***   pppcRDSbacCoder,
             TEncSbac*     pcRDGoOnSbacCoder );
   
+  Void resetIntraSeeds();
+  
 protected:
   
   /// sub-function for motion vector refinement used in fractional-pel accuracy
@@ -428,6 +436,12 @@ protected:
   
   UInt  xModeBitsIntra ( TComDataCU* pcCU, UInt uiMode, UInt uiPU, UInt uiPartOffset, UInt uiDepth, UInt uiInitTrDepth );
   UInt  xUpdateCandList( UInt uiMode, Double uiCost, UInt uiFastCandNum, UInt * CandModeList, Double * CandCostList );
+  Double xGetIntraModeCostHAD( TComDataCU* pcCU, UInt uiMode, UInt uiPU, UInt uiPartOffset, UInt uiDepth, UInt uiInitTrDepth,
+                               Pel* piOrg, Pel* piPred, UInt uiStride, UInt uiWidth, UInt uiHeight, Bool bAboveAvail, Bool bLeftAvail );
+  Int   xGetGradientModes( Pel* piOrg, UInt uiStride, UInt uiWidth, UInt uiHeight, UInt* puiModes, Int iMaxModes );
+  UInt  xFastIntraModeSearch( TComDataCU* pcCU, UInt uiPU, UInt uiPartOffset, UInt uiDepth, UInt uiInitTrDepth,
+                              Pel* piOrg, Pel* piPred, UInt uiStride, UInt uiWidth, UInt uiHeight, Bool bAboveAvail, Bool bLeftAvail,
+                              Int iNumModesForFullRD, UInt* puiRdModeList, Double* pdCandCostList );
   
   // -------------------------------------------------------------------------------------------------------------------
   // compute symbol bits
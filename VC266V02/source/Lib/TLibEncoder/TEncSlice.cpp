@@ -145,6 +145,8 @@ Void TEncSlice::init( TEncTop* pcEncTop )
   m_pcRDGoOnSbacCoder = pcEncTop->getRDGoOnSbacCoder();
 
   m_pcRateCtrl        = pcEncTop->getRateCtrl();
+
+  setSADSubsample( m_pcCfg->getWPSADSubsample() );
 }
 
 /**
@@ -655,6 +657,12 @@ Void TEncSlice::compressSlice( TComPic*& rpcPic )
     m_uiPicTotalBits += pcCU->getTotalBits();
     m_dPicRdCost     += pcCU->getTotalCost();
     m_uiPicDist      += pcCU->getTotalDistortion();
+
+    // CTU-row ALF mode: in-loop filters of the rows completed by this CTU row
+    if ( uiCol == uiWidthInLCUs - 1 && m_pcGOPEncoder->getFilterCtuRows() )
+    {
+      m_pcGOPEncoder->filterCtuRows( rpcPic, uiLin + 1 );
+    }
   }
   xRestoreWPparam( pcSlice );
 }
@@ -87,6 +87,8 @@ Void TEncTop::create ()
   // initialize global variables
   initROM();
   
+  m_cThreadPool.create( m_numWorkerThreads );
+
   // create processing unit classes
   m_cGOPEncoder.        create();
   m_cSliceEncoder.      create( getSourceWidth(), getSourceHeight(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth );
@@ -95,11 +97,13 @@ Void TEncTop::create ()
   {
     m_cEncSAO.create( getSourceWidth(), getSourceHeight(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth );
     m_cEncSAO.createEncData(getSaoLcuBoundary());
+    m_cEncSAO.setThreadPool(&m_cThreadPool);
 
   }
 
 #if ALF_TEST
   m_cAdaptiveLoopFilter.create(getSourceWidth(), getSourceHeight(), g_uiMaxCUWidth, g_uiMaxCUHeight, g_uiMaxCUDepth);
+  m_cAdaptiveLoopFilter.setThreadPool(&m_cThreadPool);
 #endif
 #if MQT_BA_RA && MQT_ALF_NPASS
   if (m_bUseALF)
@@ -113,7 +117,7 @@ Void TEncTop::create ()
   if ( m_RCEnableRateControl )
   {
     m_cRateCtrl.init( m_framesToBeEncoded, m_RCTargetBitrate, m_iFrameRate, m_iGOPSize, m_iSourceWidth, m_iSourceHeight,
-                      g_uiMaxCUWidth, g_uiMaxCUHeight, m_RCKeepHierarchicalBit, m_RCUseLCUSeparateModel, m_GOPList );
+                      g_uiMaxCUWidth, g_uiMaxCUHeight, m_RCKeepHierarchicalBit, m_RCUseLCUSeparateModel, m_GOPList, m_RCLookahead );
   }
 
     m_pppcRDSbacCoder = new TEncSbac** [g_uiMaxCUDepth+1];
@@ -209,6 +213,7 @@ Void TEncTop::destroy ()
 
   m_cLoopFilter.        destroy();
   m_cRateCtrl.          destroy();
+  m_cThreadPool.        destroy();
 
   Int iDepth;
   for ( iDepth = 0; iDepth < g_uiMaxCUDepth+1; iDepth++ )
@@ -270,7 +275,7 @@ Void TEncTop::init()
   
   /* set the VPS profile information */
   *m_cVPS.getPTL() = *m_cSPS.getPTL();
-  m_cVPS.getTimingInfo()->setTimingInfoPresentFlag       ( false );
+  xInitHRD();
   // initialize PPS
   m_cPPS.setSPS(&m_cSPS);
   xInitPPS();
@@ -299,6 +304,8 @@ Void TEncTop::init()
   if (m_bUseALF)
   {
     m_cAdaptiveLoopFilter.setALFEncodePassReduction(m_iALFEncodePassReduction);
+    m_cAdaptiveLoopFilter.setALFTemporalReuse(m_bALFTemporalReuse);
+    m_cAdaptiveLoopFilter.setALFCtuRowMode(m_bALFCtuRowMode);
   }
 #endif
 #endif
@@ -343,6 +350,12 @@ Void TEncTop::encode(Bool flush, TComPicYuv* pcPicYuvOrg, TComList<TComPicYuv*>&
     TComPic* pcPicCurr = NULL;
     xGetNewPicBuffer( pcPicCurr );
     pcPicYuvOrg->copyToPic( pcPicCurr->getPicYuvOrg() );
+    pcPicCurr->setWpAcDcParamValid( false );
+
+    if ( m_RCEnableRateControl )
+    {
+      m_cRateCtrl.addLookaheadPicture( pcPicCurr );
+    }
   }
   
   if (!m_iNumPicRcvd || (!flush && m_iPOCLast != 0 && m_iNumPicRcvd != m_iGOPSize && m_iGOPSize))
@@ -353,7 +366,7 @@ Void TEncTop::encode(Bool flush, TComPicYuv* pcPicYuvOrg, TComList<TComPicYuv*>&
   
   if ( m_RCEnableRateControl )
   {
-    m_cRateCtrl.initRCGOP( m_iNumPicRcvd );
+    m_cRateCtrl.initRCGOP( m_iNumPicRcvd, m_iPOCLast );
   }
 
   // compress GOP
@@ -420,6 +433,11 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic )
         break;
       }
     }
+    // the picture may still be measured by the metrics stage of the GOP encoder
+    if (m_cGOPEncoder.isInMetricsStage(rpcPic))
+    {
+      m_cGOPEncoder.finishMetrics();
+    }
   }
   else
   {
@@ -438,6 +456,56 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic )
   rpcPic->getPicYuvRec()->setBorderExtension(false);
 }
 
+/** signal the coded picture buffer of the rate control in the VPS; the model of the rate control uses the signalled, rounded values
+ */
+Void TEncTop::xInitHRD()
+{
+  TimingInfo *timingInfo = m_cVPS.getTimingInfo();
+  if ( !m_RCEnableRateControl || m_RCCpbSize <= 0 )
+  {
+    timingInfo->setTimingInfoPresentFlag( false );
+    return;
+  }
+
+  timingInfo->setTimingInfoPresentFlag      ( true );
+  timingInfo->setNumUnitsInTick             ( 1 );
+  timingInfo->setTimeScale                  ( m_iFrameRate );
+  timingInfo->setPocProportionalToTimingFlag( false );
+
+  m_cVPS.setNumHrdParameters( 1 );
+  m_cVPS.createHrdParamBuffer();
+  m_cVPS.setHrdOpSetIdx( 0, 0 );
+  m_cVPS.setCprmsPresentFlag( true, 0 );
+
+  const Int bitRateScale = 4;   // bit rate in units of 2^(6+4) bit/s
+  const Int cpbSizeScale = 6;   // CPB size in units of 2^(4+6) bit
+  Int bitRate  = m_RCCpbMaxBitrate > 0 ? m_RCCpbMaxBitrate : m_RCTargetBitrate;
+  UInt bitRateValueMinus1 = max( 1, bitRate     >> ( 6 + bitRateScale ) ) - 1;
+  UInt cpbSizeValueMinus1 = max( 1, m_RCCpbSize >> ( 4 + cpbSizeScale ) ) - 1;
+
+  TComHRD *hrd = m_cVPS.getHrdParameters( 0 );
+  hrd->setNalHrdParametersPresentFlag( true );
+  hrd->setVclHrdParametersPresentFlag( false );
+  hrd->setSubPicCpbParamsPresentFlag ( false );
+  hrd->setBitRateScale( bitRateScale );
+  hrd->setCpbSizeScale( cpbSizeScale );
+  hrd->setInitialCpbRemovalDelayLengthMinus1( 23 );
+  hrd->setCpbRemovalDelayLengthMinus1       ( 23 );
+  hrd->setDpbOutputDelayLengthMinus1        ( 23 );
+  for ( Int i = 0; i < MAX_TLAYER; i++ )
+  {
+    hrd->setFixedPicRateFlag      ( i, true );
+    hrd->setPicDurationInTcMinus1 ( i, 0 );
+    hrd->setLowDelayHrdFlag       ( i, false );
+    hrd->setCpbCntMinus1          ( i, 0 );
+    hrd->setBitRateValueMinus1    ( i, 0, 0, bitRateValueMinus1 );
+    hrd->setCpbSizeValueMinus1    ( i, 0, 0, cpbSizeValueMinus1 );
+    hrd->setCbrFlag               ( i, 0, 0, false );
+  }
+
+  m_cRateCtrl.getRCSeq()->initCpb( ( cpbSizeValueMinus1 + 1 ) << ( 4 + cpbSizeScale ), ( bitRateValueMinus1 + 1 ) << ( 6 + bitRateScale ) );
+}
+
 Void TEncTop::xInitSPS()
 {
   ProfileTierLevel& profileTierLevel = *m_cSPS.getPTL()->getGeneralPTL();
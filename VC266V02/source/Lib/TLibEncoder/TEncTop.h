@@ -43,6 +43,7 @@
 #include "TLibCommon/TComPrediction.h"
 #include "TLibCommon/TComTrQuant.h"
 #include "TLibCommon/AccessUnit.h"
+#include "TLibCommon/TComThreadPool.h"
 
 #include "TLibVideoIO/TVideoIOYuv.h"
 
@@ -86,6 +87,7 @@ private:
 #endif
   
   TEncSampleAdaptiveOffset m_cEncSAO;                     ///< sample adaptive offset class
+  TComThreadPool          m_cThreadPool;                  ///< worker threads for CTU-parallel encoder stages
   TEncEntropy             m_cEntropyCoder;                ///< entropy encoder
   TEncCavlc               m_cCavlcCoder;                  ///< CAVLC encoder
   TEncSbac                m_cSbacCoder;                   ///< SBAC encoder
@@ -121,6 +123,7 @@ private:
 protected:
   Void  xGetNewPicBuffer  ( TComPic*& rpcPic );           ///< get picture buffer which will be processed
   Void  xInitSPS          ();                             ///< initialize SPS from encoder options
+  Void  xInitHRD          ();                             ///< initialize VPS timing and HRD parameters from the rate control buffer options
   Void  xInitPPS          ();                             ///< initialize PPS from encoder options
   
   Void  xInitRPS          ();                             ///< initialize PPS from encoder options
@@ -151,10 +154,15 @@ public:
 #if MQT_ALF_NPASS
   Void      setALFEncodePassReduction(Int i)  { m_iALFEncodePassReduction = i; }
   Int       getALFEncodePassReduction()       { return m_iALFEncodePassReduction; }
+  Void      setALFTemporalReuse(Bool b)       { m_bALFTemporalReuse = b; }
+  Bool      getALFTemporalReuse()             { return m_bALFTemporalReuse; }
+  Void      setALFCtuRowMode(Bool b)          { m_bALFCtuRowMode = b; }
+  Bool      getALFCtuRowMode()                { return m_bALFCtuRowMode; }
 #endif
 #endif
   
   TEncSampleAdaptiveOffset* getSAO              () { return  &m_cEncSAO;              }
+  TComThreadPool*         getThreadPool         () { return  &m_cThreadPool;          }
   TEncGOP*                getGOPEncoder         () { return  &m_cGOPEncoder;          }
   TEncSlice*              getSliceEncoder       () { return  &m_cSliceEncoder;        }
   TEncCu*                 getCuEncoder          () { return  &m_cCuEncoder;           }
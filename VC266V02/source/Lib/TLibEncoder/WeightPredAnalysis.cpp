@@ -40,14 +40,60 @@
 #include "../TLibCommon/TComPic.h"
 #include "../TLibCommon/TComPicYuv.h"
 #include "WeightPredAnalysis.h"
+#if ENABLE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 #define ABS(a)    ((a) < 0 ? - (a) : (a))
 #define DTHRESH (0.99)
 
+#if ENABLE_SIMD_SSE2
+/** sum of one line of samples, 8 samples per iteration
+ * \returns number of samples processed, the caller handles the rest
+ */
+static Int sumLineSSE2(const Pel* pPel, Int iWidth, Int64& riSum)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i sum = _mm_setzero_si128();
+  Int x;
+  for (x=0; x+8 <= iWidth; x+=8)
+  {
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(pPel+x)), one));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  riSum += _mm_cvtsi128_si32(sum);
+  return x;
+}
+
+/** sum of the absolute deviations of one line of samples from iDC, 8 samples per iteration
+ * \returns number of samples processed, the caller handles the rest
+ */
+static Int absDevLineSSE2(const Pel* pPel, Int iWidth, Int iDC, Int64& riAbsDev)
+{
+  const __m128i one  = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i dc   = _mm_set1_epi16((Short)iDC);
+  __m128i sum = _mm_setzero_si128();
+  Int x;
+  for (x=0; x+8 <= iWidth; x+=8)
+  {
+    __m128i dev = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)(pPel+x)), dc);
+    dev = _mm_max_epi16(dev, _mm_sub_epi16(zero, dev));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(dev, one));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  riAbsDev += _mm_cvtsi128_si32(sum);
+  return x;
+}
+#endif
+
 WeightPredAnalysis::WeightPredAnalysis()
 {
   m_weighted_pred_flag = false;
   m_weighted_bipred_flag = false;
+  m_iSADSubsample = 2;
   for ( Int iList =0 ; iList<2 ; iList++ )
   {
     for ( Int iRefIdx=0 ; iRefIdx<MAX_NUM_REF ; iRefIdx++ ) 
@@ -65,13 +111,23 @@ WeightPredAnalysis::WeightPredAnalysis()
 }
 
 /** calculate AC and DC values for current original image
+ *
+ * The statistics only depend on the original picture, so they are computed once per picture and reused by
+ * all its slices and by repeated encodings of the same slice.
  * \param TComSlice *slice
  * \returns Void
  */
 Bool  WeightPredAnalysis::xCalcACDCParamSlice(TComSlice *slice)
 {
+  TComPic* pcPic = slice->getPic();
+  if (pcPic->getWpAcDcParamValid())
+  {
+    slice->setWpAcDcParam(pcPic->getWpAcDcParam());
+    return (true);
+  }
+
   //===== calculate AC/DC value =====
-  TComPicYuv*   pPic = slice->getPic()->getPicYuvOrg();
+  TComPicYuv*   pPic = pcPic->getPicYuvOrg();
   Int   iSample  = 0;
 
   // calculate DC/AC value for Y
@@ -95,13 +151,14 @@ Bool  WeightPredAnalysis::xCalcACDCParamSlice(TComSlice *slice)
   pOrg = pPic->getCrAddr();
   Int64  iOrgACCr  = xCalcACValueUVSlice(slice, pOrg, iOrgNormDCCr);
 
-  wpACDCParam weightACDCParam[3];
+  wpACDCParam* weightACDCParam = pcPic->getWpAcDcParam();
   weightACDCParam[0].iAC = iOrgACY;
   weightACDCParam[0].iDC = iOrgNormDCY;
   weightACDCParam[1].iAC = iOrgACCb;
   weightACDCParam[1].iDC = iOrgNormDCCb;
   weightACDCParam[2].iAC = iOrgACCr;
   weightACDCParam[2].iDC = iOrgNormDCCr;
+  pcPic->setWpAcDcParamValid(true);
 
   slice->setWpAcDcParam(weightACDCParam);
   return (true);
@@ -289,8 +346,7 @@ Bool WeightPredAnalysis::xSelectWP(TComSlice *slice, wpScalingParam weightPredTa
       Int   iRefStride = slice->getRefPic(eRefPicList, iRefIdxTemp)->getPicYuvRec()->getStride();
 
       // calculate SAD costs with/without wp for luma
-      iSADWP   = this->xCalcSADvalueWP(g_bitDepthY, pOrg, pRef, iWidth, iHeight, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][0].iWeight, weightPredTable[iRefList][iRefIdxTemp][0].iOffset);
-      iSADnoWP = this->xCalcSADvalueWP(g_bitDepthY, pOrg, pRef, iWidth, iHeight, iOrgStride, iRefStride, iDenom, iDefaultWeight, 0);
+      xCalcSADvalueWP(g_bitDepthY, pOrg, pRef, iWidth, iHeight, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][0].iWeight, weightPredTable[iRefList][iRefIdxTemp][0].iOffset, iSADWP, iSADnoWP);
 
       pOrg = pPic->getCbAddr();
       pRef = slice->getRefPic(eRefPicList, iRefIdxTemp)->getPicYuvRec()->getCbAddr();
@@ -298,15 +354,18 @@ Bool WeightPredAnalysis::xSelectWP(TComSlice *slice, wpScalingParam weightPredTa
       iRefStride = slice->getRefPic(eRefPicList, iRefIdxTemp)->getPicYuvRec()->getCStride();
 
       // calculate SAD costs with/without wp for chroma cb
-      iSADWP   += this->xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][1].iWeight, weightPredTable[iRefList][iRefIdxTemp][1].iOffset);
-      iSADnoWP += this->xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, iDefaultWeight, 0);
+      Int64 iSADWPC, iSADnoWPC;
+      xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][1].iWeight, weightPredTable[iRefList][iRefIdxTemp][1].iOffset, iSADWPC, iSADnoWPC);
+      iSADWP   += iSADWPC;
+      iSADnoWP += iSADnoWPC;
 
       pOrg = pPic->getCrAddr();
       pRef = slice->getRefPic(eRefPicList, iRefIdxTemp)->getPicYuvRec()->getCrAddr();
 
       // calculate SAD costs with/without wp for chroma cr
-      iSADWP   += this->xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][2].iWeight, weightPredTable[iRefList][iRefIdxTemp][2].iOffset);
-      iSADnoWP += this->xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, iDefaultWeight, 0);
+      xCalcSADvalueWP(g_bitDepthC, pOrg, pRef, iWidth>>1, iHeight>>1, iOrgStride, iRefStride, iDenom, weightPredTable[iRefList][iRefIdxTemp][2].iWeight, weightPredTable[iRefList][iRefIdxTemp][2].iOffset, iSADWPC, iSADnoWPC);
+      iSADWP   += iSADWPC;
+      iSADnoWP += iSADnoWPC;
 
       Double dRatio = ((Double)iSADWP / (Double)iSADnoWP);
       if(dRatio >= (Double)DTHRESH)
@@ -413,7 +472,11 @@ Int64 WeightPredAnalysis::xCalcDCValue(Pel *pPel, Int iWidth, Int iHeight, Int i
   Int64 iDC = 0;
   for( y = 0; y < iHeight; y++ )
   {
-    for( x = 0; x < iWidth; x++ )
+    x = 0;
+#if ENABLE_SIMD_SSE2
+    x = sumLineSSE2(pPel, iWidth, iDC);
+#endif
+    for( ; x < iWidth; x++ )
     {
       iDC += (Int)( pPel[x] );
     }
@@ -436,7 +499,11 @@ Int64 WeightPredAnalysis::xCalcACValue(Pel *pPel, Int iWidth, Int iHeight, Int i
   Int64 iAC = 0;
   for( y = 0; y < iHeight; y++ )
   {
-    for( x = 0; x < iWidth; x++ )
+    x = 0;
+#if ENABLE_SIMD_SSE2
+    x = absDevLineSSE2(pPel, iWidth, (Int)iDC, iAC);
+#endif
+    for( ; x < iWidth; x++ )
     {
       iAC += abs( (Int)pPel[x] - (Int)iDC );
     }
@@ -445,7 +512,7 @@ Int64 WeightPredAnalysis::xCalcACValue(Pel *pPel, Int iWidth, Int iHeight, Int i
   return (iAC);
 }
 
-/** calculate SAD values for both WP version and non-WP version. 
+/** calculate SAD values for both WP version and non-WP version in one pass over a subsampled grid
  * \param Pel *pOrgPel
  * \param Pel *pRefPel
  * \param Int iWidth
@@ -455,24 +522,31 @@ Int64 WeightPredAnalysis::xCalcACValue(Pel *pPel, Int iWidth, Int iHeight, Int i
  * \param Int iDenom
  * \param Int iWeight
  * \param Int iOffset
- * \returns Int64
+ * \param Int64 &riSADWP   mean SAD with the weights
+ * \param Int64 &riSADnoWP mean SAD with the default weight and no offset
+ * \returns Void
  */
-Int64 WeightPredAnalysis::xCalcSADvalueWP(Int bitDepth, Pel *pOrgPel, Pel *pRefPel, Int iWidth, Int iHeight, Int iOrgStride, Int iRefStride, Int iDenom, Int iWeight, Int iOffset)
+Void WeightPredAnalysis::xCalcSADvalueWP(Int bitDepth, Pel *pOrgPel, Pel *pRefPel, Int iWidth, Int iHeight, Int iOrgStride, Int iRefStride, Int iDenom, Int iWeight, Int iOffset, Int64 &riSADWP, Int64 &riSADnoWP)
 {
   Int x, y;
-  Int64 iSAD = 0;
-  Int64 iSize   = iWidth*iHeight;
+  Int64 iSADWP = 0, iSADnoWP = 0;
+  Int64 iSize   = 0;
   Int64 iRealDenom = iDenom + bitDepth-8;
-  for( y = 0; y < iHeight; y++ )
+  Int64 iDefaultWeight = (Int64)1<<iDenom;
+  for( y = 0; y < iHeight; y += m_iSADSubsample )
   {
-    for( x = 0; x < iWidth; x++ )
+    for( x = 0; x < iWidth; x += m_iSADSubsample )
     {
-      iSAD += ABS(( ((Int64)pOrgPel[x]<<(Int64)iDenom) - ( (Int64)pRefPel[x] * (Int64)iWeight + ((Int64)iOffset<<iRealDenom) ) ) );
+      Int64 iOrg = (Int64)pOrgPel[x]<<(Int64)iDenom;
+      iSADWP   += ABS(( iOrg - ( (Int64)pRefPel[x] * (Int64)iWeight + ((Int64)iOffset<<iRealDenom) ) ) );
+      iSADnoWP += ABS(( iOrg - (Int64)pRefPel[x] * iDefaultWeight ) );
+      iSize++;
     }
-    pOrgPel += iOrgStride;
-    pRefPel += iRefStride;
+    pOrgPel += iOrgStride * m_iSADSubsample;
+    pRefPel += iRefStride * m_iSADSubsample;
   }
-  return (iSAD/iSize);
+  riSADWP   = iSADWP/iSize;
+  riSADnoWP = iSADnoWP/iSize;
 }
 
 
@@ -46,16 +46,16 @@ class  WeightPredAnalysis
   Bool m_weighted_pred_flag;
   Bool  m_weighted_bipred_flag;
   wpScalingParam  m_wp[2][MAX_NUM_REF][3];
+  Int   m_iSADSubsample;  ///< xSelectWP() compares the SADs on every n-th sample of every n-th line
 
   Int64   xCalcDCValueSlice(TComSlice *slice, Pel *pPel,Int *iSample);
   Int64   xCalcACValueSlice(TComSlice *slice, Pel *pPel, Int64 iDC);
   Int64   xCalcDCValueUVSlice(TComSlice *slice, Pel *pPel, Int *iSample);
   Int64   xCalcACValueUVSlice(TComSlice *slice, Pel *pPel, Int64 iDC);
-  Int64   xCalcSADvalueWPSlice(TComSlice *slice, Pel *pOrgPel, Pel *pRefPel, Int iDenom, Int iWeight, Int iOffset);
 
   Int64   xCalcDCValue(Pel *pPel, Int iWidth, Int iHeight, Int iStride);
   Int64   xCalcACValue(Pel *pPel, Int iWidth, Int iHeight, Int iStride, Int64 iDC);
-  Int64   xCalcSADvalueWP(Int bitDepth, Pel *pOrgPel, Pel *pRefPel, Int iWidth, Int iHeight, Int iOrgStride, Int iRefStride, Int iDenom, Int iWeight, Int iOffset);
+  Void    xCalcSADvalueWP(Int bitDepth, Pel *pOrgPel, Pel *pRefPel, Int iWidth, Int iHeight, Int iOrgStride, Int iRefStride, Int iDenom, Int iWeight, Int iOffset, Int64 &riSADWP, Int64 &riSADnoWP);
   Bool    xSelectWP(TComSlice *slice, wpScalingParam weightPredTable[2][MAX_NUM_REF][3], Int iDenom);
   Bool    xUpdatingWPParameters(TComSlice *slice, wpScalingParam weightPredTable[2][MAX_NUM_REF][3], Int log2Denom);
 
@@ -69,6 +69,7 @@ public:
   Void  xStoreWPparam(Bool weighted_pred_flag, Bool weighted_bipred_flag);
   Void  xRestoreWPparam(TComSlice *slice);
   Void  xCheckWPEnable(TComSlice *slice);
+  Void  setSADSubsample(Int iStep) { m_iSADSubsample = iStep; }
 };
 
 #endif // __WEIGHTPREDANALYSIS__